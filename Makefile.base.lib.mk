@@ -1,4 +1,7 @@
 LIBRARY_BASE_CFLAGS = -std=c++11 -D_USE_MATH_DEFINES
+ifeq ($(ENABLE_TRACING),1)
+LIBRARY_BASE_CFLAGS += -DFASTUIDRAW_TRACING
+endif
 LIBRARY_debug_BASE_CFLAGS = $(LIBRARY_BASE_CFLAGS)
 LIBRARY_release_BASE_CFLAGS = $(LIBRARY_BASE_CFLAGS) -DNDEBUG
 
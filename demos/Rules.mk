@@ -28,6 +28,21 @@ include $(dir)/Rules.mk
 dir := $(d)/painter_cells
 include $(dir)/Rules.mk
 
+dir := $(d)/distance_field_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/painter_cpu_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/packed_value_pool_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/painter_bulk_write_benchmark
+include $(dir)/Rules.mk
+
+dir := $(d)/glyph_atlas_allocator_benchmark
+include $(dir)/Rules.mk
+
 
 
 # Begin standard footer
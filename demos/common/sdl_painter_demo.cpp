@@ -116,6 +116,21 @@ sdl_painter_demo(const std::string &about_text,
                                "glyph_atlas_delayed_upload",
                                "if true delay uploading of data to GL from glyph atlas until atlas flush",
                                *this),
+  m_glyph_texel_allocator(m_glyph_atlas_params.texel_allocator(),
+                          enumerated_string_type<enum fastuidraw::GlyphAtlas::texel_allocator_t>()
+                          .add_entry("tree",
+                                     fastuidraw::GlyphAtlas::tree_texel_allocator,
+                                     "binary tree of regions")
+                          .add_entry("skyline",
+                                     fastuidraw::GlyphAtlas::skyline_texel_allocator,
+                                     "skyline bottom-left packing"),
+                          "glyph_texel_allocator",
+                          "Determines how glyph texels are placed in the glyph atlas.",
+                          *this),
+  m_glyph_geometry_compaction_budget(0, "glyph_geometry_compaction_budget",
+                                     "number of microseconds per frame the glyph atlas may spend "
+                                     "moving glyph geometry data into the holes of its geometry store, "
+                                     "0 means never move glyph geometry data", *this),
   m_glyph_geometry_backing_store_type(glyph_geometry_backing_store_auto,
                                       enumerated_string_type<enum glyph_geometry_backing_store_t>()
                                       .add_entry("buffer",
@@ -200,6 +215,9 @@ sdl_painter_demo(const std::string &about_text,
                                           "Use discard in instead of thinner widths when stroking "
                                           "opaque pass for anti-aliased stroking of paths",
                                           *this),
+  m_program_binary_cache_dir("", "program_binary_cache_dir",
+                             "If non-empty, directory (which must already exist) in which "
+                             "to cache the GL program binaries of the uber-shaders", *this),
 
   m_painter_options_affected_by_context("PainterBackendGL Options that can be overridden "
                                         "by version and extension supported by GL/GLES context",
@@ -208,6 +226,23 @@ sdl_painter_demo(const std::string &about_text,
                        "painter_use_hw_clip_planes",
                        "If true, use HW clip planes (i.e. gl_ClipDistance) for clipping",
                        *this),
+  m_use_persistent_mapped_buffers(m_painter_params.use_persistent_mapped_buffers(),
+                                  "painter_use_persistent_mapped_buffers",
+                                  "If true, stream PainterDraw data through persistently mapped "
+                                  "buffers guarded by fences (requires buffer storage support)",
+                                  *this),
+  m_header_via_base_instance(m_painter_params.header_via_base_instance(),
+                             "painter_header_via_base_instance",
+                             "If true, source the header attribute from the base instance "
+                             "of glMultiDrawElementsIndirect instead of streaming it per vertex "
+                             "(requires multi-draw-indirect and base instance support)",
+                             *this),
+  m_use_multi_draw_indirect(m_painter_params.use_multi_draw_indirect(),
+                            "painter_use_multi_draw_indirect",
+                            "If true, write the draw ranges into a streamed indirect buffer "
+                            "and issue a single glMultiDrawElementsIndirect per program and "
+                            "blend state change (requires multi-draw-indirect support)",
+                            *this),
   m_painter_alignment(m_painter_base_params.alignment(), "painter_alignment",
                        "Alignment for data store of painter, must be 1, 2, 3 or 4", *this),
   m_painter_data_blocks_per_buffer(m_painter_params.data_blocks_per_store_buffer(),
@@ -270,7 +305,27 @@ sdl_painter_demo(const std::string &about_text,
 
 sdl_painter_demo::
 ~sdl_painter_demo()
-{}
+{
+  if(m_painter_params.program_binary_cache())
+    {
+      const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> &cache(m_painter_params.program_binary_cache());
+      std::cout << "Program binary cache \"" << cache->directory() << "\": "
+                << cache->number_hits() << " hits, "
+                << cache->number_misses() << " misses ("
+                << cache->number_rejected() << " rejected)\n";
+    }
+
+  if(m_backend && m_print_painter_config.m_value)
+    {
+      std::cout << "Buffer maps: " << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::num_buffer_maps)
+                << " (" << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::buffer_map_time_us) << " us)\n"
+                << "Fence waits: " << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::num_fence_waits)
+                << " (" << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::fence_wait_time_us) << " us)\n"
+                << "Draw calls: " << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::num_draw_calls)
+                << " (" << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::num_draw_call_entries) << " entries)\n"
+                << "State calls: " << m_backend->query_stat(fastuidraw::gl::PainterBackendGL::num_state_calls) << "\n";
+    }
+}
 
 void
 sdl_painter_demo::
@@ -291,7 +346,8 @@ init_gl(int w, int h)
     .texel_store_dimensions(texel_dims)
     .number_floats(m_geometry_store_size.m_value)
     .alignment(m_geometry_store_alignment.m_value)
-    .delayed(m_glyph_atlas_delayed_upload.m_value);
+    .delayed(m_glyph_atlas_delayed_upload.m_value)
+    .texel_allocator(m_glyph_texel_allocator.m_value.m_value);
 
   switch(m_glyph_geometry_backing_store_type.m_value.m_value)
     {
@@ -326,6 +382,7 @@ init_gl(int w, int h)
         }
     }
   m_glyph_atlas = FASTUIDRAWnew fastuidraw::gl::GlyphAtlasGL(m_glyph_atlas_params);
+  m_glyph_atlas->geometry_compaction_budget(m_glyph_geometry_compaction_budget.m_value);
 
   m_colorstop_atlas_params
     .width(m_color_stop_atlas_width.m_value)
@@ -353,6 +410,9 @@ init_gl(int w, int h)
     .number_pools(m_painter_number_pools.m_value)
     .break_on_shader_change(m_painter_break_on_shader_change.m_value)
     .use_hw_clip_planes(m_use_hw_clip_planes.m_value)
+    .use_persistent_mapped_buffers(m_use_persistent_mapped_buffers.m_value)
+    .header_via_base_instance(m_header_via_base_instance.m_value)
+    .use_multi_draw_indirect(m_use_multi_draw_indirect.m_value)
     .vert_shader_use_switch(m_uber_vert_use_switch.m_value)
     .frag_shader_use_switch(m_uber_frag_use_switch.m_value)
     .blend_shader_use_switch(m_uber_blend_use_switch.m_value)
@@ -366,6 +426,11 @@ init_gl(int w, int h)
     .non_dashed_stroke_shader_uses_discard(m_non_dashed_stroke_shader_uses_discard.m_value)
     .blend_type(m_blend_type.m_value.m_value);
 
+  if(!m_program_binary_cache_dir.m_value.empty())
+    {
+      m_painter_params.program_binary_cache(FASTUIDRAWnew fastuidraw::gl::ProgramBinaryCache(m_program_binary_cache_dir.m_value.c_str()));
+    }
+
   m_backend = FASTUIDRAWnew fastuidraw::gl::PainterBackendGL(m_painter_params, m_painter_base_params);
   m_painter = FASTUIDRAWnew fastuidraw::Painter(m_backend);
   m_glyph_cache = FASTUIDRAWnew fastuidraw::GlyphCache(m_painter->glyph_atlas());
@@ -391,6 +456,9 @@ init_gl(int w, int h)
       LAZY(separate_program_for_discard);
       std::cout << "\n\nOptions affected by GL context\n";
       LAZY(use_hw_clip_planes);
+      LAZY(use_persistent_mapped_buffers);
+      LAZY(header_via_base_instance);
+      LAZY(use_multi_draw_indirect);
       LAZY(data_blocks_per_store_buffer);
       LAZY(assign_layout_to_vertex_shader_inputs);
       LAZY(assign_layout_to_varyings);
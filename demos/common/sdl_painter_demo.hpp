@@ -75,6 +75,8 @@ private:
   command_line_argument_value<int> m_texel_store_num_layers, m_geometry_store_size;
   command_line_argument_value<int> m_geometry_store_alignment;
   command_line_argument_value<bool> m_glyph_atlas_delayed_upload;
+  enumerated_command_line_argument_value<enum fastuidraw::GlyphAtlas::texel_allocator_t> m_glyph_texel_allocator;
+  command_line_argument_value<int> m_glyph_geometry_compaction_budget;
   enumerated_command_line_argument_value<enum glyph_geometry_backing_store_t> m_glyph_geometry_backing_store_type;
   command_line_argument_value<int> m_glyph_geometry_backing_texture_log2_w, m_glyph_geometry_backing_texture_log2_h;
 
@@ -99,11 +101,15 @@ private:
   command_line_argument_value<bool> m_unpack_header_and_brush_in_frag_shader;
   command_line_argument_value<bool> m_separate_program_for_discard;
   command_line_argument_value<bool> m_non_dashed_stroke_shader_uses_discard;
+  command_line_argument_value<std::string> m_program_binary_cache_dir;
 
   /* Painter params that can be overridden by properties of GL context
    */
   command_separator m_painter_options_affected_by_context;
   command_line_argument_value<bool> m_use_hw_clip_planes;
+  command_line_argument_value<bool> m_use_persistent_mapped_buffers;
+  command_line_argument_value<bool> m_header_via_base_instance;
+  command_line_argument_value<bool> m_use_multi_draw_indirect;
   command_line_argument_value<int> m_painter_alignment;
   command_line_argument_value<int> m_painter_data_blocks_per_buffer;
   enumerated_command_line_argument_value<data_store_backing_t> m_data_store_backing;
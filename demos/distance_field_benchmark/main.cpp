@@ -0,0 +1,196 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include <fastuidraw/path.hpp>
+#include <fastuidraw/text/freetype_font.hpp>
+#include <fastuidraw/text/glyph_layout_data.hpp>
+#include <fastuidraw/text/glyph_render_data_distance_field.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+
+using namespace fastuidraw;
+
+/* Micro-benchmark comparing the distance field generators
+   of FontFreeType over all the glyphs of a font. Does not
+   require a GL context.
+ */
+class distance_field_benchmark:public command_line_register
+{
+public:
+  distance_field_benchmark(void);
+
+  int
+  main(int argc, char **argv);
+
+private:
+  class generator_result
+  {
+  public:
+    generator_result(void):
+      m_time_us(0),
+      m_number_texels(0)
+    {}
+
+    int64_t m_time_us;
+    uint64_t m_number_texels;
+    std::vector<std::vector<uint8_t> > m_values;
+  };
+
+  void
+  run_generator(const reference_counted_ptr<FreetypeLib> &lib,
+                enum FontFreeType::distance_field_generator_t gen,
+                generator_result &out_result);
+
+  command_line_argument_value<std::string> m_font_file;
+  command_line_argument_value<int> m_face_index;
+  command_line_argument_value<int> m_pixel_size;
+  command_line_argument_value<float> m_max_distance;
+  command_line_argument_value<int> m_num_runs;
+  command_line_argument_value<int> m_max_glyphs;
+};
+
+distance_field_benchmark::
+distance_field_benchmark(void):
+  m_font_file("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", "font_file",
+              "font file from which to generate distance field glyphs", *this),
+  m_face_index(0, "face_index", "face index into font file", *this),
+  m_pixel_size(48, "pixel_size", "pixel size at which to create distance field glyphs", *this),
+  m_max_distance(96.0f, "max_distance",
+                 "value to use for max distance in 64'ths of a pixel "
+                 "when generating distance field glyphs", *this),
+  m_num_runs(1, "num_runs", "number of times to generate each glyph with each generator", *this),
+  m_max_glyphs(-1, "max_glyphs", "if non-negative, limit the number of glyphs to generate", *this)
+{}
+
+void
+distance_field_benchmark::
+run_generator(const reference_counted_ptr<FreetypeLib> &lib,
+              enum FontFreeType::distance_field_generator_t gen,
+              generator_result &out_result)
+{
+  reference_counted_ptr<FontFreeType> font;
+  int number_glyphs;
+
+  font = FontFreeType::create(m_font_file.m_value.c_str(), lib,
+                              FontFreeType::RenderParams()
+                              .distance_field_pixel_size(m_pixel_size.m_value)
+                              .distance_field_max_distance(m_max_distance.m_value)
+                              .distance_field_generator(gen),
+                              m_face_index.m_value);
+  if(!font)
+    {
+      std::cerr << "Unable to load font \"" << m_font_file.m_value << "\"\n";
+      exit(-1);
+    }
+
+  number_glyphs = font->face()->num_glyphs;
+  if(m_max_glyphs.m_value >= 0)
+    {
+      number_glyphs = t_min(number_glyphs, m_max_glyphs.m_value);
+    }
+
+  out_result.m_values.resize(number_glyphs);
+  for(int run = 0; run < m_num_runs.m_value; ++run)
+    {
+      for(int g = 0; g < number_glyphs; ++g)
+        {
+          GlyphRenderData *data;
+          GlyphRenderDataDistanceField *df;
+          GlyphLayoutData layout;
+          Path path;
+          simple_time timer;
+
+          data = font->compute_rendering_data(GlyphRender(distance_field_glyph), g, layout, path);
+          out_result.m_time_us += timer.elapsed_us();
+
+          df = dynamic_cast<GlyphRenderDataDistanceField*>(data);
+          assert(df);
+          if(run == 0)
+            {
+              const_c_array<uint8_t> values(df->distance_values());
+              out_result.m_values[g].assign(values.begin(), values.end());
+              out_result.m_number_texels += values.size();
+            }
+          FASTUIDRAWdelete(data);
+        }
+    }
+}
+
+int
+distance_field_benchmark::
+main(int argc, char **argv)
+{
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  parse_command_line(argc, argv);
+  std::cout << "\n\n" << std::flush;
+
+  reference_counted_ptr<FreetypeLib> lib;
+  generator_result exact, sweep;
+  uint64_t total_error(0), number_compared(0);
+  unsigned int max_error(0), number_mismatched_glyphs(0);
+
+  lib = FASTUIDRAWnew FreetypeLib();
+  run_generator(lib, FontFreeType::distance_field_exact, exact);
+  run_generator(lib, FontFreeType::distance_field_sweep, sweep);
+
+  for(unsigned int g = 0; g < exact.m_values.size(); ++g)
+    {
+      const std::vector<uint8_t> &E(exact.m_values[g]);
+      const std::vector<uint8_t> &S(sweep.m_values[g]);
+
+      if(E.size() != S.size())
+        {
+          ++number_mismatched_glyphs;
+          continue;
+        }
+
+      for(unsigned int i = 0; i < E.size(); ++i)
+        {
+          unsigned int e;
+
+          e = std::abs(static_cast<int>(E[i]) - static_cast<int>(S[i]));
+          max_error = t_max(max_error, e);
+          total_error += e;
+          ++number_compared;
+        }
+    }
+
+  std::cout << "Glyphs: " << exact.m_values.size() << " (" << exact.m_number_texels
+            << " texels) x " << m_num_runs.m_value << " runs\n"
+            << "exact generator: " << exact.m_time_us / 1000 << " ms\n"
+            << "sweep generator: " << sweep.m_time_us / 1000 << " ms\n";
+  if(sweep.m_time_us > 0)
+    {
+      std::cout << "speedup: "
+                << static_cast<float>(exact.m_time_us) / static_cast<float>(sweep.m_time_us)
+                << "\n";
+    }
+  std::cout << "max texel difference: " << max_error << "\n"
+            << "average texel difference: "
+            << ((number_compared > 0) ?
+                static_cast<float>(total_error) / static_cast<float>(number_compared) :
+                0.0f)
+            << "\n";
+  if(number_mismatched_glyphs > 0)
+    {
+      std::cout << "glyphs of different resolution: " << number_mismatched_glyphs << "\n";
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  distance_field_benchmark B;
+  return B.main(argc, argv);
+}
@@ -0,0 +1,437 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <stdlib.h>
+#include <fastuidraw/path.hpp>
+#include <fastuidraw/text/glyph_atlas.hpp>
+#include <fastuidraw/text/freetype_font.hpp>
+#include <fastuidraw/text/glyph_layout_data.hpp>
+#include <fastuidraw/text/glyph_render_data.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+
+using namespace fastuidraw;
+
+/* Benchmark comparing the texel allocators of GlyphAtlas
+   (see GlyphAtlas::texel_allocator_t) on the sizes of the
+   regions that the glyphs of a font allocate. Does not
+   require a GL context: the backing stores only record
+   what is written to them.
+
+   For each allocator, the atlas is filled from a shuffled
+   stream of the glyph sizes until many allocations in a row
+   fail; then, for a number of rounds, a random fraction of the
+   regions is freed and the atlas is filled again. Reports the
+   packing density (allocated texels over texels of the atlas)
+   and the time of allocation as JSON.
+ */
+
+class RecordingTexelStore:public GlyphAtlasTexelBackingStoreBase
+{
+public:
+  RecordingTexelStore(ivec3 dims, bool resizeable):
+    GlyphAtlasTexelBackingStoreBase(dims, resizeable)
+  {}
+
+  virtual
+  void
+  set_data(int, int, int, int w, int h, const_c_array<uint8_t>)
+  {
+    if(w > 0 && h > 0)
+      {
+        m_sizes.push_back(ivec2(w, h));
+      }
+  }
+
+  virtual
+  void
+  flush(void)
+  {}
+
+  std::vector<ivec2> m_sizes;
+
+protected:
+  virtual
+  void
+  resize_implement(int)
+  {}
+};
+
+class NullGeometryStore:public GlyphAtlasGeometryBackingStoreBase
+{
+public:
+  NullGeometryStore(void):
+    GlyphAtlasGeometryBackingStoreBase(4, 1024, true)
+  {}
+
+  virtual
+  void
+  set_values(unsigned int, const_c_array<generic_data>)
+  {}
+
+  virtual
+  void
+  flush(void)
+  {}
+
+protected:
+  virtual
+  void
+  resize_implement(unsigned int)
+  {}
+};
+
+class glyph_atlas_allocator_benchmark:public command_line_register
+{
+public:
+  glyph_atlas_allocator_benchmark(void);
+
+  int
+  main(int argc, char **argv);
+
+private:
+  class run_result
+  {
+  public:
+    run_result(void):
+      m_fill_allocations(0),
+      m_fill_time_us(0),
+      m_fill_density(0.0),
+      m_churn_allocations(0),
+      m_churn_attempts(0),
+      m_churn_time_us(0),
+      m_churn_density(0.0)
+    {}
+
+    enum GlyphAtlas::texel_allocator_t m_allocator;
+    unsigned int m_fill_allocations;
+    int64_t m_fill_time_us;
+    double m_fill_density;
+    unsigned int m_churn_allocations, m_churn_attempts;
+    int64_t m_churn_time_us;
+    double m_churn_density;
+  };
+
+  class live_region
+  {
+  public:
+    GlyphLocation m_location;
+    int m_area;
+  };
+
+  void
+  collect_glyph_sizes(void);
+
+  run_result
+  run(enum GlyphAtlas::texel_allocator_t allocator);
+
+  /* allocate from the stream until m_max_failures allocations in
+     a row fail, returning the number of allocation attempts.
+   */
+  unsigned int
+  fill(GlyphAtlas &atlas, std::vector<live_region> &live,
+       int64_t &allocated_area, unsigned int &number_allocated);
+
+  void
+  write_json(std::ostream &str);
+
+  command_line_argument_value<std::string> m_font_file;
+  command_line_argument_value<int> m_face_index;
+  command_line_argument_value<std::string> m_pixel_sizes;
+  command_line_argument_value<bool> m_distance_field;
+  command_line_argument_value<int> m_max_glyphs;
+  command_line_argument_value<int> m_atlas_width, m_atlas_height, m_atlas_layers;
+  command_line_argument_value<int> m_max_failures;
+  command_line_argument_value<int> m_churn_rounds;
+  command_line_argument_value<float> m_churn_fraction;
+  command_line_argument_value<int> m_seed;
+  command_line_argument_value<std::string> m_output;
+
+  std::vector<ivec2> m_glyph_sizes;
+  std::vector<ivec2> m_stream;
+  unsigned int m_stream_pos;
+  std::vector<run_result> m_results;
+};
+
+glyph_atlas_allocator_benchmark::
+glyph_atlas_allocator_benchmark(void):
+  m_font_file("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", "font_file",
+              "font file from which to take the glyph sizes", *this),
+  m_face_index(0, "face_index", "face index into font file", *this),
+  m_pixel_sizes("12 16 24 32 48", "pixel_sizes",
+                "space separated list of pixel sizes of coverage glyphs", *this),
+  m_distance_field(true, "distance_field", "if true, also take the sizes of distance field glyphs", *this),
+  m_max_glyphs(-1, "max_glyphs", "if non-negative, limit the number of glyphs of the font to use", *this),
+  m_atlas_width(1024, "atlas_width", "width of the texel store", *this),
+  m_atlas_height(1024, "atlas_height", "height of the texel store", *this),
+  m_atlas_layers(1, "atlas_layers", "number of layers of the texel store", *this),
+  m_max_failures(64, "max_failures",
+                 "number of allocations in a row that fail to consider the atlas full", *this),
+  m_churn_rounds(16, "churn_rounds",
+                 "number of rounds of freeing regions and filling the atlas again", *this),
+  m_churn_fraction(0.25f, "churn_fraction", "fraction of the regions freed each churn round", *this),
+  m_seed(1, "seed", "seed of the random order of the glyph sizes", *this),
+  m_output("", "output", "file to which to write the JSON results, if empty "
+           "the results are written to stdout", *this),
+  m_stream_pos(0)
+{}
+
+void
+glyph_atlas_allocator_benchmark::
+collect_glyph_sizes(void)
+{
+  reference_counted_ptr<FreetypeLib> lib;
+  reference_counted_ptr<FontFreeType> font;
+  reference_counted_ptr<RecordingTexelStore> texel_store;
+  reference_counted_ptr<GlyphAtlas> atlas;
+  std::vector<GlyphRender> renders;
+  std::istringstream pixel_sizes(m_pixel_sizes.m_value);
+  int number_glyphs, sz;
+
+  lib = FASTUIDRAWnew FreetypeLib();
+  font = FontFreeType::create(m_font_file.m_value.c_str(), lib,
+                              FontFreeType::RenderParams(), m_face_index.m_value);
+  if(!font)
+    {
+      std::cerr << "Unable to load font \"" << m_font_file.m_value << "\"\n";
+      exit(-1);
+    }
+
+  while(pixel_sizes >> sz)
+    {
+      renders.push_back(GlyphRender(sz));
+    }
+  if(m_distance_field.m_value)
+    {
+      renders.push_back(GlyphRender(distance_field_glyph));
+    }
+
+  /* let the glyph render data allocate its regions, with
+     its own padding, from an atlas that only records the
+     sizes allocated.
+   */
+  texel_store = FASTUIDRAWnew RecordingTexelStore(ivec3(1024, 1024, 1), true);
+  atlas = FASTUIDRAWnew GlyphAtlas(texel_store, FASTUIDRAWnew NullGeometryStore());
+
+  number_glyphs = font->face()->num_glyphs;
+  if(m_max_glyphs.m_value >= 0)
+    {
+      number_glyphs = t_min(number_glyphs, m_max_glyphs.m_value);
+    }
+
+  for(unsigned int r = 0; r < renders.size(); ++r)
+    {
+      for(int g = 0; g < number_glyphs; ++g)
+        {
+          GlyphRenderData *data;
+          GlyphLayoutData layout;
+          GlyphLocation loc0, loc1;
+          int geometry_offset, geometry_length;
+          Path path;
+
+          data = font->compute_rendering_data(renders[r], g, layout, path);
+          data->upload_to_atlas(atlas, loc0, loc1, geometry_offset, geometry_length);
+          FASTUIDRAWdelete(data);
+        }
+    }
+  m_glyph_sizes.swap(texel_store->m_sizes);
+}
+
+unsigned int
+glyph_atlas_allocator_benchmark::
+fill(GlyphAtlas &atlas, std::vector<live_region> &live,
+     int64_t &allocated_area, unsigned int &number_allocated)
+{
+  unsigned int number_attempts(0);
+
+  for(int failures = 0; failures < m_max_failures.m_value; ++number_attempts)
+    {
+      const ivec2 &sz(m_stream[m_stream_pos]);
+      live_region R;
+
+      m_stream_pos = (m_stream_pos + 1) % m_stream.size();
+      R.m_location = atlas.allocate(sz, const_c_array<uint8_t>(), GlyphAtlas::Padding());
+      if(R.m_location.valid())
+        {
+          R.m_area = sz.x() * sz.y();
+          allocated_area += R.m_area;
+          ++number_allocated;
+          live.push_back(R);
+          failures = 0;
+        }
+      else
+        {
+          ++failures;
+        }
+    }
+  return number_attempts;
+}
+
+glyph_atlas_allocator_benchmark::run_result
+glyph_atlas_allocator_benchmark::
+run(enum GlyphAtlas::texel_allocator_t allocator)
+{
+  reference_counted_ptr<RecordingTexelStore> texel_store;
+  reference_counted_ptr<GlyphAtlas> atlas;
+  std::vector<live_region> live;
+  std::mt19937 engine(m_seed.m_value);
+  int64_t allocated_area(0), atlas_area;
+  run_result R;
+
+  texel_store = FASTUIDRAWnew RecordingTexelStore(ivec3(m_atlas_width.m_value,
+                                                        m_atlas_height.m_value,
+                                                        m_atlas_layers.m_value),
+                                                  false);
+  atlas = FASTUIDRAWnew GlyphAtlas(texel_store, FASTUIDRAWnew NullGeometryStore(), allocator);
+  atlas_area = static_cast<int64_t>(m_atlas_width.m_value) * m_atlas_height.m_value * m_atlas_layers.m_value;
+
+  /* every allocator sees the same stream of sizes */
+  m_stream_pos = 0;
+
+  {
+    simple_time timer;
+    fill(*atlas, live, allocated_area, R.m_fill_allocations);
+    R.m_fill_time_us = timer.elapsed_us();
+  }
+  R.m_allocator = allocator;
+  R.m_fill_density = static_cast<double>(allocated_area) / static_cast<double>(atlas_area);
+
+  for(int round = 0; round < m_churn_rounds.m_value; ++round)
+    {
+      unsigned int number_free;
+      simple_time timer;
+
+      std::shuffle(live.begin(), live.end(), engine);
+      number_free = static_cast<unsigned int>(m_churn_fraction.m_value * live.size());
+      for(unsigned int i = 0; i < number_free; ++i)
+        {
+          atlas->deallocate(live.back().m_location);
+          allocated_area -= live.back().m_area;
+          live.pop_back();
+        }
+      R.m_churn_attempts += fill(*atlas, live, allocated_area, R.m_churn_allocations);
+      R.m_churn_time_us += timer.elapsed_us();
+      R.m_churn_density += static_cast<double>(allocated_area) / static_cast<double>(atlas_area);
+    }
+
+  if(m_churn_rounds.m_value > 0)
+    {
+      R.m_churn_density /= static_cast<double>(m_churn_rounds.m_value);
+    }
+
+  for(unsigned int i = 0; i < live.size(); ++i)
+    {
+      atlas->deallocate(live[i].m_location);
+    }
+  return R;
+}
+
+void
+glyph_atlas_allocator_benchmark::
+write_json(std::ostream &str)
+{
+  int64_t texels(0);
+  for(unsigned int i = 0; i < m_glyph_sizes.size(); ++i)
+    {
+      texels += m_glyph_sizes[i].x() * m_glyph_sizes[i].y();
+    }
+
+  str << "{\n"
+      << "  \"config\": {\n"
+#ifdef NDEBUG
+      << "    \"build\": \"release\",\n"
+#else
+      << "    \"build\": \"debug\",\n"
+#endif
+      << "    \"font_file\": \"" << m_font_file.m_value << "\",\n"
+      << "    \"glyph_regions\": " << m_glyph_sizes.size() << ",\n"
+      << "    \"average_region_texels\": "
+      << (m_glyph_sizes.empty() ? 0.0 : static_cast<double>(texels) / m_glyph_sizes.size()) << ",\n"
+      << "    \"atlas\": [" << m_atlas_width.m_value << ", " << m_atlas_height.m_value
+      << ", " << m_atlas_layers.m_value << "],\n"
+      << "    \"churn_rounds\": " << m_churn_rounds.m_value << ",\n"
+      << "    \"churn_fraction\": " << m_churn_fraction.m_value << "\n"
+      << "  },\n"
+      << "  \"runs\": [\n";
+
+  for(unsigned int i = 0; i < m_results.size(); ++i)
+    {
+      const run_result &R(m_results[i]);
+
+      str << "    { \"allocator\": \""
+          << ((R.m_allocator == GlyphAtlas::skyline_texel_allocator) ? "skyline" : "tree") << "\""
+          << ", \"fill_allocations\": " << R.m_fill_allocations
+          << ", \"fill_density\": " << R.m_fill_density
+          << ", \"fill_us_per_allocation\": "
+          << ((R.m_fill_allocations > 0) ?
+              static_cast<double>(R.m_fill_time_us) / R.m_fill_allocations : 0.0)
+          << ", \"churn_allocations\": " << R.m_churn_allocations
+          << ", \"churn_success_rate\": "
+          << ((R.m_churn_attempts > 0) ?
+              static_cast<double>(R.m_churn_allocations) / R.m_churn_attempts : 0.0)
+          << ", \"churn_density\": " << R.m_churn_density
+          << ", \"churn_us_per_allocation\": "
+          << ((R.m_churn_allocations > 0) ?
+              static_cast<double>(R.m_churn_time_us) / R.m_churn_allocations : 0.0)
+          << " }" << ((i + 1 < m_results.size()) ? ",\n" : "\n");
+    }
+  str << "  ]\n"
+      << "}\n";
+}
+
+int
+glyph_atlas_allocator_benchmark::
+main(int argc, char **argv)
+{
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  parse_command_line(argc, argv);
+
+  collect_glyph_sizes();
+  if(m_glyph_sizes.empty())
+    {
+      std::cerr << "No glyph regions from font \"" << m_font_file.m_value << "\"\n";
+      return -1;
+    }
+
+  m_stream = m_glyph_sizes;
+  std::shuffle(m_stream.begin(), m_stream.end(), std::mt19937(m_seed.m_value));
+
+  m_results.push_back(run(GlyphAtlas::tree_texel_allocator));
+  m_results.push_back(run(GlyphAtlas::skyline_texel_allocator));
+
+  if(m_output.m_value.empty())
+    {
+      write_json(std::cout);
+    }
+  else
+    {
+      std::ofstream file(m_output.m_value.c_str());
+      if(!file)
+        {
+          std::cerr << "Unable to open \"" << m_output.m_value << "\" for writing\n";
+          return -1;
+        }
+      write_json(file);
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  glyph_atlas_allocator_benchmark B;
+  return B.main(argc, argv);
+}
@@ -0,0 +1,292 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <fastuidraw/painter/painter_packed_value.hpp>
+#include <fastuidraw/painter/painter_stroke_params.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+
+using namespace fastuidraw;
+
+/* Contention benchmark of PainterPackedValuePool: for each
+   thread count, every thread creates packed brushes, item
+   matrices and stroke parameters, keeping a window of the
+   last values it created alive (so that values are released
+   as they are created) and copying each handle once (so that
+   the reference count is exercised). The values are created
+   from a single shared PainterPackedValuePool or, to give the
+   uncontended baseline, from a PainterPackedValuePool per
+   thread. The results are written as JSON.
+ */
+class packed_value_pool_benchmark:public command_line_register
+{
+public:
+  packed_value_pool_benchmark(void);
+
+  int
+  main(int argc, char **argv);
+
+private:
+  class run_result
+  {
+  public:
+    unsigned int m_number_threads;
+    int64_t m_time_us;
+    uint64_t m_values_created;
+  };
+
+  class worker_values
+  {
+  public:
+    std::vector<PainterPackedValue<PainterBrush> > m_brushes;
+    std::vector<PainterPackedValue<PainterItemMatrix> > m_matrices;
+    std::vector<PainterPackedValue<PainterItemShaderData> > m_stroke_params;
+  };
+
+  static
+  void
+  worker(packed_value_pool_benchmark *p, PainterPackedValuePool *pool,
+         std::atomic<bool> *go, uint64_t *out_values_created);
+
+  run_result
+  run(unsigned int number_threads);
+
+  void
+  write_json(std::ostream &str);
+
+  command_line_argument_value<int> m_num_iterations;
+  command_line_argument_value<int> m_max_threads;
+  command_line_argument_value<int> m_live_values;
+  command_line_argument_value<bool> m_shared_pool;
+  command_line_argument_value<std::string> m_output;
+
+  std::vector<run_result> m_results;
+};
+
+packed_value_pool_benchmark::
+packed_value_pool_benchmark(void):
+  m_num_iterations(200000, "num_iterations",
+                   "number of values each thread creates in a run", *this, false),
+  m_max_threads(std::thread::hardware_concurrency(), "max_threads",
+                "runs are made with 1, 2, 4, ... threads up to this number of threads", *this, false),
+  m_live_values(64, "live_values",
+                "number of values of each type each thread keeps alive, a value "
+                "is released when the value created that many values after it is "
+                "created", *this, false),
+  m_shared_pool(true, "shared_pool",
+                "if true all threads create values from the same PainterPackedValuePool, "
+                "otherwise each thread creates values from its own PainterPackedValuePool",
+                *this, false),
+  m_output("", "output", "file to which to write the JSON results, if empty "
+           "the results are written to stdout", *this, false)
+{}
+
+void
+packed_value_pool_benchmark::
+worker(packed_value_pool_benchmark *p, PainterPackedValuePool *pool,
+       std::atomic<bool> *go, uint64_t *out_values_created)
+{
+  worker_values values;
+  unsigned int window;
+  uint64_t created(0);
+
+  window = t_max(1, p->m_live_values.m_value);
+  values.m_brushes.resize(window);
+  values.m_matrices.resize(window);
+  values.m_stroke_params.resize(window);
+
+  while(!go->load(std::memory_order_acquire))
+    {
+      std::this_thread::yield();
+    }
+
+  for(int i = 0; i < p->m_num_iterations.m_value; ++i)
+    {
+      unsigned int slot;
+      float f;
+
+      slot = i % window;
+      f = static_cast<float>(i % 97);
+      switch(i % 3)
+        {
+        case 0:
+          {
+            PainterBrush brush;
+            PainterPackedValue<PainterBrush> copy;
+
+            brush.pen(f / 97.0f, 0.5f, 0.25f, 1.0f);
+            values.m_brushes[slot] = pool->create_packed_value(brush);
+            copy = values.m_brushes[slot];
+          }
+          break;
+
+        case 1:
+          {
+            float3x3 m;
+            PainterPackedValue<PainterItemMatrix> copy;
+
+            m(0, 2) = f;
+            m(1, 2) = -f;
+            values.m_matrices[slot] = pool->create_packed_value(PainterItemMatrix(m));
+            copy = values.m_matrices[slot];
+          }
+          break;
+
+        default:
+          {
+            PainterStrokeParams st;
+            PainterPackedValue<PainterItemShaderData> copy;
+
+            st.width(1.0f + f);
+            st.miter_limit(4.0f);
+            values.m_stroke_params[slot] = pool->create_packed_value(st);
+            copy = values.m_stroke_params[slot];
+          }
+        }
+      ++created;
+    }
+  *out_values_created = created;
+}
+
+packed_value_pool_benchmark::run_result
+packed_value_pool_benchmark::
+run(unsigned int number_threads)
+{
+  std::vector<PainterPackedValuePool*> pools;
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> values_created(number_threads, 0);
+  std::atomic<bool> go(false);
+  run_result R;
+
+  pools.resize(m_shared_pool.m_value ? 1 : number_threads);
+  for(unsigned int i = 0; i < pools.size(); ++i)
+    {
+      pools[i] = FASTUIDRAWnew PainterPackedValuePool(1);
+    }
+
+  for(unsigned int i = 0; i < number_threads; ++i)
+    {
+      threads.push_back(std::thread(worker, this, pools[i % pools.size()],
+                                    &go, &values_created[i]));
+    }
+
+  simple_time timer;
+  go.store(true, std::memory_order_release);
+  for(unsigned int i = 0; i < number_threads; ++i)
+    {
+      threads[i].join();
+    }
+
+  R.m_number_threads = number_threads;
+  R.m_time_us = timer.elapsed_us();
+  R.m_values_created = 0;
+  for(unsigned int i = 0; i < number_threads; ++i)
+    {
+      R.m_values_created += values_created[i];
+    }
+
+  for(unsigned int i = 0; i < pools.size(); ++i)
+    {
+      FASTUIDRAWdelete(pools[i]);
+    }
+
+  return R;
+}
+
+void
+packed_value_pool_benchmark::
+write_json(std::ostream &str)
+{
+  double base_rate(0.0);
+
+  str << "{\n"
+      << "  \"config\": {\n"
+#ifdef NDEBUG
+      << "    \"build\": \"release\",\n"
+#else
+      << "    \"build\": \"debug\",\n"
+#endif
+      << "    \"num_iterations\": " << m_num_iterations.m_value << ",\n"
+      << "    \"max_threads\": " << m_max_threads.m_value << ",\n"
+      << "    \"live_values\": " << m_live_values.m_value << ",\n"
+      << "    \"shared_pool\": " << (m_shared_pool.m_value ? "true" : "false") << "\n"
+      << "  },\n"
+      << "  \"runs\": [\n";
+
+  for(unsigned int i = 0; i < m_results.size(); ++i)
+    {
+      const run_result &R(m_results[i]);
+      double rate;
+
+      rate = (R.m_time_us > 0) ?
+        static_cast<double>(R.m_values_created) / static_cast<double>(R.m_time_us) :
+        0.0;
+      if(i == 0)
+        {
+          base_rate = rate;
+        }
+
+      str << "    { \"threads\": " << R.m_number_threads
+          << ", \"time_us\": " << R.m_time_us
+          << ", \"values_created\": " << R.m_values_created
+          << ", \"values_per_us\": " << rate
+          << ", \"speedup\": " << ((base_rate > 0.0) ? rate / base_rate : 0.0)
+          << " }" << ((i + 1 < m_results.size()) ? ",\n" : "\n");
+    }
+  str << "  ]\n"
+      << "}\n";
+}
+
+int
+packed_value_pool_benchmark::
+main(int argc, char **argv)
+{
+  unsigned int max_threads;
+
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  parse_command_line(argc, argv);
+
+  max_threads = t_max(1, m_max_threads.m_value);
+  for(unsigned int n = 1; n < max_threads; n *= 2)
+    {
+      std::cerr << "Running with " << n << " threads\n";
+      m_results.push_back(run(n));
+    }
+  std::cerr << "Running with " << max_threads << " threads\n";
+  m_results.push_back(run(max_threads));
+
+  if(m_output.m_value.empty())
+    {
+      write_json(std::cout);
+    }
+  else
+    {
+      std::ofstream file(m_output.m_value.c_str());
+      if(!file)
+        {
+          std::cerr << "Unable to open \"" << m_output.m_value << "\" for writing\n";
+          return -1;
+        }
+      write_json(file);
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  packed_value_pool_benchmark B;
+  return B.main(argc, argv);
+}
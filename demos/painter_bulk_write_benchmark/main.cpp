@@ -0,0 +1,297 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <fastuidraw/painter/painter.hpp>
+#include <fastuidraw/painter/packing/painter_backend_null.hpp>
+#include <fastuidraw/util/bulk_copy.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+#include "cast_c_array.hpp"
+
+using namespace fastuidraw;
+
+/* Throughput benchmark of the writing of attribute and index
+   data by PainterPacker to the PainterDraw objects of the null
+   backend: each frame draws, with a single Painter::draw_generic(),
+   a mesh made of chunks of grids. The frames are timed for each
+   implementation of bulk_copy that the CPU supports and the
+   results are written as JSON.
+ */
+class painter_bulk_write_benchmark:public command_line_register
+{
+public:
+  painter_bulk_write_benchmark(void);
+
+  int
+  main(int argc, char **argv);
+
+private:
+  class run_result
+  {
+  public:
+    enum bulk_copy::implementation_t m_implementation;
+    int64_t m_time_us;
+    uint64_t m_bytes;
+  };
+
+  void
+  create_mesh(void);
+
+  run_result
+  run(enum bulk_copy::implementation_t impl);
+
+  void
+  write_json(std::ostream &str);
+
+  command_line_argument_value<int> m_num_vertices;
+  command_line_argument_value<int> m_grid_size;
+  command_line_argument_value<int> m_num_frames;
+  command_line_argument_value<int> m_num_warm_up_frames;
+  command_line_argument_value<int> m_attributes_per_buffer;
+  command_line_argument_value<int> m_indices_per_buffer;
+  command_line_argument_value<bool> m_header_via_base_instance;
+  command_line_argument_value<std::string> m_output;
+
+  reference_counted_ptr<PainterBackendNull> m_backend;
+  reference_counted_ptr<Painter> m_painter;
+
+  std::vector<std::vector<PainterAttribute> > m_attributes;
+  std::vector<std::vector<PainterIndex> > m_indices;
+  std::vector<const_c_array<PainterAttribute> > m_attribute_chunks;
+  std::vector<const_c_array<PainterIndex> > m_index_chunks;
+  std::vector<int> m_index_adjusts;
+  uint64_t m_mesh_vertices, m_mesh_indices;
+
+  std::vector<run_result> m_results;
+};
+
+painter_bulk_write_benchmark::
+painter_bulk_write_benchmark(void):
+  m_num_vertices(1000000, "num_vertices",
+                 "number of vertices drawn per frame, rounded up to a "
+                 "multiple of the vertices of a grid", *this, false),
+  m_grid_size(128, "grid_size",
+              "each chunk of the mesh is a grid of grid_size by "
+              "grid_size vertices", *this, false),
+  m_num_frames(100, "num_frames", "number of frames timed per implementation", *this, false),
+  m_num_warm_up_frames(10, "num_warm_up_frames",
+                       "number of frames drawn before timing", *this, false),
+  m_attributes_per_buffer(512 * 1024, "attributes_per_buffer",
+                          "see ConfigurationNull::attributes_per_buffer()", *this, false),
+  m_indices_per_buffer(3 * 1024 * 1024, "indices_per_buffer",
+                       "see ConfigurationNull::indices_per_buffer()", *this, false),
+  m_header_via_base_instance(false, "header_via_base_instance",
+                             "see ConfigurationNull::header_via_base_instance(), if false "
+                             "the header attributes are also written", *this, false),
+  m_output("", "output", "file to which to write the JSON results, if empty "
+           "the results are written to stdout", *this, false),
+  m_mesh_vertices(0),
+  m_mesh_indices(0)
+{}
+
+void
+painter_bulk_write_benchmark::
+create_mesh(void)
+{
+  unsigned int n, verts_per_chunk, num_chunks;
+
+  n = t_max(2, m_grid_size.m_value);
+  verts_per_chunk = n * n;
+  num_chunks = (t_max(1, m_num_vertices.m_value) + verts_per_chunk - 1) / verts_per_chunk;
+
+  m_attributes.resize(num_chunks);
+  m_indices.resize(num_chunks);
+  for(unsigned int c = 0; c < num_chunks; ++c)
+    {
+      std::vector<PainterAttribute> &attribs(m_attributes[c]);
+      std::vector<PainterIndex> &indices(m_indices[c]);
+
+      attribs.resize(verts_per_chunk);
+      for(unsigned int y = 0; y < n; ++y)
+        {
+          for(unsigned int x = 0; x < n; ++x)
+            {
+              PainterAttribute &A(attribs[x + y * n]);
+              vec2 p(x + c * n, y);
+
+              A.m_attrib0 = pack_vec4(p.x(), p.y(), 0.0f, 0.0f);
+              A.m_attrib1 = uvec4(c, x, y, 0u);
+              A.m_attrib2 = uvec4(0u, 0u, 0u, 0u);
+            }
+        }
+
+      indices.reserve(6 * (n - 1) * (n - 1));
+      for(unsigned int y = 0; y + 1 < n; ++y)
+        {
+          for(unsigned int x = 0; x + 1 < n; ++x)
+            {
+              PainterIndex i0(x + y * n), i1(i0 + 1), i2(i0 + n), i3(i2 + 1);
+
+              indices.push_back(i0);
+              indices.push_back(i1);
+              indices.push_back(i2);
+              indices.push_back(i1);
+              indices.push_back(i3);
+              indices.push_back(i2);
+            }
+        }
+
+      m_attribute_chunks.push_back(cast_c_array(attribs));
+      m_index_chunks.push_back(cast_c_array(indices));
+      m_index_adjusts.push_back(0);
+      m_mesh_vertices += attribs.size();
+      m_mesh_indices += indices.size();
+    }
+}
+
+painter_bulk_write_benchmark::run_result
+painter_bulk_write_benchmark::
+run(enum bulk_copy::implementation_t impl)
+{
+  PainterBrush brush;
+  run_result R;
+  int total_frames;
+
+  bulk_copy::implementation(impl);
+  R.m_implementation = impl;
+  R.m_time_us = 0;
+  R.m_bytes = 0;
+
+  brush.pen(1.0f, 1.0f, 1.0f, 1.0f);
+  total_frames = m_num_warm_up_frames.m_value + m_num_frames.m_value;
+  for(int frame = 0; frame < total_frames; ++frame)
+    {
+      simple_time timer;
+      int64_t us;
+
+      m_backend->reset_stats();
+      m_painter->begin();
+      m_painter->draw_generic(m_painter->default_shaders().fill_shader().item_shader(),
+                              PainterData(&brush),
+                              cast_c_array(m_attribute_chunks),
+                              cast_c_array(m_index_chunks),
+                              cast_c_array(m_index_adjusts));
+      m_painter->end();
+      us = timer.elapsed_us();
+
+      if(frame >= m_num_warm_up_frames.m_value)
+        {
+          R.m_time_us += us;
+          R.m_bytes += m_backend->query_stat(PainterBackendNull::attribute_bytes)
+            + m_backend->query_stat(PainterBackendNull::index_bytes);
+        }
+    }
+  return R;
+}
+
+void
+painter_bulk_write_benchmark::
+write_json(std::ostream &str)
+{
+  double base_rate(0.0);
+
+  str << "{\n"
+      << "  \"config\": {\n"
+#ifdef NDEBUG
+      << "    \"build\": \"release\",\n"
+#else
+      << "    \"build\": \"debug\",\n"
+#endif
+      << "    \"vertices_per_frame\": " << m_mesh_vertices << ",\n"
+      << "    \"indices_per_frame\": " << m_mesh_indices << ",\n"
+      << "    \"num_frames\": " << m_num_frames.m_value << ",\n"
+      << "    \"num_warm_up_frames\": " << m_num_warm_up_frames.m_value << ",\n"
+      << "    \"attributes_per_buffer\": " << m_attributes_per_buffer.m_value << ",\n"
+      << "    \"indices_per_buffer\": " << m_indices_per_buffer.m_value << ",\n"
+      << "    \"header_via_base_instance\": " << (m_header_via_base_instance.m_value ? "true" : "false") << "\n"
+      << "  },\n"
+      << "  \"runs\": [\n";
+
+  for(unsigned int i = 0; i < m_results.size(); ++i)
+    {
+      const run_result &R(m_results[i]);
+      double frame_us, rate;
+
+      frame_us = static_cast<double>(R.m_time_us) / static_cast<double>(t_max(1, m_num_frames.m_value));
+      rate = (R.m_time_us > 0) ?
+        static_cast<double>(R.m_bytes) / static_cast<double>(R.m_time_us) :
+        0.0;
+      if(i == 0)
+        {
+          base_rate = rate;
+        }
+
+      str << "    { \"implementation\": \"" << bulk_copy::label(R.m_implementation) << "\""
+          << ", \"frame_us\": " << frame_us
+          << ", \"vertices_per_us\": " << ((frame_us > 0.0) ? m_mesh_vertices / frame_us : 0.0)
+          << ", \"bytes_per_us\": " << rate
+          << ", \"speedup\": " << ((base_rate > 0.0) ? rate / base_rate : 0.0)
+          << " }" << ((i + 1 < m_results.size()) ? ",\n" : "\n");
+    }
+  str << "  ]\n"
+      << "}\n";
+}
+
+int
+painter_bulk_write_benchmark::
+main(int argc, char **argv)
+{
+  enum bulk_copy::implementation_t default_impl;
+
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  parse_command_line(argc, argv);
+
+  m_backend = FASTUIDRAWnew PainterBackendNull(PainterBackendNull::ConfigurationNull()
+                                               .attributes_per_buffer(t_max(1, m_attributes_per_buffer.m_value))
+                                               .indices_per_buffer(t_max(1, m_indices_per_buffer.m_value))
+                                               .header_via_base_instance(m_header_via_base_instance.m_value));
+  m_painter = FASTUIDRAWnew Painter(m_backend);
+  create_mesh();
+
+  default_impl = bulk_copy::implementation();
+  for(unsigned int i = 0; i < bulk_copy::number_implementations; ++i)
+    {
+      enum bulk_copy::implementation_t impl;
+
+      impl = static_cast<enum bulk_copy::implementation_t>(i);
+      if(bulk_copy::supported(impl))
+        {
+          std::cerr << "Running with " << bulk_copy::label(impl) << "\n";
+          m_results.push_back(run(impl));
+        }
+    }
+  bulk_copy::implementation(default_impl);
+
+  if(m_output.m_value.empty())
+    {
+      write_json(std::cout);
+    }
+  else
+    {
+      std::ofstream file(m_output.m_value.c_str());
+      if(!file)
+        {
+          std::cerr << "Unable to open \"" << m_output.m_value << "\" for writing\n";
+          return -1;
+        }
+      write_json(file);
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  painter_bulk_write_benchmark B;
+  return B.main(argc, argv);
+}
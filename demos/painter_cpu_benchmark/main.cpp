@@ -0,0 +1,738 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdlib.h>
+#include <fastuidraw/tessellated_path.hpp>
+#include <fastuidraw/painter/painter.hpp>
+#include <fastuidraw/painter/filled_path.hpp>
+#include <fastuidraw/painter/stroked_path.hpp>
+#include <fastuidraw/painter/packing/painter_backend_null.hpp>
+#include <fastuidraw/text/freetype_font.hpp>
+#include <fastuidraw/text/glyph_cache.hpp>
+#include <fastuidraw/text/glyph_selector.hpp>
+#include <fastuidraw/util/tracing.hpp>
+#include <fastuidraw/util/memory_accounting.hpp>
+
+#include "generic_command_line.hpp"
+#include "simple_time.hpp"
+#include "cast_c_array.hpp"
+#include "scenes.hpp"
+
+using namespace fastuidraw;
+
+/* Benchmark of the CPU side of Painter over a set of fixed
+   scenes, drawn with a PainterBackendNull so that it does not
+   require a GL context. The content of each frame of each scene
+   depends only on the frame number, so the amount of data packed
+   is the same from run to run; the timings and data counts are
+   written as JSON so that they can be compared between releases.
+ */
+class painter_cpu_benchmark:public command_line_register
+{
+public:
+  painter_cpu_benchmark(void);
+
+  ~painter_cpu_benchmark();
+
+  int
+  main(int argc, char **argv);
+
+private:
+  enum timing_t
+    {
+      time_painter_begin,
+      time_painter_draw,
+      time_painter_end,
+      time_command_list_replay,
+      time_select_subsets,
+      time_filled_path,
+      time_stroked_path,
+
+      number_timings
+    };
+
+  class timing_stat
+  {
+  public:
+    void
+    add(int64_t v)
+    {
+      m_samples.push_back(v);
+    }
+
+    void
+    write_json(std::ostream &str) const;
+
+  private:
+    std::vector<int64_t> m_samples;
+  };
+
+  class scene_result
+  {
+  public:
+    scene_result(void):
+      m_timings(number_timings),
+      m_packer_stats(0),
+      m_backend_stats(0),
+      m_fills(0),
+      m_selected_subsets(0),
+      m_peak_bytes(0),
+      m_evicted_caches(0)
+    {}
+
+    std::vector<timing_stat> m_timings;
+    vecN<uint64_t, PainterPacker::num_stats> m_packer_stats;
+    vecN<uint64_t, PainterBackendNull::num_stats> m_backend_stats;
+    uint64_t m_fills, m_selected_subsets;
+    vecN<uint64_t, memory_accounting::number_categories> m_peak_bytes;
+    uint64_t m_evicted_caches;
+  };
+
+  static
+  const char*
+  timing_label(enum timing_t t);
+
+  static
+  const char*
+  packer_stat_label(enum PainterPacker::stats_t st);
+
+  static
+  const char*
+  backend_stat_label(enum PainterBackendNull::stats_t st);
+
+  void
+  init_painter(void);
+
+  void
+  run_scene(BenchmarkScene *scene, scene_result &out_result);
+
+  void
+  write_json(std::ostream &str);
+
+  command_line_argument_value<int> m_num_frames;
+  command_line_argument_value<int> m_num_warm_up_frames;
+  command_line_argument_value<int> m_width, m_height;
+  command_line_argument_value<std::string> m_font;
+  enumerated_command_line_argument_value<enum glyph_type> m_text_renderer;
+  command_line_argument_value<int> m_text_renderer_realized_pixel_size;
+  command_line_argument_value<float> m_pixel_size;
+  command_line_argument_value<bool> m_break_on_shader_change;
+  command_line_argument_value<int> m_retained_geometry_attributes;
+  command_line_argument_value<int> m_retained_geometry_indices;
+  command_line_argument_value<int> m_persistent_data_store_blocks;
+  command_line_argument_value<bool> m_header_via_base_instance;
+  command_line_argument_value<bool> m_deferred_submission;
+  command_line_argument_value<bool> m_command_list;
+  command_line_argument_value<std::string> m_scene;
+  command_line_argument_value<std::string> m_output;
+  command_line_argument_value<std::string> m_trace_output;
+  command_line_argument_value<int> m_path_cache_budget_kb;
+
+  reference_counted_ptr<PainterBackendNull> m_backend;
+  reference_counted_ptr<Painter> m_painter;
+  reference_counted_ptr<PainterCommandList> m_command_list_backend;
+  reference_counted_ptr<Painter> m_recorder;
+  reference_counted_ptr<FreetypeLib> m_ft_lib;
+  reference_counted_ptr<GlyphCache> m_glyph_cache;
+  reference_counted_ptr<GlyphSelector> m_glyph_selector;
+
+  std::vector<BenchmarkScene*> m_scenes;
+  std::vector<scene_result> m_results;
+  uint64_t m_setup_atlas_bytes;
+  int64_t m_setup_time_us;
+};
+
+void
+painter_cpu_benchmark::timing_stat::
+write_json(std::ostream &str) const
+{
+  std::vector<int64_t> sorted(m_samples);
+  int64_t total(0);
+
+  std::sort(sorted.begin(), sorted.end());
+  for(unsigned int i = 0; i < sorted.size(); ++i)
+    {
+      total += sorted[i];
+    }
+
+  str << "{ \"total_us\": " << total;
+  if(!sorted.empty())
+    {
+      str << ", \"mean_us\": " << static_cast<double>(total) / static_cast<double>(sorted.size())
+          << ", \"median_us\": " << sorted[sorted.size() / 2]
+          << ", \"min_us\": " << sorted.front()
+          << ", \"max_us\": " << sorted.back();
+    }
+  str << " }";
+}
+
+painter_cpu_benchmark::
+painter_cpu_benchmark(void):
+  m_num_frames(100, "num_frames", "number of frames of each scene to time", *this, false),
+  m_num_warm_up_frames(5, "num_warm_up_frames",
+                       "number of frames of each scene to draw before timing", *this, false),
+  m_width(1024, "width", "width of the render target of the scenes", *this, false),
+  m_height(768, "height", "height of the render target of the scenes", *this, false),
+  m_font("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", "font", "File from which to take font", *this, false),
+  m_text_renderer(distance_field_glyph,
+                  enumerated_string_type<enum glyph_type>()
+                  .add_entry("coverage", coverage_glyph, "coverage glyphs (i.e. alpha masks)")
+                  .add_entry("distance_field", distance_field_glyph, "distance field glyphs")
+                  .add_entry("curve_pair", curve_pair_glyph, "curve-pair glyphs"),
+                  "text_renderer",
+                  "Specifies how to render text", *this, false),
+  m_text_renderer_realized_pixel_size(24,
+                                      "text_renderer_stored_pixel_size_non_scalable",
+                                      "Only has effect if text_renderer value is a text rendering value "
+                                      "where the font data is not scalable (i.e. coverage). Specifies "
+                                      "the value to realize the glyph data to render",
+                                      *this, false),
+  m_pixel_size(12.0f, "font_pixel_size", "Render size for text rendering", *this, false),
+  m_break_on_shader_change(false, "break_on_shader_change",
+                           "If true, the backend breaks the draw on each shader change, "
+                           "see ConfigurationNull::break_on_shader_change()", *this, false),
+  m_retained_geometry_attributes(0, "retained_geometry_attributes",
+                                 "If positive (together with retained_geometry_indices), the "
+                                 "backend has a PainterRetainedGeometryStore of this many attributes "
+                                 "from which path geometry is drawn, see "
+                                 "ConfigurationNull::retained_geometry_attributes()", *this, false),
+  m_retained_geometry_indices(0, "retained_geometry_indices",
+                              "Number of indices of the PainterRetainedGeometryStore, see "
+                              "ConfigurationNull::retained_geometry_indices()", *this, false),
+  m_persistent_data_store_blocks(0, "persistent_data_store_blocks",
+                                 "If positive, the backend has a PainterPersistentDataStore "
+                                 "of this many blocks and the static brushes of the scenes "
+                                 "are long lived packed values, see "
+                                 "ConfigurationNull::persistent_data_store_blocks()", *this, false),
+  m_header_via_base_instance(false, "header_via_base_instance",
+                             "If true, the backend has no header attributes and is given "
+                             "the header of the indices by PainterDraw::header_changed(), see "
+                             "ConfigurationNull::header_via_base_instance()", *this, false),
+  m_deferred_submission(false, "deferred_submission",
+                        "If true, the Painter reorders items whose output does not depend "
+                        "on the framebuffer to reduce draw breaks, see "
+                        "Painter::deferred_submission()", *this, false),
+  m_command_list(false, "command_list",
+                 "If true, each frame of a scene is recorded with a Painter of a "
+                 "PainterCommandList and then drawn with Painter::draw_command_list(), "
+                 "the recording is timed as painter_draw_and_pack", *this, false),
+  m_scene("", "scene", "if non-empty, only run the scene of the given name, "
+          "the scenes are text_pages, painter_cells, dashed_strokes and "
+          "clip_path_stacks", *this, false),
+  m_output("", "output", "file to which to write the JSON results, if empty "
+           "the results are written to stdout", *this, false),
+  m_trace_output("", "trace_output", "if non-empty, record the tracing zones and counters "
+                 "of FastUIDraw while running the scenes and write them as Chrome trace-event "
+                 "JSON to the named file, requires FastUIDraw built with ENABLE_TRACING=1",
+                 *this, false),
+  m_path_cache_budget_kb(0, "path_cache_budget_kb",
+                         "If positive, the soft budget in KB of each of the memory_accounting "
+                         "categories tessellation, filled_path_data and stroked_path_data, "
+                         "enforced with memory_accounting::enforce_budgets() after each frame",
+                         *this, false),
+  m_setup_atlas_bytes(0),
+  m_setup_time_us(0)
+{}
+
+painter_cpu_benchmark::
+~painter_cpu_benchmark()
+{
+  for(unsigned int i = 0; i < m_scenes.size(); ++i)
+    {
+      FASTUIDRAWdelete(m_scenes[i]);
+    }
+}
+
+const char*
+painter_cpu_benchmark::
+timing_label(enum timing_t t)
+{
+  switch(t)
+    {
+    case time_painter_begin:
+      return "painter_begin";
+    case time_painter_draw:
+      return "painter_draw_and_pack";
+    case time_painter_end:
+      return "painter_end";
+    case time_command_list_replay:
+      return "command_list_replay";
+    case time_select_subsets:
+      return "select_subsets";
+    case time_filled_path:
+      return "filled_path_construction";
+    case time_stroked_path:
+      return "stroked_path_construction";
+    default:
+      return "unknown";
+    }
+}
+
+const char*
+painter_cpu_benchmark::
+packer_stat_label(enum PainterPacker::stats_t st)
+{
+  switch(st)
+    {
+    case PainterPacker::num_attributes:
+      return "num_attributes";
+    case PainterPacker::num_indices:
+      return "num_indices";
+    case PainterPacker::num_generic_datas:
+      return "num_generic_datas";
+    case PainterPacker::num_draws:
+      return "num_draws";
+    case PainterPacker::num_headers:
+      return "num_headers";
+    case PainterPacker::num_deferred_filled_path_subsets:
+      return "num_deferred_filled_path_subsets";
+    case PainterPacker::num_coarser_fill_fallbacks:
+      return "num_coarser_fill_fallbacks";
+    case PainterPacker::num_culled_fill_indices:
+      return "num_culled_fill_indices";
+    case PainterPacker::num_retained_indices:
+      return "num_retained_indices";
+    case PainterPacker::num_persistent_data_references:
+      return "num_persistent_data_references";
+    case PainterPacker::num_draw_breaks:
+      return "num_draw_breaks";
+    default:
+      return "unknown";
+    }
+}
+
+const char*
+painter_cpu_benchmark::
+backend_stat_label(enum PainterBackendNull::stats_t st)
+{
+  switch(st)
+    {
+    case PainterBackendNull::num_draws:
+      return "num_draws";
+    case PainterBackendNull::num_draw_breaks:
+      return "num_draw_breaks";
+    case PainterBackendNull::num_blend_mode_changes:
+      return "num_blend_mode_changes";
+    case PainterBackendNull::num_attributes:
+      return "num_attributes";
+    case PainterBackendNull::num_indices:
+      return "num_indices";
+    case PainterBackendNull::attribute_bytes:
+      return "attribute_bytes";
+    case PainterBackendNull::index_bytes:
+      return "index_bytes";
+    case PainterBackendNull::data_store_bytes:
+      return "data_store_bytes";
+    case PainterBackendNull::atlas_bytes:
+      return "atlas_bytes";
+    case PainterBackendNull::num_retained_draws:
+      return "num_retained_draws";
+    case PainterBackendNull::retained_geometry_bytes:
+      return "retained_geometry_bytes";
+    case PainterBackendNull::num_header_changes:
+      return "num_header_changes";
+    case PainterBackendNull::persistent_data_store_bytes:
+      return "persistent_data_store_bytes";
+    default:
+      return "unknown";
+    }
+}
+
+void
+painter_cpu_benchmark::
+init_painter(void)
+{
+  SceneParams params;
+  reference_counted_ptr<FontFreeType> font;
+  simple_time timer;
+
+  m_backend = FASTUIDRAWnew PainterBackendNull(PainterBackendNull::ConfigurationNull()
+                                               .break_on_shader_change(m_break_on_shader_change.m_value)
+                                               .retained_geometry_attributes(std::max(0, m_retained_geometry_attributes.m_value))
+                                               .retained_geometry_indices(std::max(0, m_retained_geometry_indices.m_value))
+                                               .persistent_data_store_blocks(std::max(0, m_persistent_data_store_blocks.m_value))
+                                               .header_via_base_instance(m_header_via_base_instance.m_value));
+  m_painter = FASTUIDRAWnew Painter(m_backend);
+  m_painter->deferred_submission(m_deferred_submission.m_value);
+  m_painter->target_resolution(m_width.m_value, m_height.m_value);
+  if(m_command_list.m_value)
+    {
+      m_command_list_backend = FASTUIDRAWnew PainterCommandList(m_backend);
+      m_recorder = FASTUIDRAWnew Painter(m_command_list_backend);
+      m_recorder->deferred_submission(m_deferred_submission.m_value);
+      m_recorder->target_resolution(m_width.m_value, m_height.m_value);
+    }
+
+  m_ft_lib = FASTUIDRAWnew FreetypeLib();
+  font = FontFreeType::create(m_font.m_value.c_str(), m_ft_lib, FontFreeType::RenderParams());
+  if(!font)
+    {
+      std::cerr << "Unable to load font \"" << m_font.m_value << "\"\n";
+      exit(-1);
+    }
+
+  m_glyph_cache = FASTUIDRAWnew GlyphCache(m_painter->glyph_atlas());
+  m_glyph_selector = FASTUIDRAWnew GlyphSelector(m_glyph_cache);
+
+  params.m_resolution = vec2(m_width.m_value, m_height.m_value);
+  params.m_font = font;
+  params.m_glyph_selector = m_glyph_selector;
+  params.m_pixel_size = m_pixel_size.m_value;
+  if(m_persistent_data_store_blocks.m_value > 0)
+    {
+      params.m_long_lived_values = &m_painter->packed_value_pool();
+    }
+  if(!GlyphRender::scalable(m_text_renderer.m_value.m_value))
+    {
+      GlyphRender r(m_text_renderer_realized_pixel_size.m_value);
+      r.m_type = m_text_renderer.m_value.m_value;
+      params.m_text_render = r;
+    }
+  else
+    {
+      params.m_text_render = GlyphRender(m_text_renderer.m_value.m_value);
+    }
+
+  create_benchmark_scenes(params, m_scenes);
+  if(!m_scene.m_value.empty())
+    {
+      std::vector<BenchmarkScene*> tmp;
+      for(unsigned int i = 0; i < m_scenes.size(); ++i)
+        {
+          if(m_scenes[i]->name() == m_scene.m_value)
+            {
+              tmp.push_back(m_scenes[i]);
+            }
+          else
+            {
+              FASTUIDRAWdelete(m_scenes[i]);
+            }
+        }
+      m_scenes.swap(tmp);
+      if(m_scenes.empty())
+        {
+          std::cerr << "No scene named \"" << m_scene.m_value << "\"\n";
+          exit(-1);
+        }
+    }
+
+  m_setup_time_us = timer.elapsed_us();
+  m_setup_atlas_bytes = m_backend->query_stat(PainterBackendNull::atlas_bytes);
+}
+
+void
+painter_cpu_benchmark::
+run_scene(BenchmarkScene *scene, scene_result &out_result)
+{
+  float3x3 proj(float_orthogonal_projection_params(0, m_width.m_value, m_height.m_value, 0));
+  const std::vector<Path> &paths(scene->paths());
+  std::vector<std::vector<unsigned int> > needed_subsets(paths.size());
+  std::vector<unsigned int> selected;
+  FilledPath::ScratchSpace scratch_space;
+  vecN<vec3, 4> clip_equations;
+  unsigned int total_frames;
+
+  /* clip equations of the render target in clip coordinates */
+  clip_equations[0] = vec3( 1.0f,  0.0f, 1.0f);
+  clip_equations[1] = vec3(-1.0f,  0.0f, 1.0f);
+  clip_equations[2] = vec3( 0.0f,  1.0f, 1.0f);
+  clip_equations[3] = vec3( 0.0f, -1.0f, 1.0f);
+
+  memory_accounting::reset_peak_bytes();
+  total_frames = m_num_warm_up_frames.m_value + m_num_frames.m_value;
+  for(unsigned int frame = 0; frame < total_frames; ++frame)
+    {
+      bool measure(frame >= static_cast<unsigned int>(m_num_warm_up_frames.m_value));
+      vecN<int64_t, number_timings> times;
+      simple_time timer;
+
+      m_backend->reset_stats();
+      timer.restart_us();
+      m_painter->begin();
+      times[time_painter_begin] = timer.restart_us();
+
+      if(m_recorder)
+        {
+          m_command_list_backend->clear();
+          m_recorder->begin();
+          m_recorder->transformation(proj);
+          scene->paint(m_recorder.get(), frame);
+          m_recorder->end();
+          times[time_painter_draw] = timer.restart_us();
+
+          m_painter->draw_command_list(*m_command_list_backend);
+          times[time_command_list_replay] = timer.restart_us();
+        }
+      else
+        {
+          m_painter->transformation(proj);
+          scene->paint(m_painter.get(), frame);
+          times[time_painter_draw] = timer.restart_us();
+          times[time_command_list_replay] = 0;
+        }
+
+      m_painter->end();
+      times[time_painter_end] = timer.restart_us();
+
+      /* select_subsets() of each fill of the frame, against the
+         FilledPath objects that the Painter used; these are already
+         triangulated by the fills, so only the selection is timed.
+       */
+      const std::vector<BenchmarkScene::FillInstance> &fills(scene->fill_instances());
+      for(unsigned int i = 0; i < needed_subsets.size(); ++i)
+        {
+          needed_subsets[i].clear();
+        }
+
+      timer.restart_us();
+      for(unsigned int i = 0; i < fills.size(); ++i)
+        {
+          const reference_counted_ptr<const FilledPath> &filled(paths[fills[i].m_path].tessellation()->filled());
+          std::vector<unsigned int> &needed(needed_subsets[fills[i].m_path]);
+          unsigned int cnt, sz;
+
+          selected.resize(filled->number_subsets());
+          cnt = filled->select_subsets(scratch_space,
+                                       const_c_array<vec3>(clip_equations.c_ptr(), clip_equations.size()),
+                                       fills[i].m_clip_matrix_local,
+                                       m_backend->attribs_per_mapping(),
+                                       m_backend->indices_per_mapping(),
+                                       cast_c_array(selected));
+          sz = needed.size();
+          needed.resize(sz + cnt);
+          std::copy(selected.begin(), selected.begin() + cnt, needed.begin() + sz);
+          if(measure)
+            {
+              out_result.m_selected_subsets += cnt;
+            }
+        }
+      times[time_select_subsets] = timer.restart_us();
+
+      for(unsigned int i = 0; i < needed_subsets.size(); ++i)
+        {
+          std::vector<unsigned int> &needed(needed_subsets[i]);
+          std::sort(needed.begin(), needed.end());
+          needed.erase(std::unique(needed.begin(), needed.end()), needed.end());
+        }
+
+      /* construct from scratch the FilledPath of each path of the
+         scene, including the triangulation of those Subset objects
+         the frame needed, and the StrokedPath of each path.
+       */
+      timer.restart_us();
+      for(unsigned int i = 0; i < paths.size(); ++i)
+        {
+          FilledPath filled(*paths[i].tessellation());
+          for(unsigned int s = 0; s < needed_subsets[i].size(); ++s)
+            {
+              if(needed_subsets[i][s] < filled.number_subsets())
+                {
+                  filled.subset(needed_subsets[i][s]);
+                }
+            }
+        }
+      times[time_filled_path] = timer.restart_us();
+
+      for(unsigned int i = 0; i < paths.size(); ++i)
+        {
+          StrokedPath stroked(*paths[i].tessellation());
+        }
+      times[time_stroked_path] = timer.restart_us();
+
+      if(measure)
+        {
+          for(unsigned int t = 0; t < number_timings; ++t)
+            {
+              out_result.m_timings[t].add(times[t]);
+            }
+          for(unsigned int st = 0; st < PainterPacker::num_stats; ++st)
+            {
+              out_result.m_packer_stats[st] += m_painter->query_stat(static_cast<enum PainterPacker::stats_t>(st));
+            }
+          for(unsigned int st = 0; st < PainterBackendNull::num_stats; ++st)
+            {
+              out_result.m_backend_stats[st] += m_backend->query_stat(static_cast<enum PainterBackendNull::stats_t>(st));
+            }
+          out_result.m_fills += fills.size();
+        }
+
+      if(m_path_cache_budget_kb.m_value > 0)
+        {
+          unsigned int evicted;
+
+          evicted = memory_accounting::enforce_budgets();
+          if(measure)
+            {
+              out_result.m_evicted_caches += evicted;
+            }
+        }
+    }
+
+  for(unsigned int c = 0; c < memory_accounting::number_categories; ++c)
+    {
+      out_result.m_peak_bytes[c] = memory_accounting::peak_bytes(static_cast<enum memory_accounting::category_t>(c));
+    }
+}
+
+void
+painter_cpu_benchmark::
+write_json(std::ostream &str)
+{
+  str << "{\n"
+      << "  \"benchmark\": \"painter-cpu-benchmark\",\n"
+      << "  \"config\": {\n"
+#ifdef NDEBUG
+      << "    \"build\": \"release\",\n"
+#else
+      << "    \"build\": \"debug\",\n"
+#endif
+      << "    \"num_frames\": " << m_num_frames.m_value << ",\n"
+      << "    \"num_warm_up_frames\": " << m_num_warm_up_frames.m_value << ",\n"
+      << "    \"width\": " << m_width.m_value << ",\n"
+      << "    \"height\": " << m_height.m_value << ",\n"
+      << "    \"text_renderer\": "
+      << "\"" << m_text_renderer.m_value.m_label_set.m_value_Ts[m_text_renderer.m_value.m_value].first << "\",\n"
+      << "    \"font_pixel_size\": " << m_pixel_size.m_value << ",\n"
+      << "    \"break_on_shader_change\": " << (m_break_on_shader_change.m_value ? "true" : "false") << ",\n"
+      << "    \"retained_geometry_attributes\": " << m_retained_geometry_attributes.m_value << ",\n"
+      << "    \"retained_geometry_indices\": " << m_retained_geometry_indices.m_value << ",\n"
+      << "    \"persistent_data_store_blocks\": " << m_persistent_data_store_blocks.m_value << ",\n"
+      << "    \"header_via_base_instance\": " << (m_header_via_base_instance.m_value ? "true" : "false") << ",\n"
+      << "    \"deferred_submission\": " << (m_deferred_submission.m_value ? "true" : "false") << ",\n"
+      << "    \"command_list\": " << (m_command_list.m_value ? "true" : "false") << ",\n"
+      << "    \"path_cache_budget_kb\": " << m_path_cache_budget_kb.m_value << "\n"
+      << "  },\n"
+      << "  \"setup\": { \"time_us\": " << m_setup_time_us
+      << ", \"atlas_bytes\": " << m_setup_atlas_bytes << " },\n"
+      << "  \"scenes\": [\n";
+
+  for(unsigned int i = 0; i < m_scenes.size(); ++i)
+    {
+      const scene_result &R(m_results[i]);
+
+      str << "    {\n"
+          << "      \"name\": \"" << m_scenes[i]->name() << "\",\n"
+          << "      \"num_paths\": " << m_scenes[i]->paths().size() << ",\n"
+          << "      \"num_fills\": " << R.m_fills << ",\n"
+          << "      \"num_selected_subsets\": " << R.m_selected_subsets << ",\n"
+          << "      \"timings\": {\n";
+      for(unsigned int t = 0; t < number_timings; ++t)
+        {
+          str << "        \"" << timing_label(static_cast<enum timing_t>(t)) << "\": ";
+          R.m_timings[t].write_json(str);
+          str << ((t + 1 < number_timings) ? ",\n" : "\n");
+        }
+
+      str << "      },\n"
+          << "      \"painter_packer\": {\n";
+      for(unsigned int st = 0; st < PainterPacker::num_stats; ++st)
+        {
+          str << "        \"" << packer_stat_label(static_cast<enum PainterPacker::stats_t>(st))
+              << "\": " << R.m_packer_stats[st]
+              << ((st + 1 < PainterPacker::num_stats) ? ",\n" : "\n");
+        }
+
+      str << "      },\n"
+          << "      \"backend\": {\n";
+      for(unsigned int st = 0; st < PainterBackendNull::num_stats; ++st)
+        {
+          str << "        \"" << backend_stat_label(static_cast<enum PainterBackendNull::stats_t>(st))
+              << "\": " << R.m_backend_stats[st]
+              << ((st + 1 < PainterBackendNull::num_stats) ? ",\n" : "\n");
+        }
+      str << "      },\n"
+          << "      \"memory\": {\n"
+          << "        \"evicted_caches\": " << R.m_evicted_caches << ",\n";
+      for(unsigned int c = 0; c < memory_accounting::number_categories; ++c)
+        {
+          str << "        \"peak_" << memory_accounting::label(static_cast<enum memory_accounting::category_t>(c))
+              << "_bytes\": " << R.m_peak_bytes[c]
+              << ((c + 1 < memory_accounting::number_categories) ? ",\n" : "\n");
+        }
+      str << "      }\n"
+          << "    }" << ((i + 1 < m_scenes.size()) ? ",\n" : "\n");
+    }
+  str << "  ]\n"
+      << "}\n";
+}
+
+int
+painter_cpu_benchmark::
+main(int argc, char **argv)
+{
+  if(argc == 2 && (std::string(argv[1]) == "-help" || std::string(argv[1]) == "--help"))
+    {
+      std::cout << "\n\nUsage: " << argv[0];
+      print_help(std::cout);
+      print_detailed_help(std::cout);
+      return 0;
+    }
+
+  parse_command_line(argc, argv);
+
+  if(m_path_cache_budget_kb.m_value > 0)
+    {
+      uint64_t budget(1024u * static_cast<uint64_t>(m_path_cache_budget_kb.m_value));
+
+      memory_accounting::soft_budget(memory_accounting::tessellation, budget);
+      memory_accounting::soft_budget(memory_accounting::filled_path_data, budget);
+      memory_accounting::soft_budget(memory_accounting::stroked_path_data, budget);
+    }
+
+  init_painter();
+  if(!m_trace_output.m_value.empty())
+    {
+      if(!tracing::compiled_in())
+        {
+          std::cerr << "FastUIDraw built without tracing, trace_output ignored\n";
+        }
+      tracing::reset();
+      tracing::enabled(true);
+    }
+
+  m_results.resize(m_scenes.size());
+  for(unsigned int i = 0; i < m_scenes.size(); ++i)
+    {
+      std::cerr << "Running scene " << m_scenes[i]->name() << "\n";
+      run_scene(m_scenes[i], m_results[i]);
+    }
+
+  if(!m_trace_output.m_value.empty())
+    {
+      std::ofstream file(m_trace_output.m_value.c_str());
+
+      tracing::enabled(false);
+      if(!file)
+        {
+          std::cerr << "Unable to open \"" << m_trace_output.m_value << "\" for writing\n";
+          return -1;
+        }
+      tracing::write_chrome_trace(file);
+    }
+
+  if(m_output.m_value.empty())
+    {
+      write_json(std::cout);
+    }
+  else
+    {
+      std::ofstream file(m_output.m_value.c_str());
+      if(!file)
+        {
+          std::cerr << "Unable to open \"" << m_output.m_value << "\" for writing\n";
+          return -1;
+        }
+      write_json(file);
+    }
+
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  painter_cpu_benchmark B;
+  return B.main(argc, argv);
+}
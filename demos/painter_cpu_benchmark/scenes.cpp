@@ -0,0 +1,689 @@
+#include <sstream>
+#include <random>
+#include <map>
+#include <math.h>
+#include <string.h>
+#include <fastuidraw/painter/painter_attribute_data.hpp>
+#include <fastuidraw/painter/painter_attribute_data_filler_glyphs.hpp>
+#include <fastuidraw/painter/painter_stroke_params.hpp>
+#include <fastuidraw/painter/painter_dashed_stroke_params.hpp>
+#include "scenes.hpp"
+#include "text_helper.hpp"
+#include "cast_c_array.hpp"
+
+namespace
+{
+  /* The scenes use their own generator so that their content
+     is the same on every platform, std::minstd_rand is fully
+     specified by the standard whereas the distributions are not.
+   */
+  class SceneRandom
+  {
+  public:
+    explicit
+    SceneRandom(uint32_t seed):
+      m_engine(seed)
+    {}
+
+    unsigned int
+    operator()(unsigned int N)
+    {
+      return m_engine() % N;
+    }
+
+    float
+    operator()(float a, float b)
+    {
+      float t;
+      t = static_cast<float>(m_engine() % 1024u) / 1023.0f;
+      return a + t * (b - a);
+    }
+
+  private:
+    std::minstd_rand m_engine;
+  };
+
+  std::string
+  make_page_text(SceneRandom &R, unsigned int num_lines, unsigned int chars_per_line)
+  {
+    static const char *words[] =
+      {
+        "painter", "glyph", "atlas", "stroke", "fill", "path", "clip",
+        "shader", "attribute", "index", "header", "store", "subset",
+        "tessellate", "join", "cap", "dash", "brush", "pen", "image",
+        "gradient", "blend", "packer", "draw", "break", "the", "a",
+        "of", "to", "with", "and", "on", "from", "is", "by"
+      };
+    const unsigned int num_words(sizeof(words) / sizeof(words[0]));
+    std::ostringstream str;
+
+    for(unsigned int line = 0; line < num_lines; ++line)
+      {
+        unsigned int len(0);
+        while(len < chars_per_line)
+          {
+            const char *w(words[R(num_words)]);
+            str << w << " ";
+            len += strlen(w) + 1;
+          }
+        str << "\n";
+      }
+    return str.str();
+  }
+
+  Path
+  make_star(const vec2 &center, float outer_radius, float inner_radius,
+            unsigned int num_points)
+  {
+    Path P;
+    for(unsigned int i = 0; i < 2 * num_points; ++i)
+      {
+        float a, r;
+        a = static_cast<float>(i) * static_cast<float>(M_PI) / static_cast<float>(num_points);
+        r = (i & 1u) ? inner_radius : outer_radius;
+        P << center + r * vec2(cosf(a), sinf(a));
+      }
+    P << Path::contour_end();
+    return P;
+  }
+
+  Path
+  make_rounded_rect(const vec2 &min_pt, const vec2 &max_pt, float r)
+  {
+    Path P;
+    P << vec2(min_pt.x() + r, min_pt.y())
+      << vec2(max_pt.x() - r, min_pt.y())
+      << Path::arc_degrees(90.0f, vec2(max_pt.x(), min_pt.y() + r))
+      << vec2(max_pt.x(), max_pt.y() - r)
+      << Path::arc_degrees(90.0f, vec2(max_pt.x() - r, max_pt.y()))
+      << vec2(min_pt.x() + r, max_pt.y())
+      << Path::arc_degrees(90.0f, vec2(min_pt.x(), max_pt.y() - r))
+      << vec2(min_pt.x(), min_pt.y() + r)
+      << Path::contour_end_arc_degrees(90.0f);
+    return P;
+  }
+
+  Path
+  make_circle(const vec2 &center, float r)
+  {
+    Path P;
+    P << center + vec2(r, 0.0f)
+      << Path::arc_degrees(180.0f, center - vec2(r, 0.0f))
+      << Path::contour_end_arc_degrees(180.0f);
+    return P;
+  }
+
+  Path
+  make_wave(const vec2 &start, float length, float amplitude, unsigned int num_waves)
+  {
+    Path P;
+    float dx;
+
+    dx = length / static_cast<float>(num_waves);
+    P << start;
+    for(unsigned int i = 0; i < num_waves; ++i)
+      {
+        float x, sgn;
+        x = start.x() + dx * static_cast<float>(i);
+        sgn = (i & 1u) ? -1.0f : 1.0f;
+        P << Path::control_point(x + 0.25f * dx, start.y() + sgn * amplitude)
+          << Path::control_point(x + 0.75f * dx, start.y() + sgn * amplitude)
+          << vec2(x + dx, start.y());
+      }
+    P << vec2(start.x() + length, start.y() + 2.0f * amplitude)
+      << vec2(start.x(), start.y() + 2.0f * amplitude)
+      << Path::contour_end();
+    return P;
+  }
+
+  Path
+  make_spiral(const vec2 &center, float r, unsigned int num_turns)
+  {
+    Path P;
+    float rr(r);
+
+    P << center + vec2(rr, 0.0f);
+    for(unsigned int i = 0; i < 2 * num_turns; ++i)
+      {
+        float sgn;
+        sgn = (i & 1u) ? 1.0f : -1.0f;
+        rr *= 0.8f;
+        P << Path::arc_degrees(180.0f, center + vec2(sgn * rr, 0.0f));
+      }
+    P << Path::contour_end();
+    return P;
+  }
+
+  /* Pages of text laid out in a grid with a heading
+     drawn by filling the paths of its glyphs.
+   */
+  class TextPagesScene:public BenchmarkScene
+  {
+  public:
+    explicit
+    TextPagesScene(const SceneParams &params);
+
+    ~TextPagesScene();
+
+  protected:
+    virtual
+    void
+    paint_scene(Painter *painter, unsigned int frame);
+
+  private:
+    class Page
+    {
+    public:
+      PainterAttributeData *m_text;
+      std::vector<unsigned int> m_heading_paths;
+      std::vector<vec2> m_heading_positions;
+      std::vector<float> m_heading_scales;
+    };
+
+    ivec2 m_count;
+    vec2 m_page_size;
+    std::vector<Page> m_pages;
+    PainterBrush m_background_brush, m_text_brush, m_heading_brush;
+    PainterData::value<PainterBrush> m_background_value, m_text_value, m_heading_value;
+  };
+
+  /* A grid of rotating cells, each with a background,
+     a rounded-rect drawn by filling and a line of text,
+     modeled after the painter_cells demo.
+   */
+  class CellsGridScene:public BenchmarkScene
+  {
+  public:
+    explicit
+    CellsGridScene(const SceneParams &params);
+
+    ~CellsGridScene();
+
+  protected:
+    virtual
+    void
+    paint_scene(Painter *painter, unsigned int frame);
+
+  private:
+    ivec2 m_count;
+    vec2 m_cell_size;
+    unsigned int m_rounded_rect;
+    std::vector<PainterAttributeData*> m_text;
+    std::vector<PainterBrush> m_background_brushes;
+    PainterBrush m_text_brush, m_item_brush, m_line_brush;
+    PainterStrokeParams m_line_params;
+  };
+
+  /* Paths stroked dashed with each join and cap style,
+     with the dash offset moving with the frame.
+   */
+  class DashedStrokesScene:public BenchmarkScene
+  {
+  public:
+    explicit
+    DashedStrokesScene(const SceneParams &params);
+
+  protected:
+    virtual
+    void
+    paint_scene(Painter *painter, unsigned int frame);
+
+  private:
+    ivec2 m_count;
+    vec2 m_tile_size;
+    std::vector<PainterDashedStrokeParams::DashPatternElement> m_dash_pattern;
+    PainterBrush m_fill_brush, m_stroke_brush;
+  };
+
+  /* Stacks of nested clipInPath() and clipOutPath(),
+     with content drawn inside of each stack.
+   */
+  class ClipStackScene:public BenchmarkScene
+  {
+  public:
+    explicit
+    ClipStackScene(const SceneParams &params);
+
+  protected:
+    virtual
+    void
+    paint_scene(Painter *painter, unsigned int frame);
+
+  private:
+    ivec2 m_count;
+    vec2 m_tile_size;
+    unsigned int m_circle, m_star, m_rounded_rect, m_spiral;
+    PainterBrush m_background_brush, m_content_brush, m_stroke_brush;
+    PainterStrokeParams m_stroke_params;
+  };
+}
+
+//////////////////////////////////////
+// BenchmarkScene methods
+BenchmarkScene::
+BenchmarkScene(const std::string &name, const SceneParams &params):
+  m_name(name),
+  m_params(params)
+{}
+
+void
+BenchmarkScene::
+paint(Painter *painter, unsigned int frame)
+{
+  m_fill_instances.clear();
+  paint_scene(painter, frame);
+}
+
+unsigned int
+BenchmarkScene::
+add_path(const Path &path)
+{
+  m_paths.push_back(path);
+  return m_paths.size() - 1;
+}
+
+PainterData::value<PainterBrush>
+BenchmarkScene::
+brush_value(const PainterBrush *brush)
+{
+  if(m_params.m_long_lived_values)
+    {
+      return m_params.m_long_lived_values->create_packed_value(*brush, true);
+    }
+  return brush;
+}
+
+void
+BenchmarkScene::
+record_fill(Painter *painter, unsigned int path)
+{
+  FillInstance F;
+
+  F.m_path = path;
+  F.m_clip_matrix_local = painter->transformation().m_item_matrix;
+  m_fill_instances.push_back(F);
+}
+
+void
+BenchmarkScene::
+fill_path(Painter *painter, const PainterData &draw, unsigned int path,
+          enum PainterEnums::fill_rule_t fill_rule)
+{
+  record_fill(painter, path);
+  painter->fill_path(draw, m_paths[path], fill_rule, true);
+}
+
+void
+BenchmarkScene::
+clip_in_path(Painter *painter, unsigned int path,
+             enum PainterEnums::fill_rule_t fill_rule)
+{
+  record_fill(painter, path);
+  painter->clipInPath(m_paths[path], fill_rule);
+}
+
+void
+BenchmarkScene::
+clip_out_path(Painter *painter, unsigned int path,
+              enum PainterEnums::fill_rule_t fill_rule)
+{
+  record_fill(painter, path);
+  painter->clipOutPath(m_paths[path], fill_rule);
+}
+
+void
+BenchmarkScene::
+create_text(const std::string &text, PainterAttributeData &out_data,
+            std::vector<Glyph> *out_glyphs,
+            std::vector<vec2> *out_positions)
+{
+  std::istringstream str(text);
+  std::vector<Glyph> glyphs;
+  std::vector<vec2> positions;
+  std::vector<uint32_t> character_codes;
+
+  create_formatted_text(str, m_params.m_text_render, m_params.m_pixel_size,
+                        m_params.m_font, m_params.m_glyph_selector,
+                        glyphs, positions, character_codes);
+  out_data.set_data(PainterAttributeDataFillerGlyphs(cast_c_array(positions),
+                                                     cast_c_array(glyphs),
+                                                     m_params.m_pixel_size));
+  if(out_glyphs)
+    {
+      out_glyphs->swap(glyphs);
+    }
+  if(out_positions)
+    {
+      out_positions->swap(positions);
+    }
+}
+
+//////////////////////////////////////
+// TextPagesScene methods
+TextPagesScene::
+TextPagesScene(const SceneParams &params):
+  BenchmarkScene("text_pages", params),
+  m_count(2, 2)
+{
+  SceneRandom R(1u);
+  unsigned int num_lines, chars_per_line;
+  std::vector<Glyph> heading_glyphs;
+  std::vector<vec2> heading_positions;
+  std::map<unsigned int, unsigned int> glyph_paths;
+  const float heading_scale(3.0f);
+
+  m_page_size = params.m_resolution / vec2(m_count);
+  num_lines = static_cast<unsigned int>(m_page_size.y() / (params.m_pixel_size + 1.0f));
+  chars_per_line = static_cast<unsigned int>(2.0f * m_page_size.x() / params.m_pixel_size);
+
+  m_pages.resize(m_count.x() * m_count.y());
+  for(unsigned int p = 0; p < m_pages.size(); ++p)
+    {
+      PainterAttributeData heading;
+      std::ostringstream heading_text;
+
+      m_pages[p].m_text = FASTUIDRAWnew PainterAttributeData();
+      create_text(make_page_text(R, num_lines, chars_per_line), *m_pages[p].m_text);
+
+      heading_text << "Page " << p;
+      create_text(heading_text.str(), heading, &heading_glyphs, &heading_positions);
+      for(unsigned int g = 0; g < heading_glyphs.size(); ++g)
+        {
+          if(heading_glyphs[g].valid() && heading_glyphs[g].path().number_contours() > 0)
+            {
+              std::map<unsigned int, unsigned int>::iterator iter;
+              unsigned int code;
+
+              code = heading_glyphs[g].cache_location();
+              iter = glyph_paths.find(code);
+              if(iter == glyph_paths.end())
+                {
+                  iter = glyph_paths.insert(std::make_pair(code, add_path(heading_glyphs[g].path()))).first;
+                }
+              m_pages[p].m_heading_paths.push_back(iter->second);
+              m_pages[p].m_heading_positions.push_back(heading_scale * heading_positions[g]);
+              m_pages[p].m_heading_scales.push_back(heading_scale * params.m_pixel_size
+                                                    / static_cast<float>(heading_glyphs[g].layout().m_pixel_size));
+            }
+        }
+    }
+
+  m_background_brush.pen(1.0f, 1.0f, 0.9f, 1.0f);
+  m_text_brush.pen(0.0f, 0.0f, 0.0f, 1.0f);
+  m_heading_brush.pen(0.2f, 0.2f, 0.6f, 1.0f);
+
+  m_background_value = brush_value(&m_background_brush);
+  m_text_value = brush_value(&m_text_brush);
+  m_heading_value = brush_value(&m_heading_brush);
+}
+
+TextPagesScene::
+~TextPagesScene()
+{
+  for(unsigned int p = 0; p < m_pages.size(); ++p)
+    {
+      FASTUIDRAWdelete(m_pages[p].m_text);
+    }
+}
+
+void
+TextPagesScene::
+paint_scene(Painter *painter, unsigned int frame)
+{
+  float scroll;
+
+  /* scroll the text of each page by a few pixels per frame */
+  scroll = static_cast<float>(frame % 32u);
+  for(int y = 0, p = 0; y < m_count.y(); ++y)
+    {
+      for(int x = 0; x < m_count.x(); ++x, ++p)
+        {
+          const Page &page(m_pages[p]);
+
+          painter->save();
+          painter->translate(m_page_size * vec2(x, y));
+          painter->clipInRect(vec2(0.0f, 0.0f), m_page_size);
+
+          /* the page background is opaque */
+          painter->blend_shader(PainterEnums::blend_porter_duff_src);
+          painter->draw_rect(PainterData(m_background_value), vec2(0.0f, 0.0f), m_page_size, false);
+          painter->blend_shader(PainterEnums::blend_porter_duff_src_over);
+
+          painter->save();
+          painter->translate(vec2(4.0f, 4.0f - scroll));
+          painter->draw_glyphs(PainterData(m_text_value), *page.m_text);
+          painter->restore();
+
+          for(unsigned int g = 0; g < page.m_heading_paths.size(); ++g)
+            {
+              painter->save();
+              painter->translate(vec2(8.0f, 8.0f) + page.m_heading_positions[g]);
+              painter->scale(page.m_heading_scales[g]);
+              fill_path(painter, PainterData(m_heading_value), page.m_heading_paths[g],
+                        PainterEnums::nonzero_fill_rule);
+              painter->restore();
+            }
+          painter->restore();
+        }
+    }
+}
+
+//////////////////////////////////////
+// CellsGridScene methods
+CellsGridScene::
+CellsGridScene(const SceneParams &params):
+  BenchmarkScene("painter_cells", params),
+  m_count(16, 12)
+{
+  SceneRandom R(2u);
+  vec2 sz;
+
+  m_cell_size = params.m_resolution / vec2(m_count);
+  sz = 0.3f * m_cell_size;
+  m_rounded_rect = add_path(make_rounded_rect(-sz, sz, 0.25f * t_min(sz.x(), sz.y())));
+
+  m_text.resize(m_count.x() * m_count.y());
+  for(int y = 0, c = 0; y < m_count.y(); ++y)
+    {
+      for(int x = 0; x < m_count.x(); ++x, ++c)
+        {
+          std::ostringstream str;
+
+          str << "Cell(" << x << ", " << y << ")";
+          m_text[c] = FASTUIDRAWnew PainterAttributeData();
+          create_text(str.str(), *m_text[c]);
+        }
+    }
+
+  for(unsigned int i = 0; i < 8; ++i)
+    {
+      m_background_brushes.push_back(PainterBrush());
+      m_background_brushes.back().pen(R(0.0f, 1.0f), R(0.0f, 1.0f), R(0.0f, 1.0f), R(0.2f, 0.8f));
+    }
+  m_text_brush.pen(1.0f, 1.0f, 1.0f, 1.0f);
+  m_item_brush.pen(0.5f, 0.0f, 0.5f, 0.8f);
+  m_line_brush.pen(1.0f, 1.0f, 1.0f, 1.0f);
+  m_line_params.width(2.0f);
+}
+
+CellsGridScene::
+~CellsGridScene()
+{
+  for(unsigned int c = 0; c < m_text.size(); ++c)
+    {
+      FASTUIDRAWdelete(m_text[c]);
+    }
+}
+
+void
+CellsGridScene::
+paint_scene(Painter *painter, unsigned int frame)
+{
+  for(int y = 0, c = 0; y < m_count.y(); ++y)
+    {
+      for(int x = 0; x < m_count.x(); ++x, ++c)
+        {
+          float angle;
+
+          angle = static_cast<float>((3 * frame + 17 * c) % 360) * static_cast<float>(M_PI) / 180.0f;
+          painter->save();
+          painter->translate(m_cell_size * vec2(x, y));
+          painter->draw_rect(PainterData(&m_background_brushes[c % m_background_brushes.size()]),
+                             vec2(0.0f, 0.0f), m_cell_size, false);
+
+          painter->save();
+          painter->translate(0.5f * m_cell_size);
+          painter->rotate(angle);
+          fill_path(painter, PainterData(&m_item_brush), m_rounded_rect, PainterEnums::nonzero_fill_rule);
+          painter->translate(-0.5f * m_cell_size);
+          painter->draw_glyphs(PainterData(&m_text_brush), *m_text[c]);
+          painter->restore();
+
+          /* the grid lines are opaque */
+          painter->blend_shader(PainterEnums::blend_porter_duff_src);
+          painter->draw_rect(PainterData(&m_line_brush), vec2(0.0f, 0.0f),
+                             vec2(m_cell_size.x(), m_line_params.width()), false);
+          painter->draw_rect(PainterData(&m_line_brush), vec2(0.0f, 0.0f),
+                             vec2(m_line_params.width(), m_cell_size.y()), false);
+          painter->blend_shader(PainterEnums::blend_porter_duff_src_over);
+          painter->restore();
+        }
+    }
+}
+
+//////////////////////////////////////
+// DashedStrokesScene methods
+DashedStrokesScene::
+DashedStrokesScene(const SceneParams &params):
+  BenchmarkScene("dashed_strokes", params),
+  m_count(4, 3)
+{
+  vec2 c;
+  float r;
+
+  m_tile_size = params.m_resolution / vec2(m_count);
+  c = 0.5f * m_tile_size;
+  r = 0.4f * t_min(m_tile_size.x(), m_tile_size.y());
+
+  add_path(make_star(c, r, 0.4f * r, 5));
+  add_path(make_rounded_rect(c - vec2(r, 0.7f * r), c + vec2(r, 0.7f * r), 0.3f * r));
+  add_path(make_circle(c, r));
+  add_path(make_wave(c - vec2(r, 0.5f * r), 2.0f * r, 0.3f * r, 6));
+  add_path(make_spiral(c, r, 4));
+  add_path(make_star(c, r, 0.8f * r, 17));
+
+  m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement(20.0f, 10.0f));
+  m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement(15.0f, 10.0f));
+  m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement(10.0f, 10.0f));
+  m_dash_pattern.push_back(PainterDashedStrokeParams::DashPatternElement( 5.0f, 10.0f));
+
+  m_fill_brush.pen(0.0f, 0.5f, 0.5f, 0.5f);
+  m_stroke_brush.pen(1.0f, 0.5f, 0.0f, 0.8f);
+}
+
+void
+DashedStrokesScene::
+paint_scene(Painter *painter, unsigned int frame)
+{
+  PainterDashedStrokeParams st;
+
+  st.miter_limit(5.0f);
+  st.dash_offset(static_cast<float>(frame % 60u));
+  st.dash_pattern(cast_c_array(m_dash_pattern));
+
+  for(int y = 0, t = 0; y < m_count.y(); ++y)
+    {
+      for(int x = 0; x < m_count.x(); ++x, ++t)
+        {
+          unsigned int P;
+          enum PainterEnums::join_style js;
+          enum PainterEnums::cap_style cp;
+
+          P = t % paths().size();
+          js = static_cast<enum PainterEnums::join_style>(t % PainterEnums::number_join_styles);
+          cp = static_cast<enum PainterEnums::cap_style>(t % PainterEnums::number_cap_styles);
+          st.width(4.0f + 2.0f * static_cast<float>(t % 5));
+
+          painter->save();
+          painter->translate(m_tile_size * vec2(x, y));
+          if(t & 1)
+            {
+              fill_path(painter, PainterData(&m_fill_brush), P, PainterEnums::odd_even_fill_rule);
+            }
+          painter->stroke_dashed_path(PainterData(&m_stroke_brush, &st), path(P), true, cp, js, true);
+          painter->restore();
+        }
+    }
+}
+
+//////////////////////////////////////
+// ClipStackScene methods
+ClipStackScene::
+ClipStackScene(const SceneParams &params):
+  BenchmarkScene("clip_path_stacks", params),
+  m_count(3, 2)
+{
+  float r;
+
+  m_tile_size = params.m_resolution / vec2(m_count);
+  r = 0.45f * t_min(m_tile_size.x(), m_tile_size.y());
+
+  m_circle = add_path(make_circle(vec2(0.0f, 0.0f), r));
+  m_star = add_path(make_star(vec2(0.0f, 0.0f), 0.6f * r, 0.25f * r, 7));
+  m_rounded_rect = add_path(make_rounded_rect(vec2(-0.8f * r, -0.5f * r), vec2(0.8f * r, 0.5f * r), 0.2f * r));
+  m_spiral = add_path(make_spiral(vec2(0.0f, 0.0f), 0.9f * r, 3));
+
+  m_background_brush.pen(0.2f, 0.2f, 0.2f, 1.0f);
+  m_content_brush.pen(0.8f, 0.8f, 0.2f, 1.0f);
+  m_stroke_brush.pen(0.2f, 0.8f, 0.8f, 1.0f);
+  m_stroke_params.width(6.0f);
+}
+
+void
+ClipStackScene::
+paint_scene(Painter *painter, unsigned int frame)
+{
+  for(int y = 0, t = 0; y < m_count.y(); ++y)
+    {
+      for(int x = 0; x < m_count.x(); ++x, ++t)
+        {
+          float angle;
+
+          angle = static_cast<float>((2 * frame + 45 * t) % 360) * static_cast<float>(M_PI) / 180.0f;
+          painter->save();
+          painter->translate(m_tile_size * (vec2(x, y) + vec2(0.5f, 0.5f)));
+
+          painter->save();
+          clip_in_path(painter, m_circle, PainterEnums::nonzero_fill_rule);
+          painter->draw_rect(PainterData(&m_background_brush), -0.5f * m_tile_size, m_tile_size, false);
+
+          painter->save();
+          painter->rotate(angle);
+          clip_out_path(painter, m_star, PainterEnums::nonzero_fill_rule);
+          clip_in_path(painter, m_rounded_rect, PainterEnums::odd_even_fill_rule);
+          painter->draw_rect(PainterData(&m_content_brush), -0.5f * m_tile_size, m_tile_size, false);
+
+          painter->save();
+          painter->rotate(-2.0f * angle);
+          clip_in_path(painter, m_spiral, PainterEnums::odd_even_fill_rule);
+          fill_path(painter, PainterData(&m_background_brush), m_rounded_rect, PainterEnums::nonzero_fill_rule);
+          painter->stroke_path(PainterData(&m_stroke_brush, &m_stroke_params), path(m_star), true,
+                               PainterEnums::flat_caps, PainterEnums::rounded_joins, true);
+          painter->restore();
+
+          painter->restore();
+          painter->restore();
+          painter->restore();
+        }
+    }
+}
+
+void
+create_benchmark_scenes(const SceneParams &params,
+                        std::vector<BenchmarkScene*> &out_scenes)
+{
+  out_scenes.push_back(FASTUIDRAWnew TextPagesScene(params));
+  out_scenes.push_back(FASTUIDRAWnew CellsGridScene(params));
+  out_scenes.push_back(FASTUIDRAWnew DashedStrokesScene(params));
+  out_scenes.push_back(FASTUIDRAWnew ClipStackScene(params));
+}
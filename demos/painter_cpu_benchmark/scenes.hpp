@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fastuidraw/path.hpp>
+#include <fastuidraw/painter/painter.hpp>
+#include <fastuidraw/text/glyph_selector.hpp>
+#include <fastuidraw/text/font.hpp>
+#include <fastuidraw/util/util.hpp>
+
+using namespace fastuidraw;
+
+/* Parameters shared by all scenes of the benchmark.
+ */
+class SceneParams
+{
+public:
+  SceneParams(void):
+    m_resolution(1024.0f, 768.0f),
+    m_pixel_size(12.0f),
+    m_long_lived_values(nullptr)
+  {}
+
+  vec2 m_resolution;
+  reference_counted_ptr<const FontBase> m_font;
+  reference_counted_ptr<GlyphSelector> m_glyph_selector;
+  GlyphRender m_text_render;
+  float m_pixel_size;
+
+  /* if non-nullptr, the static brushes of the scenes are
+     long lived PainterPackedValue objects from this pool.
+   */
+  PainterPackedValuePool *m_long_lived_values;
+};
+
+/* A BenchmarkScene is a fixed scene whose content depends
+   only on the frame number; all of its paths are created
+   in the ctor so that the benchmark can time the creation
+   of the FilledPath and StrokedPath objects of them and
+   the selection of FilledPath::Subset objects on its own.
+ */
+class BenchmarkScene:noncopyable
+{
+public:
+  /* A fill of (or clip against) a path added with
+     add_path(), together with the transformation
+     from the path's coordinates to clip coordinates
+     that the Painter had.
+   */
+  class FillInstance
+  {
+  public:
+    unsigned int m_path;
+    float3x3 m_clip_matrix_local;
+  };
+
+  BenchmarkScene(const std::string &name, const SceneParams &params);
+
+  virtual
+  ~BenchmarkScene()
+  {}
+
+  const std::string&
+  name(void) const
+  {
+    return m_name;
+  }
+
+  const std::vector<Path>&
+  paths(void) const
+  {
+    return m_paths;
+  }
+
+  /* Returns the fills and clips of the last call to paint(). */
+  const std::vector<FillInstance>&
+  fill_instances(void) const
+  {
+    return m_fill_instances;
+  }
+
+  /* Issue the draws of the scene for a frame; the caller
+     is responsible for calling Painter::begin() and
+     Painter::end().
+   */
+  void
+  paint(Painter *painter, unsigned int frame);
+
+protected:
+  virtual
+  void
+  paint_scene(Painter *painter, unsigned int frame) = 0;
+
+  unsigned int
+  add_path(const Path &path);
+
+  void
+  fill_path(Painter *painter, const PainterData &draw, unsigned int path,
+            enum PainterEnums::fill_rule_t fill_rule);
+
+  void
+  clip_in_path(Painter *painter, unsigned int path,
+               enum PainterEnums::fill_rule_t fill_rule);
+
+  void
+  clip_out_path(Painter *painter, unsigned int path,
+                enum PainterEnums::fill_rule_t fill_rule);
+
+  /* Create the glyphs and attribute data of text laid out
+     by create_formatted_text(), with the glyphs written
+     to out_glyphs if it is non-nullptr.
+   */
+  void
+  create_text(const std::string &text, PainterAttributeData &out_data,
+              std::vector<Glyph> *out_glyphs = nullptr,
+              std::vector<vec2> *out_positions = nullptr);
+
+  /* Returns a packed long lived value of a brush if
+     SceneParams::m_long_lived_values is non-nullptr,
+     otherwise returns brush itself.
+   */
+  PainterData::value<PainterBrush>
+  brush_value(const PainterBrush *brush);
+
+  const Path&
+  path(unsigned int I) const
+  {
+    return m_paths[I];
+  }
+
+  const SceneParams&
+  params(void) const
+  {
+    return m_params;
+  }
+
+private:
+  void
+  record_fill(Painter *painter, unsigned int path);
+
+  std::string m_name;
+  SceneParams m_params;
+  std::vector<Path> m_paths;
+  std::vector<FillInstance> m_fill_instances;
+};
+
+/* Create the fixed scenes of the benchmark: text pages,
+   a grid of cells as in painter_cells, dashed strokes and
+   stacks of clip-paths. The caller owns the returned
+   objects and must delete them with FASTUIDRAWdelete.
+ */
+void
+create_benchmark_scenes(const SceneParams &params,
+                        std::vector<BenchmarkScene*> &out_scenes);
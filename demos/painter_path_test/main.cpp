@@ -185,6 +185,8 @@ private:
   color_stop_arguments m_color_stop_args;
   command_line_argument_value<std::string> m_image_file;
   command_line_argument_value<unsigned int> m_image_slack;
+  enumerated_command_line_argument_value<enum Image::mipmap_filter_t> m_image_mipmaps;
+  command_line_argument_value<unsigned int> m_image_deferred_mipmap_levels;
   command_line_argument_value<int> m_sub_image_x, m_sub_image_y;
   command_line_argument_value<int> m_sub_image_w, m_sub_image_h;
   command_line_argument_value<std::string> m_font_file;
@@ -301,6 +303,16 @@ painter_stroke_test(void):
   m_color_stop_args(*this),
   m_image_file("", "image", "if a valid file name, apply an image to drawing the fill", *this),
   m_image_slack(0, "image_slack", "amount of slack on tiles when loading image", *this),
+  m_image_mipmaps(Image::no_mipmaps,
+                  enumerated_string_type<enum Image::mipmap_filter_t>()
+                  .add_entry("none", Image::no_mipmaps, "image has no mipmaps")
+                  .add_entry("box", Image::box_mipmap_filter, "mipmaps made with a box filter")
+                  .add_entry("lanczos", Image::lanczos_mipmap_filter, "mipmaps made with a Lanczos filter"),
+                  "image_mipmaps",
+                  "Specifies if and how to make the mipmaps of the image", *this),
+  m_image_deferred_mipmap_levels(0, "image_deferred_mipmap_levels",
+                                 "number of the finest mipmap levels of the image to upload "
+                                 "one per frame instead of at load", *this),
   m_sub_image_x(0, "sub_image_x",
                 "x-coordinate of top left corner of sub-image rectange (negative value means no-subimage)",
                 *this),
@@ -1174,6 +1186,11 @@ draw_frame(void)
 
   enable_wire_frame(m_wire_frame);
 
+  if(m_image)
+    {
+      m_image->refine();
+    }
+
   m_painter->curveFlatness(m_curve_flatness);
   m_painter->begin();
 
@@ -1539,6 +1556,8 @@ draw_frame(void)
            << m_painter->query_stat(PainterPacker::num_attributes)
            << "\nIndices: "
            << m_painter->query_stat(PainterPacker::num_indices)
+           << "\nCulled fill indices: "
+           << m_painter->query_stat(PainterPacker::num_culled_fill_indices)
            << "\nGenericData: "
            << m_painter->query_stat(PainterPacker::num_generic_datas)
            << "\nMouse position:"
@@ -1614,7 +1633,9 @@ derived_init(int w, int h)
       if(image_size.x() > 0 && image_size.y() > 0)
         {
           m_image = Image::create(m_painter->image_atlas(), image_size.x(), image_size.y(),
-                                  cast_c_array(image_data), m_image_slack.m_value);
+                                  cast_c_array(image_data), m_image_slack.m_value,
+                                  m_image_mipmaps.m_value.m_value,
+                                  m_image_deferred_mipmap_levels.m_value);
         }
     }
 
@@ -664,6 +664,103 @@ private:
   void *m_d;
 };
 
+/*!
+  A ProgramBinaryCache stores the GL program binaries (as returned
+  by glGetProgramBinary) of linked Program objects to files in a
+  directory so that a later process can skip compiling and linking
+  the GLSL source code of a Program. An entry is identified by a
+  key string; a Program using a ProgramBinaryCache computes its key
+  from a hash of the source code of its shaders, a caller supplied
+  string and the GL vendor, renderer and version strings. Should an
+  entry be present but unusable (for example the driver no longer
+  accepts the binary format), the entry is rejected and the Program
+  falls back to compiling and linking from source, replacing the
+  entry afterwards. The methods load_program_binary() and
+  save_program_binary() must be called with a GL context current.
+ */
+class ProgramBinaryCache:
+  public reference_counted<ProgramBinaryCache>::default_base
+{
+public:
+  /*!
+    Ctor.
+    \param directory directory in which to store and from which
+                     to fetch program binaries. The directory is
+                     not created by the ProgramBinaryCache, it
+                     must already exist.
+   */
+  explicit
+  ProgramBinaryCache(const char *directory);
+
+  ~ProgramBinaryCache();
+
+  /*!
+    Returns the directory passed in the ctor.
+   */
+  const char*
+  directory(void) const;
+
+  /*!
+    Returns true if the current GL context supports program
+    binaries, i.e. the GL context is atleast OpenGL 4.1 or
+    supports GL_ARB_get_program_binary, or is atleast OpenGL ES
+    3.0, and the GL implementation supports atleast one program
+    binary format.
+   */
+  static
+  bool
+  program_binary_supported(void);
+
+  /*!
+    Attempt to load the program binary of an entry into a GL program.
+    Returns true if the entry exists and the GL program successfully
+    linked from the binary (a hit). Otherwise returns false (a miss);
+    if the entry existed but the GL implementation did not accept it,
+    the entry is also counted in number_rejected().
+    \param key key of entry
+    \param program GL name of program into which to load the binary
+   */
+  bool
+  load_program_binary(const char *key, GLuint program);
+
+  /*!
+    Save the program binary of a linked GL program to an entry,
+    replacing the entry if it already exists. Returns true on
+    success. The GL program should have been linked with
+    GL_PROGRAM_BINARY_RETRIEVABLE_HINT set to GL_TRUE.
+    \param key key of entry
+    \param program GL name of program from which to fetch the binary
+   */
+  bool
+  save_program_binary(const char *key, GLuint program);
+
+  /*!
+    Returns the number of times load_program_binary()
+    returned true.
+   */
+  unsigned int
+  number_hits(void) const;
+
+  /*!
+    Returns the number of times load_program_binary()
+    returned false.
+   */
+  unsigned int
+  number_misses(void) const;
+
+  /*!
+    Returns the number of times load_program_binary() found
+    an entry that could not be used, for example because its
+    binary format is not supported by the GL implementation.
+    Rejected entries are also counted in number_misses().
+   */
+  unsigned int
+  number_rejected(void) const;
+
+private:
+  void *m_d;
+};
+
 /*!
   Class for creating and using GLSL programs.
   A Program delays the GL commands to
@@ -1137,10 +1234,18 @@ public:
     \param action specifies actions to perform before linking of the Program
     \param initers one-time initialization actions to perform at GLSL
                    program creation
+    \param binary_cache if non-null, ProgramBinaryCache from which to
+                        fetch and to which to save the program binary
+    \param binary_cache_key additional string to add to the key used
+                            for binary_cache, for example to encode
+                            state that affects the program but is
+                            not visible in the shader source code
    */
   Program(const_c_array<reference_counted_ptr<Shader> > pshaders,
           const PreLinkActionArray &action = PreLinkActionArray(),
-          const ProgramInitializerArray &initers = ProgramInitializerArray());
+          const ProgramInitializerArray &initers = ProgramInitializerArray(),
+          const reference_counted_ptr<ProgramBinaryCache> &binary_cache = reference_counted_ptr<ProgramBinaryCache>(),
+          const char *binary_cache_key = "");
 
   /*!
     Ctor.
@@ -1150,11 +1255,19 @@ public:
                   after linking of the Program.
     \param initers one-time initialization actions to perform at GLSL
                    program creation
+    \param binary_cache if non-null, ProgramBinaryCache from which to
+                        fetch and to which to save the program binary
+    \param binary_cache_key additional string to add to the key used
+                            for binary_cache, for example to encode
+                            state that affects the program but is
+                            not visible in the shader source code
    */
   Program(reference_counted_ptr<Shader> vert_shader,
           reference_counted_ptr<Shader> frag_shader,
           const PreLinkActionArray &action = PreLinkActionArray(),
-          const ProgramInitializerArray &initers = ProgramInitializerArray());
+          const ProgramInitializerArray &initers = ProgramInitializerArray(),
+          const reference_counted_ptr<ProgramBinaryCache> &binary_cache = reference_counted_ptr<ProgramBinaryCache>(),
+          const char *binary_cache_key = "");
 
   /*!
     Ctor.
@@ -1164,11 +1277,19 @@ public:
                   after linking of the Program.
     \param initers one-time initialization actions to perform at GLSL
                    program creation
+    \param binary_cache if non-null, ProgramBinaryCache from which to
+                        fetch and to which to save the program binary
+    \param binary_cache_key additional string to add to the key used
+                            for binary_cache, for example to encode
+                            state that affects the program but is
+                            not visible in the shader source code
    */
   Program(const glsl::ShaderSource &vert_shader,
           const glsl::ShaderSource &frag_shader,
           const PreLinkActionArray &action = PreLinkActionArray(),
-          const ProgramInitializerArray &initers = ProgramInitializerArray());
+          const ProgramInitializerArray &initers = ProgramInitializerArray(),
+          const reference_counted_ptr<ProgramBinaryCache> &binary_cache = reference_counted_ptr<ProgramBinaryCache>(),
+          const char *binary_cache_key = "");
 
 
   ~Program(void);
@@ -1210,6 +1331,15 @@ public:
   float
   program_build_time(void);
 
+  /*!
+    Returns true if the GL program was created from a
+    program binary fetched from the ProgramBinaryCache
+    passed in the ctor instead of from compiling and
+    linking the shader source code.
+   */
+  bool
+  program_binary_cache_hit(void);
+
   /*!
     Returns true if and only if this Program
     successfully linked. This function should
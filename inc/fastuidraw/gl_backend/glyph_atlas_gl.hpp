@@ -115,6 +115,20 @@ namespace gl
       params&
       delayed(bool v);
 
+      /*!
+        How the GlyphAtlas places regions within the layers
+        of the texel store, see GlyphAtlas::texel_allocator_t.
+        Initial value is GlyphAtlas::tree_texel_allocator.
+       */
+      enum GlyphAtlas::texel_allocator_t
+      texel_allocator(void) const;
+
+      /*!
+        Set the value for texel_allocator(void) const
+       */
+      params&
+      texel_allocator(enum GlyphAtlas::texel_allocator_t v);
+
       /*!
         Returns what kind of GL object is used to back
         the glyph geometry data. Default value is
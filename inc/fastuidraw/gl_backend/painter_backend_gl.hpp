@@ -68,6 +68,66 @@ namespace fastuidraw
           number_program_types
         };
 
+      /*!
+        Enumeration to query the statistics of how the buffers
+        backing PainterDraw objects are streamed to GL, see
+        query_stat().
+       */
+      enum stats_t
+        {
+          /*!
+            Number of times a buffer was mapped with glMapBufferRange.
+            When ConfigurationGL::use_persistent_mapped_buffers() is
+            true, buffers are mapped only once, at creation.
+           */
+          num_buffer_maps,
+
+          /*!
+            Time in microseconds spent mapping, flushing and
+            unmapping buffers.
+           */
+          buffer_map_time_us,
+
+          /*!
+            Number of times reusing a pool of buffers had to wait
+            on the GPU to finish reading it. Only incremented when
+            ConfigurationGL::use_persistent_mapped_buffers() is true.
+           */
+          num_fence_waits,
+
+          /*!
+            Time in microseconds spent waiting on the GPU to
+            finish reading a pool of buffers.
+           */
+          fence_wait_time_us,
+
+          /*!
+            Number of GL draw calls issued, i.e. each call to
+            glMultiDrawElementsIndirect, glMultiDrawElements,
+            glDrawElements or glDrawElementsBaseVertex counts
+            as one.
+           */
+          num_draw_calls,
+
+          /*!
+            Number of entries (index ranges) drawn by the
+            draw calls counted by \ref num_draw_calls.
+           */
+          num_draw_call_entries,
+
+          /*!
+            Number of GL calls issued to change state (binding
+            of buffers, textures and VAO's, program changes,
+            blend state) when drawing.
+           */
+          num_state_calls,
+
+          /*!
+            Number of stats.
+           */
+          num_stats
+        };
+
       /*!
         A ConfigurationGL gives parameters how to contruct
         a PainterBackendGL.
@@ -271,6 +331,134 @@ namespace fastuidraw
         ConfigurationGL&
         number_pools(unsigned int v);
 
+        /*!
+          If true, the buffers backing PainterDraw objects are
+          created with immutable storage (GL_ARB_buffer_storage
+          or GL_EXT_buffer_storage) and mapped persistently and
+          coherently once, so that PainterDraw data is written
+          directly to GPU visible memory without mapping and
+          unmapping per PainterDraw. Each of the number_pools()
+          pools of buffers is guarded by a fence sync, which is
+          waited on before the pool is reused. If the GL context
+          does not support buffer storage, the value is ignored.
+         */
+        bool
+        use_persistent_mapped_buffers(void) const;
+
+        /*!
+          Set the value for use_persistent_mapped_buffers(void) const.
+          Default value is false.
+        */
+        ConfigurationGL&
+        use_persistent_mapped_buffers(bool v);
+
+        /*!
+          The number of attributes the PainterRetainedGeometryStore
+          of the PainterBackendGL holds, see
+          PainterBackend::retained_geometry_store(). The store
+          is backed by a buffer object that is drawn from with
+          glDrawElementsBaseVertex. A value of 0, or a GL context
+          that does not support glDrawElementsBaseVertex (GL 3.2,
+          GL_ARB_draw_elements_base_vertex or GLES 3.2), indicates
+          that the PainterBackendGL does not have a
+          PainterRetainedGeometryStore.
+         */
+        unsigned int
+        retained_geometry_attributes(void) const;
+
+        /*!
+          Set the value for retained_geometry_attributes(void) const.
+          Default value is 0.
+        */
+        ConfigurationGL&
+        retained_geometry_attributes(unsigned int v);
+
+        /*!
+          The number of indices the PainterRetainedGeometryStore
+          of the PainterBackendGL holds, only has effect if
+          retained_geometry_attributes() is non-zero.
+         */
+        unsigned int
+        retained_geometry_indices(void) const;
+
+        /*!
+          Set the value for retained_geometry_indices(void) const.
+          Default value is 0.
+        */
+        ConfigurationGL&
+        retained_geometry_indices(unsigned int v);
+
+        /*!
+          The number of blocks (see
+          PainterBackend::ConfigurationBase::alignment()) the
+          PainterPersistentDataStore of the PainterBackendGL holds,
+          see PainterBackend::persistent_data_store(). The store is
+          backed by a buffer object bound as a texture buffer next
+          to the data store buffer of each PainterDraw. A value of
+          0, or a data_store_backing() that is not \ref data_store_tbo,
+          indicates that the PainterBackendGL does not have a
+          PainterPersistentDataStore.
+         */
+        unsigned int
+        persistent_data_store_blocks(void) const;
+
+        /*!
+          Set the value for persistent_data_store_blocks(void) const.
+          Default value is 0.
+        */
+        ConfigurationGL&
+        persistent_data_store_blocks(unsigned int v);
+
+        /*!
+          If true, the header location of the vertices is not
+          streamed as a per-vertex attribute; instead the header
+          attribute is sourced from a static buffer holding 0, 1,
+          2, ... with an attribute divisor of 1 and each range of
+          indices of a header is an entry of a
+          glMultiDrawElementsIndirect call whose base instance is
+          the location of the header. This removes the upload of
+          PainterDraw::m_header_attributes at the cost of an
+          indirect draw entry per header. Requires GL 4.3, or
+          GL_ARB_multi_draw_indirect and GL_ARB_base_instance, or
+          GLES 3.1 with GL_EXT_multi_draw_indirect and
+          GL_EXT_base_instance; if the GL context does not support
+          them, the value is ignored. Setting it to true implies
+          use_multi_draw_indirect().
+         */
+        bool
+        header_via_base_instance(void) const;
+
+        /*!
+          Set the value for header_via_base_instance(void) const.
+          Default value is false.
+        */
+        ConfigurationGL&
+        header_via_base_instance(bool v);
+
+        /*!
+          If true, the index ranges of each PainterDraw are written
+          as DrawElementsIndirectCommand records into a buffer
+          object streamed together with the other buffers of the
+          PainterDraw and each run of index ranges that share the
+          same program and blend state is drawn with a single
+          glMultiDrawElementsIndirect call. Contiguous index ranges
+          whose only difference is handled by the uber-shader
+          (item, blend or brush shader changes) are merged into
+          one record unless break_on_shader_change() is true.
+          Requires GL 4.3, or GL_ARB_multi_draw_indirect, or GLES
+          3.1 with GL_EXT_multi_draw_indirect; if the GL context
+          does not support them, the value is ignored.
+         */
+        bool
+        use_multi_draw_indirect(void) const;
+
+        /*!
+          Set the value for use_multi_draw_indirect(void) const.
+          Default value is false.
+        */
+        ConfigurationGL&
+        use_multi_draw_indirect(bool v);
+
         /*!
           If true, place different item shaders in seperate
           entries of a glMultiDrawElements call.
@@ -374,6 +562,24 @@ namespace fastuidraw
         ConfigurationGL&
         separate_program_for_discard(bool v);
 
+        /*!
+          If non-null, the GLSL programs of the PainterBackendGL
+          are first fetched from the ProgramBinaryCache and, when
+          not present there, compiled from source and then saved
+          to it. The key of each program includes a hash of the
+          GLSL source code, the IDs of the registered shaders
+          and the GL vendor, renderer and version strings.
+         */
+        const reference_counted_ptr<ProgramBinaryCache>&
+        program_binary_cache(void) const;
+
+        /*!
+          Set the value for program_binary_cache(void) const.
+          Default value is nullptr.
+        */
+        ConfigurationGL&
+        program_binary_cache(const reference_counted_ptr<ProgramBinaryCache> &v);
+
         /*!
           If framebuffer fetch is available, this value is ignored.
           When framebuffer fetch is not availabe, for non-dashed
@@ -471,6 +677,15 @@ namespace fastuidraw
       const ConfigurationGL&
       configuration_gl(void) const;
 
+      /*!
+        Returns a stat on how the buffers backing PainterDraw
+        objects are streamed to GL. The values are cumulative
+        over the lifetime of the PainterBackendGL.
+        \param st stat to query
+       */
+      uint64_t
+      query_stat(enum stats_t st) const;
+
     protected:
 
       virtual
@@ -138,7 +138,9 @@ namespace fastuidraw
           uint_attrib_slot,
 
           /*!
-            Slot for the values of PainterDraw::m_header_attributes
+            Slot for the values of PainterDraw::m_header_attributes,
+            or equivalently the location of the header of the
+            vertex when PainterDraw::m_header_attributes is empty
            */
           header_attrib_slot,
         };
@@ -406,6 +408,22 @@ namespace fastuidraw
         BindingPoints&
         data_store_buffer_ubo(unsigned int);
 
+        /*!
+          Specifies the buffer binding point of the buffer of
+          the PainterPersistentDataStore of the PainterBackend
+          as a samplerBuffer. Only active if
+          UberShaderParams::use_persistent_data_store() is true.
+         */
+        unsigned int
+        persistent_data_store_buffer_tbo(void) const;
+
+        /*!
+          Set the value returned by persistent_data_store_buffer_tbo(void) const.
+          Default value is 8.
+         */
+        BindingPoints&
+        persistent_data_store_buffer_tbo(unsigned int);
+
       private:
         void *m_d;
       };
@@ -620,6 +638,25 @@ namespace fastuidraw
         UberShaderParams&
         data_blocks_per_store_buffer(int);
 
+        /*!
+          If true, the data at locations for which
+          PainterPersistentDataStore::is_persistent_location()
+          is true is fetched from the buffer of the
+          PainterPersistentDataStore of the PainterBackend
+          (bound as a samplerBuffer at
+          BindingPoints::persistent_data_store_buffer_tbo())
+          instead of from PainterDraw::m_store.
+         */
+        bool
+        use_persistent_data_store(void) const;
+
+        /*!
+          Set the value returned by use_persistent_data_store(void) const.
+          Default value is false.
+         */
+        UberShaderParams&
+        use_persistent_data_store(bool);
+
         /*!
           Specifies how the glyph geometry data (GlyphAtlas::geometry_store())
           is accessed from the uber-shaders.
@@ -816,6 +853,24 @@ namespace fastuidraw
       uint32_t
       ubo_size(void);
 
+      /*!
+        Returns the ID that will be assigned to the next
+        PainterItemShader registered, i.e. one more than
+        the largest ID assigned to a registered item shader
+        or sub-shader.
+       */
+      uint32_t
+      next_item_shader_ID(void) const;
+
+      /*!
+        Returns the ID that will be assigned to the next
+        PainterBlendShader registered, i.e. one more than
+        the largest ID assigned to a registered blend shader
+        or sub-shader.
+       */
+      uint32_t
+      next_blend_shader_ID(void) const;
+
       //////////////////////////////////////////////////////////////
       // virtual methods from PainterBackend, do NOT reimplement(!)
       virtual
@@ -429,11 +429,43 @@ class Image;
   /*!
     An Image represents an image comprising of RGBA8 values.
     The texel values themselves are stored in a ImageAtlas.
+    An Image can also hold a mipmap chain, each mipmap level
+    stored in its own tiles of the ImageAtlas. The finer
+    mipmap levels can be left off the ImageAtlas when the
+    Image is created and uploaded later with refine();
+    the values of number_index_lookups(), master_index_tile(),
+    master_index_tile_dims() and dimensions_index_divisor()
+    are those of the mipmap level finest_resident_mipmap_level().
    */
   class Image:
     public reference_counted<Image>::default_base
   {
   public:
+    /*!
+      Enumeration specifying if and how the mipmap
+      levels of an Image are made.
+     */
+    enum mipmap_filter_t
+      {
+        /*!
+          The Image has only the one level.
+         */
+        no_mipmaps,
+
+        /*!
+          Each pixel of a mipmap level is the average
+          of 2x2 pixels of the next finer level.
+         */
+        box_mipmap_filter,
+
+        /*!
+          Each mipmap level is made from the next finer
+          level with a Lanczos filter (a = 3); sharper
+          than \ref box_mipmap_filter but slower to make.
+         */
+        lanczos_mipmap_filter,
+      };
+
     /*!
       Construct an image. If there is insufficient room on the atlas,
       returns a nullptr handle.
@@ -450,6 +482,29 @@ class Image;
     create(reference_counted_ptr<ImageAtlas> atlas, int w, int h,
            const_c_array<u8vec4> image_data, unsigned int pslack);
 
+    /*!
+      Construct an image with a mipmap chain, made on the CPU from
+      image_data, that goes down to a single pixel. If there is
+      insufficient room on the atlas, returns a nullptr handle.
+      \param atlas ImageAtlas atlas onto which to place the image
+      \param w width of the image
+      \param h height of the image
+      \param image_data image data to which to initialize the image
+      \param pslack number of pixels allowed to sample outside of color tile
+                    for each mipmap level of the image
+      \param filter filter with which to make the mipmap levels
+      \param number_deferred_levels number of the finest mipmap levels
+                                    to not upload to the atlas until
+                                    refine() is called; the coarsest
+                                    level is always uploaded.
+     */
+    static
+    reference_counted_ptr<Image>
+    create(reference_counted_ptr<ImageAtlas> atlas, int w, int h,
+           const_c_array<u8vec4> image_data, unsigned int pslack,
+           enum mipmap_filter_t filter,
+           unsigned int number_deferred_levels = 0);
+
     ~Image();
 
     /*!
@@ -502,9 +557,63 @@ class Image;
     const reference_counted_ptr<ImageAtlas>&
     atlas(void) const;
 
+    /*!
+      Returns the number of mipmap levels of the
+      Image, a value of 1 indicates that the Image
+      has no mipmaps. Level 0 is the Image itself.
+     */
+    unsigned int
+    number_mipmap_levels(void) const;
+
+    /*!
+      Returns the finest mipmap level that is
+      on the atlas; the levels coarser than it
+      are on the atlas as well.
+     */
+    unsigned int
+    finest_resident_mipmap_level(void) const;
+
+    /*!
+      Returns the dimensions of a mipmap level.
+      \param L mipmap level with L < number_mipmap_levels()
+     */
+    ivec2
+    mipmap_dimensions(unsigned int L) const;
+
+    /*!
+      Returns the "head" index tile of a mipmap level,
+      see master_index_tile().
+      \param L mipmap level with finest_resident_mipmap_level()
+               <= L < number_mipmap_levels()
+     */
+    ivec3
+    mipmap_master_index_tile(unsigned int L) const;
+
+    /*!
+      Returns the number of index look-ups to get
+      to the image data of a mipmap level, see
+      number_index_lookups().
+      \param L mipmap level with finest_resident_mipmap_level()
+               <= L < number_mipmap_levels()
+     */
+    unsigned int
+    mipmap_number_index_lookups(unsigned int L) const;
+
+    /*!
+      Upload to the atlas the mipmap level just finer than
+      finest_resident_mipmap_level(), resizing the atlas if
+      there is not enough room and it is resizeable. Returns
+      false if all mipmap levels are already on the atlas
+      or if there is not enough room on the atlas. Brushes
+      packed after refine() returns use the new level.
+     */
+    bool
+    refine(void);
+
   private:
     Image(reference_counted_ptr<ImageAtlas> atlas, int w, int h,
-          const_c_array<u8vec4> image_data, unsigned int pslack);
+          const_c_array<u8vec4> image_data, unsigned int pslack,
+          enum mipmap_filter_t filter, unsigned int number_deferred_levels);
 
     void *m_d;
   };
@@ -20,10 +20,12 @@
 #pragma once
 
 #include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <fastuidraw/util/util.hpp>
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
 #include <fastuidraw/util/matrix.hpp>
 #include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/task_pool.hpp>
 #include <fastuidraw/painter/painter_enums.hpp>
 #include <fastuidraw/painter/fill_rule.hpp>
 #include <fastuidraw/painter/packing/painter_packer.hpp>
@@ -46,7 +48,7 @@ class Path;
   the fill rule.
  */
 class FilledPath:
-    public reference_counted<FilledPath>::non_concurrent
+    public reference_counted<FilledPath>::default_base
 {
 public:
   /*!
@@ -109,6 +111,32 @@ public:
     const_c_array<int>
     winding_neighbors(int w) const;
 
+    /*!
+      Returns the number of cells of the Subset. The triangles
+      of each winding number of a Subset are sorted by a grid
+      of cells over the Subset so that a caller can draw only
+      those triangles in cells that intersect a clipping region,
+      see FilledPath::select_cells(). A Subset that is made from
+      other Subset objects has no cells.
+     */
+    unsigned int
+    number_cells(void) const;
+
+    /*!
+      Returns the range into the index chunk of a winding
+      number, i.e. the array returned by the method
+      PainterAttributeData::index_data_chunk() passed the
+      value chunk_from_winding_number(w) called on
+      painter_data(), of the triangles with that winding
+      number that are in a named cell. For a fixed
+      winding number, the ranges of cell C and cell C + 1
+      are adjacent.
+      \param w winding number
+      \param C which cell, must be less than number_cells()
+     */
+    range_type<unsigned int>
+    cell_range(int w, unsigned int C) const;
+
     /*!
       Returns what chunk to pass PainterAttributeData::index_chunks()
       called on the PainterAttributeData returned by painter_data()
@@ -210,6 +238,89 @@ public:
                  unsigned int max_attribute_cnt,
                  unsigned int max_index_cnt,
                  c_array<unsigned int> dst) const;
+
+  /*!
+    Fetch those Subset objects that have triangles that
+    intersect a region specified by clip equations, without
+    blocking on triangulation. Those Subset objects that are
+    needed but whose triangulation is not yet ready are not
+    written to dst; instead their triangulation is handed to
+    a TaskPool and, where possible, already triangulated
+    descendants of them are written to dst in their place.
+    The Subset values written to dst are ready, i.e. calling
+    subset() on them does not block. The triangulation of a
+    Subset is handed to a TaskPool at most once.
+    \param scratch_space scratch space for computations.
+    \param clip_equations array of clip equations
+    \param clip_matrix_local 3x3 transformation from local (x, y, 1)
+                             coordinates to clip coordinates.
+    \param max_attribute_cnt only allow those SubSet objects for which
+                             Subset::painter_data() have no more than
+                             max_attribute_cnt attributes.
+    \param max_index_cnt only allow those SubSet objects for which
+                         Subset::painter_data() have no more than
+                         max_index_cnt attributes.
+    \param task_pool TaskPool to which to hand triangulation jobs
+    \param[out] dst location to which to write the what SubSets
+    \param[out] out_number_deferred if non-nullptr, location to which
+                                    to write the number of needed Subset
+                                    objects whose triangulation was not
+                                    ready; a value of 0 indicates that
+                                    dst holds the same selection as the
+                                    blocking overload of select_subsets()
+                                    would give.
+    \returns the number of chunks written to dst, that number is
+             guarnanteed to be no more than number_subsets().
+   */
+  unsigned int
+  select_subsets(ScratchSpace &scratch_space,
+                 const_c_array<vec3> clip_equations,
+                 const float3x3 &clip_matrix_local,
+                 unsigned int max_attribute_cnt,
+                 unsigned int max_index_cnt,
+                 TaskPool &task_pool,
+                 c_array<unsigned int> dst,
+                 unsigned int *out_number_deferred = nullptr) const;
+
+  /*!
+    Fetch those cells of a Subset, see Subset::number_cells(),
+    whose triangles intersect a region specified by clip
+    equations. Use this on a Subset returned by select_subsets()
+    to skip those triangles of the Subset that are outside of
+    the region.
+    \param scratch_space scratch space for computations.
+    \param clip_equations array of clip equations
+    \param clip_matrix_local 3x3 transformation from local (x, y, 1)
+                             coordinates to clip coordinates.
+    \param I which Subset, as returned by select_subsets()
+    \param[out] dst location to which to write what cells, must
+                    be atleast Subset::number_cells() in size
+    \returns the number of cells written to dst; if the value is
+             the same as Subset::number_cells(), then no triangles
+             of the Subset are skipped
+   */
+  unsigned int
+  select_cells(ScratchSpace &scratch_space,
+               const_c_array<vec3> clip_equations,
+               const float3x3 &clip_matrix_local,
+               unsigned int I,
+               c_array<unsigned int> dst) const;
+
+  /*!
+    Returns the number of Subset objects whose triangulation
+    was handed to a TaskPool by select_subsets() and has not
+    yet completed.
+   */
+  unsigned int
+  number_deferred_subsets(void) const;
+
+  /*!
+    Blocks until all triangulation handed to a TaskPool by
+    select_subsets() has completed.
+   */
+  void
+  wait_deferred_subsets(void) const;
+
 private:
   void *m_d;
 };
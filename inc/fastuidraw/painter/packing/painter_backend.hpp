@@ -24,6 +24,8 @@
 #include <fastuidraw/image.hpp>
 #include <fastuidraw/colorstop_atlas.hpp>
 #include <fastuidraw/painter/packing/painter_draw.hpp>
+#include <fastuidraw/painter/packing/painter_retained_geometry_store.hpp>
+#include <fastuidraw/painter/packing/painter_persistent_data_store.hpp>
 #include <fastuidraw/painter/painter_shader.hpp>
 #include <fastuidraw/painter/painter_shader_set.hpp>
 
@@ -34,6 +36,8 @@ namespace fastuidraw
   @{
  */
 
+  class Glyph;
+
   /*!
     A PainterBackend is an interface that defines the API-specific
     elements to implement Painter:
@@ -215,6 +219,27 @@ namespace fastuidraw
     const ConfigurationBase&
     configuration_base(void) const;
 
+    /*!
+      Returns the PainterRetainedGeometryStore of this
+      PainterBackend, or a nullptr handle if it does not
+      support drawing retained geometry. If non-nullptr,
+      the PainterDraw objects returned by map_draw() must
+      implement PainterDraw::draw_retained().
+     */
+    const reference_counted_ptr<PainterRetainedGeometryStore>&
+    retained_geometry_store(void) const;
+
+    /*!
+      Returns the PainterPersistentDataStore of this
+      PainterBackend, or a nullptr handle if it does not
+      support a persistent data store. If non-nullptr, the
+      shaders of the backend must fetch the data at locations
+      for which PainterPersistentDataStore::is_persistent_location()
+      is true from the PainterPersistentDataStore.
+     */
+    const reference_counted_ptr<PainterPersistentDataStore>&
+    persistent_data_store(void) const;
+
     /*!
       Called just before calling PainterDraw::draw()
       on a sequence of PainterDraw objects who have
@@ -239,6 +264,23 @@ namespace fastuidraw
     reference_counted_ptr<const PainterDraw>
     map_draw(void) = 0;
 
+    /*!
+      Called by Painter when it draws data that refers to
+      glyphs, i.e. Painter::draw_glyphs() with the value of
+      PainterAttributeData::glyphs(), and when it splices a
+      PainterCommandList with the value of
+      PainterCommandList::glyphs(). A PainterBackend that keeps
+      the data drawn beyond the frame, such as PainterCommandList,
+      implements it to keep the glyphs valid (see Glyph::pin())
+      for as long as it keeps the data. Default implementation
+      does nothing.
+      \param glyphs glyphs drawn, the array is only valid for
+                    the duration of the call
+     */
+    virtual
+    void
+    glyphs_drawn(const_c_array<Glyph> glyphs);
+
     /*!
       Registers a vertex shader for use. Must not be called within a
       on_pre_draw()/on_post_draw() pair.
@@ -381,6 +423,35 @@ namespace fastuidraw
     PerformanceHints&
     set_hints(void);
 
+    /*!
+      To be called by a derived class in its ctor to set
+      the value returned by retained_geometry_store().
+      \param store PainterRetainedGeometryStore of the backend
+     */
+    void
+    set_retained_geometry_store(const reference_counted_ptr<PainterRetainedGeometryStore> &store);
+
+    /*!
+      To be called by a derived class in its ctor to set
+      the value returned by persistent_data_store().
+      \param store PainterPersistentDataStore of the backend
+     */
+    void
+    set_persistent_data_store(const reference_counted_ptr<PainterPersistentDataStore> &store);
+
+    /*!
+      To be called by a derived class in its ctor, before any
+      shader is registered to it, to make it use the shaders of
+      another PainterBackend: register_shader() then registers
+      shaders to that PainterBackend and the derived class's
+      absorb_item_shader(), absorb_blend_shader(),
+      compute_item_sub_shader_group() and
+      compute_blend_sub_shader_group() are never called.
+      \param backend PainterBackend whose shaders to use
+     */
+    void
+    share_shaders(const reference_counted_ptr<PainterBackend> &backend);
+
   private:
     void *m_d;
   };
@@ -0,0 +1,363 @@
+/*!
+ * \file painter_backend_null.hpp
+ * \brief file painter_backend_null.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/glsl/painter_backend_glsl.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterBackendNull is a PainterBackend that does not
+    draw anything and does not need a 3D API context. The
+    PainterDraw objects it returns from map_draw() are backed
+    by heap memory and its GlyphAtlas, ImageAtlas and
+    ColorStopAtlas are backed by stores in memory. It records
+    how much data is sent to it so that the CPU side of Painter,
+    PainterPacker, FilledPath, StrokedPath and GlyphCache can be
+    profiled and benchmarked without a GPU.
+
+    A PainterBackendNull derives from glsl::PainterBackendGLSL so
+    that its default shaders and the shader groups it assigns, and
+    thus the draw breaks PainterPacker issues, are the same as those
+    of gl::PainterBackendGL with ConfigurationGL::separate_program_for_discard()
+    false.
+   */
+  class PainterBackendNull:public glsl::PainterBackendGLSL
+  {
+  public:
+    /*!
+      Enumeration to query the statistics of the data sent
+      to a PainterBackendNull, see query_stat().
+     */
+    enum stats_t
+      {
+        /*!
+          Number of PainterDraw objects returned by map_draw().
+         */
+        num_draws,
+
+        /*!
+          Number of calls to PainterDraw::draw_break() on
+          the PainterDraw objects returned by map_draw().
+         */
+        num_draw_breaks,
+
+        /*!
+          Number of calls to PainterDraw::draw_break() where
+          the blend mode changed; for gl::PainterBackendGL,
+          these are the draw breaks that change GL state.
+         */
+        num_blend_mode_changes,
+
+        /*!
+          Number of attributes written.
+         */
+        num_attributes,
+
+        /*!
+          Number of indices written.
+         */
+        num_indices,
+
+        /*!
+          Number of bytes of attribute data written, which
+          includes the header attributes unless
+          ConfigurationNull::header_via_base_instance()
+          is true.
+         */
+        attribute_bytes,
+
+        /*!
+          Number of bytes of index data written.
+         */
+        index_bytes,
+
+        /*!
+          Number of bytes of data store data written.
+         */
+        data_store_bytes,
+
+        /*!
+          Number of bytes written to the backing stores of
+          the GlyphAtlas, ImageAtlas and ColorStopAtlas.
+         */
+        atlas_bytes,
+
+        /*!
+          Number of calls to PainterDraw::draw_retained()
+          on the PainterDraw objects returned by map_draw().
+         */
+        num_retained_draws,
+
+        /*!
+          Number of bytes of attribute and index data
+          written to the PainterRetainedGeometryStore, see
+          ConfigurationNull::retained_geometry_attributes().
+         */
+        retained_geometry_bytes,
+
+        /*!
+          Number of calls to PainterDraw::header_changed()
+          on the PainterDraw objects returned by map_draw(),
+          see ConfigurationNull::header_via_base_instance().
+         */
+        num_header_changes,
+
+        /*!
+          Number of bytes of data written to the
+          PainterPersistentDataStore, see
+          ConfigurationNull::persistent_data_store_blocks().
+         */
+        persistent_data_store_bytes,
+
+        /*!
+          Number of stats.
+         */
+        num_stats
+      };
+
+    /*!
+      A ConfigurationNull gives parameters how to contruct
+      a PainterBackendNull.
+     */
+    class ConfigurationNull
+    {
+    public:
+      /*!
+        Ctor.
+       */
+      ConfigurationNull(void);
+
+      /*!
+        Copy ctor.
+        \param obj value from which to copy
+       */
+      ConfigurationNull(const ConfigurationNull &obj);
+
+      ~ConfigurationNull();
+
+      /*!
+        Assignment operator
+        \param rhs value from which to copy
+       */
+      ConfigurationNull&
+      operator=(const ConfigurationNull &rhs);
+
+      /*!
+        The number of attributes each PainterDraw
+        returned by map_draw() holds, default value
+        is 512 * 512.
+       */
+      unsigned int
+      attributes_per_buffer(void) const;
+
+      /*!
+        Set the value for attributes_per_buffer(void) const
+       */
+      ConfigurationNull&
+      attributes_per_buffer(unsigned int v);
+
+      /*!
+        The number of indices each PainterDraw returned
+        by map_draw() holds, default value is
+        (512 * 512 * 6) / 4.
+       */
+      unsigned int
+      indices_per_buffer(void) const;
+
+      /*!
+        Set the value for indices_per_buffer(void) const
+       */
+      ConfigurationNull&
+      indices_per_buffer(unsigned int v);
+
+      /*!
+        The size of the data store of each PainterDraw
+        returned by map_draw() in units of blocks, where
+        a block is ConfigurationBase::alignment() generic_data
+        values, default value is 1024 * 64.
+       */
+      unsigned int
+      data_blocks_per_store_buffer(void) const;
+
+      /*!
+        Set the value for data_blocks_per_store_buffer(void) const
+       */
+      ConfigurationNull&
+      data_blocks_per_store_buffer(unsigned int v);
+
+      /*!
+        If true, each item and blend shader gets its own
+        shader group, which forces a draw break on each
+        shader change, see ConfigurationGL::break_on_shader_change().
+        Default value is false.
+       */
+      bool
+      break_on_shader_change(void) const;
+
+      /*!
+        Set the value for break_on_shader_change(void) const
+       */
+      ConfigurationNull&
+      break_on_shader_change(bool v);
+
+      /*!
+        The number of attributes the PainterRetainedGeometryStore
+        of the PainterBackendNull holds, see
+        PainterBackend::retained_geometry_store(). A value of 0
+        indicates that the PainterBackendNull does not have a
+        PainterRetainedGeometryStore. Default value is 0.
+       */
+      unsigned int
+      retained_geometry_attributes(void) const;
+
+      /*!
+        Set the value for retained_geometry_attributes(void) const
+       */
+      ConfigurationNull&
+      retained_geometry_attributes(unsigned int v);
+
+      /*!
+        The number of indices the PainterRetainedGeometryStore
+        of the PainterBackendNull holds, only has effect if
+        retained_geometry_attributes() is non-zero. Default
+        value is 0.
+       */
+      unsigned int
+      retained_geometry_indices(void) const;
+
+      /*!
+        Set the value for retained_geometry_indices(void) const
+       */
+      ConfigurationNull&
+      retained_geometry_indices(unsigned int v);
+
+      /*!
+        The number of blocks (see ConfigurationBase::alignment())
+        the PainterPersistentDataStore of the PainterBackendNull
+        holds, see PainterBackend::persistent_data_store(). A value
+        of 0 indicates that the PainterBackendNull does not have a
+        PainterPersistentDataStore. Default value is 0.
+       */
+      unsigned int
+      persistent_data_store_blocks(void) const;
+
+      /*!
+        Set the value for persistent_data_store_blocks(void) const
+       */
+      ConfigurationNull&
+      persistent_data_store_blocks(unsigned int v);
+
+      /*!
+        If true, the PainterDraw objects returned by map_draw()
+        have an empty PainterDraw::m_header_attributes, so that
+        the header of the indices is given by calls to
+        PainterDraw::header_changed() instead, see
+        ConfigurationGL::header_via_base_instance(). Default
+        value is false.
+       */
+      bool
+      header_via_base_instance(void) const;
+
+      /*!
+        Set the value for header_via_base_instance(void) const
+       */
+      ConfigurationNull&
+      header_via_base_instance(bool v);
+
+    private:
+      void *m_d;
+    };
+
+    /*!
+      Ctor.
+      \param config_null ConfigurationNull providing configuration parameters
+      \param config_base ConfigurationBase parameters inherited from PainterBackend
+     */
+    explicit
+    PainterBackendNull(const ConfigurationNull &config_null = ConfigurationNull(),
+                       const ConfigurationBase &config_base = ConfigurationBase());
+
+    ~PainterBackendNull();
+
+    /*!
+      Returns the ConfigurationNull passed in the ctor.
+     */
+    const ConfigurationNull&
+    configuration_null(void) const;
+
+    /*!
+      Returns a stat on the data sent to the PainterBackendNull.
+      The values are cumulative over the lifetime of the
+      PainterBackendNull, or since the last call to
+      reset_stats().
+      \param st stat to query
+     */
+    uint64_t
+    query_stat(enum stats_t st) const;
+
+    /*!
+      Set all stats to zero.
+     */
+    void
+    reset_stats(void);
+
+    virtual
+    unsigned int
+    attribs_per_mapping(void) const;
+
+    virtual
+    unsigned int
+    indices_per_mapping(void) const;
+
+    virtual
+    void
+    on_pre_draw(void);
+
+    virtual
+    void
+    on_post_draw(void);
+
+    virtual
+    reference_counted_ptr<const PainterDraw>
+    map_draw(void);
+
+  protected:
+
+    virtual
+    uint32_t
+    compute_item_shader_group(PainterShader::Tag tag,
+                              const reference_counted_ptr<PainterItemShader> &shader);
+
+    virtual
+    uint32_t
+    compute_blend_shader_group(PainterShader::Tag tag,
+                               const reference_counted_ptr<PainterBlendShader> &shader);
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+
+}
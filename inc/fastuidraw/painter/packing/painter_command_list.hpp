@@ -0,0 +1,278 @@
+/*!
+ * \file painter_command_list.hpp
+ * \brief file painter_command_list.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/blend_mode.hpp>
+#include <fastuidraw/painter/packing/painter_backend.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterCommandList is a PainterBackend that records the
+    PainterDraw objects it is given into memory instead of
+    drawing them. A Painter (or PainterPacker) constructed from a
+    PainterCommandList records its drawing commands into it; the
+    recording is then spliced, as many times as desired, into the
+    PainterDraw objects of the PainterBackend passed in the ctor
+    (the target) with PainterPacker::draw_command_list() or
+    Painter::draw_command_list().
+
+    A PainterCommandList shares the shaders, atlases and
+    ConfigurationBase of its target, so the data it records is
+    valid for the target without any translation other than
+    rebasing the locations within PainterDraw::m_store and the
+    z-values of the headers. Recording does not access the
+    target other than through its atlases, which are thread
+    safe; thus different PainterCommandList objects of the same
+    target can be recorded to from different threads, each with
+    its own Painter, while the target is used on another thread.
+    Note however that:
+     - shaders must be registered to the target before recording
+       with them, since registering a shader is not thread safe,
+     - the objects used to draw (Path, FilledPath, StrokedPath,
+       PainterPackedValue, etc) are not thread safe, so the same
+       object must not be used by different threads at the same
+       time,
+     - drawing glyphs pins them (see glyphs()), which accesses
+       their GlyphCache, and GlyphCache is not thread safe.
+   */
+  class PainterCommandList:public PainterBackend
+  {
+  public:
+    /*!
+      A StateChange records a call to PainterDraw::draw_break()
+      of a RecordedDraw, i.e. the shader groups from which the
+      indices that follow it are drawn.
+     */
+    class StateChange
+    {
+    public:
+      /*!
+        Value of PainterShaderGroup::item_group()
+       */
+      uint32_t m_item_group;
+
+      /*!
+        Value of PainterShaderGroup::blend_group()
+       */
+      uint32_t m_blend_group;
+
+      /*!
+        Value of PainterShaderGroup::brush()
+       */
+      uint32_t m_brush;
+
+      /*!
+        Value of PainterShaderGroup::packed_blend_mode()
+       */
+      BlendMode::packed_value m_blend_mode;
+
+      /*!
+        Number of indices of the RecordedDraw that come
+        before the state change.
+       */
+      unsigned int m_indices_written;
+    };
+
+    /*!
+      A RecordedDraw holds the data written to one of the
+      PainterDraw objects returned by map_draw().
+     */
+    class RecordedDraw
+    {
+    public:
+      /*!
+        Attributes written to PainterDraw::m_attributes
+       */
+      const_c_array<PainterAttribute> m_attributes;
+
+      /*!
+        Values written to PainterDraw::m_header_attributes
+       */
+      const_c_array<uint32_t> m_header_attributes;
+
+      /*!
+        Indices written to PainterDraw::m_indices
+       */
+      const_c_array<PainterIndex> m_indices;
+
+      /*!
+        Data written to PainterDraw::m_store
+       */
+      const_c_array<generic_data> m_store;
+
+      /*!
+        The locations, in units of ConfigurationBase::alignment(),
+        within \ref m_store of the PainterHeader values, sorted in
+        increasing order.
+       */
+      const_c_array<uint32_t> m_header_locations;
+
+      /*!
+        The state changes of the draw, sorted by
+        StateChange::m_indices_written. The first
+        element is always at the start of the indices
+        and has its shader groups all zero, which is
+        the state PainterPacker starts a PainterDraw in.
+       */
+      const_c_array<StateChange> m_state_changes;
+    };
+
+    /*!
+      Ctor. The recording keeps the storage into which each
+      recorded PainterDraw was written instead of copying
+      its data, so the memory held by a recording is the
+      number of PainterDraw objects recorded times the size
+      of a PainterDraw as given by the parameters.
+      \param target PainterBackend into whose PainterDraw objects
+                    the recorded data is to be spliced
+      \param data_blocks_per_draw size of PainterDraw::m_store of the
+                                  PainterDraw objects returned by map_draw()
+                                  in units of ConfigurationBase::alignment();
+                                  must not exceed that of the PainterDraw
+                                  objects of the target
+      \param attributes_per_draw number of attributes that the PainterDraw
+                                 objects returned by map_draw() hold; the
+                                 value is clamped to that of the target
+      \param indices_per_draw number of indices that the PainterDraw
+                              objects returned by map_draw() hold; the
+                              value is clamped to that of the target
+     */
+    explicit
+    PainterCommandList(const reference_counted_ptr<PainterBackend> &target,
+                       unsigned int data_blocks_per_draw = 4096,
+                       unsigned int attributes_per_draw = 64 * 1024,
+                       unsigned int indices_per_draw = 96 * 1024);
+
+    ~PainterCommandList();
+
+    /*!
+      Returns the PainterBackend passed in the ctor.
+     */
+    const reference_counted_ptr<PainterBackend>&
+    target(void) const;
+
+    /*!
+      Remove all recorded data. Must not be called while a
+      PainterDraw returned by map_draw() is not yet unmapped.
+     */
+    void
+    clear(void);
+
+    /*!
+      Returns the number of PainterDraw objects recorded,
+      i.e. the number of PainterDraw objects returned by
+      map_draw() since the last call to clear().
+     */
+    unsigned int
+    number_draws(void) const;
+
+    /*!
+      Returns a recorded PainterDraw, in the order in which
+      they were returned by map_draw(). The returned reference
+      stays valid until clear() is called, more is recorded or
+      the PainterCommandList is deleted.
+      \param I which draw with 0 <= I < number_draws()
+     */
+    const RecordedDraw&
+    recorded_draw(unsigned int I) const;
+
+    /*!
+      Returns one more than the largest z-value (see
+      PainterHeader::m_z) of the recorded headers, i.e. the
+      amount by which to increment the z-value of a Painter
+      after splicing the recording into it.
+     */
+    unsigned int
+    z_range(void) const;
+
+    /*!
+      Returns the glyphs drawn into the recording (see
+      PainterBackend::glyphs_drawn()). The PainterCommandList
+      pins them (see Glyph::pin()) until clear() is called or
+      it is deleted, so that the recording can be replayed in
+      later frames; Painter::draw_command_list() marks them as
+      used (see Glyph::mark_used()) each time it is replayed.
+     */
+    const_c_array<Glyph>
+    glyphs(void) const;
+
+    virtual
+    unsigned int
+    attribs_per_mapping(void) const;
+
+    virtual
+    unsigned int
+    indices_per_mapping(void) const;
+
+    /*!
+      Does nothing; the recorded data does not depend
+      on the resolution of the target surface.
+     */
+    virtual
+    void
+    target_resolution(int w, int h);
+
+    virtual
+    void
+    on_pre_draw(void);
+
+    virtual
+    void
+    on_post_draw(void);
+
+    virtual
+    reference_counted_ptr<const PainterDraw>
+    map_draw(void);
+
+    /*!
+      Pins the glyphs until clear() is called, see glyphs().
+     */
+    virtual
+    void
+    glyphs_drawn(const_c_array<Glyph> glyphs);
+
+  protected:
+    virtual
+    PainterShader::Tag
+    absorb_item_shader(const reference_counted_ptr<PainterItemShader> &shader);
+
+    virtual
+    uint32_t
+    compute_item_sub_shader_group(const reference_counted_ptr<PainterItemShader> &shader);
+
+    virtual
+    PainterShader::Tag
+    absorb_blend_shader(const reference_counted_ptr<PainterBlendShader> &shader);
+
+    virtual
+    uint32_t
+    compute_blend_sub_shader_group(const reference_counted_ptr<PainterBlendShader> &shader);
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+
+}
@@ -93,8 +93,12 @@ namespace fastuidraw
       Location to which to place the attribute data
       storing the header locations. The size of
       \ref m_header_attributes must be the same
-      as the size of \ref m_attributes,
-      the store is understood to be write only.
+      as the size of \ref m_attributes, or zero.
+      If the size is zero, the header locations are
+      not written per attribute; instead header_changed()
+      is called each time the header of the indices
+      that follow changes. The store is understood to
+      be write only.
      */
     c_array<uint32_t> m_header_attributes;
 
@@ -141,6 +145,56 @@ namespace fastuidraw
                unsigned int attributes_written,
                unsigned int indices_written) const = 0;
 
+    /*!
+      Called to add a draw of index data that resides in the
+      PainterBackend::retained_geometry_store() of the PainterBackend
+      that created this PainterDraw. The draw is to be issued after
+      those indices of \ref m_indices written before the call and
+      before those written after it. A PainterBackend that has a
+      PainterRetainedGeometryStore must implement this method;
+      the default implementation asserts.
+      \param index_offset location within the index store of
+                          PainterBackend::retained_geometry_store()
+                          of the first index to draw
+      \param index_count number of indices to draw
+      \param base_vertex value to add to each index to get the location
+                         within the attribute store of the attribute
+      \param header_location value for all vertices of the header
+                             attribute, i.e. the value that would be
+                             written to \ref m_header_attributes
+      \param attributes_written total number of attributes written
+                                to m_attributes before the call
+      \param indices_written total number of indices written to
+                             m_indices before the call
+     */
+    virtual
+    void
+    draw_retained(unsigned int index_offset, unsigned int index_count,
+                  int base_vertex, uint32_t header_location,
+                  unsigned int attributes_written,
+                  unsigned int indices_written) const;
+
+    /*!
+      Called when \ref m_header_attributes is empty to indicate
+      that the indices written to \ref m_indices after the call
+      are of the header at the given location, up to the next call
+      to header_changed(). A PainterBackend whose PainterDraw
+      objects have an empty \ref m_header_attributes must implement
+      this method; the default implementation asserts.
+      \param header_location location within \ref m_store of the
+                             header, i.e. the value that would be
+                             written to \ref m_header_attributes
+      \param attributes_written total number of attributes written
+                                to m_attributes before the call
+      \param indices_written total number of indices written to
+                             m_indices before the call
+     */
+    virtual
+    void
+    header_changed(uint32_t header_location,
+                   unsigned int attributes_written,
+                   unsigned int indices_written) const;
+
     /*!
       Adds a delayed action to the action list.
       \param h handle to action to add.
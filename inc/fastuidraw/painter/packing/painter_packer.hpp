@@ -43,6 +43,8 @@ namespace fastuidraw
   @{
  */
 
+  class PainterCommandList;
+
   /*!
     A PainterPacker packs data created by a Painter
     to be fed to a PainterBackend to draw.
@@ -192,6 +194,53 @@ namespace fastuidraw
         */
         num_headers,
 
+        /*!
+          Offset to how many FilledPath::Subset objects were
+          needed for drawing but were skipped because their
+          triangulation was handed to a TaskPool and was not
+          yet ready, see Painter::filled_path_task_pool().
+        */
+        num_deferred_filled_path_subsets,
+
+        /*!
+          Offset to how many times a fill of a Path used a
+          coarser tessellation than requested because the
+          triangulation of the requested one was not ready,
+          see Painter::filled_path_task_pool().
+        */
+        num_coarser_fill_fallbacks,
+
+        /*!
+          Offset to how many indices of filled paths were
+          not sent because the triangles they make are in
+          cells of a FilledPath::Subset outside of the
+          clipping region, see FilledPath::select_cells().
+        */
+        num_culled_fill_indices,
+
+        /*!
+          Offset to how many indices were drawn from the
+          PainterBackend::retained_geometry_store() instead
+          of being copied to a PainterDraw, see
+          PainterDraw::draw_retained().
+        */
+        num_retained_indices,
+
+        /*!
+          Offset to how many locations of packed data written
+          to headers are within the
+          PainterBackend::persistent_data_store() instead of
+          a PainterDraw, see PainterPackedValue::long_lived().
+        */
+        num_persistent_data_references,
+
+        /*!
+          Offset to how many times PainterDraw::draw_break()
+          was called on the PainterDraw objects sent, see
+          also deferred_submission().
+         */
+        num_draw_breaks,
+
         /*!
           Number of stats.
          */
@@ -277,6 +326,37 @@ namespace fastuidraw
     void
     flush(void);
 
+    /*!
+      Set if the PainterPacker is in deferred submission mode.
+      In deferred submission mode, the headers packed into a
+      PainterDraw and the draws made with them are recorded
+      and only sent to the PainterDraw (i.e. the calls to
+      PainterDraw::draw_break() and PainterDraw::draw_retained())
+      when the PainterDraw is unmapped. Before then, the opaque
+      items, i.e. those drawn with a blend shader whose output
+      does not depend on the framebuffer (the blend shaders of
+      PainterEnums::blend_porter_duff_src and
+      PainterEnums::blend_porter_duff_clear of default_shaders()),
+      are drawn before the other items that precede them
+      and have a lower z, sorted to reduce the number of draw
+      breaks; the other items are kept in order. Items drawn
+      with a DataCallBack are never moved across. This relies
+      on the z-values of items increasing with the order in
+      which they are drawn and on the PainterBackend using
+      depth testing, as is the case for items drawn by Painter.
+      The value takes effect on the next PainterDraw, i.e.
+      changing the value should be done outside of
+      begin()/end(). Default value is false.
+     */
+    void
+    deferred_submission(bool v);
+
+    /*!
+      Returns the value as set by deferred_submission(bool).
+     */
+    bool
+    deferred_submission(void) const;
+
     /*!
       Return the default shaders for common drawing types.
      */
@@ -326,6 +406,45 @@ namespace fastuidraw
                  const_c_array<unsigned int> attrib_chunk_selector,
                  unsigned int z,
                  const reference_counted_ptr<DataCallBack> &call_back = reference_counted_ptr<DataCallBack>());
+    /*!
+      Draw generic attribute data, using the
+      PainterBackend::retained_geometry_store() of the backend,
+      if it has one, for those index chunks whose attribute and
+      index data come from a PainterAttributeData. For such
+      chunks, the attribute chunk and index chunk are sub-arrays
+      of PainterAttributeData::attribute_data() and of
+      PainterAttributeData::index_data(); when the data is
+      resident in the store only the header is packed into the
+      PainterDraw, otherwise the chunk is drawn as usual.
+      \param shader shader with which to draw data
+      \param data data for how to draw
+      \param attrib_chunks attribute data to draw
+      \param index_chunks the i'th element is index data into attrib_chunks[K]
+                          where K = attrib_chunk_selector[i]
+      \param index_adjusts the i'th element is the value by which to adjust all of index_chunks[i]
+      \param attrib_chunk_selector selects which attribute chunk to use for
+             each index chunk, an empty array indicates that index_chunks[i]
+             uses attrib_chunks[i]
+      \param index_chunk_sources the i'th element is the PainterAttributeData
+             from which index_chunks[i] and its attribute chunk come, or
+             nullptr if they do not come from a PainterAttributeData; an
+             empty array indicates that none of the chunks come from a
+             PainterAttributeData
+      \param z z-value z value placed into the header
+      \param call_back if non-nullptr handle, call back called when attribute data
+                       is added.
+     */
+    void
+    draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
+                 const PainterPackerData &data,
+                 const_c_array<const_c_array<PainterAttribute> > attrib_chunks,
+                 const_c_array<const_c_array<PainterIndex> > index_chunks,
+                 const_c_array<int> index_adjusts,
+                 const_c_array<unsigned int> attrib_chunk_selector,
+                 const_c_array<const PainterAttributeData*> index_chunk_sources,
+                 unsigned int z,
+                 const reference_counted_ptr<DataCallBack> &call_back = reference_counted_ptr<DataCallBack>());
+
     /*!
       Draw generic attribute data
       \param shader shader with which to draw data
@@ -341,6 +460,24 @@ namespace fastuidraw
                  const DataWriter &src,
                  unsigned int z,
                  const reference_counted_ptr<DataCallBack> &call_back = reference_counted_ptr<DataCallBack>());
+    /*!
+      Splice the data recorded by a PainterCommandList into the
+      PainterDraw objects of this PainterPacker. The locations
+      within PainterDraw::m_store of the recorded headers are
+      rebased and their z-values are incremented by z; the
+      recorded data is otherwise drawn as it was recorded, i.e.
+      the state of this PainterPacker does not affect it. In
+      deferred submission mode, the items of the recording are
+      not reordered, see deferred_submission().
+      \param list PainterCommandList whose recording to splice,
+                  PainterCommandList::target() must be the
+                  PainterBackend of this PainterPacker
+      \param z value by which to increment the z-values of
+               the recorded headers
+     */
+    void
+    draw_command_list(const PainterCommandList &list, unsigned int z);
+
     /*!
       Returns a stat on how much data the PainterPacker has
       handled since the last call to begin().
@@ -349,6 +486,17 @@ namespace fastuidraw
     unsigned int
     query_stat(enum stats_t st) const;
 
+    /*!
+      Increment a stat. Provided so that the object
+      driving the PainterPacker (for example Painter)
+      can report work it does on behalf of the
+      PainterPacker since the last call to begin().
+      \param st stat to increment
+      \param amount amount by which to increment the stat
+     */
+    void
+    increment_stat(enum stats_t st, unsigned int amount = 1u);
+
     /*!
       Returns the PainterBackend::PerformanceHints of the underlying
       PainterBackend of this PainterPacker.
@@ -0,0 +1,237 @@
+/*!
+ * \file painter_persistent_data_store.hpp
+ * \brief file painter_persistent_data_store.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/util.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterPersistentDataStore represents a region of the
+    data store that persists across PainterDraw objects, in a
+    buffer separate from PainterDraw::m_store. The packed data
+    of a PainterPackedValue marked as long lived (see
+    PainterPackedValuePool::create_packed_value()) is uploaded
+    to it once and referenced by a stable location, instead of
+    being copied into the PainterDraw::m_store of each
+    PainterDraw (and each frame) that uses it.
+
+    A location within the store is encoded in the locations
+    of a PainterHeader by setting the bit \ref location_bit;
+    the shader code of a backend that has a
+    PainterPersistentDataStore fetches the data of such a
+    location from the store instead of the streamed data store.
+
+    The store has a fixed capacity; when it is full, the data
+    least recently used is evicted from it. When the free room
+    of the store is fragmented, the store is compacted by moving
+    its resident data to the start of the store; since moving
+    data changes its location, the store is only compacted when
+    no data has been fetched since the last call to end_batch().
+    Data is identified by a key given to fetch(); the store keeps
+    a copy of the resident data so that it can be re-uploaded
+    when compacting. An implementation does NOT need to be thread
+    safe, a PainterPersistentDataStore is only used by the
+    PainterPacker of its PainterBackend.
+   */
+  class PainterPersistentDataStore:
+    public reference_counted<PainterPersistentDataStore>::default_base
+  {
+  public:
+    enum
+      {
+        /*!
+          The bit set in the locations written to a PainterHeader
+          to indicate that the location is within the store.
+         */
+        location_bit = 30
+      };
+
+    /*!
+      Enumeration to query the statistics of a
+      PainterPersistentDataStore, see query_stat().
+     */
+    enum stats_t
+      {
+        /*!
+          Number of times data was uploaded to
+          the store because it was not resident.
+         */
+        num_uploads,
+
+        /*!
+          Number of times data was evicted from
+          the store to make room.
+         */
+        num_evictions,
+
+        /*!
+          Number of times the store was compacted.
+         */
+        num_compactions,
+
+        /*!
+          Number of times fetch() failed because the
+          data could not be made to fit in the store.
+         */
+        num_failed_fetches,
+
+        /*!
+          Number of blocks (see ConfigurationBase::alignment())
+          uploaded to the store, including those re-uploaded by
+          compacting.
+         */
+        num_blocks_uploaded,
+
+        /*!
+          Number of stats.
+         */
+        num_stats
+      };
+
+    /*!
+      Ctor.
+      \param number_blocks number of blocks the store holds
+      \param alignment number of generic_data values per block,
+                       i.e. ConfigurationBase::alignment() of
+                       the PainterBackend of the store
+     */
+    PainterPersistentDataStore(unsigned int number_blocks,
+                               unsigned int alignment);
+
+    virtual
+    ~PainterPersistentDataStore();
+
+    /*!
+      Returns the number of blocks the store
+      holds, as passed in the ctor.
+     */
+    unsigned int
+    number_blocks(void) const;
+
+    /*!
+      Returns the number of generic_data values
+      per block, as passed in the ctor.
+     */
+    unsigned int
+    alignment(void) const;
+
+    /*!
+      Returns true if a location (as written to a PainterHeader)
+      is within a PainterPersistentDataStore.
+      \param location location to query
+     */
+    static
+    bool
+    is_persistent_location(uint32_t location)
+    {
+      return (location & (1u << location_bit)) != 0u;
+    }
+
+    /*!
+      Make data resident in the store, uploading it (and evicting
+      other data) if it is not already. Returns false if the data
+      cannot be made resident, which happens if it is larger than
+      the store or if the only data that could be evicted has been
+      fetched since the last call to end_batch().
+      \param key key identifying the data; different data must
+                 have different keys and the data of a key must
+                 never change
+      \param data data to make resident, its size must be a multiple
+                  of alignment()
+      \param out_location location to which to write the location,
+                          in units of blocks and with \ref location_bit
+                          set, of the data
+     */
+    bool
+    fetch(uint64_t key, const_c_array<generic_data> data,
+          uint32_t *out_location);
+
+    /*!
+      To be called after all PainterDraw objects that use
+      locations returned by fetch() have been sent to the
+      3D API. Until then, data returned by fetch() is not
+      evicted or moved.
+     */
+    void
+    end_batch(void);
+
+    /*!
+      Evict all data from the store. Must not be called
+      between a fetch() and the following end_batch().
+     */
+    void
+    clear(void);
+
+    /*!
+      Returns the number of keys whose data is
+      resident in the store.
+     */
+    unsigned int
+    number_resident(void) const;
+
+    /*!
+      Returns the number of blocks that are
+      resident in the store.
+     */
+    unsigned int
+    number_blocks_resident(void) const;
+
+    /*!
+      Returns a stat of the store. The values are
+      cumulative over the lifetime of the store, or
+      since the last call to reset_stats().
+      \param st stat to query
+     */
+    uint64_t
+    query_stat(enum stats_t st) const;
+
+    /*!
+      Set all stats to zero.
+     */
+    void
+    reset_stats(void);
+
+  protected:
+    /*!
+      To be implemented by a derived class to set
+      data of the store.
+      \param location location within the store in units
+                      of blocks (without \ref location_bit)
+      \param data values to set, the size is a multiple
+                  of alignment()
+     */
+    virtual
+    void
+    set_data(unsigned int location,
+             const_c_array<generic_data> data) = 0;
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+
+}
@@ -0,0 +1,235 @@
+/*!
+ * \file painter_retained_geometry_store.hpp
+ * \brief file painter_retained_geometry_store.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/painter/painter_attribute.hpp>
+#include <fastuidraw/painter/painter_attribute_data.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup PainterPacking
+  @{
+ */
+
+  /*!
+    A PainterRetainedGeometryStore represents a long-lived
+    store, in a form ready for a 3D API to consume, of the
+    attribute and index data of PainterAttributeData objects.
+    Drawing from data that is resident in the store only
+    requires the PainterHeader and painter state to be sent
+    in a PainterDraw, see PainterDraw::draw_retained().
+
+    The store has a fixed capacity; when it is full, the
+    PainterAttributeData objects that were least recently
+    used are evicted from it. Data is identified by
+    PainterAttributeData::unique_id(), so data that is changed
+    or deleted is never drawn from the store; its stale copy
+    is eventually evicted. An implementation does NOT need to
+    be thread safe, a PainterRetainedGeometryStore is only
+    used by the PainterPacker of its PainterBackend.
+   */
+  class PainterRetainedGeometryStore:
+    public reference_counted<PainterRetainedGeometryStore>::default_base
+  {
+  public:
+    /*!
+      A Region gives the location within a PainterRetainedGeometryStore
+      of the data of a PainterAttributeData.
+     */
+    class Region
+    {
+    public:
+      /*!
+        Location within the attribute store of the
+        first element of PainterAttributeData::attribute_data().
+       */
+      unsigned int m_attribute_offset;
+
+      /*!
+        Location within the index store of the
+        first element of PainterAttributeData::index_data().
+       */
+      unsigned int m_index_offset;
+    };
+
+    /*!
+      Enumeration to query the statistics of a
+      PainterRetainedGeometryStore, see query_stat().
+     */
+    enum stats_t
+      {
+        /*!
+          Number of PainterAttributeData objects whose
+          data was uploaded to the store.
+         */
+        num_uploads,
+
+        /*!
+          Number of PainterAttributeData objects whose
+          data was evicted from the store to make room.
+         */
+        num_evictions,
+
+        /*!
+          Number of times fetch() failed because the
+          data could not be made to fit in the store.
+         */
+        num_failed_fetches,
+
+        /*!
+          Number of attributes uploaded to the store.
+         */
+        num_attributes_uploaded,
+
+        /*!
+          Number of indices uploaded to the store.
+         */
+        num_indices_uploaded,
+
+        /*!
+          Number of stats.
+         */
+        num_stats
+      };
+
+    /*!
+      Ctor.
+      \param number_attributes number of PainterAttribute values the store holds
+      \param number_indices number of PainterIndex values the store holds
+     */
+    PainterRetainedGeometryStore(unsigned int number_attributes,
+                                 unsigned int number_indices);
+
+    virtual
+    ~PainterRetainedGeometryStore();
+
+    /*!
+      Returns the number of PainterAttribute values
+      the store holds, as passed in the ctor.
+     */
+    unsigned int
+    number_attributes(void) const;
+
+    /*!
+      Returns the number of PainterIndex values
+      the store holds, as passed in the ctor.
+     */
+    unsigned int
+    number_indices(void) const;
+
+    /*!
+      Make the data of a PainterAttributeData resident in
+      the store, uploading it (and evicting other data) if
+      it is not already. Returns false if the data cannot be
+      made resident, which happens if it is larger than the
+      store or if the only data that could be evicted has
+      been fetched since the last call to end_batch().
+      \param data PainterAttributeData whose data to fetch
+      \param out_region location to which to write where
+                        the data resides in the store
+     */
+    bool
+    fetch(const PainterAttributeData &data, Region *out_region);
+
+    /*!
+      To be called after all PainterDraw objects that draw
+      from regions returned by fetch() have been sent to the
+      3D API. Until then, data returned by fetch() is not
+      evicted.
+     */
+    void
+    end_batch(void);
+
+    /*!
+      Evict all data from the store. Must not be called
+      between a fetch() and the following end_batch().
+     */
+    void
+    clear(void);
+
+    /*!
+      Returns the number of PainterAttributeData objects
+      whose data is resident in the store.
+     */
+    unsigned int
+    number_resident(void) const;
+
+    /*!
+      Returns the number of attributes that are
+      resident in the store.
+     */
+    unsigned int
+    number_attributes_resident(void) const;
+
+    /*!
+      Returns the number of indices that are
+      resident in the store.
+     */
+    unsigned int
+    number_indices_resident(void) const;
+
+    /*!
+      Returns a stat of the store. The values are
+      cumulative over the lifetime of the store, or
+      since the last call to reset_stats().
+      \param st stat to query
+     */
+    uint64_t
+    query_stat(enum stats_t st) const;
+
+    /*!
+      Set all stats to zero.
+     */
+    void
+    reset_stats(void);
+
+  protected:
+    /*!
+      To be implemented by a derived class to set
+      attribute data of the store.
+      \param location location within the attribute store
+      \param data attribute values to set
+     */
+    virtual
+    void
+    set_attributes(unsigned int location,
+                   const_c_array<PainterAttribute> data) = 0;
+
+    /*!
+      To be implemented by a derived class to set
+      index data of the store. The values are set
+      unmodified, i.e. they are relative to the
+      PainterAttributeData from which they come.
+      \param location location within the index store
+      \param data index values to set
+     */
+    virtual
+    void
+    set_indices(unsigned int location,
+                const_c_array<PainterIndex> data) = 0;
+
+  private:
+    void *m_d;
+  };
+/*! @} */
+
+}
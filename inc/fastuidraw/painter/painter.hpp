@@ -29,6 +29,7 @@
 #include <fastuidraw/painter/painter_dashed_stroke_params.hpp>
 #include <fastuidraw/painter/painter_data.hpp>
 #include <fastuidraw/painter/packing/painter_packer.hpp>
+#include <fastuidraw/painter/packing/painter_command_list.hpp>
 
 namespace fastuidraw
 {
@@ -345,6 +346,71 @@ namespace fastuidraw
     float
     curveFlatness(void);
 
+    /*!
+      Set the TaskPool to which to hand the triangulation of
+      FilledPath::Subset objects when filling paths. If the
+      TaskPool is non-nullptr, filling a path never blocks
+      on triangulation; those portions of the fill whose
+      triangulation is not yet ready are not drawn and, when
+      filling a Path, a coarser TessellatedPath whose
+      triangulation is ready is used if there is one. The
+      stats PainterPacker::num_deferred_filled_path_subsets and
+      PainterPacker::num_coarser_fill_fallbacks report how often
+      this occurs. Default value is nullptr, i.e. triangulation
+      is performed on the calling thread when it is needed.
+      \param task_pool TaskPool to use
+     */
+    void
+    filled_path_task_pool(const reference_counted_ptr<TaskPool> &task_pool);
+
+    /*!
+      Returns the value set by filled_path_task_pool(const reference_counted_ptr<TaskPool>&).
+     */
+    const reference_counted_ptr<TaskPool>&
+    filled_path_task_pool(void) const;
+
+    /*!
+      If true, the FilledPath and StrokedPath data of fills and
+      strokes is drawn from the PainterBackend::retained_geometry_store()
+      of the PainterBackend, uploading it there the first time it
+      is drawn, so that redrawing the same paths only sends the
+      PainterHeader and painter state to the PainterBackend each
+      frame. Has no effect if the PainterBackend does not have a
+      PainterRetainedGeometryStore. Setting the value to false is
+      useful when drawing paths that are drawn only once, so that
+      they do not evict the data of other paths from the store.
+      Default value is true.
+      \param v value to use
+     */
+    void
+    retain_path_geometry(bool v);
+
+    /*!
+      Returns the value set by retain_path_geometry(bool).
+     */
+    bool
+    retain_path_geometry(void) const;
+
+    /*!
+      Set if the underlying PainterPacker draws the items whose
+      output does not depend on the framebuffer (i.e. those drawn
+      with PainterEnums::blend_porter_duff_src or
+      PainterEnums::blend_porter_duff_clear) ahead of the items
+      below them, sorted to reduce the number of draw breaks,
+      see PainterPacker::deferred_submission().
+      Should only be changed outside of begin()/end().
+      Default value is false.
+      \param v value to use
+     */
+    void
+    deferred_submission(bool v);
+
+    /*!
+      Returns the value set by deferred_submission(bool).
+     */
+    bool
+    deferred_submission(void) const;
+
     /*!
       Save the current state of this Painter onto the save state stack.
       The state is restored (and the stack popped) by called restore().
@@ -408,7 +474,8 @@ namespace fastuidraw
       \param inc_edge amount by which to increment current_z() for the edge drawing
       \param cap_data attribute and index data for drawing the caps,
                       nullptr value indicates to not draw caps.
-      \param cap_chunk which chunk to take from cap_data
+      \param cap_chunks which chunks to take from cap_data
+      \param inc_cap amount by which to increment current_z() for the cap drawing
       \param join_data attribute and index data for drawing the joins,
                        nullptr value indicates to not draw joins.
       \param join_chunks which chunks to take from join_data to draw the joins
@@ -421,7 +488,8 @@ namespace fastuidraw
     stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
                 const PainterAttributeData *edge_data, const_c_array<unsigned int> edge_chunks,
                 unsigned int inc_edge,
-                const PainterAttributeData *cap_data, unsigned int cap_chunk,
+                const PainterAttributeData *cap_data, const_c_array<unsigned int> cap_chunks,
+                unsigned int inc_cap,
                 const PainterAttributeData *join_data, const_c_array<unsigned int> join_chunks,
                 unsigned int inc_join, bool with_anti_aliasing,
                 const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
@@ -513,7 +581,8 @@ namespace fastuidraw
       \param inc_edge amount by which to increment current_z() for the edge drawing
       \param cap_data attribute and index data for drawing the caps,
                       nullptr value indicates to not draw caps.
-      \param cap_chunk which chunk to take from cap_data
+      \param cap_chunks which chunks to take from cap_data
+      \param inc_cap amount by which to increment current_z() for the cap drawing
       \param include_joins_from_closing_edge if false, disclude the joins formed
                                              from the closing edges of each contour
       \param dash_evaluator DashEvaluatorBase object to determine which joins
@@ -528,7 +597,8 @@ namespace fastuidraw
     stroke_dashed_path(const PainterStrokeShader &shader, const PainterData &draw,
                        const PainterAttributeData *edge_data, const_c_array<unsigned int> edge_chunks,
                        unsigned int inc_edge,
-                       const PainterAttributeData *cap_data, unsigned int cap_chunk,
+                       const PainterAttributeData *cap_data, const_c_array<unsigned int> cap_chunks,
+                       unsigned int inc_cap,
                        bool include_joins_from_closing_edge,
                        const DashEvaluatorBase *dash_evaluator, const PainterAttributeData *join_data,
                        bool with_anti_aliasing,
@@ -869,6 +939,26 @@ namespace fastuidraw
                  const PainterPacker::DataWriter &src,
                  const reference_counted_ptr<PainterPacker::DataCallBack> &call_back = reference_counted_ptr<PainterPacker::DataCallBack>());
 
+    /*!
+      Draw the recording of a PainterCommandList, see
+      PainterPacker::draw_command_list(). The recording is
+      drawn as it was recorded by the Painter of the
+      PainterCommandList: the transformation, clip equations,
+      brush and blend shader of this Painter are not applied
+      to it. The items of the recording are given z-values
+      starting at current_z(), which is then incremented by
+      PainterCommandList::z_range(); thus the occluders of the
+      clipping of this Painter (whose z-values are assigned when
+      the clipping is popped) do apply to the recorded items.
+      The glyphs of the recording (PainterCommandList::glyphs())
+      are marked as used (see Glyph::mark_used()).
+      \param list PainterCommandList whose recording to draw,
+                  PainterCommandList::target() must be the
+                  PainterBackend of this Painter
+     */
+    void
+    draw_command_list(const PainterCommandList &list);
+
     /*!
       Returns a stat on how much data the Packer has
       handled since the last call to begin().
@@ -53,6 +53,31 @@ namespace fastuidraw
     void
     set_data(const PainterAttributeDataFiller &filler);
 
+    /*!
+      Returns a value that identifies the current contents of
+      this PainterAttributeData. No two PainterAttributeData
+      objects share the value, and the value changes each
+      time set_data() is called. A PainterBackend can use
+      it as a key for a copy of the data that it keeps, see
+      PainterRetainedGeometryStore.
+     */
+    uint64_t
+    unique_id(void) const;
+
+    /*!
+      Returns all of the attribute data. Each element of
+      attribute_data_chunks() is a sub-array of it.
+     */
+    const_c_array<PainterAttribute>
+    attribute_data(void) const;
+
+    /*!
+      Returns all of the index data. Each element of
+      index_data_chunks() is a sub-array of it.
+     */
+    const_c_array<PainterIndex>
+    index_data(void) const;
+
     /*!
       Returns the attribute data chunks. Usually, for each
       attribute data chunk, there is a matching index data
@@ -132,6 +157,21 @@ namespace fastuidraw
     unsigned int
     increment_z_value(unsigned int i) const;
 
+    /*!
+      Returns the glyphs whose data in a GlyphAtlas the
+      attribute data references, as given by
+      PainterAttributeDataFiller::glyphs() of the filler
+      last passed to set_data(). The PainterAttributeData
+      pins the glyphs (see Glyph::pin()) and holds a reference
+      to their GlyphCache until it is deleted or set_data() is
+      called again, so that the glyphs are neither evicted nor
+      moved while the attribute data refers to them.
+      Painter::draw_glyphs() marks them as used in the current
+      frame of their GlyphAtlas, see Glyph::mark_used().
+     */
+    const_c_array<Glyph>
+    glyphs(void) const;
+
   private:
     void *m_d;
   };
@@ -25,6 +25,8 @@
 
 namespace fastuidraw
 {
+  class Glyph;
+
 /*!\addtogroup Painter
   @{
  */
@@ -89,6 +91,21 @@ namespace fastuidraw
               c_array<const_c_array<PainterIndex> > index_chunks,
               c_array<unsigned int> zincrements,
               c_array<int> index_adjusts) const = 0;
+
+    /*!
+      To be optionally implemented by a derived class to
+      return the glyphs whose data in a GlyphAtlas is
+      referenced by the filled attribute data, see
+      PainterAttributeData::glyphs(). Called after
+      fill_data(). Default implementation returns an
+      empty array.
+     */
+    virtual
+    const_c_array<Glyph>
+    glyphs(void) const
+    {
+      return const_c_array<Glyph>();
+    }
   };
 /*! @} */
 }
@@ -134,6 +134,14 @@ namespace fastuidraw
               c_array<unsigned int> zincrements,
               c_array<int> index_adjusts) const;
 
+    /*!
+      Returns the first number_glyphs() glyphs of the
+      glyph array passed to the ctor.
+     */
+    virtual
+    const_c_array<Glyph>
+    glyphs(void) const;
+
   private:
     void *m_d;
   };
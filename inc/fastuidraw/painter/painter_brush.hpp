@@ -127,6 +127,19 @@ namespace fastuidraw
           Bit up is translation is present
          */
         transformation_matrix_bit,
+
+        /*!
+          Number of bits needed to encode the number of mipmap
+          levels of the image packed by the brush, see
+          \ref image_mipmap_offset_t. A value of 0 indicates
+          that the image has no mipmaps.
+         */
+        image_mipmap_levels_num_bits = 5,
+
+        /*!
+          first bit for the number of mipmap levels of the image
+         */
+        image_mipmap_levels_bit0 = transformation_matrix_bit + 1,
       };
 
     /*!
@@ -177,6 +190,15 @@ namespace fastuidraw
           bit mask for if matrix is used in brush
          */
         transformation_matrix_mask = FASTUIDRAW_MASK(transformation_matrix_bit, 1),
+
+        /*!
+          bit mask for the number of mipmap levels of the
+          image, the value of shader() bit wise anded with
+          \ref image_mipmap_levels_mask shifted right by
+          \ref image_mipmap_levels_bit0 gives the number of
+          mipmap levels packed by the brush.
+         */
+        image_mipmap_levels_mask = FASTUIDRAW_MASK(image_mipmap_levels_bit0, image_mipmap_levels_num_bits),
       };
 
     /*!
@@ -200,6 +222,13 @@ namespace fastuidraw
          */
         image_packing,
 
+        /*!
+          image mipmap packing (only if the image has mipmaps),
+          see \ref image_mipmap_offset_t for the offsets
+          for the individual fields
+         */
+        image_mipmap_packing,
+
         /*!
           gradient packing, see \ref gradient_offset_t
           for the offsets from the start of gradient packing
@@ -355,6 +384,58 @@ namespace fastuidraw
         image_data_size
       };
 
+    /*!
+      Offsets for the packing of the mipmap levels of an image;
+      the number of mipmap levels packed is recorded in
+      PainterBrush::shader(), see \ref image_mipmap_levels_mask.
+      The location in the atlas of each level is packed so that
+      the shader fetches only the level it samples from.
+     */
+    enum image_mipmap_offset_t
+      {
+        /*!
+          Image::finest_resident_mipmap_level() packed as a uint32;
+          the levels finer than it are not on the atlas and their
+          values are not to be used.
+         */
+        image_mipmap_finest_level_offset,
+
+        /*!
+          Offset to the values of mipmap level 0, the values of
+          mipmap level L start at image_mipmap_levels_offset +
+          L * image_mipmap_level_data_size, see
+          \ref image_mipmap_level_offset_t for the offsets of
+          the individual fields of a level.
+         */
+        image_mipmap_levels_offset,
+      };
+
+    /*!
+      Offsets for the values of one mipmap level
+      of an image, see \ref image_mipmap_offset_t.
+     */
+    enum image_mipmap_level_offset_t
+      {
+        /*!
+          Location of the level (Image::mipmap_master_index_tile())
+          in the image atlas packed as according to
+          image_atlas_location_encoding
+         */
+        image_mipmap_level_atlas_location_xyz_offset,
+
+        /*!
+          Number of index look ups of the level
+          (Image::mipmap_number_index_lookups())
+          packed as a uint32
+         */
+        image_mipmap_level_number_lookups_offset,
+
+        /*!
+          Number of elements packed for each mipmap level.
+         */
+        image_mipmap_level_data_size
+      };
+
     /*!
       Bit encoding for packing ColorStopSequenceOnAtlas::texel_location()
      */
@@ -527,7 +608,13 @@ namespace fastuidraw
     image(const reference_counted_ptr<const Image> &im, enum image_filter f = image_filter_nearest);
 
     /*!
-      Set the brush to source from a sub-rectangle of an image
+      Set the brush to source from a sub-rectangle of an image.
+      If the image has mipmaps (see Image::number_mipmap_levels()),
+      the shader samples, for each pixel, from the mipmap level
+      closest to the rate of change of the brush coordinate,
+      but never from a level finer than
+      Image::finest_resident_mipmap_level() as of when the brush
+      is packed.
       \param im handle to image to use
       \param xy top-left corner of sub-rectangle of image to use
       \param wh width and height of sub-rectangle of image to use
@@ -750,6 +837,12 @@ namespace fastuidraw
         translation is applied to the brush.
       - If shader() & \ref transformation_matrix_mask is non-zero, then a
         2x2 matrix is applied to the brush.
+      - The value given by
+        \code
+        unpack_bits(image_mipmap_levels_bit0, image_mipmap_levels_num_bits, shader())
+        \endcode
+        is the number of mipmap levels of the image and is non-zero
+        only if the image has mipmaps.
      */
     uint32_t
     shader(void) const;
@@ -811,6 +904,19 @@ namespace fastuidraw
     int
     slack_requirement(enum image_filter f);
 
+    /*!
+      Returns the number of elements to pack the
+      mipmap levels of an image, see \ref
+      image_mipmap_offset_t.
+      \param number_levels number of mipmap levels
+     */
+    static
+    unsigned int
+    image_mipmap_data_size(unsigned int number_levels)
+    {
+      return image_mipmap_levels_offset + number_levels * image_mipmap_level_data_size;
+    }
+
   private:
 
     class brush_data
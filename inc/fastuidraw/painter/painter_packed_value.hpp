@@ -64,6 +64,9 @@ namespace fastuidraw
     unsigned int
     alignment_packing(void) const;
 
+    bool
+    long_lived(void) const;
+
     void *m_d;
   };
 
@@ -72,14 +75,18 @@ namespace fastuidraw
     packed state data and tracks if that underlying data is already is
     already copied to PainterDraw::m_store. If already
     on a store, then rather than copying the data again, the data is
-    reused. The object behind the handle is NOT thread safe. In addition
-    the underlying reference count is not either. Hence any access
-    (even dtor, copy ctor and equality operator) on a fixed object cannot
-    be done from multiple threads simutaneously. A fixed
-    PainterPackedValue can be used by different Painter (and PainterPacker)
-    objects subject to the condition that the data store alignment (see
-    PainterPacker::Configuration::alignment()) is the same for each of these
-    objects.
+    reused. The reference count of the underlying object is atomic,
+    so handles to the same object can be copied and destroyed from
+    different threads simutaneously; however a fixed handle object
+    (like any other value) must not be modified from one thread while
+    accessed from another. The value itself is immutable. Tracking
+    where the data was copied to is NOT thread safe, so the same
+    underlying object must not be drawn with by Painter (or
+    PainterPacker) objects on different threads at the same time.
+    A fixed PainterPackedValue can be used by different Painter (and
+    PainterPacker) objects subject to the condition that the data store
+    alignment (see PainterPacker::Configuration::alignment()) is the
+    same for each of these objects.
    */
   template<typename T>
   class PainterPackedValue:PainterPackedValueBase
@@ -121,6 +128,18 @@ namespace fastuidraw
       return this->m_d->alignment_packing();
     }
 
+    /*!
+      Returns true if the PainterPackedValue was created as
+      long lived (see PainterPackedValuePool::create_packed_value()).
+      If the PainterPackedValue represents a nullptr handle then
+      returns false.
+     */
+    bool
+    long_lived(void) const
+    {
+      return PainterPackedValueBase::long_lived();
+    }
+
     /*!
       Used to allow using object as a boolean without
       accidentally converting to a boolean (since it
@@ -187,14 +206,33 @@ namespace fastuidraw
 
   /*!
     A PainterPackedValuePool can be used to create PainterPackedValue
-    objects. Just like PainterPackedValue, PainterPackedValuePool is
-    NOT thread safe, as such it is not a safe operation to use the
-    same PainterPackedValuePool object from multiple threads at the
-    same time. A fixed PainterPackedValuePool can create PainterPackedValue
+    objects. The methods create_packed_value() are thread safe, so
+    worker threads can create PainterPackedValue objects from the same
+    PainterPackedValuePool while another thread draws with those
+    already created. The allocation is lock-free: each thread takes
+    the storage for the values it creates in batches (magazines) from
+    lock-free free lists, and a mutex is only locked when all the
+    storage of the pool is in use and more must be allocated. Storage
+    taken by a thread but not yet used is kept by the thread until the
+    thread exits or creates a value from another PainterPackedValuePool
+    after this one is deleted. The dtor must not be called while other
+    threads are creating values from the PainterPackedValuePool.
+    Created PainterPackedValue objects may outlive the
+    PainterPackedValuePool that created them.
+    A fixed PainterPackedValuePool can create PainterPackedValue
     objects used by different Painter (and PainterPacker) objects subject
     to the condition that the data store alignment (see
     PainterPacker::Configuration::alignment()) is the same for each of
     these objects.
+
+    A value that is drawn with across many frames (for example a
+    brush or transformation shared by many items of a scene) can be
+    created as long lived. When drawn by a PainterPacker whose
+    PainterBackend has a PainterPersistentDataStore (see
+    PainterBackend::persistent_data_store()), the packed data of a long
+    lived value is uploaded once to the PainterPersistentDataStore and
+    then referenced from there, instead of being copied to the
+    PainterDraw::m_store of each PainterDraw that uses it.
    */
   class PainterPackedValuePool:noncopyable
   {
@@ -213,41 +251,51 @@ namespace fastuidraw
       Create and return a PainterPackedValue<PainterBrush>
       object for the value of a PainterBrush object.
       \param value data to pack into returned PainterPackedValue
+      \param long_lived if true, the returned value is long lived, see
+                        PainterPackedValue::long_lived()
      */
     PainterPackedValue<PainterBrush>
-    create_packed_value(const PainterBrush &value);
+    create_packed_value(const PainterBrush &value, bool long_lived = false);
 
     /*!
       Create and return a PainterPackedValue<PainterClipEquations>
       object for the value of a PainterClipEquations object.
       \param value data to pack into returned PainterPackedValue
+      \param long_lived if true, the returned value is long lived, see
+                        PainterPackedValue::long_lived()
      */
     PainterPackedValue<PainterClipEquations>
-    create_packed_value(const PainterClipEquations &value);
+    create_packed_value(const PainterClipEquations &value, bool long_lived = false);
 
     /*!
       Create and return a PainterPackedValue<PainterItemMatrix>
       object for the value of a PainterItemMatrix object.
       \param value data to pack into returned PainterPackedValue
+      \param long_lived if true, the returned value is long lived, see
+                        PainterPackedValue::long_lived()
      */
     PainterPackedValue<PainterItemMatrix>
-    create_packed_value(const PainterItemMatrix &value);
+    create_packed_value(const PainterItemMatrix &value, bool long_lived = false);
 
     /*!
       Create and return a PainterPackedValue<PainterItemShaderData>
       object for the value of a PainterItemShaderData object.
       \param value data to pack into returned PainterPackedValue
+      \param long_lived if true, the returned value is long lived, see
+                        PainterPackedValue::long_lived()
      */
     PainterPackedValue<PainterItemShaderData>
-    create_packed_value(const PainterItemShaderData &value);
+    create_packed_value(const PainterItemShaderData &value, bool long_lived = false);
 
     /*!
       Create and return a PainterPackedValue<PainterBlendShaderData>
       object for the value of a PainterBlendShaderData object.
       \param value data to pack into returned PainterPackedValue
+      \param long_lived if true, the returned value is long lived, see
+                        PainterPackedValue::long_lived()
      */
     PainterPackedValue<PainterBlendShaderData>
-    create_packed_value(const PainterBlendShaderData &value);
+    create_packed_value(const PainterBlendShaderData &value, bool long_lived = false);
 
   private:
     void *m_d;
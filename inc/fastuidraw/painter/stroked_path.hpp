@@ -46,7 +46,7 @@ class PainterAttribute;
   of how one strokes the original path for drawing.
  */
 class StrokedPath:
-    public reference_counted<StrokedPath>::non_concurrent
+    public reference_counted<StrokedPath>::default_base
 {
 public:
   /*!
@@ -749,6 +749,96 @@ public:
   const PainterAttributeData&
   rounded_caps(float thresh) const;
 
+  /*!
+    Given a set of clip equations in clip coordinates
+    and a tranformation from local coordiante to clip
+    coordinates, compute what chunks of join data are
+    not completely culled by the clip equations. The
+    joins are kept in a hierarchy of bounding boxes
+    so that joins far from the clipping region are
+    rejected in groups.
+    \param scratch_space scratch space for computations.
+    \param join_data join data of this StrokedPath, i.e. as returned
+                     by bevel_joins(), miter_joins() or rounded_joins()
+    \param clip_equations array of clip equations
+    \param clip_matrix_local 3x3 transformation from local (x, y, 1)
+                             coordinates to clip coordinates.
+    \param recip_dimensions holds the reciprocal of the dimensions of the viewport
+    \param pixels_additional_room amount in -pixels- to push clip equations by
+                                  to grab additional joins, i.e. the stroking
+                                  radius in pixels
+    \param item_space_additional_room amount in local coordinates to push clip
+                                      equations by to grab additional joins,
+                                      i.e. the stroking radius in local
+                                      coordinates
+    \param include_closing_edges if true include the chunks needed to
+                                 draw the joins of the closing edges of
+                                 each contour
+    \param max_attribute_cnt only allow those chunks for which have no more
+                             than max_attribute_cnt attributes
+    \param max_index_cnt only allow those chunks for which have no more
+                         than max_index_cnt indices
+    \param[out] dst location to which to write the what chunks
+    \returns the number of chunks that intersect the clipping region,
+             that number is guarnanteed to be no more than
+             PainterAttributeData::attribute_data_chunks().size()
+             of join_data.
+   */
+  unsigned int
+  join_chunks(ScratchSpace &scratch_space,
+              const PainterAttributeData &join_data,
+              const_c_array<vec3> clip_equations,
+              const float3x3 &clip_matrix_local,
+              const vec2 &recip_dimensions,
+              float pixels_additional_room,
+              float item_space_additional_room,
+              bool include_closing_edges,
+              unsigned int max_attribute_cnt,
+              unsigned int max_index_cnt,
+              c_array<unsigned int> dst) const;
+
+  /*!
+    Given a set of clip equations in clip coordinates
+    and a tranformation from local coordiante to clip
+    coordinates, compute what chunks of cap data are
+    not completely culled by the clip equations. Chunk
+    0 of cap data holds all of the caps.
+    \param scratch_space scratch space for computations.
+    \param cap_data cap data of this StrokedPath, i.e. as returned
+                    by square_caps(), adjustable_caps() or rounded_caps()
+    \param clip_equations array of clip equations
+    \param clip_matrix_local 3x3 transformation from local (x, y, 1)
+                             coordinates to clip coordinates.
+    \param recip_dimensions holds the reciprocal of the dimensions of the viewport
+    \param pixels_additional_room amount in -pixels- to push clip equations by
+                                  to grab additional caps, i.e. the stroking
+                                  radius in pixels
+    \param item_space_additional_room amount in local coordinates to push clip
+                                      equations by to grab additional caps,
+                                      i.e. the stroking radius in local
+                                      coordinates
+    \param max_attribute_cnt only allow those chunks for which have no more
+                             than max_attribute_cnt attributes
+    \param max_index_cnt only allow those chunks for which have no more
+                         than max_index_cnt indices
+    \param[out] dst location to which to write the what chunks
+    \returns the number of chunks that intersect the clipping region,
+             that number is guarnanteed to be no more than
+             PainterAttributeData::attribute_data_chunks().size()
+             of cap_data.
+   */
+  unsigned int
+  cap_chunks(ScratchSpace &scratch_space,
+             const PainterAttributeData &cap_data,
+             const_c_array<vec3> clip_equations,
+             const float3x3 &clip_matrix_local,
+             const vec2 &recip_dimensions,
+             float pixels_additional_room,
+             float item_space_additional_room,
+             unsigned int max_attribute_cnt,
+             unsigned int max_index_cnt,
+             c_array<unsigned int> dst) const;
+
 private:
   void *m_d;
 };
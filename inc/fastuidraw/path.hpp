@@ -24,6 +24,7 @@
 #include <fastuidraw/util/vecN.hpp>
 #include <fastuidraw/util/c_array.hpp>
 #include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/task_pool.hpp>
 #include <fastuidraw/tessellated_path.hpp>
 
 namespace fastuidraw  {
@@ -40,7 +41,7 @@ namespace fastuidraw  {
   to the first point.
  */
 class PathContour:
-    public reference_counted<PathContour>::non_concurrent
+    public reference_counted<PathContour>::default_base
 {
 public:
 
@@ -50,7 +51,7 @@ public:
     the shape of an edge.
    */
   class interpolator_base:
-    public reference_counted<interpolator_base>::non_concurrent
+    public reference_counted<interpolator_base>::default_base
   {
   public:
     /*!
@@ -900,7 +901,13 @@ public:
     level of detail. The TessellatedPath is constructed
     lazily. Additionally, if this Path changes its geometry,
     then a new TessellatedPath will be contructed on the
-    next call to tessellation().
+    next call to tessellation(). It is safe to call
+    tessellation(), cached_tessellation() and
+    prefetch_tessellation() from multiple threads
+    simultaneously as long as the Path is not modified
+    while doing so. The levels of detail other than the
+    starting point tessellation may be evicted by
+    memory_accounting::enforce_budgets().
     \param thresh the returned tessellated path will be so that
                   TessellatedPath::effective_curve_distance_threshhold()
                   is no more than thresh. A non-positive value
@@ -911,6 +918,41 @@ public:
   const reference_counted_ptr<const TessellatedPath>&
   tessellation(float thresh) const;
 
+  /*!
+    Returns, without constructing any TessellatedPath, the
+    value that tessellation(float) const would return if
+    it is already constructed; otherwise returns the finest
+    TessellatedPath that is already constructed, which is a
+    nullptr handle if none has been constructed.
+    \param thresh threshhold as in tessellation(float) const
+    \param[out] out_is_match if non-nullptr, location to which to
+                             write true if the returned value is
+                             the same as tessellation(float) const
+                             would return.
+   */
+  reference_counted_ptr<const TessellatedPath>
+  cached_tessellation(float thresh, bool *out_is_match = nullptr) const;
+
+  /*!
+    Hand to a TaskPool the construction of the TessellatedPath
+    that tessellation(float) const returns for a threshhold.
+    Typical use is to prefetch the next finer level of detail
+    while drawing the current one or to tessellate large paths
+    at load time. Does nothing if the TessellatedPath is already
+    constructed or if a prefetch of an equal or finer level of
+    detail is pending. The construction is for the geometry of
+    the Path at the time of the call; if the Path is modified
+    afterwards the result of the prefetch is discarded.
+    \param thresh threshhold as in tessellation(float) const
+    \param task_pool TaskPool to perform the construction
+    \param with_filled if true, also construct TessellatedPath::filled()
+    \param with_stroked if true, also construct TessellatedPath::stroked()
+   */
+  void
+  prefetch_tessellation(float thresh, TaskPool &task_pool,
+                        bool with_filled = false,
+                        bool with_stroked = false) const;
+
   /*!
     Return the tessellation of this Path tessellated with the
     default values of TessellatedPath::TessellationParams.
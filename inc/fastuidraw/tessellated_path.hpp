@@ -41,7 +41,7 @@ class FilledPath;
   A TessellatedPath represents the tessellation of a Path.
  */
 class TessellatedPath:
-    public reference_counted<TessellatedPath>::non_concurrent
+    public reference_counted<TessellatedPath>::default_base
 {
 public:
   /*!
@@ -339,14 +339,20 @@ public:
 
   /*!
     Returns this TessellatedPath stroked. The StrokedPath object
-    is constructed lazily.
+    is constructed lazily; it is safe to call stroked() from
+    multiple threads simultaneously. The StrokedPath may be
+    evicted by memory_accounting::enforce_budgets(), in which
+    case it is constructed again on the next call.
    */
   const reference_counted_ptr<const StrokedPath>&
   stroked(void) const;
 
   /*!
     Returns this TessellatedPath filled. The FilledPath object
-    is constructed lazily.
+    is constructed lazily; it is safe to call filled() from
+    multiple threads simultaneously. The FilledPath may be
+    evicted by memory_accounting::enforce_budgets(), in which
+    case it is constructed again on the next call.
    */
   const reference_counted_ptr<const FilledPath>&
   filled(void) const;
@@ -87,7 +87,9 @@ namespace fastuidraw
 
     /*!
       To be implemented by a derived class to generate glyph
-      rendering data given a glyph code and GlyphRender.
+      rendering data given a glyph code and GlyphRender. The
+      method must be thread safe, i.e. GlyphCache::fetch_glyphs()
+      may call it from several threads at the same time.
       \param render specifies object to return via GlyphRender::type(),
                     it is guaranteed by the caller that can_create_rendering_data()
                     returns true on render.type()
@@ -43,6 +43,34 @@ namespace fastuidraw
   class FontFreeType:public FontBase
   {
   public:
+    /*!
+      Enumeration to specify how the distance values
+      of distance field glyphs are computed.
+     */
+    enum distance_field_generator_t
+      {
+        /*!
+          Compute the distance value of each texel
+          from the curves of the glyph. The texels
+          visited around each critical point of the
+          outline grow with the square of
+          distance_field_max_distance().
+         */
+        distance_field_exact,
+
+        /*!
+          Compute the distance values exactly only for those
+          texels next to the outline (and its critical points)
+          and propagate them to the remaining texels with a
+          linear time sweep. The cost does not depend on
+          distance_field_max_distance(). The values are the same
+          as those of \ref distance_field_exact except far from
+          the outline where they can be smaller (i.e. closer to
+          the true distance).
+         */
+        distance_field_sweep,
+      };
+
     /*!
       A RenderParams specifies the parameters
       for generating scalable glyph rendering data
@@ -103,6 +131,21 @@ namespace fastuidraw
       RenderParams&
       distance_field_max_distance(float v);
 
+      /*!
+        Specifies how the distance values of distance field
+        glyphs are computed.
+       */
+      enum distance_field_generator_t
+      distance_field_generator(void) const;
+
+      /*!
+        Set the value returned by distance_field_generator(void) const,
+        initial value is \ref distance_field_exact.
+        \param v value
+       */
+      RenderParams&
+      distance_field_generator(enum distance_field_generator_t v);
+
       /*!
         Pixel size at which to render curve pair scalable glyphs.
        */
@@ -164,6 +207,11 @@ namespace fastuidraw
 
     /*!
       Ctor. Create a font from file and guess the FontProperties from the FT_Face.
+      A font created from a file opens additional FT_Face objects from
+      the file as needed so that several threads can generate glyph
+      data from the font at the same time (see GlyphCache::fetch_glyphs());
+      fonts made from an FT_Face directly generate glyph data one
+      glyph at a time.
       \param filename from which to load the font
       \param lib FreetypeLib used to create FreeTypeFont object
       \param render_params specifies how to generate data for scalable glyph data
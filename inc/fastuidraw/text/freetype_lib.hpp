@@ -67,8 +67,25 @@ namespace fastuidraw
       return m_lib != nullptr;
     }
 
+    /*!
+      Aquire the lock of the FreetypeLib. libFreeType requires
+      that the creation and destruction of FT_Face objects from
+      the same FT_Library is not done concurrently; code that
+      creates or destroys FT_Face objects from lib() from several
+      threads should hold the lock while doing so.
+     */
+    void
+    lock(void);
+
+    /*!
+      Release the lock of the FreetypeLib, see lock().
+     */
+    void
+    unlock(void);
+
   private:
     FT_Library m_lib;
+    void *m_mutex;
   };
 /*! @} */
 };
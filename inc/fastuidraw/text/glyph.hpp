@@ -134,6 +134,47 @@ namespace fastuidraw
     enum return_code
     upload_to_atlas(void) const;
 
+    /*!
+      Marks the glyph as used in the current frame of the
+      GlyphAtlas of its GlyphCache (see GlyphAtlas::frame()),
+      without uploading it. A GlyphCache does not evict a
+      glyph used in the frame in progress. Painter::draw_glyphs()
+      calls mark_used() on each glyph of PainterAttributeData::glyphs().
+      The return value of valid() must be true. If not, debug
+      builds assert and release builds crash.
+     */
+    void
+    mark_used(void) const;
+
+    /*!
+      Pins the glyph: while the glyph is pinned, its GlyphCache
+      does not evict it, the GlyphAtlas does not move its geometry
+      data (see GlyphAtlas::compact_geometry_data()) and
+      GlyphCache::delete_glyph() and GlyphCache::clear_cache()
+      keep its slot until it is unpinned, so that data made from
+      the glyph, such as PainterAttributeData, stays valid. Calls
+      to pin() and unpin() nest. PainterAttributeData pins the
+      glyphs of its data and PainterCommandList the glyphs drawn
+      to it. GlyphCache::clear_atlas() and GlyphCache::clear_cache()
+      still remove pinned glyphs from the GlyphAtlas, so data made
+      from glyphs before either is called must be made again.
+      The return value of valid() must be true. If not, debug
+      builds assert and release builds crash.
+     */
+    void
+    pin(void) const;
+
+    /*!
+      Undo a call to pin(). If the glyph was deleted (see
+      GlyphCache::delete_glyph() and GlyphCache::clear_cache())
+      while pinned, the last unpin() completes the deletion, after
+      which the Glyph must not be used. The return value of valid()
+      must be true. If not, debug builds assert and release builds
+      crash.
+     */
+    void
+    unpin(void) const;
+
     /*!
       Returns the path of the Glyph.
      */
@@ -147,7 +147,7 @@ namespace fastuidraw
                         store.
       \param psize number of blocks, where each block is palignment generic_data
                    in size, that GlyphAtlasGeometryBackingStoreBase backs
-      \param presizable if true the object can be resized to be larger
+      \param presizable if true the object can be resized
      */
     GlyphAtlasGeometryBackingStoreBase(unsigned int palignment, unsigned int psize,
                                        bool presizable);
@@ -190,14 +190,18 @@ namespace fastuidraw
 
     /*!
       Returns true if and only if this object can be
-      resized to a larger size.
+      resized.
      */
     bool
     resizeable(void) const;
 
     /*!
-      Resize the object to a larger size. The routine resizeable()
-      must return true, if not the function asserts.
+      Resize the object. The routine resizeable() must return
+      true, if not the function asserts. GlyphAtlas makes the
+      object larger when geometry data does not fit and, once
+      compaction (see GlyphAtlas::compact_geometry_data()) frees
+      the end of the object, smaller, but not smaller than the
+      size passed to the ctor.
       \param new_size new size of object in number of blocks.
      */
     void
@@ -208,7 +212,10 @@ namespace fastuidraw
     /*!
       To be implemented by a derived class to resize the
       object. When called, the return value of size() is
-      the size before the resize completes.
+      the size before the resize completes. If the new size
+      is smaller, the content beyond it is no longer used and
+      values set there (see set_values()) that are not yet
+      flushed may be dropped.
       \param new_size new size in number of blocks
      */
     virtual
@@ -265,13 +272,39 @@ namespace fastuidraw
       unsigned int m_bottom;
     };
 
+    /*!
+      Enumeration of the ways a GlyphAtlas places the
+      regions allocated by allocate() within the layers
+      of its GlyphAtlasTexelBackingStoreBase.
+     */
+    enum texel_allocator_t
+      {
+        /*!
+          Each layer is a binary tree of regions, a region
+          holding a rectangle being split in three when
+          another rectangle is added to it.
+         */
+        tree_texel_allocator,
+
+        /*!
+          Each layer places rectangles with the skyline
+          bottom-left heuristic, reusing the room of freed
+          rectangles with guillotine splits. Typically packs
+          denser and allocates faster than \ref
+          tree_texel_allocator.
+         */
+        skyline_texel_allocator,
+      };
+
     /*!
       Ctor.
       \param ptexel_store GlyphAtlasTexelBackingStoreBase to which to store texel data
       \param pgeometry_store GlyphAtlasGeometryBackingStoreBase to which to store geometry data
+      \param ptexel_allocator how to place regions in the layers of ptexel_store
      */
     GlyphAtlas(reference_counted_ptr<GlyphAtlasTexelBackingStoreBase> ptexel_store,
-               reference_counted_ptr<GlyphAtlasGeometryBackingStoreBase> pgeometry_store);
+               reference_counted_ptr<GlyphAtlasGeometryBackingStoreBase> pgeometry_store,
+               enum texel_allocator_t ptexel_allocator = tree_texel_allocator);
 
     virtual
     ~GlyphAtlas();
@@ -307,12 +340,125 @@ namespace fastuidraw
     void
     deallocate_geometry_data(int location, int count);
 
+    /*!
+      Set the location to which to write the new location
+      of geometry data when compact_geometry_data() moves
+      it. Geometry data without such a location is never
+      moved. The location is forgotten when the geometry
+      data is deallocated.
+      \param location location of geometry data as returned
+                      by allocate_geometry_data()
+      \param location_ref location to which to write the new
+                          location of the geometry data, a
+                          nullptr value indicates that the
+                          geometry data is not to be moved
+     */
+    void
+    track_geometry_data(int location, int *location_ref);
+
+    /*!
+      Move geometry data that is tracked (see
+      track_geometry_data()) into the free room below it
+      in the geometry store, so that the free room of the
+      geometry store stays in one piece instead of growing
+      the geometry store to allocate geometry data that
+      does not fit in any of its holes; once the top three
+      quarters of a resizeable geometry store are free, the
+      store is made smaller, but not smaller than its
+      initial size. When no frame is in progress,
+      allocate_geometry_data() also moves geometry data,
+      without a time limit, before growing the geometry
+      store if the free room is enough but in pieces.
+      The work is
+      incremental: each call stops once it has run
+      for geometry_compaction_budget() microseconds and
+      the next call continues from where it stopped.
+      Does nothing if geometry_compaction_budget() is
+      zero or if a frame is in progress (see
+      frame_in_progress()). PainterPacker calls
+      compact_geometry_data() from PainterPacker::end().
+      Returns the number of geometry data moved.
+     */
+    unsigned int
+    compact_geometry_data(void);
+
+    /*!
+      Returns the number of microseconds compact_geometry_data()
+      may run. Default value is 0, i.e. geometry data is never
+      moved.
+     */
+    int64_t
+    geometry_compaction_budget(void) const;
+
+    /*!
+      Set the value returned by geometry_compaction_budget(void) const.
+      While the budget is non-zero, the GlyphAtlas keeps a copy
+      of the geometry data allocated, from which it writes the
+      data when it moves it; only geometry data allocated while
+      the budget is non-zero is moved. Setting the budget to zero
+      releases the copies. Moving geometry data changes the
+      location of glyphs in the GlyphAtlas; the geometry data
+      of a pinned glyph (see Glyph::pin()), which includes the
+      glyphs of a live PainterAttributeData or PainterCommandList,
+      is not moved, but data made from a glyph that is not
+      pinned must be made again once geometry_generation()
+      changes.
+      \param us number of microseconds
+     */
+    void
+    geometry_compaction_budget(int64_t us);
+
+    /*!
+      Returns a value that compact_geometry_data() increments
+      each time it moves geometry data. Data made from glyphs
+      that are not pinned (see Glyph::pin()) when the value
+      was different may refer to stale locations and must be
+      made again.
+     */
+    uint64_t
+    geometry_generation(void) const;
+
     /*!
       Frees all allocated regions of this GlyphAtlas;
      */
     void
     clear(void);
 
+    /*!
+      Increments an internal counter. If the counter was
+      zero, a new frame starts, i.e. the value returned by
+      frame() is incremented. PainterPacker calls
+      begin_frame() from PainterPacker::begin() and
+      end_frame() from PainterPacker::end(). A GlyphCache
+      uses the frame to know which glyphs are referenced
+      by draws not yet sent to the GPU, and thus which
+      glyphs it must not evict from this GlyphAtlas.
+     */
+    void
+    begin_frame(void);
+
+    /*!
+      Decrements the internal counter incremented by
+      begin_frame(). When it reaches zero, the frame
+      ends.
+     */
+    void
+    end_frame(void);
+
+    /*!
+      Returns the current frame, i.e. the number of frames
+      started by begin_frame().
+     */
+    uint64_t
+    frame(void) const;
+
+    /*!
+      Returns true if a frame is in progress, i.e. if
+      begin_frame() was called more often than end_frame().
+     */
+    bool
+    frame_in_progress(void) const;
+
     /*!
       Calls GlyphAtlasTexelBackingStoreBase::flush() on
       the texel backing store (see texel_store())
@@ -322,6 +468,13 @@ namespace fastuidraw
     void
     flush(void) const;
 
+    /*!
+      Returns how this GlyphAtlas places regions, as
+      passed in the ctor.
+     */
+    enum texel_allocator_t
+    texel_allocator(void) const;
+
     /*!
       Returns the texel store for this GlyphAtlas.
      */
@@ -20,6 +20,8 @@
 #pragma once
 
 #include <fastuidraw/util/reference_counted.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/task_pool.hpp>
 #include <fastuidraw/text/glyph_atlas.hpp>
 #include <fastuidraw/text/font.hpp>
 #include <fastuidraw/text/glyph_layout_data.hpp>
@@ -34,10 +36,59 @@ namespace fastuidraw
   /*!
     A GlyphCache represents a cache of glyphs and manages the uploading
     of the data to a GlyphAtlas. Methods are NOT thread safe.
+
+    A GlyphCache tracks the residency of its glyphs in the GlyphAtlas:
+    each call to Glyph::upload_to_atlas() or Glyph::mark_used() marks
+    the glyph as used in the current frame of the GlyphAtlas (see
+    GlyphAtlas::frame()); Painter::draw_glyphs() marks the glyphs it
+    draws, so glyphs drawn each frame from retained attribute data
+    are not evicted.
+    When the GlyphAtlas cannot allocate room for a glyph, the GlyphCache
+    evicts from the GlyphAtlas the least recently used glyphs, never
+    evicting a glyph used in the frame in progress (see
+    GlyphAtlas::frame_in_progress()), and tries again. An evicted
+    glyph stays in the GlyphCache and is uploaded again by the next
+    call to Glyph::upload_to_atlas(). A pinned glyph (see Glyph::pin()),
+    such as a glyph of a live PainterAttributeData, is never evicted
+    and its geometry data is never moved by
+    GlyphAtlas::compact_geometry_data(). Evicting or moving a glyph
+    that is not pinned changes its location in the GlyphAtlas, so
+    data made from it by other means than PainterAttributeData
+    must then be made again.
    */
   class GlyphCache:public reference_counted<GlyphCache>::default_base
   {
   public:
+    /*!
+      Enumeration to query the statistics of a GlyphCache.
+     */
+    enum stats_t
+      {
+        /*!
+          Number of glyphs evicted from the GlyphAtlas
+          to make room for other glyphs.
+         */
+        num_glyphs_evicted,
+
+        /*!
+          Number of uploads to the GlyphAtlas of glyphs
+          that were evicted (or removed by clear_atlas()).
+         */
+        num_glyphs_reuploaded,
+
+        /*!
+          Number of uploads to the GlyphAtlas that failed
+          even after evicting every glyph that could be
+          evicted.
+         */
+        num_upload_failures,
+
+        /*!
+          Number of stats.
+         */
+        num_stats
+      };
+
     /*!
       Ctor
       \param patlas GlyphAtlas to store glyph data
@@ -57,10 +108,37 @@ namespace fastuidraw
                 const reference_counted_ptr<const FontBase> &font,
                 uint32_t glyph_code);
 
+    /*!
+      Fetch, and if necessay create and store, a set of glyphs
+      of a font. The generation of the rendering data of those
+      glyphs not yet in the GlyphCache is spread across the
+      threads of a TaskPool (the calling thread participates
+      as well). After all data is generated, the calling thread
+      uploads the glyphs to the GlyphAtlas in the order of
+      glyph_codes (see Glyph::upload_to_atlas()).
+      \param render specifies how to render the glyphs
+      \param font font of the glyphs
+      \param glyph_codes glyph codes of the glyphs to fetch
+      \param[out] out_glyphs location to which to write the glyphs,
+                             out_glyphs[i] is the glyph for glyph_codes[i];
+                             must be atleast the size of glyph_codes
+      \param task_pool TaskPool used to generate the glyph data
+      \returns routine_fail if a glyph could not be uploaded to
+                the GlyphAtlas, otherwise routine_success
+     */
+    enum return_code
+    fetch_glyphs(GlyphRender render,
+                 const reference_counted_ptr<const FontBase> &font,
+                 const_c_array<uint32_t> glyph_codes,
+                 c_array<Glyph> out_glyphs,
+                 TaskPool &task_pool);
+
     /*!
       Removes a glyph from the -CACHE-, i.e. the GlyphCache,
       thus to use that glyph again requires calling fetch_glyph()
-      (and thus fetching a new value for Glyph).
+      (and thus fetching a new value for Glyph). If the glyph
+      is pinned (see Glyph::pin()), it is removed from the
+      GlyphAtlas and its slot reused only once it is unpinned.
      */
     void
     delete_glyph(Glyph);
@@ -79,10 +157,26 @@ namespace fastuidraw
 
     /*!
       Clear this GlyphCache and the GlyphAtlas. Essentially NUKE.
+      Pinned glyphs (see Glyph::pin()) are deleted once unpinned,
+      see delete_glyph().
      */
     void
     clear_cache(void);
 
+    /*!
+      Returns a stat of this GlyphCache, accumulated
+      since construction or the last call to reset_stats().
+      \param st stat to query
+     */
+    unsigned int
+    query_stat(enum stats_t st) const;
+
+    /*!
+      Sets all stats to zero.
+     */
+    void
+    reset_stats(void);
+
   private:
     void *m_d;
   };
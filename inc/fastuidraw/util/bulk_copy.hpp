@@ -0,0 +1,155 @@
+/*!
+ * \file bulk_copy.hpp
+ * \brief file bulk_copy.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fastuidraw
+{
+/*!\addtogroup Utility
+  @{
+ */
+
+  /*!
+    Bulk copy routines with which PainterPacker writes attribute
+    and index data to the arrays of a PainterDraw. The arrays of a
+    PainterDraw are often mapped GPU memory that is write-combined,
+    thus the vectorized implementations write with non-temporal
+    (streaming) stores that bypass the cache. The implementation
+    is chosen at runtime as the fastest one the CPU supports; it
+    can be changed with implementation(enum implementation_t),
+    which is mostly useful for benchmarking. All functions are
+    thread safe.
+   */
+  namespace bulk_copy
+  {
+    /*!
+      Enumeration of the implementations of bulk_copy.
+     */
+    enum implementation_t
+      {
+        /*!
+          Portable implementation, one element at a time.
+         */
+        scalar_implementation,
+
+        /*!
+          x86 implementation with 128-bit SSE2
+          loads and non-temporal stores.
+         */
+        sse2_implementation,
+
+        /*!
+          x86 implementation with 256-bit AVX2
+          loads and non-temporal stores.
+         */
+        avx2_implementation,
+
+        /*!
+          ARM implementation with 128-bit NEON loads and
+          stores; NEON has no non-temporal store intrinsic,
+          so the stores are regular stores.
+         */
+        neon_implementation,
+
+        /*!
+          Number of implementations.
+         */
+        number_implementations
+      };
+
+    /*!
+      Returns true if an implementation is compiled
+      in and supported by the CPU.
+      \param v implementation to query
+     */
+    bool
+    supported(enum implementation_t v);
+
+    /*!
+      Returns the implementation in use.
+     */
+    enum implementation_t
+    implementation(void);
+
+    /*!
+      Set the implementation to use. Returns false and
+      does nothing if the implementation is not supported.
+      Default value is the supported implementation with
+      the largest enumeration value.
+      \param v implementation to use
+     */
+    bool
+    implementation(enum implementation_t v);
+
+    /*!
+      Returns a string label of an implementation.
+      \param v implementation to query
+     */
+    const char*
+    label(enum implementation_t v);
+
+    /*!
+      Copy bytes, the same as std::memcpy.
+      \param dst destination, must not overlap with src
+      \param src source
+      \param number_bytes number of bytes to copy
+     */
+    void
+    copy(void *dst, const void *src, size_t number_bytes);
+
+    /*!
+      Copy 32-bit values adding a value to each,
+      i.e. dst[i] = src[i] + value.
+      \param dst destination, must not overlap with src
+      \param src source
+      \param count number of values to copy
+      \param value value to add
+     */
+    void
+    copy_add(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value);
+
+    /*!
+      Copy 32-bit values adding a value to each as copy_add()
+      does, but with regular stores that leave the written
+      values in the cache. To be used for an array that is
+      read back soon after, such as the indices PainterPacker
+      stages in deferred submission mode.
+      \param dst destination, must not overlap with src
+      \param src source
+      \param count number of values to copy
+      \param value value to add
+     */
+    void
+    copy_add_cached(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value);
+
+    /*!
+      Fill 32-bit values with a value,
+      i.e. dst[i] = value.
+      \param dst destination
+      \param count number of values to write
+      \param value value to write
+     */
+    void
+    fill(uint32_t *dst, size_t count, uint32_t value);
+  }
+/*! @} */
+}
@@ -0,0 +1,174 @@
+/*!
+ * \file memory_accounting.hpp
+ * \brief file memory_accounting.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+namespace fastuidraw
+{
+/*!\addtogroup Utility
+  @{
+ */
+
+  /*!
+    Accounting, in all builds, of the bytes of the data FastUIDraw
+    keeps in system memory for its larger objects, together with
+    soft budgets for the lazily built caches of that data. The
+    caches are never evicted behind the back of the application;
+    a budget is only enforced by a call to enforce_budgets().
+   */
+  namespace memory_accounting
+  {
+    /*!
+      Enumeration of the categories of memory that
+      are accounted.
+     */
+    enum category_t
+      {
+        /*!
+          Point and edge data of TessellatedPath objects;
+          enforce_budgets() evicts the levels of detail
+          a Path keeps (see Path::tessellation(float) const),
+          except the coarsest, of those Path objects whose
+          tessellation was least recently used.
+         */
+        tessellation,
+
+        /*!
+          PainterAttributeData of the Subset objects of
+          FilledPath objects; enforce_budgets() evicts the
+          FilledPath a TessellatedPath keeps (see
+          TessellatedPath::filled()) of those least
+          recently used.
+         */
+        filled_path_data,
+
+        /*!
+          PainterAttributeData of StrokedPath objects;
+          enforce_budgets() evicts the StrokedPath a
+          TessellatedPath keeps (see TessellatedPath::stroked())
+          of those least recently used.
+         */
+        stroked_path_data,
+
+        /*!
+          The data of GlyphRenderData objects, i.e. the
+          data from which GlyphCache uploads glyphs to
+          a GlyphAtlas, and the copy of the geometry data
+          a GlyphAtlas keeps to move it (see
+          GlyphAtlas::compact_geometry_data()). Not
+          evicted by enforce_budgets().
+         */
+        glyph_render_data,
+
+        /*!
+          The texels of the color and index tiles allocated
+          from ImageAtlas objects and the pixels of the mipmap
+          levels of Image objects not yet on their ImageAtlas
+          (see Image::refine()), at 4 bytes per texel. Not
+          evicted by enforce_budgets().
+         */
+        image_tiles,
+
+        /*!
+          The texels of the intervals allocated from
+          ColorStopAtlas objects, at 4 bytes per texel.
+          Not evicted by enforce_budgets().
+         */
+        colorstop_intervals,
+
+        /*!
+          Number of categories.
+         */
+        number_categories
+      };
+
+    /*!
+      Returns the number of bytes currently live of a category.
+      Thread safe.
+      \param c category to query
+     */
+    uint64_t
+    live_bytes(enum category_t c);
+
+    /*!
+      Returns the largest value live_bytes() has had
+      since the start of the process or the last call
+      to reset_peak_bytes().
+      \param c category to query
+     */
+    uint64_t
+    peak_bytes(enum category_t c);
+
+    /*!
+      Set the value of peak_bytes() of each
+      category to its current live_bytes().
+     */
+    void
+    reset_peak_bytes(void);
+
+    /*!
+      Returns a string label of a category.
+      \param c category to query
+     */
+    const char*
+    label(enum category_t c);
+
+    /*!
+      Returns the soft budget, in bytes, of a category; a
+      value of 0 indicates that the category has no budget.
+      \param c category to query
+     */
+    uint64_t
+    soft_budget(enum category_t c);
+
+    /*!
+      Set the soft budget of a category. Default value is 0,
+      i.e. no budget.
+      \param c category to set
+      \param v budget in bytes, 0 for no budget
+     */
+    void
+    soft_budget(enum category_t c, uint64_t v);
+
+    /*!
+      For each category whose live_bytes() exceeds its
+      soft_budget(), evict, least recently used first, the
+      caches of that category until the category is within
+      budget or no cache is left to evict. A cache used since
+      the previous call to enforce_budgets() is never evicted;
+      thus calling enforce_budgets() once per frame gives a
+      residency of a frame. Since data referenced by handles
+      held elsewhere is not freed, a category may remain above
+      its budget. Evicted caches are rebuilt on demand.
+
+      The references returned by Path::tessellation(float) const,
+      TessellatedPath::filled() and TessellatedPath::stroked() to
+      an evicted cache become invalid (handles copied from them
+      stay valid), thus enforce_budgets() is to be called at a
+      point where no other thread is using such references
+      (for example, between frames, after Painter::end()).
+      Returns the number of caches evicted.
+     */
+    unsigned int
+    enforce_budgets(void);
+  }
+/*! @} */
+}
@@ -0,0 +1,137 @@
+/*!
+ * \file task_pool.hpp
+ * \brief file task_pool.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/reference_counted.hpp>
+
+namespace fastuidraw
+{
+/*!\addtogroup Utility
+  @{
+ */
+
+  /*!
+    A TaskPool represents a set of worker threads that
+    execute TaskPool::Task objects in the order in which
+    they were added. A TaskPool is thread safe, i.e. tasks
+    can be added from any thread. The dtor of a TaskPool
+    waits for all added tasks to complete before returning.
+   */
+  class TaskPool:public reference_counted<TaskPool>::default_base
+  {
+  public:
+    /*!
+      A Task represents a unit of work to be executed
+      by one of the worker threads of a TaskPool.
+     */
+    class Task:public reference_counted<Task>::default_base
+    {
+    public:
+      Task(void);
+
+      virtual
+      ~Task();
+
+      /*!
+        Returns true if the Task has been executed,
+        i.e. run_task() has been called and returned.
+       */
+      bool
+      finished(void) const;
+
+      /*!
+        Blocks the calling thread until the Task has been
+        executed. It is an error to call wait() on a Task
+        that has neither been added to a TaskPool nor
+        had run() called on it.
+       */
+      void
+      wait(void) const;
+
+      /*!
+        If the Task has not yet started executing, executes
+        it on the calling thread; otherwise blocks until the
+        Task has finished executing. This allows for a thread
+        that needs the results of a Task to not wait on the
+        workers of the TaskPool to reach the Task.
+       */
+      void
+      run(void);
+
+    protected:
+      /*!
+        To be implemented by a derived class to perform
+        the work of the Task. The method is called exactly
+        once, either from a worker thread of the TaskPool to
+        which the Task was added or from run().
+       */
+      virtual
+      void
+      run_task(void) = 0;
+
+    private:
+      void *m_d;
+    };
+
+    /*!
+      Ctor.
+      \param number_threads number of worker threads to use; a value
+                            of 0 indicates to use as many threads as
+                            the system reports as hardware threads.
+     */
+    explicit
+    TaskPool(unsigned int number_threads = 0);
+
+    ~TaskPool();
+
+    /*!
+      Returns the number of worker threads of the TaskPool.
+     */
+    unsigned int
+    number_threads(void) const;
+
+    /*!
+      Add a Task to be executed by the TaskPool. A Task
+      may only be added once to a TaskPool.
+      \param task Task to execute
+     */
+    void
+    add_task(const reference_counted_ptr<Task> &task);
+
+    /*!
+      Returns the number of Task objects added to the
+      TaskPool that have not yet finished executing.
+     */
+    unsigned int
+    number_pending_tasks(void) const;
+
+    /*!
+      Blocks until every Task added to the TaskPool
+      has finished executing.
+     */
+    void
+    wait_all(void);
+
+  private:
+    void *m_d;
+  };
+
+/*! @} */
+}
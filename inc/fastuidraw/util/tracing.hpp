@@ -0,0 +1,284 @@
+/*!
+ * \file tracing.hpp
+ * \brief file tracing.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+#include <ostream>
+
+namespace fastuidraw
+{
+/*!\addtogroup Utility
+  @{
+ */
+
+  /*!
+    Tracing of the time spent in the stages of drawing with a
+    Painter, together with counters of the data sent to the
+    PainterBackend. Zones are recorded with FASTUIDRAWtrace_zone
+    into a ring buffer per thread, so that recording does not
+    contend between threads, and are exported in the Chrome
+    trace-event JSON format (viewable with chrome://tracing or
+    Perfetto) by write_chrome_trace(). Recording is off until
+    enabled(true) is called; FastUIDraw records zones and
+    counters only if it is built with the macro
+    FASTUIDRAW_TRACING defined (the Makefile variable
+    ENABLE_TRACING, which is 0 by default), otherwise FASTUIDRAWtrace_zone and
+    FASTUIDRAWtrace_counter expand to nothing.
+   */
+  namespace tracing
+  {
+    /*!
+      Enumeration of the counters of tracing, see
+      counter(). The values are cumulative since
+      the last call to reset().
+     */
+    enum counter_t
+      {
+        /*!
+          Number of draw breaks because the blend
+          mode (PainterShaderGroup::blend_mode())
+          changed.
+         */
+        draw_breaks_blend_mode,
+
+        /*!
+          Number of draw breaks because the item shader
+          group (PainterShaderGroup::item_group()) changed.
+         */
+        draw_breaks_item_shader_group,
+
+        /*!
+          Number of draw breaks because the blend shader
+          group (PainterShaderGroup::blend_group()) changed.
+         */
+        draw_breaks_blend_shader_group,
+
+        /*!
+          Number of draw breaks because the brush
+          shader (PainterShaderGroup::brush()) changed
+          in bits the PainterBackend breaks on.
+         */
+        draw_breaks_brush_shader,
+
+        /*!
+          Number of draw breaks at which the backend switched
+          between drawing with and without discard, see
+          gl::PainterBackendGL::ConfigurationGL::separate_program_for_discard().
+         */
+        draw_breaks_discard,
+
+        /*!
+          Number of bytes of attribute data
+          (PainterDraw::m_attributes) written.
+         */
+        attribute_bytes,
+
+        /*!
+          Number of bytes of header attribute data
+          (PainterDraw::m_header_attributes) written.
+         */
+        header_attribute_bytes,
+
+        /*!
+          Number of bytes of index data
+          (PainterDraw::m_indices) written.
+         */
+        index_bytes,
+
+        /*!
+          Number of bytes of data store data
+          (PainterDraw::m_store) written.
+         */
+        data_store_bytes,
+
+        /*!
+          Number of nanoseconds a PainterBackend spent
+          waiting for the GPU to release the buffers
+          it streams to.
+         */
+        buffer_wait_nanoseconds,
+
+        /*!
+          Number of counters.
+         */
+        number_counters
+      };
+
+    /*!
+      Returns true if zones and counters are being recorded.
+     */
+    bool
+    enabled(void);
+
+    /*!
+      Set if zones and counters are recorded.
+      Default value is false.
+      \param v value to use
+     */
+    void
+    enabled(bool v);
+
+    /*!
+      Returns true if FastUIDraw was built with
+      tracing, i.e. with FASTUIDRAW_TRACING defined.
+     */
+    bool
+    compiled_in(void);
+
+    /*!
+      Returns the number of zones each thread's ring
+      buffer holds; once full, the oldest zones of the
+      thread are overwritten. A ring buffer grows as
+      zones are recorded up to that size.
+     */
+    unsigned int
+    ring_buffer_size(void);
+
+    /*!
+      Set the value returned by ring_buffer_size(), only
+      affects threads that have not yet recorded a zone.
+      Default value is 65536.
+      \param v value to use
+     */
+    void
+    ring_buffer_size(unsigned int v);
+
+    /*!
+      Returns the current time in nanoseconds since an
+      arbitrary but fixed point of the process.
+     */
+    uint64_t
+    time_nanoseconds(void);
+
+    /*!
+      Record a zone of the calling thread; it is recommended
+      to use FASTUIDRAWtrace_zone (or ScopedZone) instead.
+      \param name name of the zone, the string must stay
+                  alive until the zone is exported (string
+                  literals are ideal)
+      \param begin_ns time_nanoseconds() at the start of the zone
+      \param end_ns time_nanoseconds() at the end of the zone
+     */
+    void
+    add_zone(const char *name, uint64_t begin_ns, uint64_t end_ns);
+
+    /*!
+      Add to a counter if enabled() is true. Thread safe.
+      \param c counter to add to
+      \param v amount to add
+     */
+    void
+    add_counter(enum counter_t c, uint64_t v);
+
+    /*!
+      Returns the value of a counter.
+      \param c counter to query
+     */
+    uint64_t
+    counter(enum counter_t c);
+
+    /*!
+      Returns a string label of a counter.
+      \param c counter to query
+     */
+    const char*
+    counter_label(enum counter_t c);
+
+    /*!
+      Discard all recorded zones, releasing the memory
+      of the ring buffers, forget the threads that have
+      exited and set all counters to zero.
+     */
+    void
+    reset(void);
+
+    /*!
+      Write the zones recorded and the current value of the
+      counters as Chrome trace-event JSON. Zones recorded by a
+      thread while write_chrome_trace() runs may or may not be
+      in the output.
+      \param str stream to which to write
+     */
+    void
+    write_chrome_trace(std::ostream &str);
+
+    /*!
+      A ScopedZone records a zone from its construction
+      to its destruction if enabled() is true at its
+      construction.
+     */
+    class ScopedZone
+    {
+    public:
+      /*!
+        Ctor.
+        \param name name of the zone, see add_zone()
+       */
+      explicit
+      ScopedZone(const char *name):
+        m_name(enabled() ? name : nullptr),
+        m_begin(m_name ? time_nanoseconds() : 0u)
+      {}
+
+      ~ScopedZone()
+      {
+        if(m_name)
+          {
+            add_zone(m_name, m_begin, time_nanoseconds());
+          }
+      }
+
+    private:
+      ScopedZone(const ScopedZone&);
+
+      ScopedZone&
+      operator=(const ScopedZone&);
+
+      const char *m_name;
+      uint64_t m_begin;
+    };
+  }
+/*! @} */
+}
+
+/*!\def FASTUIDRAWtrace_zone
+  Records a zone (see fastuidraw::tracing::ScopedZone) from
+  the macro to the end of the enclosing scope; expands to
+  nothing if FASTUIDRAW_TRACING is not defined.
+  \param name name of the zone, should be a string literal
+ */
+
+/*!\def FASTUIDRAWtrace_counter
+  Adds to a counter (see fastuidraw::tracing::add_counter());
+  expands to nothing if FASTUIDRAW_TRACING is not defined.
+  \param c counter, an enumeration of fastuidraw::tracing::counter_t
+  \param v amount to add
+ */
+#ifdef FASTUIDRAW_TRACING
+  #define FASTUIDRAWtrace_zone_concat_implement(X, Y) X##Y
+  #define FASTUIDRAWtrace_zone_concat(X, Y) FASTUIDRAWtrace_zone_concat_implement(X, Y)
+  #define FASTUIDRAWtrace_zone(name) \
+    fastuidraw::tracing::ScopedZone FASTUIDRAWtrace_zone_concat(fastuidraw_trace_zone_, __LINE__)(name)
+  #define FASTUIDRAWtrace_counter(c, v) \
+    fastuidraw::tracing::add_counter(fastuidraw::tracing::c, v)
+#else
+  #define FASTUIDRAWtrace_zone(name) do {} while(0)
+  #define FASTUIDRAWtrace_counter(c, v) do {} while(0)
+#endif
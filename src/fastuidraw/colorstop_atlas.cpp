@@ -21,6 +21,7 @@
 #include <fastuidraw/colorstop_atlas.hpp>
 #include "private/interval_allocator.hpp"
 #include "private/util_private.hpp"
+#include "private/memory_accounting_private.hpp"
 
 namespace
 {
@@ -76,6 +77,7 @@ namespace
 
     fastuidraw::reference_counted_ptr<fastuidraw::ColorStopBackingStore> m_backing_store;
     int m_allocated;
+    fastuidraw::detail::AccountedBytes m_bytes;
 
     /* Each layer has an interval allocator to allocate
        and free "color stop arrays"
@@ -119,7 +121,8 @@ ColorStopAtlasPrivate::
 ColorStopAtlasPrivate(fastuidraw::reference_counted_ptr<fastuidraw::ColorStopBackingStore> pbacking_store):
   m_delayed_interval_freeing_counter(0),
   m_backing_store(pbacking_store),
-  m_allocated(0)
+  m_allocated(0),
+  m_bytes(fastuidraw::memory_accounting::colorstop_intervals)
 {
   assert(m_backing_store);
   add_bookkeeping(m_backing_store->dimensions().y());
@@ -178,6 +181,7 @@ deallocate_implement(fastuidraw::ivec2 location, int width)
       m_available_layers[new_max].insert(y);
     }
   m_allocated -= width;
+  m_bytes.bytes(m_allocated * sizeof(fastuidraw::u8vec4));
 }
 
 /////////////////////////////////////
@@ -419,6 +423,7 @@ allocate(const_c_array<u8vec4> data)
   d->m_backing_store->set_data(return_value.x(), return_value.y(),
                                width, data);
   d->m_allocated += width;
+  d->m_bytes.bytes(d->m_allocated * sizeof(u8vec4));
   return return_value;
 }
 
@@ -29,7 +29,9 @@
 #include <list>
 #include <algorithm>
 #include <sstream>
+#include <cstdio>
 #include <stdint.h>
+#include <unistd.h>
 #include <sys/time.h>
 
 #include <fastuidraw/util/static_resource.hpp>
@@ -37,6 +39,7 @@
 #include <fastuidraw/gl_backend/gl_get.hpp>
 #include <fastuidraw/gl_backend/gl_context_properties.hpp>
 #include <fastuidraw/gl_backend/gl_program.hpp>
+#include "../private/util_private.hpp"
 
 namespace
 {
@@ -575,6 +578,56 @@ namespace
     std::vector<AtomicBufferInfo> m_abo_buffers;
   };
 
+  class ProgramBinaryCachePrivate:fastuidraw::noncopyable
+  {
+  public:
+    explicit
+    ProgramBinaryCachePrivate(const char *directory):
+      m_directory(directory),
+      m_number_hits(0),
+      m_number_misses(0),
+      m_number_rejected(0)
+    {}
+
+    std::string
+    filename(const char *key) const
+    {
+      return m_directory + "/" + key + ".bin";
+    }
+
+    /* the file of an entry is a header followed by the
+       bytes of the binary as returned by glGetProgramBinary
+     */
+    class Header
+    {
+    public:
+      enum
+        {
+          /* bump when the layout of the file changes */
+          version = 1
+        };
+
+      char m_magic[8];
+      uint32_t m_version;
+      uint32_t m_binary_format;
+      uint32_t m_binary_length;
+      uint32_t m_padding;
+    };
+
+    static
+    const char*
+    magic(void)
+    {
+      return "FUIDPBIN";
+    }
+
+    std::string m_directory;
+    mutable fastuidraw::mutex m_mutex;
+    unsigned int m_number_hits;
+    unsigned int m_number_misses;
+    unsigned int m_number_rejected;
+  };
+
   class ShaderData
   {
   public:
@@ -593,12 +646,17 @@ namespace
     ProgramPrivate(const fastuidraw::const_c_array<ShaderRef> pshaders,
                    const fastuidraw::gl::PreLinkActionArray &action,
                    const fastuidraw::gl::ProgramInitializerArray &initers,
+                   const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> &binary_cache,
+                   const char *binary_cache_key,
                    fastuidraw::gl::Program *p):
       m_shaders(pshaders.begin(), pshaders.end()),
       m_name(0),
       m_assembled(false),
+      m_from_binary_cache(false),
       m_initializers(initers),
       m_pre_link_actions(action),
+      m_binary_cache(binary_cache),
+      m_binary_cache_key(binary_cache_key ? binary_cache_key : ""),
       m_p(p)
     {
     }
@@ -607,11 +665,16 @@ namespace
                    fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> frag_shader,
                    const fastuidraw::gl::PreLinkActionArray &action,
                    const fastuidraw::gl::ProgramInitializerArray &initers,
+                   const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> &binary_cache,
+                   const char *binary_cache_key,
                    fastuidraw::gl::Program *p):
       m_name(0),
       m_assembled(false),
+      m_from_binary_cache(false),
       m_initializers(initers),
       m_pre_link_actions(action),
+      m_binary_cache(binary_cache),
+      m_binary_cache_key(binary_cache_key ? binary_cache_key : ""),
       m_p(p)
     {
       m_shaders.push_back(vert_shader);
@@ -622,11 +685,16 @@ namespace
                    const fastuidraw::glsl::ShaderSource &frag_shader,
                    const fastuidraw::gl::PreLinkActionArray &action,
                    const fastuidraw::gl::ProgramInitializerArray &initers,
+                   const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> &binary_cache,
+                   const char *binary_cache_key,
                    fastuidraw::gl::Program *p):
       m_name(0),
       m_assembled(false),
+      m_from_binary_cache(false),
       m_initializers(initers),
       m_pre_link_actions(action),
+      m_binary_cache(binary_cache),
+      m_binary_cache_key(binary_cache_key ? binary_cache_key : ""),
       m_p(p)
     {
       m_shaders.push_back(FASTUIDRAWnew fastuidraw::gl::Shader(vert_shader, GL_VERTEX_SHADER));
@@ -637,7 +705,16 @@ namespace
     assemble(fastuidraw::gl::Program *program);
 
     void
-    clear_shaders_and_save_shader_data(void);
+    clear_shaders_and_save_shader_data(bool shaders_compiled);
+
+    bool
+    link_program(void);
+
+    bool
+    load_from_binary_cache(void);
+
+    std::string
+    compute_binary_cache_key(void);
 
     void
     generate_log(void);
@@ -647,7 +724,7 @@ namespace
     std::map<GLenum, std::vector<int> > m_shader_data_sorted_by_type;
 
     GLuint m_name;
-    bool m_link_success, m_assembled;
+    bool m_link_success, m_assembled, m_from_binary_cache;
     std::string m_link_log;
     std::string m_log;
     float m_assemble_time;
@@ -658,8 +735,68 @@ namespace
     ShaderStorageBlockSetInfo m_storage_buffer_list;
     fastuidraw::gl::ProgramInitializerArray m_initializers;
     fastuidraw::gl::PreLinkActionArray m_pre_link_actions;
+    fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> m_binary_cache;
+    std::string m_binary_cache_key;
+    std::string m_binary_cache_entry;
     fastuidraw::gl::Program *m_p;
   };
+
+  /* 64-bit FNV-1a hash */
+  class StringHasher
+  {
+  public:
+    StringHasher(void):
+      m_value(0xcbf29ce484222325ull)
+    {}
+
+    StringHasher&
+    add(const char *str)
+    {
+      /* include the terminator so that concatenations
+         of different strings hash differently
+       */
+      for(; *str; ++str)
+        {
+          add_byte(static_cast<uint8_t>(*str));
+        }
+      add_byte(0);
+      return *this;
+    }
+
+    StringHasher&
+    add(uint32_t v)
+    {
+      for(unsigned int i = 0; i < 4; ++i, v >>= 8u)
+        {
+          add_byte(static_cast<uint8_t>(v & 0xFF));
+        }
+      return *this;
+    }
+
+    uint64_t
+    value(void) const
+    {
+      return m_value;
+    }
+
+  private:
+    void
+    add_byte(uint8_t v)
+    {
+      m_value ^= v;
+      m_value *= 0x100000001b3ull;
+    }
+
+    uint64_t m_value;
+  };
+
+  const char*
+  gl_string(GLenum tp)
+  {
+    const GLubyte *str;
+    str = glGetString(tp);
+    return (str) ? reinterpret_cast<const char*>(str) : "";
+  }
 }
 
 /////////////////////////////////////////
@@ -2113,61 +2250,38 @@ assemble(fastuidraw::gl::Program *program)
   struct timeval start_time, end_time;
   gettimeofday(&start_time, nullptr);
 
-  std::ostringstream error_ostr;
-
   m_assembled = true;
   assert(m_name == 0);
-  m_name = glCreateProgram();
-  m_link_success = true;
 
-  //attatch the shaders, attaching a bad shader makes
-  //m_link_success become false
-  for(std::vector<fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> >::iterator iter = m_shaders.begin(),
-        end = m_shaders.end(); iter != end; ++iter)
+  if(m_binary_cache && fastuidraw::gl::ProgramBinaryCache::program_binary_supported())
     {
-      if((*iter)->compile_success())
-        {
-          glAttachShader(m_name, (*iter)->name());
-        }
-      else
-        {
-          m_link_success = false;
-        }
+      m_binary_cache_entry = compute_binary_cache_key();
+      m_from_binary_cache = load_from_binary_cache();
     }
 
-  //we no longer need the GL shaders.
-  clear_shaders_and_save_shader_data();
-
-  //perform any pre-link actions and then clear them
-  m_pre_link_actions.execute_actions(m_name);
-  m_pre_link_actions = fastuidraw::gl::PreLinkActionArray();
-
-  //now finally link!
-  glLinkProgram(m_name);
+  if(m_from_binary_cache)
+    {
+      m_link_success = true;
+      m_link_log = "\n-----------------------\nLoaded from program binary cache";
+    }
+  else
+    {
+      m_link_success = link_program();
+    }
 
   gettimeofday(&end_time, nullptr);
   m_assemble_time = float(end_time.tv_sec - start_time.tv_sec)
     + float(end_time.tv_usec - start_time.tv_usec) / 1e6f;
 
-  //retrieve the log fun
-  std::vector<char> raw_log;
-  GLint logSize, linkOK;
-
-  glGetProgramiv(m_name, GL_LINK_STATUS, &linkOK);
-  glGetProgramiv(m_name, GL_INFO_LOG_LENGTH, &logSize);
-
-  raw_log.resize(logSize+2);
-  glGetProgramInfoLog(m_name, logSize+1, nullptr , &raw_log[0]);
-
-  error_ostr << "\n-----------------------\n" << &raw_log[0];
-
-  m_link_log = error_ostr.str();
-  m_link_success = m_link_success and (linkOK == GL_TRUE);
-
   if(m_link_success)
     {
       fastuidraw::gl::ContextProperties ctx_props;
 
+      if(!m_from_binary_cache && !m_binary_cache_entry.empty())
+        {
+          m_binary_cache->save_program_binary(m_binary_cache_entry.c_str(), m_name);
+        }
+
       m_uniform_list.populate(m_name, ctx_props);
       m_attribute_list.populate(m_name, ctx_props);
       m_storage_buffer_list.populate(m_name, ctx_props);
@@ -2220,17 +2334,133 @@ assemble(fastuidraw::gl::Program *program)
   m_initializers.clear();
 }
 
+bool
+ProgramPrivate::
+load_from_binary_cache(void)
+{
+  m_name = glCreateProgram();
+
+  /* the pre-link actions are executed so that any state
+     they set that is not part of the program binary is
+     still applied to the program.
+   */
+  m_pre_link_actions.execute_actions(m_name);
+  if(m_binary_cache->load_program_binary(m_binary_cache_entry.c_str(), m_name))
+    {
+      //the shaders are never compiled.
+      clear_shaders_and_save_shader_data(false);
+      m_pre_link_actions = fastuidraw::gl::PreLinkActionArray();
+      return true;
+    }
+
+  /* a program on which glProgramBinary failed is left
+     in an unlinked state; start over with a fresh program
+     to compile and link from source.
+   */
+  glDeleteProgram(m_name);
+  m_name = 0;
+  return false;
+}
+
+bool
+ProgramPrivate::
+link_program(void)
+{
+  std::ostringstream error_ostr;
+  bool return_value(true);
+
+  m_name = glCreateProgram();
+
+  //attatch the shaders, attaching a bad shader makes
+  //the link fail
+  for(std::vector<fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> >::iterator iter = m_shaders.begin(),
+        end = m_shaders.end(); iter != end; ++iter)
+    {
+      if((*iter)->compile_success())
+        {
+          glAttachShader(m_name, (*iter)->name());
+        }
+      else
+        {
+          return_value = false;
+        }
+    }
+
+  //we no longer need the GL shaders.
+  clear_shaders_and_save_shader_data(true);
+
+  //perform any pre-link actions and then clear them
+  m_pre_link_actions.execute_actions(m_name);
+  m_pre_link_actions = fastuidraw::gl::PreLinkActionArray();
+
+  if(!m_binary_cache_entry.empty())
+    {
+      glProgramParameteri(m_name, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+  //now finally link!
+  glLinkProgram(m_name);
+
+  //retrieve the log fun
+  std::vector<char> raw_log;
+  GLint logSize, linkOK;
+
+  glGetProgramiv(m_name, GL_LINK_STATUS, &linkOK);
+  glGetProgramiv(m_name, GL_INFO_LOG_LENGTH, &logSize);
+
+  raw_log.resize(logSize+2);
+  glGetProgramInfoLog(m_name, logSize+1, nullptr , &raw_log[0]);
+
+  error_ostr << "\n-----------------------\n" << &raw_log[0];
+
+  m_link_log = error_ostr.str();
+  return return_value && (linkOK == GL_TRUE);
+}
+
+std::string
+ProgramPrivate::
+compute_binary_cache_key(void)
+{
+  StringHasher hasher;
+  std::ostringstream str;
+
+  for(std::vector<fastuidraw::reference_counted_ptr<fastuidraw::gl::Shader> >::iterator iter = m_shaders.begin(),
+        end = m_shaders.end(); iter != end; ++iter)
+    {
+      hasher
+        .add(static_cast<uint32_t>((*iter)->shader_type()))
+        .add((*iter)->source_code());
+    }
+
+  hasher
+    .add(m_binary_cache_key.c_str())
+    .add(gl_string(GL_VENDOR))
+    .add(gl_string(GL_RENDERER))
+    .add(gl_string(GL_VERSION));
+
+  str << std::hex << std::setw(16) << std::setfill('0') << hasher.value();
+  return str.str();
+}
+
 void
 ProgramPrivate::
-clear_shaders_and_save_shader_data(void)
+clear_shaders_and_save_shader_data(bool shaders_compiled)
 {
   m_shader_data.resize(m_shaders.size());
   for(unsigned int i = 0, endi = m_shaders.size(); i<endi; ++i)
     {
       m_shader_data[i].m_source_code = m_shaders[i]->source_code();
-      m_shader_data[i].m_name = m_shaders[i]->name();
       m_shader_data[i].m_shader_type = m_shaders[i]->shader_type();
-      m_shader_data[i].m_compile_log = m_shaders[i]->compile_log();
+      if(shaders_compiled)
+        {
+          m_shader_data[i].m_name = m_shaders[i]->name();
+          m_shader_data[i].m_compile_log = m_shaders[i]->compile_log();
+        }
+      else
+        {
+          m_shader_data[i].m_name = 0;
+          m_shader_data[i].m_compile_log = "Not compiled, program loaded from program binary cache";
+        }
       m_shader_data_sorted_by_type[m_shader_data[i].m_shader_type].push_back(i);
     }
   m_shaders.clear();
@@ -2357,32 +2587,264 @@ generate_log(void)
   m_log = ostr.str();
 }
 
+////////////////////////////////////////////////////////
+//fastuidraw::gl::ProgramBinaryCache methods
+fastuidraw::gl::ProgramBinaryCache::
+ProgramBinaryCache(const char *directory)
+{
+  m_d = FASTUIDRAWnew ProgramBinaryCachePrivate(directory);
+}
+
+fastuidraw::gl::ProgramBinaryCache::
+~ProgramBinaryCache()
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+const char*
+fastuidraw::gl::ProgramBinaryCache::
+directory(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  return d->m_directory.c_str();
+}
+
+bool
+fastuidraw::gl::ProgramBinaryCache::
+program_binary_supported(void)
+{
+  ContextProperties ctx_props;
+  bool has_api;
+
+  if(ctx_props.is_es())
+    {
+      has_api = ctx_props.version() >= ivec2(3, 0);
+    }
+  else
+    {
+      has_api = ctx_props.version() >= ivec2(4, 1)
+        || ctx_props.has_extension("GL_ARB_get_program_binary");
+    }
+
+  return has_api && context_get<GLint>(GL_NUM_PROGRAM_BINARY_FORMATS) > 0;
+}
+
+bool
+fastuidraw::gl::ProgramBinaryCache::
+load_program_binary(const char *key, GLuint program)
+{
+  ProgramBinaryCachePrivate *d;
+  ProgramBinaryCachePrivate::Header header;
+  std::vector<uint8_t> binary;
+  bool found, usable;
+
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  std::ifstream file(d->filename(key).c_str(), std::ios::binary);
+  found = bool(file);
+  usable = found;
+
+  if(usable)
+    {
+      file.read(reinterpret_cast<char*>(&header), sizeof(header));
+      usable = file
+        && std::memcmp(header.m_magic, ProgramBinaryCachePrivate::magic(), sizeof(header.m_magic)) == 0
+        && header.m_version == ProgramBinaryCachePrivate::Header::version
+        && header.m_binary_length > 0;
+    }
+
+  if(usable)
+    {
+      binary.resize(header.m_binary_length);
+      file.read(reinterpret_cast<char*>(&binary[0]), binary.size());
+      usable = bool(file);
+    }
+
+  if(usable)
+    {
+      /* the format stored may not be supported by the
+         GL implementation, for example if the driver
+         changed since the entry was created.
+       */
+      std::vector<GLint> formats;
+
+      formats.resize(context_get<GLint>(GL_NUM_PROGRAM_BINARY_FORMATS));
+      if(!formats.empty())
+        {
+          glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, &formats[0]);
+        }
+      usable = std::find(formats.begin(), formats.end(),
+                         static_cast<GLint>(header.m_binary_format)) != formats.end();
+    }
+
+  if(usable)
+    {
+      GLint linkOK;
+
+      /* the GL implementation is allowed to reject a binary
+         even if the format is supported, which is reported
+         by the link status being false.
+       */
+      glProgramBinary(program, header.m_binary_format, &binary[0], binary.size());
+      glGetProgramiv(program, GL_LINK_STATUS, &linkOK);
+      usable = (linkOK == GL_TRUE);
+    }
+
+  autolock_mutex M(d->m_mutex);
+  if(usable)
+    {
+      ++d->m_number_hits;
+    }
+  else
+    {
+      ++d->m_number_misses;
+      if(found)
+        {
+          ++d->m_number_rejected;
+        }
+    }
+
+  return usable;
+}
+
+bool
+fastuidraw::gl::ProgramBinaryCache::
+save_program_binary(const char *key, GLuint program)
+{
+  ProgramBinaryCachePrivate *d;
+  ProgramBinaryCachePrivate::Header header;
+  std::vector<uint8_t> binary;
+  std::string filename, tmp_filename;
+  GLint length(0), linkOK(GL_FALSE);
+  GLsizei written(0);
+  GLenum format(GL_NONE);
+
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+
+  glGetProgramiv(program, GL_LINK_STATUS, &linkOK);
+  if(linkOK != GL_TRUE)
+    {
+      return false;
+    }
+
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if(length <= 0)
+    {
+      return false;
+    }
+
+  binary.resize(length);
+  glGetProgramBinary(program, length, &written, &format, &binary[0]);
+  if(written <= 0)
+    {
+      return false;
+    }
+
+  std::memcpy(header.m_magic, ProgramBinaryCachePrivate::magic(), sizeof(header.m_magic));
+  header.m_version = ProgramBinaryCachePrivate::Header::version;
+  header.m_binary_format = format;
+  header.m_binary_length = written;
+  header.m_padding = 0;
+
+  /* write to a temporary file first and rename it so that
+     a process reading the entry never sees a partial file.
+   */
+  filename = d->filename(key);
+  {
+    std::ostringstream str;
+    str << filename << "." << getpid() << ".tmp";
+    tmp_filename = str.str();
+  }
+
+  {
+    std::ofstream file(tmp_filename.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&binary[0]), written);
+    if(!file)
+      {
+        file.close();
+        std::remove(tmp_filename.c_str());
+        return false;
+      }
+  }
+
+  if(std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+      std::remove(tmp_filename.c_str());
+      return false;
+    }
+  return true;
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_hits(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  autolock_mutex M(d->m_mutex);
+  return d->m_number_hits;
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_misses(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  autolock_mutex M(d->m_mutex);
+  return d->m_number_misses;
+}
+
+unsigned int
+fastuidraw::gl::ProgramBinaryCache::
+number_rejected(void) const
+{
+  ProgramBinaryCachePrivate *d;
+  d = static_cast<ProgramBinaryCachePrivate*>(m_d);
+  autolock_mutex M(d->m_mutex);
+  return d->m_number_rejected;
+}
+
 ////////////////////////////////////////////////////////
 //fastuidraw::gl::Program methods
 fastuidraw::gl::Program::
 Program(const_c_array<reference_counted_ptr<Shader> > pshaders,
         const PreLinkActionArray &action,
-        const ProgramInitializerArray &initers)
+        const ProgramInitializerArray &initers,
+        const reference_counted_ptr<ProgramBinaryCache> &binary_cache,
+        const char *binary_cache_key)
 {
-  m_d = FASTUIDRAWnew ProgramPrivate(pshaders, action, initers, this);
+  m_d = FASTUIDRAWnew ProgramPrivate(pshaders, action, initers,
+                                     binary_cache, binary_cache_key, this);
 }
 
 fastuidraw::gl::Program::
 Program(reference_counted_ptr<Shader> vert_shader,
         reference_counted_ptr<Shader> frag_shader,
         const PreLinkActionArray &action,
-        const ProgramInitializerArray &initers)
+        const ProgramInitializerArray &initers,
+        const reference_counted_ptr<ProgramBinaryCache> &binary_cache,
+        const char *binary_cache_key)
 {
-  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers, this);
+  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers,
+                                     binary_cache, binary_cache_key, this);
 }
 
 fastuidraw::gl::Program::
 Program(const glsl::ShaderSource &vert_shader,
         const glsl::ShaderSource &frag_shader,
         const PreLinkActionArray &action,
-        const ProgramInitializerArray &initers)
+        const ProgramInitializerArray &initers,
+        const reference_counted_ptr<ProgramBinaryCache> &binary_cache,
+        const char *binary_cache_key)
 {
-  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers, this);
+  m_d = FASTUIDRAWnew ProgramPrivate(vert_shader, frag_shader, action, initers,
+                                     binary_cache, binary_cache_key, this);
 }
 
 fastuidraw::gl::Program::
@@ -2442,6 +2904,16 @@ program_build_time(void)
   return d->m_assemble_time;
 }
 
+bool
+fastuidraw::gl::Program::
+program_binary_cache_hit(void)
+{
+  ProgramPrivate *d;
+  d = static_cast<ProgramPrivate*>(m_d);
+  d->assemble(this);
+  return d->m_from_binary_cache;
+}
+
 bool
 fastuidraw::gl::Program::
 link_success(void)
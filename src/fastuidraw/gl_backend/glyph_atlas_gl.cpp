@@ -178,6 +178,7 @@ namespace
       m_texel_store_dimensions(1024, 1024, 16),
       m_number_floats(1024 * 1024),
       m_delayed(false),
+      m_texel_allocator(fastuidraw::GlyphAtlas::tree_texel_allocator),
       m_alignment(4),
       m_type(fastuidraw::glsl::PainterBackendGLSL::glyph_geometry_tbo),
       m_log2_dims_geometry_store(-1, -1)
@@ -186,6 +187,7 @@ namespace
     fastuidraw::ivec3 m_texel_store_dimensions;
     unsigned int m_number_floats;
     bool m_delayed;
+    enum fastuidraw::GlyphAtlas::texel_allocator_t m_texel_allocator;
     unsigned int m_alignment;
     enum fastuidraw::glsl::PainterBackendGLSL::glyph_geometry_backing_t m_type;
     fastuidraw::ivec2 m_log2_dims_geometry_store;
@@ -739,6 +741,7 @@ use_optimal_geometry_store_backing(void)
 paramsSetGet(fastuidraw::ivec3, texel_store_dimensions)
 paramsSetGet(unsigned int, number_floats)
 paramsSetGet(bool, delayed)
+paramsSetGet(enum fastuidraw::GlyphAtlas::texel_allocator_t, texel_allocator)
 paramsSetGet(unsigned int, alignment)
 
 
@@ -749,7 +752,8 @@ paramsSetGet(unsigned int, alignment)
 fastuidraw::gl::GlyphAtlasGL::
 GlyphAtlasGL(const params &P):
   GlyphAtlas(TexelStoreGL::create(P.texel_store_dimensions(), P.delayed()),
-             GeometryStoreGL::create(P))
+             GeometryStoreGL::create(P),
+             P.texel_allocator())
 {
   m_d = FASTUIDRAWnew GlyphAtlasGLPrivate(P);
 }
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <vector>
 #include <iostream>
+#include <chrono>
 
 #include <fastuidraw/gl_backend/painter_backend_gl.hpp>
 #include <fastuidraw/gl_backend/ngl_header.hpp>
@@ -30,6 +31,7 @@
 #include <fastuidraw/gl_backend/gl_get.hpp>
 #include <fastuidraw/gl_backend/gl_context_properties.hpp>
 #include <fastuidraw/gl_backend/gluniform.hpp>
+#include <fastuidraw/util/tracing.hpp>
 
 #include "private/tex_buffer.hpp"
 
@@ -38,6 +40,8 @@
 #define GL_SRC1_ALPHA GL_SRC1_ALPHA_EXT
 #define GL_ONE_MINUS_SRC1_COLOR GL_ONE_MINUS_SRC1_COLOR_EXT
 #define GL_ONE_MINUS_SRC1_ALPHA GL_ONE_MINUS_SRC1_ALPHA_EXT
+#define GL_MAP_PERSISTENT_BIT GL_MAP_PERSISTENT_BIT_EXT
+#define GL_MAP_COHERENT_BIT GL_MAP_COHERENT_BIT_EXT
 #endif
 
 namespace
@@ -48,6 +52,40 @@ namespace
       shader_group_discard_mask = (1u << 31u)
     };
 
+  class elapsed_timer
+  {
+  public:
+    elapsed_timer(void):
+      m_start(std::chrono::steady_clock::now())
+    {}
+
+    uint64_t
+    elapsed_us(void) const
+    {
+      return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    uint64_t
+    elapsed_ns(void) const
+    {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  /* layout of the commands of glMultiDrawElementsIndirect */
+  class DrawElementsIndirectCommand
+  {
+  public:
+    GLuint m_count;
+    GLuint m_instance_count;
+    GLuint m_first_index;
+    GLint m_base_vertex;
+    GLuint m_base_instance;
+  };
+
   class painter_vao
   {
   public:
@@ -57,16 +95,93 @@ namespace
       m_header_bo(0),
       m_index_bo(0),
       m_data_bo(0),
-      m_data_tbo(0)
+      m_data_tbo(0),
+      m_indirect_bo(0),
+      m_attribute_mapped(nullptr),
+      m_header_mapped(nullptr),
+      m_index_mapped(nullptr),
+      m_data_mapped(nullptr),
+      m_indirect_mapped(nullptr)
     {}
 
     GLuint m_vao;
     GLuint m_attribute_bo, m_header_bo, m_index_bo, m_data_bo;
     GLuint m_data_tbo;
+
+    /* only non-zero if drawing with glMultiDrawElementsIndirect */
+    GLuint m_indirect_bo;
+
+    /* only non-null if the buffers are persistently mapped */
+    void *m_attribute_mapped, *m_header_mapped;
+    void *m_index_mapped, *m_data_mapped;
+    void *m_indirect_mapped;
     enum fastuidraw::gl::PainterBackendGL::data_store_backing_t m_data_store_backing;
     unsigned int m_data_store_binding_point;
   };
 
+  /* The attribute and index data of a RetainedGeometryStoreGL
+     are in buffer objects that are only written to with
+     glBufferSubData. The VAO sources the header attribute
+     from the current (non-array) value of the attribute,
+     set with glVertexAttribI4ui before each draw.
+   */
+  class RetainedGeometryStoreGL:public fastuidraw::PainterRetainedGeometryStore
+  {
+  public:
+    RetainedGeometryStoreGL(unsigned int number_attributes,
+                            unsigned int number_indices);
+
+    ~RetainedGeometryStoreGL();
+
+    GLuint
+    vao(void) const
+    {
+      return m_vao;
+    }
+
+  protected:
+    virtual
+    void
+    set_attributes(unsigned int location,
+                   fastuidraw::const_c_array<fastuidraw::PainterAttribute> data);
+
+    virtual
+    void
+    set_indices(unsigned int location,
+                fastuidraw::const_c_array<fastuidraw::PainterIndex> data);
+
+  private:
+    GLuint m_vao, m_attribute_bo, m_index_bo;
+  };
+
+  /* The data of a PersistentDataStoreGL is in a buffer
+     object that is only written to with glBufferSubData
+     and is sourced by the shaders as a texture buffer.
+   */
+  class PersistentDataStoreGL:public fastuidraw::PainterPersistentDataStore
+  {
+  public:
+    PersistentDataStoreGL(unsigned int number_blocks, unsigned int alignment,
+                          enum fastuidraw::gl::detail::tex_buffer_support_t tex_buffer_support);
+
+    ~PersistentDataStoreGL();
+
+    GLuint
+    tbo(void) const
+    {
+      return m_tbo;
+    }
+
+  protected:
+    virtual
+    void
+    set_data(unsigned int location,
+             fastuidraw::const_c_array<fastuidraw::generic_data> data);
+
+  private:
+    GLuint m_bo, m_tbo;
+  };
+
   class painter_vao_pool:fastuidraw::noncopyable
   {
   public:
@@ -78,6 +193,12 @@ namespace
 
     ~painter_vao_pool();
 
+    bool
+    persistent_mapped(void) const
+    {
+      return m_persistent_mapped;
+    }
+
     unsigned int
     attribute_buffer_size(void) const
     {
@@ -90,12 +211,25 @@ namespace
       return m_header_buffer_size;
     }
 
+    bool
+    header_via_base_instance(void) const
+    {
+      return m_header_via_base_instance;
+    }
+
     unsigned int
     index_buffer_size(void) const
     {
       return m_index_buffer_size;
     }
 
+    /* zero if not drawing with glMultiDrawElementsIndirect */
+    unsigned int
+    indirect_buffer_size(void) const
+    {
+      return m_indirect_buffer_size;
+    }
+
     unsigned int
     data_buffer_size(void) const
     {
@@ -111,6 +245,22 @@ namespace
     GLuint //objects are recycled; make sure size never increases!
     request_uniform_ubo(unsigned int ubo_size, GLenum target);
 
+    /* returns the persistent mapping of the buffer returned
+       by request_uniform_ubo(), or nullptr if the buffers are
+       not persistently mapped.
+     */
+    void*
+    uniform_ubo_mapped(void) const
+    {
+      return m_ubos_mapped[m_pool];
+    }
+
+    uint64_t&
+    stat(enum fastuidraw::gl::PainterBackendGL::stats_t st)
+    {
+      return m_stats[st];
+    }
+
   private:
     void
     generate_tbos(painter_vao &vao);
@@ -118,20 +268,44 @@ namespace
     GLuint
     generate_tbo(GLuint src_buffer, GLenum fmt, unsigned int unit);
 
+    /* if the pool is persistently mapped, *out_mapped is set
+       to the mapping of the buffer; otherwise it is untouched.
+     */
     GLuint
-    generate_bo(GLenum bind_target, GLsizei psize);
+    generate_bo(GLenum bind_target, GLsizei psize, void **out_mapped);
+
+    void
+    wait_on_pool_fence(void);
+
+    /* binds to GL_ARRAY_BUFFER the buffer holding 0, 1, 2, ...
+       from which the header attribute is sourced with a divisor
+       of 1 when header_via_base_instance() is true.
+     */
+    void
+    bind_header_identity_bo(void);
 
     unsigned int m_attribute_buffer_size, m_header_buffer_size;
-    unsigned int m_index_buffer_size;
+    unsigned int m_index_buffer_size, m_indirect_buffer_size;
     int m_alignment, m_blocks_per_data_buffer;
     unsigned int m_data_buffer_size;
     enum fastuidraw::gl::PainterBackendGL::data_store_backing_t m_data_store_backing;
     enum fastuidraw::gl::detail::tex_buffer_support_t m_tex_buffer_support;
     fastuidraw::glsl::PainterBackendGLSL::BindingPoints m_binding_points;
 
+    bool m_persistent_mapped;
+    bool m_header_via_base_instance;
+    GLuint m_header_identity_bo;
+
     unsigned int m_current, m_pool;
     std::vector<std::vector<painter_vao> > m_vaos;
     std::vector<GLuint> m_ubos;
+    std::vector<void*> m_ubos_mapped;
+
+    /* fence placed after the last draw using a pool; a pool
+       is only rewritten once its fence is signaled.
+     */
+    std::vector<GLsync> m_fences;
+    fastuidraw::vecN<uint64_t, fastuidraw::gl::PainterBackendGL::num_stats> m_stats;
   };
 
   bool
@@ -220,6 +394,8 @@ namespace
     std::vector<fastuidraw::generic_data> m_uniform_values;
     fastuidraw::c_array<fastuidraw::generic_data> m_uniform_values_ptr;
     painter_vao_pool *m_pool;
+    fastuidraw::reference_counted_ptr<RetainedGeometryStoreGL> m_retained_geometry_store;
+    fastuidraw::reference_counted_ptr<PersistentDataStoreGL> m_persistent_data_store;
 
     fastuidraw::gl::PainterBackendGL *m_p;
   };
@@ -237,10 +413,45 @@ namespace
     void
     add_entry(GLsizei count, const void *offset);
 
+    /* add the command at the given location of the indirect
+       buffer; the commands of a DrawEntry are contiguous in
+       the indirect buffer and it is drawn with
+       glMultiDrawElementsIndirect instead of glMultiDrawElements.
+     */
     void
-    draw(void) const;
+    add_indirect_entry(unsigned int location);
+
+    void
+    add_retained_entry(GLsizei count, const void *offset,
+                       GLint base_vertex, uint32_t header);
+
+    void
+    draw(GLuint vao, GLuint retained_vao, painter_vao_pool *pool) const;
 
   private:
+    /* a draw from the RetainedGeometryStoreGL issued
+       before the entries starting at m_position.
+     */
+    class RetainedEntry
+    {
+    public:
+      unsigned int m_position;
+      GLsizei m_count;
+      const GLvoid *m_offset;
+      GLint m_base_vertex;
+      uint32_t m_header;
+    };
+
+    unsigned int
+    number_entries(void) const
+    {
+      return (m_indirect_begin >= 0) ?
+        m_indirect_count :
+        m_counts.size();
+    }
+
+    void
+    draw_entries(unsigned int begin, unsigned int end, painter_vao_pool *pool) const;
 
     static
     GLenum
@@ -253,8 +464,11 @@ namespace
     fastuidraw::BlendMode m_blend_mode;
     std::vector<GLsizei> m_counts;
     std::vector<const GLvoid*> m_indices;
+    std::vector<RetainedEntry> m_retained;
     PainterBackendGLPrivate *m_private;
     unsigned int m_choice;
+    int m_indirect_begin;
+    unsigned int m_indirect_count;
   };
 
   class DrawCommand:public fastuidraw::PainterDraw
@@ -275,6 +489,19 @@ namespace
                const fastuidraw::PainterShaderGroup &new_shaders,
                unsigned int attributes_written, unsigned int indices_written) const;
 
+    virtual
+    void
+    draw_retained(unsigned int index_offset, unsigned int index_count,
+                  int base_vertex, uint32_t header_location,
+                  unsigned int attributes_written,
+                  unsigned int indices_written) const;
+
+    virtual
+    void
+    header_changed(uint32_t header_location,
+                   unsigned int attributes_written,
+                   unsigned int indices_written) const;
+
     virtual
     void
     draw(void) const;
@@ -289,13 +516,30 @@ namespace
 
   private:
 
+    /* adds the indices written since the last call as an
+       entry of the current DrawEntry; in indirect mode, the
+       entry is merged into the pending command if possible.
+     */
     void
     add_entry(unsigned int indices_written) const;
 
+    /* in indirect mode, write the pending command to the
+       indirect buffer as an entry of the current DrawEntry.
+     */
+    void
+    flush_indirect(void) const;
+
     PainterBackendGLPrivate *m_pr;
     painter_vao m_vao;
     mutable unsigned int m_attributes_written, m_indices_written;
+    mutable uint32_t m_header;
     mutable std::list<DrawEntry> m_draws;
+
+    /* only non-empty if drawing with glMultiDrawElementsIndirect */
+    fastuidraw::c_array<DrawElementsIndirectCommand> m_indirect;
+    mutable unsigned int m_indirect_written;
+    mutable DrawElementsIndirectCommand m_pending;
+    bool m_merge_entries;
   };
 
   class ConfigurationGLPrivate
@@ -322,7 +566,13 @@ namespace
       m_use_ubo_for_uniforms(false),
       m_separate_program_for_discard(true),
       m_non_dashed_stroke_shader_uses_discard(false),
-      m_blend_type(fastuidraw::PainterBlendShader::dual_src)
+      m_blend_type(fastuidraw::PainterBlendShader::dual_src),
+      m_use_persistent_mapped_buffers(false),
+      m_retained_geometry_attributes(0),
+      m_retained_geometry_indices(0),
+      m_persistent_data_store_blocks(0),
+      m_header_via_base_instance(false),
+      m_use_multi_draw_indirect(false)
     {}
 
     unsigned int m_attributes_per_buffer;
@@ -346,10 +596,152 @@ namespace
     bool m_separate_program_for_discard;
     bool m_non_dashed_stroke_shader_uses_discard;
     enum fastuidraw::PainterBlendShader::shader_type m_blend_type;
+    fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache> m_program_binary_cache;
+    bool m_use_persistent_mapped_buffers;
+    unsigned int m_retained_geometry_attributes;
+    unsigned int m_retained_geometry_indices;
+    unsigned int m_persistent_data_store_blocks;
+    bool m_header_via_base_instance;
+    bool m_use_multi_draw_indirect;
   };
 
 }
 
+///////////////////////////////////////////
+// RetainedGeometryStoreGL methods
+RetainedGeometryStoreGL::
+RetainedGeometryStoreGL(unsigned int number_attributes,
+                        unsigned int number_indices):
+  fastuidraw::PainterRetainedGeometryStore(number_attributes, number_indices),
+  m_vao(0),
+  m_attribute_bo(0),
+  m_index_bo(0)
+{
+  fastuidraw::gl::opengl_trait_value v;
+
+  glGenVertexArrays(1, &m_vao);
+  assert(m_vao != 0);
+  glBindVertexArray(m_vao);
+
+  glGenBuffers(1, &m_attribute_bo);
+  assert(m_attribute_bo != 0);
+  glBindBuffer(GL_ARRAY_BUFFER, m_attribute_bo);
+  glBufferData(GL_ARRAY_BUFFER, number_attributes * sizeof(fastuidraw::PainterAttribute),
+               nullptr, GL_STATIC_DRAW);
+
+  glGenBuffers(1, &m_index_bo);
+  assert(m_index_bo != 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_bo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, number_indices * sizeof(fastuidraw::PainterIndex),
+               nullptr, GL_STATIC_DRAW);
+
+  glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot);
+  v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                             offsetof(fastuidraw::PainterAttribute, m_attrib0));
+  fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot, v);
+
+  glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot);
+  v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                             offsetof(fastuidraw::PainterAttribute, m_attrib1));
+  fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::secondary_attrib_slot, v);
+
+  glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot);
+  v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
+                                                             offsetof(fastuidraw::PainterAttribute, m_attrib2));
+  fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot, v);
+
+  glDisableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+RetainedGeometryStoreGL::
+~RetainedGeometryStoreGL()
+{
+  glDeleteBuffers(1, &m_attribute_bo);
+  glDeleteBuffers(1, &m_index_bo);
+  glDeleteVertexArrays(1, &m_vao);
+}
+
+void
+RetainedGeometryStoreGL::
+set_attributes(unsigned int location,
+               fastuidraw::const_c_array<fastuidraw::PainterAttribute> data)
+{
+  /* use GL_COPY_WRITE_BUFFER so that the binding
+     of the currently bound VAO is not affected.
+   */
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_attribute_bo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, location * sizeof(fastuidraw::PainterAttribute),
+                  data.size() * sizeof(fastuidraw::PainterAttribute), data.c_ptr());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void
+RetainedGeometryStoreGL::
+set_indices(unsigned int location,
+            fastuidraw::const_c_array<fastuidraw::PainterIndex> data)
+{
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_index_bo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, location * sizeof(fastuidraw::PainterIndex),
+                  data.size() * sizeof(fastuidraw::PainterIndex), data.c_ptr());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+///////////////////////////////////////////
+// PersistentDataStoreGL methods
+PersistentDataStoreGL::
+PersistentDataStoreGL(unsigned int number_blocks, unsigned int alignment,
+                      enum fastuidraw::gl::detail::tex_buffer_support_t tex_buffer_support):
+  fastuidraw::PainterPersistentDataStore(number_blocks, alignment),
+  m_bo(0),
+  m_tbo(0)
+{
+  const GLenum uint_fmts[4] =
+    {
+      GL_R32UI,
+      GL_RG32UI,
+      GL_RGB32UI,
+      GL_RGBA32UI,
+    };
+
+  assert(alignment >= 1 && alignment <= 4);
+
+  glGenBuffers(1, &m_bo);
+  assert(m_bo != 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_bo);
+  glBufferData(GL_COPY_WRITE_BUFFER, number_blocks * alignment * sizeof(fastuidraw::generic_data),
+               nullptr, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  glGenTextures(1, &m_tbo);
+  assert(m_tbo != 0);
+  glBindTexture(GL_TEXTURE_BUFFER, m_tbo);
+  fastuidraw::gl::detail::tex_buffer(tex_buffer_support, GL_TEXTURE_BUFFER, uint_fmts[alignment - 1], m_bo);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+PersistentDataStoreGL::
+~PersistentDataStoreGL()
+{
+  glDeleteTextures(1, &m_tbo);
+  glDeleteBuffers(1, &m_bo);
+}
+
+void
+PersistentDataStoreGL::
+set_data(unsigned int location,
+         fastuidraw::const_c_array<fastuidraw::generic_data> data)
+{
+  unsigned int block_size(alignment() * sizeof(fastuidraw::generic_data));
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_bo);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, location * block_size,
+                  data.size() * sizeof(fastuidraw::generic_data), data.c_ptr());
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 ///////////////////////////////////////////
 // painter_vao_pool methods
 painter_vao_pool::
@@ -358,18 +750,32 @@ painter_vao_pool(const fastuidraw::gl::PainterBackendGL::ConfigurationGL &params
                  enum fastuidraw::gl::detail::tex_buffer_support_t tex_buffer_support,
                  const fastuidraw::glsl::PainterBackendGLSL::BindingPoints &binding_points):
   m_attribute_buffer_size(params.attributes_per_buffer() * sizeof(fastuidraw::PainterAttribute)),
-  m_header_buffer_size(params.attributes_per_buffer() * sizeof(uint32_t)),
+  m_header_buffer_size(params.header_via_base_instance() ?
+                       0u :
+                       params.attributes_per_buffer() * sizeof(uint32_t)),
   m_index_buffer_size(params.indices_per_buffer() * sizeof(fastuidraw::PainterIndex)),
+  /* each command draws at least one triangle and the
+     trailing command of a DrawEntry may be empty.
+   */
+  m_indirect_buffer_size(params.use_multi_draw_indirect() ?
+                         (params.indices_per_buffer() / 3 + 1) * sizeof(DrawElementsIndirectCommand) :
+                         0u),
   m_alignment(params_base.alignment()),
   m_blocks_per_data_buffer(params.data_blocks_per_store_buffer()),
   m_data_buffer_size(m_blocks_per_data_buffer * m_alignment * sizeof(fastuidraw::generic_data)),
   m_data_store_backing(params.data_store_backing()),
   m_tex_buffer_support(tex_buffer_support),
   m_binding_points(binding_points),
+  m_persistent_mapped(params.use_persistent_mapped_buffers()),
+  m_header_via_base_instance(params.header_via_base_instance()),
+  m_header_identity_bo(0),
   m_current(0),
   m_pool(0),
   m_vaos(params.number_pools()),
-  m_ubos(params.number_pools(), 0)
+  m_ubos(params.number_pools(), 0),
+  m_ubos_mapped(params.number_pools(), nullptr),
+  m_fences(params.number_pools(), nullptr),
+  m_stats(0)
 {}
 
 painter_vao_pool::
@@ -388,6 +794,7 @@ painter_vao_pool::
           glDeleteBuffers(1, &m_vaos[p][i].m_header_bo);
           glDeleteBuffers(1, &m_vaos[p][i].m_index_bo);
           glDeleteBuffers(1, &m_vaos[p][i].m_data_bo);
+          glDeleteBuffers(1, &m_vaos[p][i].m_indirect_bo);
           glDeleteVertexArrays(1, &m_vaos[p][i].m_vao);
         }
 
@@ -395,6 +802,16 @@ painter_vao_pool::
         {
           glDeleteBuffers(1, &m_ubos[p]);
         }
+
+      if(m_fences[p] != nullptr)
+        {
+          glDeleteSync(m_fences[p]);
+        }
+    }
+
+  if(m_header_identity_bo != 0)
+    {
+      glDeleteBuffers(1, &m_header_identity_bo);
     }
 }
 
@@ -402,9 +819,10 @@ GLuint
 painter_vao_pool::
 request_uniform_ubo(unsigned int sz, GLenum target)
 {
+  wait_on_pool_fence();
   if(m_ubos[m_pool] == 0)
     {
-      m_ubos[m_pool] = generate_bo(target, sz);
+      m_ubos[m_pool] = generate_bo(target, sz, &m_ubos_mapped[m_pool]);
     }
   else
     {
@@ -428,6 +846,7 @@ request_vao(void)
 {
   painter_vao return_value;
 
+  wait_on_pool_fence();
   if(m_current == m_vaos[m_pool].size())
     {
       fastuidraw::gl::opengl_trait_value v;
@@ -444,7 +863,8 @@ request_vao(void)
         {
         case fastuidraw::gl::PainterBackendGL::data_store_tbo:
           {
-            m_vaos[m_pool][m_current].m_data_bo = generate_bo(GL_TEXTURE_BUFFER, m_data_buffer_size);
+            m_vaos[m_pool][m_current].m_data_bo = generate_bo(GL_TEXTURE_BUFFER, m_data_buffer_size,
+                                                              &m_vaos[m_pool][m_current].m_data_mapped);
             m_vaos[m_pool][m_current].m_data_store_binding_point = m_binding_points.data_store_buffer_tbo();
             generate_tbos(m_vaos[m_pool][m_current]);
           }
@@ -452,7 +872,8 @@ request_vao(void)
 
         case fastuidraw::gl::PainterBackendGL::data_store_ubo:
           {
-            m_vaos[m_pool][m_current].m_data_bo = generate_bo(GL_ARRAY_BUFFER, m_data_buffer_size);
+            m_vaos[m_pool][m_current].m_data_bo = generate_bo(GL_ARRAY_BUFFER, m_data_buffer_size,
+                                                              &m_vaos[m_pool][m_current].m_data_mapped);
             m_vaos[m_pool][m_current].m_data_store_binding_point = m_binding_points.data_store_buffer_ubo();
           }
           break;
@@ -461,8 +882,10 @@ request_vao(void)
       /* generate_bo leaves the returned buffer object bound to
          the passed binding target.
       */
-      m_vaos[m_pool][m_current].m_attribute_bo = generate_bo(GL_ARRAY_BUFFER, m_attribute_buffer_size);
-      m_vaos[m_pool][m_current].m_index_bo = generate_bo(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer_size);
+      m_vaos[m_pool][m_current].m_attribute_bo = generate_bo(GL_ARRAY_BUFFER, m_attribute_buffer_size,
+                                                             &m_vaos[m_pool][m_current].m_attribute_mapped);
+      m_vaos[m_pool][m_current].m_index_bo = generate_bo(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer_size,
+                                                         &m_vaos[m_pool][m_current].m_index_mapped);
 
       glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::primary_attrib_slot);
       v = fastuidraw::gl::opengl_trait_values<fastuidraw::uvec4>(sizeof(fastuidraw::PainterAttribute),
@@ -479,10 +902,29 @@ request_vao(void)
                                                                  offsetof(fastuidraw::PainterAttribute, m_attrib2));
       fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::uint_attrib_slot, v);
 
-      m_vaos[m_pool][m_current].m_header_bo = generate_bo(GL_ARRAY_BUFFER, m_header_buffer_size);
-      glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
-      v = fastuidraw::gl::opengl_trait_values<uint32_t>();
-      fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot, v);
+      if(m_header_via_base_instance)
+        {
+          bind_header_identity_bo();
+          glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
+          v = fastuidraw::gl::opengl_trait_values<uint32_t>();
+          fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot, v);
+          glVertexAttribDivisor(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot, 1);
+        }
+      else
+        {
+          m_vaos[m_pool][m_current].m_header_bo = generate_bo(GL_ARRAY_BUFFER, m_header_buffer_size,
+                                                              &m_vaos[m_pool][m_current].m_header_mapped);
+          glEnableVertexAttribArray(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot);
+          v = fastuidraw::gl::opengl_trait_values<uint32_t>();
+          fastuidraw::gl::VertexAttribIPointer(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot, v);
+        }
+
+      if(m_indirect_buffer_size > 0)
+        {
+          m_vaos[m_pool][m_current].m_indirect_bo = generate_bo(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer_size,
+                                                                &m_vaos[m_pool][m_current].m_indirect_mapped);
+          glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
 
       glBindVertexArray(0);
     }
@@ -493,10 +935,47 @@ request_vao(void)
   return return_value;
 }
 
+void
+painter_vao_pool::
+bind_header_identity_bo(void)
+{
+  if(m_header_identity_bo == 0)
+    {
+      /* header locations are in units of blocks, thus
+         are less than the number of blocks of the
+         data store buffer.
+       */
+      std::vector<uint32_t> values(m_blocks_per_data_buffer);
+      for(unsigned int i = 0, endi = values.size(); i < endi; ++i)
+        {
+          values[i] = i;
+        }
+
+      glGenBuffers(1, &m_header_identity_bo);
+      assert(m_header_identity_bo != 0);
+      glBindBuffer(GL_ARRAY_BUFFER, m_header_identity_bo);
+      glBufferData(GL_ARRAY_BUFFER, values.size() * sizeof(uint32_t), &values[0], GL_STATIC_DRAW);
+    }
+  else
+    {
+      glBindBuffer(GL_ARRAY_BUFFER, m_header_identity_bo);
+    }
+}
+
 void
 painter_vao_pool::
 next_pool(void)
 {
+  if(m_persistent_mapped)
+    {
+      /* the GPU may still be reading the buffers of the pool;
+         they may only be written to again once the commands
+         issued so far have completed.
+       */
+      assert(m_fences[m_pool] == nullptr);
+      m_fences[m_pool] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
   ++m_pool;
   if(m_pool == m_vaos.size())
     {
@@ -540,16 +1019,78 @@ generate_tbo(GLuint src_buffer, GLenum fmt, unsigned int unit)
 
 GLuint
 painter_vao_pool::
-generate_bo(GLenum bind_target, GLsizei psize)
+generate_bo(GLenum bind_target, GLsizei psize, void **out_mapped)
 {
   GLuint return_value(0);
   glGenBuffers(1, &return_value);
   assert(return_value != 0);
   glBindBuffer(bind_target, return_value);
-  glBufferData(bind_target, psize, nullptr, GL_STREAM_DRAW);
+  if(m_persistent_mapped)
+    {
+      GLbitfield flags;
+      elapsed_timer timer;
+
+      flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      #ifdef FASTUIDRAW_GL_USE_GLES
+        {
+          glBufferStorageEXT(bind_target, psize, nullptr, flags);
+        }
+      #else
+        {
+          glBufferStorage(bind_target, psize, nullptr, flags);
+        }
+      #endif
+      *out_mapped = glMapBufferRange(bind_target, 0, psize, flags);
+      assert(*out_mapped != nullptr);
+
+      ++m_stats[fastuidraw::gl::PainterBackendGL::num_buffer_maps];
+      m_stats[fastuidraw::gl::PainterBackendGL::buffer_map_time_us] += timer.elapsed_us();
+    }
+  else
+    {
+      glBufferData(bind_target, psize, nullptr, GL_STREAM_DRAW);
+    }
   return return_value;
 }
 
+void
+painter_vao_pool::
+wait_on_pool_fence(void)
+{
+  GLsync fence(m_fences[m_pool]);
+  GLenum status;
+
+  if(fence == nullptr)
+    {
+      return;
+    }
+
+  status = glClientWaitSync(fence, 0, 0);
+  if(status == GL_TIMEOUT_EXPIRED)
+    {
+      FASTUIDRAWtrace_zone("PainterBackendGL::wait_on_pool_fence");
+      elapsed_timer timer;
+      const GLuint64 timeout_ns(1000000000u);
+
+      /* flush on the first wait so that the fence is
+         guaranteed to be eventually signaled.
+       */
+      status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns);
+      while(status == GL_TIMEOUT_EXPIRED)
+        {
+          status = glClientWaitSync(fence, 0, timeout_ns);
+        }
+
+      ++m_stats[fastuidraw::gl::PainterBackendGL::num_fence_waits];
+      m_stats[fastuidraw::gl::PainterBackendGL::fence_wait_time_us] += timer.elapsed_us();
+      FASTUIDRAWtrace_counter(buffer_wait_nanoseconds, timer.elapsed_ns());
+    }
+  assert(status != GL_WAIT_FAILED);
+
+  glDeleteSync(fence);
+  m_fences[m_pool] = nullptr;
+}
+
 ///////////////////////////////////////////////
 // DrawEntry methods
 DrawEntry::
@@ -558,7 +1099,9 @@ DrawEntry(const fastuidraw::BlendMode &mode,
           unsigned int pz):
   m_blend_mode(mode),
   m_private(pr),
-  m_choice(pz)
+  m_choice(pz),
+  m_indirect_begin(-1),
+  m_indirect_count(0)
 {}
 
 
@@ -566,24 +1109,65 @@ DrawEntry::
 DrawEntry(const fastuidraw::BlendMode &mode):
   m_blend_mode(mode),
   m_private(nullptr),
-  m_choice(fastuidraw::gl::PainterBackendGL::number_program_types)
+  m_choice(fastuidraw::gl::PainterBackendGL::number_program_types),
+  m_indirect_begin(-1),
+  m_indirect_count(0)
 {}
 
 void
 DrawEntry::
 add_entry(GLsizei count, const void *offset)
 {
+  assert(m_indirect_begin < 0);
   m_counts.push_back(count);
   m_indices.push_back(offset);
 }
 
 void
 DrawEntry::
-draw(void) const
+add_indirect_entry(unsigned int location)
+{
+  assert(m_counts.empty());
+  if(m_indirect_begin < 0)
+    {
+      m_indirect_begin = location;
+    }
+  assert(m_indirect_begin + m_indirect_count == location);
+  ++m_indirect_count;
+}
+
+void
+DrawEntry::
+add_retained_entry(GLsizei count, const void *offset,
+                   GLint base_vertex, uint32_t header)
+{
+  RetainedEntry R;
+
+  R.m_position = number_entries();
+  R.m_count = count;
+  R.m_offset = offset;
+  R.m_base_vertex = base_vertex;
+  R.m_header = header;
+  m_retained.push_back(R);
+}
+
+void
+DrawEntry::
+draw(GLuint vao, GLuint retained_vao, painter_vao_pool *pool) const
 {
   if(m_private)
     {
       m_private->m_programs[m_choice]->use_program();
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
+    }
+
+  /* in indirect mode, empty entries are not added; the
+     program must still be set since the DrawEntry objects
+     that follow rely on it.
+   */
+  if(number_entries() == 0 && m_retained.empty())
+    {
+      return;
     }
 
   if(m_blend_mode.blending_on())
@@ -595,14 +1179,72 @@ draw(void) const
                           convert_blend_func(m_blend_mode.func_dst_rgb()),
                           convert_blend_func(m_blend_mode.func_src_alpha()),
                           convert_blend_func(m_blend_mode.func_dst_alpha()));
+      pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls) += 3;
     }
   else
     {
       glDisable(GL_BLEND);
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
     }
-  assert(!m_counts.empty());
   assert(m_counts.size() == m_indices.size());
 
+  /* retained draws must be issued in the order they were
+     added relative to the streamed draws, since the order
+     of draws is the order in which they are blended.
+   */
+  unsigned int position(0);
+  for(unsigned int i = 0, endi = m_retained.size(); i < endi; ++i)
+    {
+      const RetainedEntry &R(m_retained[i]);
+
+      draw_entries(position, R.m_position, pool);
+      position = R.m_position;
+
+      glBindVertexArray(retained_vao);
+      glVertexAttribI4ui(fastuidraw::glsl::PainterBackendGLSL::header_attrib_slot, R.m_header, 0u, 0u, 0u);
+      glDrawElementsBaseVertex(GL_TRIANGLES, R.m_count,
+                               fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
+                               R.m_offset, R.m_base_vertex);
+      glBindVertexArray(vao);
+      pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls) += 3;
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_calls);
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_call_entries);
+    }
+  draw_entries(position, number_entries(), pool);
+}
+
+void
+DrawEntry::
+draw_entries(unsigned int begin, unsigned int end, painter_vao_pool *pool) const
+{
+  if(begin == end)
+    {
+      return;
+    }
+
+  pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_call_entries) += end - begin;
+  if(m_indirect_begin >= 0)
+    {
+      const DrawElementsIndirectCommand *offset(nullptr);
+
+      offset += m_indirect_begin + begin;
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_calls);
+      #ifndef FASTUIDRAW_GL_USE_GLES
+        {
+          glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                      fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
+                                      offset, end - begin, 0);
+        }
+      #else
+        {
+          glMultiDrawElementsIndirectEXT(GL_TRIANGLES,
+                                         fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
+                                         offset, end - begin, 0);
+        }
+      #endif
+      return;
+    }
+
   /* TODO:
      Get rid of this unholy mess of #ifdef's here and move
      it to an internal private function that also has a tag
@@ -610,26 +1252,29 @@ draw(void) const
   */
   #ifndef FASTUIDRAW_GL_USE_GLES
     {
-      glMultiDrawElements(GL_TRIANGLES, &m_counts[0],
+      glMultiDrawElements(GL_TRIANGLES, &m_counts[begin],
                           fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
-                          &m_indices[0], m_counts.size());
+                          &m_indices[begin], end - begin);
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_calls);
     }
   #else
     {
       if(FASTUIDRAWglfunctionExists(glMultiDrawElementsEXT))
         {
-          glMultiDrawElementsEXT(GL_TRIANGLES, &m_counts[0],
+          glMultiDrawElementsEXT(GL_TRIANGLES, &m_counts[begin],
                                  fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
-                                 &m_indices[0], m_counts.size());
+                                 &m_indices[begin], end - begin);
+          ++pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_calls);
         }
       else
         {
-          for(unsigned int i = 0, endi = m_counts.size(); i < endi; ++i)
+          for(unsigned int i = begin; i < end; ++i)
             {
               glDrawElements(GL_TRIANGLES, m_counts[i],
                              fastuidraw::gl::opengl_trait<fastuidraw::PainterIndex>::type,
                              m_indices[i]);
             }
+          pool->stat(fastuidraw::gl::PainterBackendGL::num_draw_calls) += end - begin;
         }
     }
   #endif
@@ -706,31 +1351,68 @@ DrawCommand(painter_vao_pool *hnd,
   m_pr(pr),
   m_vao(hnd->request_vao()),
   m_attributes_written(0),
-  m_indices_written(0)
+  m_indices_written(0),
+  m_header(0),
+  m_indirect_written(0),
+  m_merge_entries(!params.break_on_shader_change())
 {
   /* map the buffers and set to the c_array<> fields of
      fastuidraw::PainterDraw to the mapping location.
   */
-  void *attr_bo, *index_bo, *data_bo, *header_bo;
-  uint32_t flags;
+  void *attr_bo, *index_bo, *data_bo, *header_bo(nullptr), *indirect_bo(nullptr);
 
-  flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+  if(hnd->persistent_mapped())
+    {
+      /* the buffers are mapped for their entire lifetime,
+         painter_vao_pool::request_vao() has already waited
+         for the GPU to be done reading them.
+       */
+      attr_bo = m_vao.m_attribute_mapped;
+      header_bo = m_vao.m_header_mapped;
+      index_bo = m_vao.m_index_mapped;
+      data_bo = m_vao.m_data_mapped;
+      indirect_bo = m_vao.m_indirect_mapped;
+    }
+  else
+    {
+      uint32_t flags;
+      elapsed_timer timer;
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_attribute_bo);
-  attr_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->attribute_buffer_size(), flags);
-  assert(attr_bo != nullptr);
+      flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_header_bo);
-  header_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->header_buffer_size(), flags);
-  assert(header_bo != nullptr);
+      glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_attribute_bo);
+      attr_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->attribute_buffer_size(), flags);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
-  index_bo = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, hnd->index_buffer_size(), flags);
-  assert(index_bo != nullptr);
+      if(!hnd->header_via_base_instance())
+        {
+          glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_header_bo);
+          header_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->header_buffer_size(), flags);
+          ++hnd->stat(fastuidraw::gl::PainterBackendGL::num_buffer_maps);
+        }
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_data_bo);
-  data_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->data_buffer_size(), flags);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
+      index_bo = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, hnd->index_buffer_size(), flags);
+
+      glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_data_bo);
+      data_bo = glMapBufferRange(GL_ARRAY_BUFFER, 0, hnd->data_buffer_size(), flags);
+
+      if(m_vao.m_indirect_bo != 0)
+        {
+          glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_vao.m_indirect_bo);
+          indirect_bo = glMapBufferRange(GL_DRAW_INDIRECT_BUFFER, 0, hnd->indirect_buffer_size(), flags);
+          glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+          ++hnd->stat(fastuidraw::gl::PainterBackendGL::num_buffer_maps);
+        }
+
+      hnd->stat(fastuidraw::gl::PainterBackendGL::num_buffer_maps) += 3;
+      hnd->stat(fastuidraw::gl::PainterBackendGL::buffer_map_time_us) += timer.elapsed_us();
+    }
+
+  assert(attr_bo != nullptr);
+  assert(header_bo != nullptr || hnd->header_via_base_instance());
+  assert(index_bo != nullptr);
   assert(data_bo != nullptr);
+  assert(indirect_bo != nullptr || m_vao.m_indirect_bo == 0);
 
   m_attributes = fastuidraw::c_array<fastuidraw::PainterAttribute>(static_cast<fastuidraw::PainterAttribute*>(attr_bo),
                                                                  params.attributes_per_buffer());
@@ -739,8 +1421,22 @@ DrawCommand(painter_vao_pool *hnd,
   m_store = fastuidraw::c_array<fastuidraw::generic_data>(static_cast<fastuidraw::generic_data*>(data_bo),
                                                           hnd->data_buffer_size() / sizeof(fastuidraw::generic_data));
 
-  m_header_attributes = fastuidraw::c_array<uint32_t>(static_cast<uint32_t*>(header_bo),
-                                                     params.attributes_per_buffer());
+  /* without header buffer, m_header_attributes is left
+     empty and the header of the indices is given by
+     header_changed().
+   */
+  if(header_bo != nullptr)
+    {
+      m_header_attributes = fastuidraw::c_array<uint32_t>(static_cast<uint32_t*>(header_bo),
+                                                         params.attributes_per_buffer());
+    }
+
+  if(indirect_bo != nullptr)
+    {
+      m_indirect = fastuidraw::c_array<DrawElementsIndirectCommand>(static_cast<DrawElementsIndirectCommand*>(indirect_bo),
+                                                                    hnd->indirect_buffer_size() / sizeof(DrawElementsIndirectCommand));
+    }
+  m_pending.m_count = 0;
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -766,6 +1462,8 @@ draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
   if(old_disc != new_disc)
     {
       unsigned int pz;
+
+      FASTUIDRAWtrace_counter(draw_breaks_discard, 1u);
       pz = (new_disc != 0u) ?
         fastuidraw::gl::PainterBackendGL::program_with_discard :
         fastuidraw::gl::PainterBackendGL::program_without_discard;
@@ -773,6 +1471,7 @@ draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
       if(!m_draws.empty())
         {
           add_entry(indices_written);
+          flush_indirect();
         }
       m_draws.push_back(DrawEntry(fastuidraw::BlendMode(new_mode), m_pr, pz));
     }
@@ -781,24 +1480,74 @@ draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
       if(!m_draws.empty())
         {
           add_entry(indices_written);
+          flush_indirect();
         }
       m_draws.push_back(fastuidraw::BlendMode(new_mode));
     }
   else
     {
       /* any other state changes means that we just need to add an
-         entry to the current draw entry.
+         entry to the current draw entry. The uber-shader handles
+         such changes within a single draw, so in indirect mode the
+         entries are merged unless each shader is to get its own
+         entry.
       */
       add_entry(indices_written);
+      if(!m_merge_entries)
+        {
+          flush_indirect();
+        }
     }
 
   FASTUIDRAWunused(attributes_written);
 }
 
+void
+DrawCommand::
+draw_retained(unsigned int index_offset, unsigned int index_count,
+              int base_vertex, uint32_t header_location,
+              unsigned int attributes_written,
+              unsigned int indices_written) const
+{
+  const fastuidraw::PainterIndex *offset(nullptr);
+
+  /* end the current entry so that the retained
+     draw comes after what has been written so far.
+   */
+  add_entry(indices_written);
+  flush_indirect();
+  offset += index_offset;
+  m_draws.back().add_retained_entry(index_count, offset, base_vertex, header_location);
+  FASTUIDRAWunused(attributes_written);
+}
+
+void
+DrawCommand::
+header_changed(uint32_t header_location,
+               unsigned int attributes_written,
+               unsigned int indices_written) const
+{
+  /* the indices written since the last entry are of the
+     previous header; if there are none, only the header
+     of the entry being built changes.
+   */
+  if(indices_written != m_indices_written)
+    {
+      add_entry(indices_written);
+    }
+  m_header = header_location;
+  FASTUIDRAWunused(attributes_written);
+}
+
 void
 DrawCommand::
 draw(void) const
 {
+  FASTUIDRAWtrace_zone("PainterDrawGL::draw");
+
+  GLuint retained_vao(0);
+  painter_vao_pool *pool(m_pr->m_pool);
+
   glBindVertexArray(m_vao.m_vao);
   switch(m_vao.m_data_store_backing)
     {
@@ -806,12 +1555,14 @@ draw(void) const
       {
         glActiveTexture(GL_TEXTURE0 + m_vao.m_data_store_binding_point);
         glBindTexture(GL_TEXTURE_BUFFER, m_vao.m_data_tbo);
+        pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls) += 2;
       }
       break;
 
     case fastuidraw::gl::PainterBackendGL::data_store_ubo:
       {
         glBindBufferBase(GL_UNIFORM_BUFFER, m_vao.m_data_store_binding_point, m_vao.m_data_bo);
+        ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
       }
       break;
 
@@ -822,14 +1573,33 @@ draw(void) const
   if(m_pr->m_params.separate_program_for_discard())
     {
       m_pr->m_programs[fastuidraw::gl::PainterBackendGL::program_without_discard]->use_program();
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
+    }
+
+  if(m_pr->m_retained_geometry_store)
+    {
+      retained_vao = m_pr->m_retained_geometry_store->vao();
+    }
+
+  if(m_vao.m_indirect_bo != 0)
+    {
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_vao.m_indirect_bo);
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
     }
 
   for(std::list<DrawEntry>::const_iterator iter = m_draws.begin(),
         end = m_draws.end(); iter != end; ++iter)
     {
-      iter->draw();
+      iter->draw(m_vao.m_vao, retained_vao, pool);
     }
   glBindVertexArray(0);
+  pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls) += 2;
+
+  if(m_vao.m_indirect_bo != 0)
+    {
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+      ++pool->stat(fastuidraw::gl::PainterBackendGL::num_state_calls);
+    }
 }
 
 void
@@ -840,15 +1610,29 @@ unmap_implement(unsigned int attributes_written,
 {
   m_attributes_written = attributes_written;
   add_entry(indices_written);
+  flush_indirect();
   assert(m_indices_written == indices_written);
 
+  if(m_pr->m_pool->persistent_mapped())
+    {
+      /* the mappings are coherent, the writes are visible
+         to GL without flushing.
+       */
+      return;
+    }
+
+  elapsed_timer timer;
+
   glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_attribute_bo);
   glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, attributes_written * sizeof(fastuidraw::PainterAttribute));
   glUnmapBuffer(GL_ARRAY_BUFFER);
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_header_bo);
-  glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, attributes_written * sizeof(uint32_t));
-  glUnmapBuffer(GL_ARRAY_BUFFER);
+  if(!m_header_attributes.empty())
+    {
+      glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_header_bo);
+      glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, attributes_written * sizeof(uint32_t));
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
 
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vao.m_index_bo);
   glFlushMappedBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, indices_written * sizeof(fastuidraw::PainterIndex));
@@ -857,6 +1641,16 @@ unmap_implement(unsigned int attributes_written,
   glBindBuffer(GL_ARRAY_BUFFER, m_vao.m_data_bo);
   glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, data_store_written * sizeof(fastuidraw::generic_data));
   glUnmapBuffer(GL_ARRAY_BUFFER);
+
+  if(m_vao.m_indirect_bo != 0)
+    {
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_vao.m_indirect_bo);
+      glFlushMappedBufferRange(GL_DRAW_INDIRECT_BUFFER, 0, m_indirect_written * sizeof(DrawElementsIndirectCommand));
+      glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER);
+      glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+  m_pr->m_pool->stat(fastuidraw::gl::PainterBackendGL::buffer_map_time_us) += timer.elapsed_us();
 }
 
 void
@@ -872,11 +1666,54 @@ add_entry(unsigned int indices_written) const
     }
   assert(indices_written >= m_indices_written);
   count = indices_written - m_indices_written;
-  offset += m_indices_written;
-  m_draws.back().add_entry(count, offset);
+
+  if(m_indirect.empty())
+    {
+      offset += m_indices_written;
+      m_draws.back().add_entry(count, offset);
+    }
+  else if(count > 0)
+    {
+      /* the index ranges are contiguous, so the range can be
+         merged into the pending command if the header is the
+         same (the base instance is only non-zero when sourcing
+         the header from it).
+       */
+      if(m_pending.m_count > 0 && m_pending.m_base_instance == m_header)
+        {
+          assert(m_pending.m_first_index + m_pending.m_count == m_indices_written);
+          m_pending.m_count += count;
+        }
+      else
+        {
+          flush_indirect();
+          m_pending.m_count = count;
+          m_pending.m_instance_count = 1;
+          m_pending.m_first_index = m_indices_written;
+          m_pending.m_base_vertex = 0;
+          m_pending.m_base_instance = m_header;
+        }
+    }
   m_indices_written = indices_written;
 }
 
+void
+DrawCommand::
+flush_indirect(void) const
+{
+  if(m_pending.m_count == 0)
+    {
+      return;
+    }
+
+  assert(!m_draws.empty());
+  assert(m_indirect_written < m_indirect.size());
+  m_indirect[m_indirect_written] = m_pending;
+  m_draws.back().add_indirect_entry(m_indirect_written);
+  ++m_indirect_written;
+  m_pending.m_count = 0;
+}
+
 /////////////////////////////////////////
 // PainterBackendGLPrivate methods
 PainterBackendGLPrivate::
@@ -1063,6 +1900,21 @@ configure_backend(void)
   */
   m_params.separate_program_for_discard(m_params.separate_program_for_discard() && m_params.use_hw_clip_planes());
 
+  /* persistent mapping requires immutable buffer storage
+   */
+  #ifdef FASTUIDRAW_GL_USE_GLES
+    {
+      m_params.use_persistent_mapped_buffers(m_params.use_persistent_mapped_buffers()
+                                             && m_ctx_properties.has_extension("GL_EXT_buffer_storage"));
+    }
+  #else
+    {
+      m_params.use_persistent_mapped_buffers(m_params.use_persistent_mapped_buffers()
+                                             && (m_ctx_properties.version() >= fastuidraw::ivec2(4, 4)
+                                                 || m_ctx_properties.has_extension("GL_ARB_buffer_storage")));
+    }
+  #endif
+
   fastuidraw::gl::ColorStopAtlasGL *color;
   assert(dynamic_cast<fastuidraw::gl::ColorStopAtlasGL*>(m_params.colorstop_atlas().get()));
   color = static_cast<fastuidraw::gl::ColorStopAtlasGL*>(m_params.colorstop_atlas().get());
@@ -1124,12 +1976,88 @@ configure_backend(void)
     .colorstop_atlas_backing(colorstop_tp)
     .blend_type(m_p->configuration_glsl().default_blend_shader_type());
 
+  /* sourcing the header attribute from the base instance
+     requires glMultiDrawElementsIndirect with base instance
+     support.
+   */
+  #ifdef FASTUIDRAW_GL_USE_GLES
+    {
+      m_params.use_multi_draw_indirect((m_params.use_multi_draw_indirect() || m_params.header_via_base_instance())
+                                       && m_ctx_properties.version() >= fastuidraw::ivec2(3, 1)
+                                       && m_ctx_properties.has_extension("GL_EXT_multi_draw_indirect"));
+      m_params.header_via_base_instance(m_params.header_via_base_instance()
+                                        && m_params.use_multi_draw_indirect()
+                                        && m_ctx_properties.has_extension("GL_EXT_base_instance"));
+    }
+  #else
+    {
+      m_params.use_multi_draw_indirect((m_params.use_multi_draw_indirect() || m_params.header_via_base_instance())
+                                       && (m_ctx_properties.version() >= fastuidraw::ivec2(4, 3)
+                                           || m_ctx_properties.has_extension("GL_ARB_multi_draw_indirect")));
+      m_params.header_via_base_instance(m_params.header_via_base_instance()
+                                        && m_params.use_multi_draw_indirect()
+                                        && (m_ctx_properties.version() >= fastuidraw::ivec2(4, 3)
+                                            || m_ctx_properties.has_extension("GL_ARB_base_instance")));
+    }
+  #endif
+
   /* now allocate m_pool after adjusting m_params
    */
   m_pool = FASTUIDRAWnew painter_vao_pool(m_params, m_p->configuration_base(),
                                           m_tex_buffer_support,
                                           m_uber_shader_builder_params.binding_points());
 
+  /* the persistent data store is sourced as a texture
+     buffer, so it requires that the streamed data store
+     is as well.
+   */
+  if(m_params.data_store_backing() == fastuidraw::gl::PainterBackendGL::data_store_tbo
+     && m_params.persistent_data_store_blocks() > 0)
+    {
+      unsigned int max_texture_buffer_size;
+
+      max_texture_buffer_size = fastuidraw::gl::context_get<GLint>(GL_MAX_TEXTURE_BUFFER_SIZE);
+      m_params.persistent_data_store_blocks(fastuidraw::t_min(max_texture_buffer_size,
+                                                              m_params.persistent_data_store_blocks()));
+      m_persistent_data_store = FASTUIDRAWnew PersistentDataStoreGL(m_params.persistent_data_store_blocks(),
+                                                                    m_p->configuration_base().alignment(),
+                                                                    m_tex_buffer_support);
+      m_uber_shader_builder_params.use_persistent_data_store(true);
+    }
+  else
+    {
+      m_params.persistent_data_store_blocks(0);
+    }
+
+  /* drawing from the retained geometry store requires
+     glDrawElementsBaseVertex.
+   */
+  bool have_base_vertex;
+  #ifdef FASTUIDRAW_GL_USE_GLES
+    {
+      have_base_vertex = m_ctx_properties.version() >= fastuidraw::ivec2(3, 2);
+    }
+  #else
+    {
+      have_base_vertex = m_ctx_properties.version() >= fastuidraw::ivec2(3, 2)
+        || m_ctx_properties.has_extension("GL_ARB_draw_elements_base_vertex");
+    }
+  #endif
+
+  if(have_base_vertex
+     && m_params.retained_geometry_attributes() > 0
+     && m_params.retained_geometry_indices() > 0)
+    {
+      m_retained_geometry_store = FASTUIDRAWnew RetainedGeometryStoreGL(m_params.retained_geometry_attributes(),
+                                                                        m_params.retained_geometry_indices());
+    }
+  else
+    {
+      m_params
+        .retained_geometry_attributes(0)
+        .retained_geometry_indices(0);
+    }
+
   configure_source_front_matter();
 }
 
@@ -1174,6 +2102,12 @@ configure_source_front_matter(void)
           }
           break;
         }
+
+      if(m_uber_shader_builder_params.use_persistent_data_store())
+        {
+          m_initializer.add_sampler_initializer("fastuidraw_painterPersistentStore_tbo",
+                                                binding_points.persistent_data_store_buffer_tbo());
+        }
     }
 
   if(!m_uber_shader_builder_params.assign_layout_to_vertex_shader_inputs())
@@ -1334,9 +2268,21 @@ build_program(enum fastuidraw::gl::PainterBackendGL::program_type_t tp)
     .add_source(m_front_matter_frag);
 
   m_p->construct_shader(vert, frag, m_uber_shader_builder_params, &item_filter, discard_macro);
+
+  /* the shader IDs are added to the key so that a program
+     binary is only reused for the same set of registered
+     shaders.
+   */
+  std::ostringstream binary_cache_key;
+  binary_cache_key << "PainterBackendGL:" << tp
+                   << ":item_IDs=" << m_p->next_item_shader_ID()
+                   << ":blend_IDs=" << m_p->next_blend_shader_ID();
+
   return_value = FASTUIDRAWnew fastuidraw::gl::Program(vert, frag,
                                                        m_attribute_binder,
-                                                       m_initializer);
+                                                       m_initializer,
+                                                       m_params.program_binary_cache(),
+                                                       binary_cache_key.str().c_str());
   return return_value;
 }
 
@@ -1403,6 +2349,12 @@ setget_implement(unsigned int, attributes_per_buffer)
 setget_implement(unsigned int, indices_per_buffer)
 setget_implement(unsigned int, data_blocks_per_store_buffer)
 setget_implement(unsigned int, number_pools)
+setget_implement(bool, use_persistent_mapped_buffers)
+setget_implement(unsigned int, retained_geometry_attributes)
+setget_implement(unsigned int, retained_geometry_indices)
+setget_implement(unsigned int, persistent_data_store_blocks)
+setget_implement(bool, header_via_base_instance)
+setget_implement(bool, use_multi_draw_indirect)
 setget_implement(bool, break_on_shader_change)
 setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::ImageAtlasGL>&, image_atlas)
 setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::ColorStopAtlasGL>&, colorstop_atlas)
@@ -1418,6 +2370,7 @@ setget_implement(bool, assign_layout_to_varyings)
 setget_implement(bool, assign_binding_points)
 setget_implement(bool, use_ubo_for_uniforms)
 setget_implement(bool, separate_program_for_discard)
+setget_implement(const fastuidraw::reference_counted_ptr<fastuidraw::gl::ProgramBinaryCache>&, program_binary_cache)
 setget_implement(bool, non_dashed_stroke_shader_uses_discard)
 setget_implement(enum fastuidraw::PainterBlendShader::shader_type, blend_type)
 
@@ -1434,7 +2387,18 @@ PainterBackendGL(const ConfigurationGL &config_gl,
                      PainterBackendGLPrivate::compute_glsl_config(config_gl),
                      PainterBackendGLPrivate::compute_base_config(config_gl, config_base))
 {
-  m_d = FASTUIDRAWnew PainterBackendGLPrivate(config_gl, this);
+  PainterBackendGLPrivate *d;
+
+  d = FASTUIDRAWnew PainterBackendGLPrivate(config_gl, this);
+  m_d = d;
+  if(d->m_retained_geometry_store)
+    {
+      set_retained_geometry_store(d->m_retained_geometry_store);
+    }
+  if(d->m_persistent_data_store)
+    {
+      set_persistent_data_store(d->m_persistent_data_store);
+    }
 }
 
 fastuidraw::gl::PainterBackendGL::
@@ -1601,6 +2565,13 @@ on_pre_draw(void)
   glBindSampler(binding_points.colorstop_atlas(), 0);
   glBindTexture(ColorStopAtlasGL::texture_bind_target(), color->texture());
 
+  if(d->m_persistent_data_store)
+    {
+      glActiveTexture(GL_TEXTURE0 + binding_points.persistent_data_store_buffer_tbo());
+      glBindSampler(binding_points.persistent_data_store_buffer_tbo(), 0);
+      glBindTexture(GL_TEXTURE_BUFFER, d->m_persistent_data_store->tbo());
+    }
+
   //grabbing the programs via programs() makes sure they
   //are built.
   const PainterBackendGLPrivate::program_set &prs(d->programs(shader_code_added()));
@@ -1622,13 +2593,21 @@ on_pre_draw(void)
 
       ubo = d->m_pool->request_uniform_ubo(size_bytes, GL_UNIFORM_BUFFER);
       assert(ubo != 0);
-      // request_uniform_ubo also binds the buffer for us
-      ubo_mapped = glMapBufferRange(GL_UNIFORM_BUFFER, 0, size_bytes,
-                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+      if(d->m_pool->persistent_mapped())
+        {
+          ubo_mapped = d->m_pool->uniform_ubo_mapped();
+          fill_uniform_buffer(c_array<generic_data>(static_cast<generic_data*>(ubo_mapped), size_generics));
+        }
+      else
+        {
+          // request_uniform_ubo also binds the buffer for us
+          ubo_mapped = glMapBufferRange(GL_UNIFORM_BUFFER, 0, size_bytes,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
 
-      fill_uniform_buffer(c_array<generic_data>(static_cast<generic_data*>(ubo_mapped), size_generics));
-      glFlushMappedBufferRange(GL_UNIFORM_BUFFER, 0, size_bytes);
-      glUnmapBuffer(GL_UNIFORM_BUFFER);
+          fill_uniform_buffer(c_array<generic_data>(static_cast<generic_data*>(ubo_mapped), size_generics));
+          glFlushMappedBufferRange(GL_UNIFORM_BUFFER, 0, size_bytes);
+          glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
 
       glBindBufferBase(GL_UNIFORM_BUFFER, d->m_uber_shader_builder_params.binding_points().uniforms_ubo(), ubo);
     }
@@ -1699,6 +2678,12 @@ on_post_draw(void)
   glActiveTexture(GL_TEXTURE0 + binding_points.colorstop_atlas());
   glBindTexture(ColorStopAtlasGL::texture_bind_target(), 0);
 
+  if(d->m_persistent_data_store)
+    {
+      glActiveTexture(GL_TEXTURE0 + binding_points.persistent_data_store_buffer_tbo());
+      glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
   switch(d->m_params.data_store_backing())
     {
     case fastuidraw::gl::PainterBackendGL::data_store_tbo:
@@ -1721,6 +2706,15 @@ on_post_draw(void)
   d->m_pool->next_pool();
 }
 
+uint64_t
+fastuidraw::gl::PainterBackendGL::
+query_stat(enum stats_t st) const
+{
+  PainterBackendGLPrivate *d;
+  d = static_cast<PainterBackendGLPrivate*>(m_d);
+  return d->m_pool->stat(st);
+}
+
 fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw>
 fastuidraw::gl::PainterBackendGL::
 map_draw(void)
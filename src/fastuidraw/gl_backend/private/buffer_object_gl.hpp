@@ -19,21 +19,19 @@
 
 #pragma once
 
+#include <vector>
+#include <fastuidraw/util/tracing.hpp>
 #include <fastuidraw/gl_backend/ngl_header.hpp>
 #include <fastuidraw/gl_backend/gl_get.hpp>
+#include "staged_writes.hpp"
 
 namespace fastuidraw { namespace gl { namespace detail {
 
-class BufferGLEntryLocation
-{
-public:
-  int m_location;
-  std::vector<uint8_t> m_data;
-};
-
 /*!\class BufferGL
   Wrapper over the GL buffer API providing ability to delay updates to
-  undlering buffer until flush().
+  undlering buffer until flush(). Delayed updates are staged in a
+  StagedWrites and those that are contiguous are uploaded with
+  a single glBufferSubData().
   \tparam binding_point GL binding point (ala glBindBuffer) to use for GL
                         operations
   \tparam usage GL usage parameter to pass to glBufferData when buffer
@@ -80,10 +78,7 @@ public:
     assert(!data.empty());
     if(m_delayed)
       {
-        m_unflushed_commands.push_back(BufferGLEntryLocation());
-        m_unflushed_commands.back().m_location = offset;
-        m_unflushed_commands.back().m_data.resize(data.size());
-        std::copy(data.begin(), data.end(), m_unflushed_commands.back().m_data.begin());
+        m_staged_writes.add(vecN<int, 1>(offset), vecN<GLsizei, 1>(data.size()), data);
       }
     else
       {
@@ -97,16 +92,7 @@ public:
   set_data_vector(int offset, std::vector<uint8_t> &data)
   {
     assert(!data.empty());
-    if(m_delayed)
-      {
-        m_unflushed_commands.push_back(BufferGLEntryLocation());
-        m_unflushed_commands.back().m_location = offset;
-        m_unflushed_commands.back().m_data.swap(data);
-      }
-    else
-      {
-        set_data(offset, data);
-      }
+    set_data(offset, const_c_array<uint8_t>(&data[0], data.size()));
   }
 
   void
@@ -118,16 +104,21 @@ public:
         create_buffer();
       }
 
-    if(!m_unflushed_commands.empty())
+    if(!m_staged_writes.empty())
       {
+        FASTUIDRAWtrace_zone("BufferGL::flush_staged_writes");
+
+        m_packed.resize(m_staged_writes.coalesce());
+        m_staged_writes.pack(&m_packed[0]);
+
         glBindBuffer(binding_point, m_buffer);
-        for(typename std::list<BufferGLEntryLocation>::iterator iter = m_unflushed_commands.begin(),
-              end = m_unflushed_commands.end(); iter != end; ++iter)
+        for(typename std::vector<StagedWrites<1>::block>::const_iterator
+              iter = m_staged_writes.blocks().begin(),
+              end = m_staged_writes.blocks().end(); iter != end; ++iter)
           {
-            assert(!iter->m_data.empty());
-            glBufferSubData(binding_point, iter->m_location, iter->m_data.size(), &iter->m_data[0]);
+            glBufferSubData(binding_point, iter->m_location[0], iter->m_size[0], &m_packed[iter->m_offset]);
           }
-        m_unflushed_commands.clear();
+        m_staged_writes.clear();
       }
   }
 
@@ -144,9 +135,17 @@ public:
     return m_size;
   }
 
+  /* the resize takes effect at the next flush() (or set_data()
+     if not delayed); when the buffer is made smaller, staged
+     writes beyond the new size are dropped.
+   */
   void
   resize(GLsizei new_size)
   {
+    if(new_size < m_size)
+      {
+        m_staged_writes.discard_outside(vecN<int, 1>(new_size));
+      }
     m_size = new_size;
   }
 
@@ -205,7 +204,8 @@ private:
   GLsizei m_buffer_size;
   bool m_delayed;
   mutable GLuint m_buffer;
-  std::list<BufferGLEntryLocation> m_unflushed_commands;
+  StagedWrites<1> m_staged_writes;
+  std::vector<uint8_t> m_packed;
 };
 
 } //namespace detail
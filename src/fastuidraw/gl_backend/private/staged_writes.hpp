@@ -0,0 +1,638 @@
+/*!
+ * \file staged_writes.hpp
+ * \brief file staged_writes.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <fastuidraw/util/vecN.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/gl_backend/ngl_header.hpp>
+
+namespace fastuidraw { namespace gl { namespace detail {
+
+/*!\class StagedWrites
+  A StagedWrites records the writes to an N-dimensional GL
+  object (a texture or, with N = 1 and one byte per element,
+  a buffer object) that are delayed until a flush. The data of
+  all writes is appended to a single array whose capacity is kept
+  across flushes, so staging a write does not allocate once warm.
+  At flush, coalesce() sorts the writes by layer, row and column
+  and merges writes into blocks, then pack() writes the blocks,
+  tightly packed, to the memory from which they are uploaded
+  (typically a mapped pixel-buffer object), so that each block is
+  uploaded with a single GL call.
+
+  A block is the bounding box of writes of a band of rows of a
+  layer. The elements of the box that no write of the block covers
+  (the gaps) are uploaded too, with undefined values, so a block
+  has gaps only if all elements of its box were never written
+  before the flush, which StagedWrites tracks with the highest row
+  written of each column of each layer, and if no write uploaded
+  before it in the flush covers them. The gaps of a block are at
+  most as many elements as its writes cover. Writes that exactly
+  tile a box, such as writes next to each other with the same
+  rows or the consecutive full rows of a write of a texture used
+  as a linear array, always merge.
+
+  If two writes overlap, which happens only when a region is
+  freed and allocated again between flushes, the writes are not
+  sorted so that they reach the GL object in the order made and
+  only writes next to each other in the same rows merge.
+  \tparam N dimension of the GL object; the first coordinate is
+            the column, the second (if N > 1) is the row and
+            the coordinates after are layers
+ */
+template<size_t N>
+class StagedWrites
+{
+public:
+  /*!
+    A block of data to upload with a single GL call.
+   */
+  class block
+  {
+  public:
+    vecN<int, N> m_location;
+    vecN<GLsizei, N> m_size;
+
+    /* offset in bytes into the data written by pack() */
+    unsigned int m_offset;
+
+    /* range into StagedWrites::m_order of the writes of the block */
+    unsigned int m_first_write, m_number_writes;
+
+    /* bytes per element and number of elements of the writes */
+    unsigned int m_bytes_per_element, m_number_elements;
+  };
+
+  StagedWrites(void):
+    m_packed_size(0)
+  {}
+
+  bool
+  empty(void) const
+  {
+    return m_writes.empty();
+  }
+
+  /*!
+    Number of writes staged since the last clear().
+   */
+  unsigned int
+  number_writes(void) const
+  {
+    return m_writes.size();
+  }
+
+  /*!
+    Stage a write.
+    \param location location of the write
+    \param size size of the write
+    \param data data of the write, must be a multiple in size
+                of the number of elements the write covers
+   */
+  void
+  add(const vecN<int, N> &location, const vecN<GLsizei, N> &size,
+      const_c_array<uint8_t> data)
+  {
+    write W;
+    unsigned int number_elements(1);
+
+    for(unsigned int i = 0; i < N; ++i)
+      {
+        number_elements *= size[i];
+      }
+
+    assert(number_elements > 0);
+    assert(data.size() % number_elements == 0);
+
+    W.m_location = location;
+    W.m_size = size;
+    W.m_bytes_per_element = data.size() / number_elements;
+    W.m_data_offset = m_data.size();
+    m_data.insert(m_data.end(), data.begin(), data.end());
+    m_writes.push_back(W);
+  }
+
+  /*!
+    Compute the blocks (see blocks()) from the staged writes,
+    returning the number of bytes pack() writes.
+   */
+  unsigned int
+  coalesce(void)
+  {
+    bool in_order;
+
+    m_order.resize(m_writes.size());
+    for(unsigned int i = 0, endi = m_writes.size(); i < endi; ++i)
+      {
+        m_order[i] = i;
+      }
+    std::sort(m_order.begin(), m_order.end(), sort_order(m_writes));
+    in_order = sorted_writes_overlap();
+    if(in_order)
+      {
+        for(unsigned int i = 0, endi = m_writes.size(); i < endi; ++i)
+          {
+            m_order[i] = i;
+          }
+      }
+
+    m_blocks.clear();
+    m_active.clear();
+    for(unsigned int i = 0, endi = m_order.size(); i < endi; ++i)
+      {
+        const write &W(m_writes[m_order[i]]);
+        bool merged;
+
+        if(m_blocks.empty())
+          {
+            merged = false;
+          }
+        else if(in_order)
+          {
+            merged = can_append(m_writes[m_order[i - 1]], W)
+              && merge_into_block(m_blocks.back(), W, false);
+          }
+        else
+          {
+            merged = merge_into_block(m_blocks.back(), W, true);
+          }
+
+        if(!merged)
+          {
+            block B;
+
+            if(!m_blocks.empty())
+              {
+                close_block(m_blocks.back(), W);
+              }
+            B.m_location = W.m_location;
+            B.m_size = W.m_size;
+            B.m_first_write = i;
+            B.m_number_writes = 1;
+            B.m_bytes_per_element = W.m_bytes_per_element;
+            B.m_number_elements = number_elements(W.m_size);
+            m_blocks.push_back(B);
+          }
+      }
+
+    m_packed_size = 0;
+    for(unsigned int b = 0, endb = m_blocks.size(); b < endb; ++b)
+      {
+        block &B(m_blocks[b]);
+
+        /* keep each block 4-byte aligned within the pack */
+        m_packed_size = (m_packed_size + 3u) & ~3u;
+        B.m_offset = m_packed_size;
+        m_packed_size += B.m_bytes_per_element * number_elements(B.m_size);
+      }
+
+    update_high_water();
+    return m_packed_size;
+  }
+
+  /*!
+    Blocks computed by the last call to coalesce().
+   */
+  const std::vector<block>&
+  blocks(void) const
+  {
+    return m_blocks;
+  }
+
+  /*!
+    Write the data of the blocks computed by the last call
+    to coalesce() to dst, where the data of a block starts
+    at block::m_offset bytes.
+    \param dst location to which to write, must be atleast
+               the size returned by coalesce().
+   */
+  void
+  pack(uint8_t *dst) const
+  {
+    for(unsigned int b = 0, endb = m_blocks.size(); b < endb; ++b)
+      {
+        const block &B(m_blocks[b]);
+        unsigned int block_row_bytes;
+
+        block_row_bytes = B.m_size[0] * B.m_bytes_per_element;
+        for(unsigned int w = B.m_first_write, endw = w + B.m_number_writes; w < endw; ++w)
+          {
+            const write &W(m_writes[m_order[w]]);
+            unsigned int row_bytes, number_rows, column;
+
+            row_bytes = W.m_size[0] * W.m_bytes_per_element;
+            number_rows = number_elements(W.m_size) / W.m_size[0];
+            column = (W.m_location[0] - B.m_location[0]) * W.m_bytes_per_element;
+            for(unsigned int r = 0; r < number_rows; ++r)
+              {
+                unsigned int box_row(0), box_stride(1), t(r);
+
+                /* the rows of the write and of the box are their
+                   rows in each of their layers one after the other.
+                 */
+                for(unsigned int k = 1; k < N; ++k)
+                  {
+                    box_row += (W.m_location[k] - B.m_location[k] + t % W.m_size[k]) * box_stride;
+                    box_stride *= B.m_size[k];
+                    t /= W.m_size[k];
+                  }
+
+                std::memcpy(dst + B.m_offset + box_row * block_row_bytes + column,
+                            &m_data[W.m_data_offset + r * row_bytes],
+                            row_bytes);
+              }
+          }
+      }
+  }
+
+  /*!
+    Remove the staged writes that are not entirely within
+    the region from the origin of the given size, for when
+    the GL object is made smaller; the data of such writes
+    is to room that is no longer used.
+    \param size size of the region
+   */
+  void
+  discard_outside(const vecN<int, N> &size)
+  {
+    unsigned int j(0);
+
+    for(unsigned int i = 0, endi = m_writes.size(); i < endi; ++i)
+      {
+        bool inside(true);
+
+        for(unsigned int k = 0; k < N && inside; ++k)
+          {
+            inside = (m_writes[i].m_location[k] + m_writes[i].m_size[k] <= size[k]);
+          }
+
+        if(inside)
+          {
+            m_writes[j++] = m_writes[i];
+          }
+      }
+    m_writes.resize(j);
+  }
+
+  /*!
+    Remove all staged writes, keeping the memory
+    allocated for the next writes.
+   */
+  void
+  clear(void)
+  {
+    m_data.clear();
+    m_writes.clear();
+    m_order.clear();
+    m_blocks.clear();
+    m_active.clear();
+    m_packed_size = 0;
+  }
+
+private:
+  class write
+  {
+  public:
+    vecN<int, N> m_location;
+    vecN<GLsizei, N> m_size;
+    unsigned int m_bytes_per_element;
+    unsigned int m_data_offset;
+  };
+
+  /* sort by layer, then row, then column; ties
+     are kept in the order the writes were made.
+   */
+  class sort_order
+  {
+  public:
+    explicit
+    sort_order(const std::vector<write> &writes):
+      m_writes(writes)
+    {}
+
+    bool
+    operator()(unsigned int lhs, unsigned int rhs) const
+    {
+      for(unsigned int i = N; i > 0; --i)
+        {
+          if(m_writes[lhs].m_location[i - 1] != m_writes[rhs].m_location[i - 1])
+            {
+              return m_writes[lhs].m_location[i - 1] < m_writes[rhs].m_location[i - 1];
+            }
+        }
+      return lhs < rhs;
+    }
+
+  private:
+    const std::vector<write> &m_writes;
+  };
+
+  /* the dimension along which to sweep for overlaps:
+     the row, or the column if N is 1.
+   */
+  enum { sweep = (N > 1) ? 1 : 0 };
+
+  static
+  unsigned int
+  number_elements(const vecN<GLsizei, N> &sz)
+  {
+    unsigned int return_value(1);
+    for(unsigned int i = 0; i < N; ++i)
+      {
+        return_value *= sz[i];
+      }
+    return return_value;
+  }
+
+  static
+  bool
+  same_layer(const write &a, const write &b)
+  {
+    for(unsigned int i = sweep + 1; i < N; ++i)
+      {
+        if(a.m_location[i] != b.m_location[i])
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  /* b is placed right after a in the same rows */
+  static
+  bool
+  can_append(const write &a, const write &b)
+  {
+    if(a.m_bytes_per_element != b.m_bytes_per_element
+       || b.m_location[0] != a.m_location[0] + a.m_size[0])
+      {
+        return false;
+      }
+
+    for(unsigned int i = 1; i < N; ++i)
+      {
+        if(a.m_location[i] != b.m_location[i] || a.m_size[i] != b.m_size[i])
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  static
+  unsigned int
+  layer_of(const vecN<int, N> &location)
+  {
+    return (N > 2) ? location[N - 1] : 0;
+  }
+
+  /* if the bounding box of the block and W is a block (see
+     the class description), make it the block and return
+     true; may_pad is false if the box must not have gaps.
+   */
+  bool
+  merge_into_block(block &B, const write &W, bool may_pad)
+  {
+    vecN<int, N> location, size;
+    unsigned int box_elements, write_elements;
+
+    if(B.m_bytes_per_element != W.m_bytes_per_element)
+      {
+        return false;
+      }
+
+    /* the sorted writes of a band start no further than
+       the end of the rows of the block.
+     */
+    if(N > 1 && W.m_location[sweep] > B.m_location[sweep] + B.m_size[sweep])
+      {
+        return false;
+      }
+
+    box_elements = 1;
+    for(unsigned int i = 0; i < N; ++i)
+      {
+        location[i] = std::min(B.m_location[i], W.m_location[i]);
+        size[i] = std::max(B.m_location[i] + B.m_size[i], W.m_location[i] + W.m_size[i]) - location[i];
+        box_elements *= size[i];
+      }
+
+    write_elements = number_elements(W.m_size);
+    if(box_elements != B.m_number_elements + write_elements)
+      {
+        if(!may_pad
+           || N == 1
+           || (N > 2 && size[N - 1] != 1)
+           || box_elements > 2 * (B.m_number_elements + write_elements)
+           || !never_written(location, size)
+           || covers_active(location, size))
+          {
+            return false;
+          }
+      }
+
+    B.m_location = location;
+    B.m_size = size;
+    B.m_number_elements += write_elements;
+    ++B.m_number_writes;
+    return true;
+  }
+
+  /* a block is finished, its writes are uploaded before
+     those of the following blocks; keep those the next
+     blocks may cover, i.e. of the layer and rows of W.
+   */
+  void
+  close_block(const block &B, const write &W)
+  {
+    unsigned int j(0);
+
+    for(unsigned int i = 0, endi = m_active.size(); i < endi; ++i)
+      {
+        const write &A(m_writes[m_active[i]]);
+        if(layer_of(A.m_location) == layer_of(W.m_location)
+           && A.m_location[sweep] + A.m_size[sweep] > W.m_location[sweep])
+          {
+            m_active[j++] = m_active[i];
+          }
+      }
+    m_active.resize(j);
+
+    for(unsigned int w = B.m_first_write, endw = w + B.m_number_writes; w < endw; ++w)
+      {
+        m_active.push_back(m_order[w]);
+      }
+  }
+
+  /* true if a write uploaded in a block before covers an
+     element of the box
+   */
+  bool
+  covers_active(const vecN<int, N> &location, const vecN<int, N> &size) const
+  {
+    for(unsigned int i = 0, endi = m_active.size(); i < endi; ++i)
+      {
+        const write &A(m_writes[m_active[i]]);
+        bool overlap(true);
+
+        for(unsigned int k = 0; k < N && overlap; ++k)
+          {
+            overlap = A.m_location[k] < location[k] + size[k]
+              && location[k] < A.m_location[k] + A.m_size[k];
+          }
+
+        if(overlap)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /* true if no element of the box (of one layer) was written
+     before the flush, i.e. all its rows are at or past the
+     rows written of its columns.
+   */
+  bool
+  never_written(const vecN<int, N> &location, const vecN<int, N> &size) const
+  {
+    unsigned int layer(layer_of(location));
+
+    if(layer < m_high_water.size())
+      {
+        const std::vector<int> &H(m_high_water[layer]);
+        for(int x = location[0], endx = std::min(location[0] + size[0], static_cast<int>(H.size())); x < endx; ++x)
+          {
+            if(H[x] > location[sweep])
+              {
+                return false;
+              }
+          }
+      }
+    return true;
+  }
+
+  /* record the rows written by the flushed writes */
+  void
+  update_high_water(void)
+  {
+    if(N == 1)
+      {
+        return;
+      }
+
+    for(unsigned int i = 0, endi = m_writes.size(); i < endi; ++i)
+      {
+        const write &W(m_writes[i]);
+        unsigned int first_layer(layer_of(W.m_location));
+        unsigned int end_layer(first_layer + ((N > 2) ? W.m_size[N - 1] : 1));
+        int end_row(W.m_location[sweep] + W.m_size[sweep]);
+
+        if(m_high_water.size() < end_layer)
+          {
+            m_high_water.resize(end_layer);
+          }
+
+        for(unsigned int layer = first_layer; layer < end_layer; ++layer)
+          {
+            std::vector<int> &H(m_high_water[layer]);
+            if(H.size() < static_cast<unsigned int>(W.m_location[0] + W.m_size[0]))
+              {
+                H.resize(W.m_location[0] + W.m_size[0], 0);
+              }
+            for(int x = W.m_location[0], endx = x + W.m_size[0]; x < endx; ++x)
+              {
+                H[x] = std::max(H[x], end_row);
+              }
+          }
+      }
+  }
+
+  /* sweep along the rows of each layer of the sorted writes,
+     keeping those writes whose rows cover the current row;
+     the number of such writes is small (the number of
+     writes that fit side by side in a row).
+   */
+  bool
+  sorted_writes_overlap(void)
+  {
+    m_active.clear();
+    for(unsigned int k = 0, endk = m_order.size(); k < endk; ++k)
+      {
+        const write &W(m_writes[m_order[k]]);
+        unsigned int j;
+
+        /* a write covering several layers is not handled
+           by the sweep, take the conservative path.
+         */
+        for(unsigned int i = sweep + 1; i < N; ++i)
+          {
+            if(W.m_size[i] != 1)
+              {
+                return true;
+              }
+          }
+
+        if(k > 0 && !same_layer(m_writes[m_order[k - 1]], W))
+          {
+            m_active.clear();
+          }
+
+        j = 0;
+        for(unsigned int i = 0, endi = m_active.size(); i < endi; ++i)
+          {
+            const write &A(m_writes[m_active[i]]);
+            if(A.m_location[sweep] + A.m_size[sweep] > W.m_location[sweep])
+              {
+                /* A covers the row of W, check the columns */
+                if(sweep == 0
+                   || (A.m_location[0] < W.m_location[0] + W.m_size[0]
+                       && W.m_location[0] < A.m_location[0] + A.m_size[0]))
+                  {
+                    return true;
+                  }
+                m_active[j++] = m_active[i];
+              }
+          }
+        m_active.resize(j);
+        m_active.push_back(m_order[k]);
+      }
+    return false;
+  }
+
+  std::vector<uint8_t> m_data;
+  std::vector<write> m_writes;
+  std::vector<unsigned int> m_order, m_active;
+  std::vector<block> m_blocks;
+  unsigned int m_packed_size;
+
+  /* for each layer and column, one past the last row
+     written by the writes flushed so far
+   */
+  std::vector<std::vector<int> > m_high_water;
+};
+
+} //namespace detail
+} //namespace gl
+} //namespace fastuidraw
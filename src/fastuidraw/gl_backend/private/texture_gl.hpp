@@ -19,13 +19,14 @@
 
 #pragma once
 
-#include <list>
 #include <vector>
 #include <algorithm>
 
 #include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include <fastuidraw/gl_backend/ngl_header.hpp>
 #include <fastuidraw/gl_backend/gl_context_properties.hpp>
+#include "staged_writes.hpp"
 
 namespace fastuidraw { namespace gl { namespace detail {
 
@@ -238,7 +239,6 @@ template<size_t N>
 class EntryLocationN
 {
 public:
-  typedef std::pair<EntryLocationN, std::vector<uint8_t> > with_data;
   vecN<int, N> m_location;
   vecN<GLsizei, N> m_size;
 };
@@ -277,9 +277,22 @@ public:
   set_data_c_array(const EntryLocation &loc,
                    const_c_array<uint8_t> data);
 
+  /* the resize takes effect at the next flush() (or
+     set_data_c_array() if not delayed); when the texture
+     is made smaller, staged writes beyond the new
+     dimensions are dropped.
+   */
   void
   resize(vecN<int, N> new_num_layers)
   {
+    for(unsigned int i = 0; i < N; ++i)
+      {
+        if(new_num_layers[i] < m_dims[i])
+          {
+            m_staged_writes.discard_outside(new_num_layers);
+            break;
+          }
+      }
     m_dims = new_num_layers;
   }
 
@@ -295,6 +308,9 @@ private:
   void
   flush_size_change(void);
 
+  void
+  flush_staged_writes(void);
+
   GLenum m_internal_format;
   GLenum m_external_format;
   GLenum m_external_type;
@@ -308,10 +324,12 @@ private:
   mutable int m_number_times_create_texture_called;
   CopyImageSubData m_blitter;
 
-  typedef typename EntryLocation::with_data with_data;
-  typedef std::list<with_data> list_type;
-
-  list_type m_unflushed_commands;
+  /* writes delayed until flush(), uploaded through
+     the pixel-buffer object m_pbo.
+   */
+  StagedWrites<N> m_staged_writes;
+  GLuint m_pbo;
+  std::vector<uint8_t> m_pbo_fallback;
 };
 
 ///////////////////////////////////////
@@ -330,7 +348,8 @@ TextureGLGeneric(GLenum internal_format,
   m_delayed(delayed),
   m_dims(dims),
   m_texture(0),
-  m_number_times_create_texture_called(0)
+  m_number_times_create_texture_called(0),
+  m_pbo(0)
 {
   if(!m_delayed)
     {
@@ -347,6 +366,11 @@ TextureGLGeneric<texture_target>::
     {
       delete_texture();
     }
+
+  if(m_pbo != 0)
+    {
+      glDeleteBuffers(1, &m_pbo);
+    }
 }
 
 template<GLenum texture_target>
@@ -468,54 +492,83 @@ flush(void)
       create_texture();
     }
 
-  if(!m_unflushed_commands.empty())
+  if(!m_staged_writes.empty())
     {
-      glBindTexture(texture_target, m_texture);
-      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-      for(typename list_type::iterator iter = m_unflushed_commands.begin(),
-            end = m_unflushed_commands.end(); iter != end; ++iter)
-        {
-          assert(!iter->second.empty());
-          tex_sub_image(texture_target,
-                        iter->first.m_location,
-                        iter->first.m_size,
-                        m_external_format, m_external_type,
-                        &iter->second[0]);
-        }
-      m_unflushed_commands.clear();
+      flush_staged_writes();
     }
 }
 
-
 template<GLenum texture_target>
 void
 TextureGLGeneric<texture_target>::
-set_data_vector(const EntryLocation &loc,
-                std::vector<uint8_t> &data)
+flush_staged_writes(void)
 {
-  if(data.empty())
+  FASTUIDRAWtrace_zone("TextureGL::flush_staged_writes");
+
+  unsigned int packed_size;
+  void *dst;
+
+  packed_size = m_staged_writes.coalesce();
+  if(m_pbo == 0)
     {
-      return;
+      glGenBuffers(1, &m_pbo);
+      assert(m_pbo != 0);
     }
 
-  if(m_delayed)
+  /* orphan the previous contents of the pixel-buffer
+     object so that filling it does not wait on the
+     uploads of the previous flush.
+   */
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, packed_size, nullptr, GL_STREAM_DRAW);
+  dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, packed_size,
+                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if(dst != nullptr)
     {
-      m_unflushed_commands.push_back(typename EntryLocation::with_data());
-      typename EntryLocation::with_data &R(m_unflushed_commands.back());
-      R.first = loc;
-      R.second.swap(data);
+      m_staged_writes.pack(static_cast<uint8_t*>(dst));
     }
-  else
+
+  /* if the mapping failed or its content was lost while
+     mapped (glUnmapBuffer() returns GL_FALSE), pack to
+     memory and upload it with glBufferSubData().
+   */
+  if(dst == nullptr || glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
     {
-      flush_size_change();
-      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-      glBindTexture(texture_target, m_texture);
+      m_pbo_fallback.resize(packed_size);
+      m_staged_writes.pack(&m_pbo_fallback[0]);
+      glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, packed_size, &m_pbo_fallback[0]);
+    }
+
+  glBindTexture(texture_target, m_texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for(typename std::vector<typename StagedWrites<N>::block>::const_iterator
+        iter = m_staged_writes.blocks().begin(),
+        end = m_staged_writes.blocks().end(); iter != end; ++iter)
+    {
+      const uint8_t *offset(nullptr);
       tex_sub_image(texture_target,
-                    loc.m_location,
-                    loc.m_size,
+                    iter->m_location,
+                    iter->m_size,
                     m_external_format, m_external_type,
-                    &data[0]);
+                    offset + iter->m_offset);
     }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  m_staged_writes.clear();
+}
+
+
+template<GLenum texture_target>
+void
+TextureGLGeneric<texture_target>::
+set_data_vector(const EntryLocation &loc,
+                std::vector<uint8_t> &data)
+{
+  if(data.empty())
+    {
+      return;
+    }
+
+  set_data_c_array(loc, const_c_array<uint8_t>(&data[0], data.size()));
 }
 
 template<GLenum texture_target>
@@ -531,10 +584,7 @@ set_data_c_array(const EntryLocation &loc,
 
   if(m_delayed)
     {
-      std::vector<uint8_t> data_copy;
-      data_copy.resize(data.size());
-      std::copy(data.begin(), data.end(), data_copy.begin());
-      set_data_vector(loc, data_copy);
+      m_staged_writes.add(loc.m_location, loc.m_size, data);
     }
   else
     {
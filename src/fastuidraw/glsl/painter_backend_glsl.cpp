@@ -93,6 +93,7 @@ namespace
       m_glyph_atlas_geometry_store(6),
       m_data_store_buffer_tbo(7),
       m_data_store_buffer_ubo(0),
+      m_persistent_data_store_buffer_tbo(8),
       m_uniforms_ubo(1)
     {}
 
@@ -105,6 +106,7 @@ namespace
     unsigned int m_glyph_atlas_geometry_store;
     unsigned int m_data_store_buffer_tbo;
     unsigned int m_data_store_buffer_ubo;
+    unsigned int m_persistent_data_store_buffer_tbo;
     unsigned int m_uniforms_ubo;
   };
 
@@ -123,6 +125,7 @@ namespace
       m_unpack_header_and_brush_in_frag_shader(false),
       m_data_store_backing(fastuidraw::glsl::PainterBackendGLSL::data_store_tbo),
       m_data_blocks_per_store_buffer(-1),
+      m_use_persistent_data_store(false),
       m_glyph_geometry_backing(fastuidraw::glsl::PainterBackendGLSL::glyph_geometry_tbo),
       m_glyph_geometry_backing_log2_dims(-1, -1),
       m_have_float_glyph_texture_atlas(true),
@@ -142,6 +145,7 @@ namespace
     bool m_unpack_header_and_brush_in_frag_shader;
     enum fastuidraw::glsl::PainterBackendGLSL::data_store_backing_t m_data_store_backing;
     int m_data_blocks_per_store_buffer;
+    bool m_use_persistent_data_store;
     enum fastuidraw::glsl::PainterBackendGLSL::glyph_geometry_backing_t m_glyph_geometry_backing;
     fastuidraw::ivec2 m_glyph_geometry_backing_log2_dims;
     bool m_have_float_glyph_texture_atlas;
@@ -356,6 +360,9 @@ ready_brush_varyings(void)
                                      coordinate goes beyond image size)
        - fastuidraw_brush_image_factor ratio of master index tile size to
                                        dimension of image
+       - fastuidraw_brush_image_start start of the sub-image within the image
+       - fastuidraw_brush_image_mipmap_location location in the data store of the
+                                                mipmap levels of the image
     */
     .add_float_varying("fastuidraw_brush_image_x", varying_list::interpolation_flat)
     .add_float_varying("fastuidraw_brush_image_y", varying_list::interpolation_flat)
@@ -365,6 +372,9 @@ ready_brush_varyings(void)
     .add_float_varying("fastuidraw_brush_image_factor", varying_list::interpolation_flat)
     .add_uint_varying("fastuidraw_brush_image_slack")
     .add_uint_varying("fastuidraw_brush_image_number_index_lookups")
+    .add_float_varying("fastuidraw_brush_image_start_x", varying_list::interpolation_flat)
+    .add_float_varying("fastuidraw_brush_image_start_y", varying_list::interpolation_flat)
+    .add_uint_varying("fastuidraw_brush_image_mipmap_location")
 
     /* ColorStop paremeters (only active if gradient active)
        - fastuidraw_brush_color_stop_xy (x,y) texture coordinates of start of color stop
@@ -452,6 +462,14 @@ add_enums(fastuidraw::glsl::ShaderSource &src)
     .add_macro("fastuidraw_shader_repeat_window_mask", PainterBrush::repeat_window_mask)
     .add_macro("fastuidraw_shader_transformation_translation_mask", PainterBrush::transformation_translation_mask)
     .add_macro("fastuidraw_shader_transformation_matrix_mask", PainterBrush::transformation_matrix_mask)
+    .add_macro("fastuidraw_shader_image_mipmap_levels_mask", PainterBrush::image_mipmap_levels_mask)
+    .add_macro("fastuidraw_shader_image_mipmap_levels_bit0", PainterBrush::image_mipmap_levels_bit0)
+    .add_macro("fastuidraw_shader_image_mipmap_levels_num_bits", PainterBrush::image_mipmap_levels_num_bits)
+    .add_macro("fastuidraw_image_mipmap_finest_level_offset", PainterBrush::image_mipmap_finest_level_offset)
+    .add_macro("fastuidraw_image_mipmap_levels_offset", PainterBrush::image_mipmap_levels_offset)
+    .add_macro("fastuidraw_image_mipmap_level_atlas_location_xyz_offset", PainterBrush::image_mipmap_level_atlas_location_xyz_offset)
+    .add_macro("fastuidraw_image_mipmap_level_number_lookups_offset", PainterBrush::image_mipmap_level_number_lookups_offset)
+    .add_macro("fastuidraw_image_mipmap_level_data_size", PainterBrush::image_mipmap_level_data_size)
     .add_macro("fastuidraw_image_number_index_lookup_bit0", PainterBrush::image_number_index_lookups_bit0)
     .add_macro("fastuidraw_image_number_index_lookup_num_bits", PainterBrush::image_number_index_lookups_num_bits)
     .add_macro("fastuidraw_image_slack_bit0", PainterBrush::image_slack_bit0)
@@ -969,6 +987,12 @@ construct_shader(fastuidraw::glsl::ShaderSource &vert,
       assert(!"Invalid data_store_backing() value");
     }
 
+  if(params.use_persistent_data_store())
+    {
+      vert.add_macro("FASTUIDRAW_PAINTER_USE_PERSISTENT_DATA_STORE");
+      frag.add_macro("FASTUIDRAW_PAINTER_USE_PERSISTENT_DATA_STORE");
+    }
+
   if(!params.have_float_glyph_texture_atlas())
     {
       vert.add_macro("FASTUIDRAW_PAINTER_EMULATE_GLYPH_TEXEL_STORE_FLOAT");
@@ -1012,6 +1036,7 @@ construct_shader(fastuidraw::glsl::ShaderSource &vert,
     .add_macro("FASTUIDRAW_GLYPH_GEOMETRY_STORE_BINDING", binding_params.glyph_atlas_geometry_store())
     .add_macro("FASTUIDRAW_PAINTER_STORE_TBO_BINDING", binding_params.data_store_buffer_tbo())
     .add_macro("FASTUIDRAW_PAINTER_STORE_UBO_BINDING", binding_params.data_store_buffer_ubo())
+    .add_macro("FASTUIDRAW_PAINTER_PERSISTENT_STORE_TBO_BINDING", binding_params.persistent_data_store_buffer_tbo())
     .add_macro("fastuidraw_varying", "out")
     .add_source(declare_vertex_shader_ins.c_str(), ShaderSource::from_string)
     .add_source(declare_brush_varyings.c_str(), ShaderSource::from_string)
@@ -1082,6 +1107,7 @@ construct_shader(fastuidraw::glsl::ShaderSource &vert,
     .add_macro("FASTUIDRAW_GLYPH_GEOMETRY_STORE_BINDING", binding_params.glyph_atlas_geometry_store())
     .add_macro("FASTUIDRAW_PAINTER_STORE_TBO_BINDING", binding_params.data_store_buffer_tbo())
     .add_macro("FASTUIDRAW_PAINTER_STORE_UBO_BINDING", binding_params.data_store_buffer_ubo())
+    .add_macro("FASTUIDRAW_PAINTER_PERSISTENT_STORE_TBO_BINDING", binding_params.persistent_data_store_buffer_tbo())
     .add_macro("fastuidraw_varying", "in")
     .add_source(declare_brush_varyings.c_str(), ShaderSource::from_string)
     .add_source(declare_main_varyings.c_str(), ShaderSource::from_string)
@@ -1260,6 +1286,7 @@ setget_implement(unsigned int, glyph_atlas_texel_store_float)
 setget_implement(unsigned int, glyph_atlas_geometry_store)
 setget_implement(unsigned int, data_store_buffer_tbo)
 setget_implement(unsigned int, data_store_buffer_ubo)
+setget_implement(unsigned int, persistent_data_store_buffer_tbo)
 setget_implement(unsigned int, uniforms_ubo)
 
 #undef setget_implement
@@ -1334,6 +1361,7 @@ setget_implement(bool, blend_shader_use_switch)
 setget_implement(bool, unpack_header_and_brush_in_frag_shader)
 setget_implement(enum fastuidraw::glsl::PainterBackendGLSL::data_store_backing_t, data_store_backing)
 setget_implement(int, data_blocks_per_store_buffer)
+setget_implement(bool, use_persistent_data_store)
 setget_implement(enum fastuidraw::glsl::PainterBackendGLSL::glyph_geometry_backing_t, glyph_geometry_backing)
 setget_implement(fastuidraw::ivec2, glyph_geometry_backing_log2_dims)
 setget_implement(bool, have_float_glyph_texture_atlas)
@@ -1503,6 +1531,24 @@ shader_code_added(void)
   return return_value;
 }
 
+uint32_t
+fastuidraw::glsl::PainterBackendGLSL::
+next_item_shader_ID(void) const
+{
+  PainterBackendGLSLPrivate *d;
+  d = static_cast<PainterBackendGLSLPrivate*>(m_d);
+  return d->m_next_item_shader_ID;
+}
+
+uint32_t
+fastuidraw::glsl::PainterBackendGLSL::
+next_blend_shader_ID(void) const
+{
+  PainterBackendGLSLPrivate *d;
+  d = static_cast<PainterBackendGLSLPrivate*>(m_d);
+  return d->m_next_blend_shader_ID;
+}
+
 const fastuidraw::glsl::PainterBackendGLSL::ConfigurationGLSL&
 fastuidraw::glsl::PainterBackendGLSL::
 configuration_glsl(void) const
@@ -22,6 +22,8 @@
 #include <fastuidraw/image.hpp>
 #include "private/array3d.hpp"
 #include "private/util_private.hpp"
+#include "private/memory_accounting_private.hpp"
+#include "private/image_downsample.hpp"
 
 
 namespace
@@ -150,22 +152,59 @@ namespace
     return return_value;
   }
 
-  /* TODO: take into account for repeated tile colors. */
+  /* returns false if there is not enough room in the atlas
+     for an image of the given dimensions and the atlas
+     cannot be resized.
+   */
   bool
-  enough_room_in_atlas(fastuidraw::ivec2 number_color_tiles,
-                       fastuidraw::ImageAtlas *C,
-                       int &total_index)
+  make_room_in_atlas(fastuidraw::ImageAtlas *atlas,
+                     fastuidraw::const_c_array<fastuidraw::ivec2> dimensions,
+                     unsigned int slack)
   {
-    int total_color;
+    fastuidraw::ivec2 num_color_tiles;
+    int tile_interior_size, total_color(0), total_index(0);
 
-    total_color = number_color_tiles.x() * number_color_tiles.y();
-    total_index = number_index_tiles_needed(number_color_tiles, C->index_tile_size());
+    tile_interior_size = atlas->color_tile_size() - 2 * slack;
+    for(unsigned int i = 0; i < dimensions.size(); ++i)
+      {
+        num_color_tiles = divide_up(dimensions[i], tile_interior_size);
+        total_color += num_color_tiles.x() * num_color_tiles.y();
+        total_index += number_index_tiles_needed(num_color_tiles, atlas->index_tile_size());
+      }
+
+    /*TODO:
+       there actually might be enough room if we take into account
+       the savings from repeated tiles. The correct thing is to
+       delay this until iamge construction, check if it succeeded
+       and if not then delete it and return an invalid handle.
+     */
+    if(total_color <= atlas->number_free_color_tiles()
+       && total_index <= atlas->number_free_index_tiles())
+      {
+        return true;
+      }
 
-    //std::cout << "Need " << total_color << " have: " << C->number_free_color_tiles() << "\n"
-    //        << "Need " << total_index << " have: " << C->number_free_index_tiles() << "\n";
+    if(atlas->resizeable())
+      {
+        atlas->resize_to_fit(total_color, total_index);
+        return true;
+      }
+    return false;
+  }
 
-    return total_color <= C->number_free_color_tiles()
-      && total_index <= C->number_free_index_tiles();
+  /* dimensions of each mipmap level, halving
+     (rounding up) down to a single pixel.
+   */
+  std::vector<fastuidraw::ivec2>
+  mipmap_chain_dimensions(fastuidraw::ivec2 dims, bool mipmapped)
+  {
+    std::vector<fastuidraw::ivec2> return_value(1, dims);
+    while(mipmapped && (dims.x() > 1 || dims.y() > 1))
+      {
+        dims = fastuidraw::detail::downsample_dimensions(dims);
+        return_value.push_back(dims);
+      }
+    return return_value;
   }
 
   class BackingStorePrivate
@@ -233,7 +272,17 @@ namespace
     void
     delete_tile_implement(fastuidraw::ivec3 v);
 
+    /* both the color and index backing stores
+       are 4 bytes per texel.
+     */
+    uint64_t
+    tile_bytes(void) const
+    {
+      return 4u * m_tile_size * m_tile_size;
+    }
+
     int m_tile_size;
+    fastuidraw::detail::AccountedBytes m_bytes;
     fastuidraw::ivec3 m_next_tile;
     fastuidraw::ivec3 m_num_tiles;
     std::vector<fastuidraw::ivec3> m_free_tiles;
@@ -287,15 +336,15 @@ namespace
     bool m_non_repeat_color;
   };
 
-  class ImagePrivate
+  class ImageLevel
   {
   public:
-    ImagePrivate(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
+    ImageLevel(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
                  int w, int h,
                  fastuidraw::const_c_array<fastuidraw::u8vec4> image_data,
                  unsigned int pslack);
 
-    ~ImagePrivate();
+    ~ImageLevel();
 
     void
     create_color_tiles(fastuidraw::const_c_array<fastuidraw::u8vec4> image_data);
@@ -323,12 +372,48 @@ namespace
     unsigned int m_number_index_lookups;
     float m_dimensions_index_divisor;
   };
+
+  class ImagePrivate
+  {
+  public:
+    ImagePrivate(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
+                 int w, int h,
+                 fastuidraw::const_c_array<fastuidraw::u8vec4> image_data,
+                 unsigned int pslack,
+                 enum fastuidraw::Image::mipmap_filter_t filter,
+                 unsigned int number_deferred_levels);
+
+    ~ImagePrivate();
+
+    const ImageLevel&
+    finest_resident_level(void) const
+    {
+      assert(m_levels[m_finest_resident_level]);
+      return *m_levels[m_finest_resident_level];
+    }
+
+    fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> m_atlas;
+    fastuidraw::ivec2 m_dimensions;
+    unsigned int m_slack;
+
+    /* element L is mipmap level L, nullptr if the
+       level is not yet uploaded to the atlas.
+     */
+    std::vector<ImageLevel*> m_levels;
+    std::vector<fastuidraw::ivec2> m_level_dimensions;
+
+    /* pixels of the levels not yet uploaded */
+    std::vector<std::vector<fastuidraw::u8vec4> > m_deferred_data;
+    fastuidraw::detail::AccountedBytes m_deferred_bytes;
+
+    unsigned int m_finest_resident_level;
+  };
 }
 
 /////////////////////////////////////////////
-//ImagePrivate methods
-ImagePrivate::
-ImagePrivate(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
+//ImageLevel methods
+ImageLevel::
+ImageLevel(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
              int w, int h,
              fastuidraw::const_c_array<fastuidraw::u8vec4> image_data,
              unsigned int pslack):
@@ -344,8 +429,8 @@ ImagePrivate(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
   create_index_tiles();
 }
 
-ImagePrivate::
-~ImagePrivate()
+ImageLevel::
+~ImageLevel()
 {
   for(std::vector<per_color_tile>::const_iterator iter = m_color_tiles.begin(),
         end = m_color_tiles.end(); iter != end; ++iter)
@@ -374,7 +459,7 @@ ImagePrivate::
 }
 
 void
-ImagePrivate::
+ImageLevel::
 create_color_tiles(fastuidraw::const_c_array<fastuidraw::u8vec4> image_data)
 {
   int tile_interior_size;
@@ -447,7 +532,7 @@ create_color_tiles(fastuidraw::const_c_array<fastuidraw::u8vec4> image_data)
 */
 template<typename T>
 fastuidraw::ivec2
-ImagePrivate::
+ImageLevel::
 create_index_layer(fastuidraw::const_c_array<T> src_tiles,
                    fastuidraw::ivec2 src_dims, int slack,
                    std::list<std::vector<fastuidraw::ivec3> > &destination)
@@ -490,7 +575,7 @@ create_index_layer(fastuidraw::const_c_array<T> src_tiles,
 }
 
 void
-ImagePrivate::
+ImageLevel::
 create_index_tiles(void)
 {
   fastuidraw::ivec2 num_index_tiles;
@@ -518,11 +603,82 @@ create_index_tiles(void)
   m_number_index_lookups = m_index_tiles.size();
 }
 
+/////////////////////////////////////////////
+//ImagePrivate methods
+ImagePrivate::
+ImagePrivate(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
+             int w, int h,
+             fastuidraw::const_c_array<fastuidraw::u8vec4> image_data,
+             unsigned int pslack,
+             enum fastuidraw::Image::mipmap_filter_t filter,
+             unsigned int number_deferred_levels):
+  m_atlas(patlas),
+  m_dimensions(w, h),
+  m_slack(pslack),
+  m_level_dimensions(mipmap_chain_dimensions(m_dimensions, filter != fastuidraw::Image::no_mipmaps)),
+  m_deferred_bytes(fastuidraw::memory_accounting::image_tiles)
+{
+  std::vector<fastuidraw::u8vec4> previous, current;
+  fastuidraw::const_c_array<fastuidraw::u8vec4> level_data(image_data);
+
+  assert(number_deferred_levels < m_level_dimensions.size());
+  m_finest_resident_level = number_deferred_levels;
+  m_levels.resize(m_level_dimensions.size(), nullptr);
+  m_deferred_data.resize(m_level_dimensions.size());
+
+  for(unsigned int L = 0; L < m_level_dimensions.size(); ++L)
+    {
+      if(L > 0)
+        {
+          fastuidraw::ivec2 sz(m_level_dimensions[L]);
+
+          current.resize(sz.x() * sz.y());
+          if(filter == fastuidraw::Image::lanczos_mipmap_filter)
+            {
+              fastuidraw::detail::downsample_lanczos(level_data, m_level_dimensions[L - 1],
+                                                     fastuidraw::make_c_array(current));
+            }
+          else
+            {
+              fastuidraw::detail::downsample_box(level_data, m_level_dimensions[L - 1],
+                                                 fastuidraw::make_c_array(current));
+            }
+          std::swap(previous, current);
+          level_data = fastuidraw::make_c_array(previous);
+        }
+
+      if(L < m_finest_resident_level)
+        {
+          m_deferred_data[L].assign(level_data.begin(), level_data.end());
+          m_deferred_bytes.add(4u * level_data.size());
+        }
+      else
+        {
+          m_levels[L] = FASTUIDRAWnew ImageLevel(m_atlas, m_level_dimensions[L].x(),
+                                                 m_level_dimensions[L].y(),
+                                                 level_data, m_slack);
+        }
+    }
+}
+
+ImagePrivate::
+~ImagePrivate()
+{
+  for(unsigned int L = 0; L < m_levels.size(); ++L)
+    {
+      if(m_levels[L])
+        {
+          FASTUIDRAWdelete(m_levels[L]);
+        }
+    }
+}
+
 ///////////////////////////////////////////
 // tile_allocator methods
 tile_allocator::
 tile_allocator(int tile_size, fastuidraw::ivec3 store_dimensions):
   m_tile_size(tile_size),
+  m_bytes(fastuidraw::memory_accounting::image_tiles),
   m_next_tile(0, 0, 0),
   m_num_tiles(store_dimensions.x() / m_tile_size,
               store_dimensions.y() / m_tile_size,
@@ -587,6 +743,7 @@ allocate_tile(void)
   #endif
 
   ++m_tile_count;
+  m_bytes.bytes(tile_bytes() * m_tile_count);
   return return_value;
 }
 
@@ -640,6 +797,7 @@ delete_tile_implement(fastuidraw::ivec3 v)
   #endif
 
   --m_tile_count;
+  m_bytes.bytes(tile_bytes() * m_tile_count);
   m_free_tiles.push_back(v);
 }
 
@@ -1036,53 +1194,51 @@ fastuidraw::Image::
 create(fastuidraw::reference_counted_ptr<ImageAtlas> atlas, int w, int h,
        const_c_array<u8vec4> image_data, unsigned int pslack)
 {
-  int tile_interior_size;
-  int color_tile_size;
-  ivec2 num_color_tiles;
-  int index_tiles;
+  return create(atlas, w, h, image_data, pslack, no_mipmaps);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::Image>
+fastuidraw::Image::
+create(fastuidraw::reference_counted_ptr<ImageAtlas> atlas, int w, int h,
+       const_c_array<u8vec4> image_data, unsigned int pslack,
+       enum mipmap_filter_t filter, unsigned int number_deferred_levels)
+{
+  std::vector<ivec2> dims;
+  const_c_array<ivec2> resident_dims;
 
   if(w <= 0 || h <= 0)
     {
       return reference_counted_ptr<Image>();
     }
 
-  color_tile_size = atlas->color_tile_size();
-  tile_interior_size = color_tile_size - 2 * pslack;
-
-  if(tile_interior_size <= 0)
+  if(atlas->color_tile_size() <= 2 * static_cast<int>(pslack))
     {
       return reference_counted_ptr<Image>();
     }
 
-  num_color_tiles = divide_up(ivec2(w, h), tile_interior_size);
-  if(!enough_room_in_atlas(num_color_tiles, atlas.get(), index_tiles))
+  /* the coarsest level is always uploaded */
+  dims = mipmap_chain_dimensions(ivec2(w, h), filter != no_mipmaps);
+  number_deferred_levels = t_min(number_deferred_levels,
+                                 static_cast<unsigned int>(dims.size() - 1));
+
+  resident_dims = make_c_array(dims).sub_array(number_deferred_levels);
+  if(!make_room_in_atlas(atlas.get(), resident_dims, pslack))
     {
-      /*TODO:
-         there actually might be enough room if we take into account
-         the savings from repeated tiles. The correct thing is to
-         delay this until iamge construction, check if it succeeded
-         and if not then delete it and return an invalid handle.
-       */
-      if(atlas->resizeable())
-        {
-          atlas->resize_to_fit(num_color_tiles.x() * num_color_tiles.y(), index_tiles);
-        }
-      else
-        {
-          return reference_counted_ptr<Image>();
-        }
+      return reference_counted_ptr<Image>();
     }
 
-  return FASTUIDRAWnew Image(atlas, w, h, image_data, pslack);
+  return FASTUIDRAWnew Image(atlas, w, h, image_data, pslack, filter, number_deferred_levels);
 }
 
 fastuidraw::Image::
 Image(fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas> patlas,
       int w, int h,
       fastuidraw::const_c_array<fastuidraw::u8vec4> image_data,
-      unsigned int pslack)
+      unsigned int pslack, enum mipmap_filter_t filter,
+      unsigned int number_deferred_levels)
 {
-  m_d = FASTUIDRAWnew ImagePrivate(patlas, w, h, image_data, pslack);
+  m_d = FASTUIDRAWnew ImagePrivate(patlas, w, h, image_data, pslack,
+                                   filter, number_deferred_levels);
 }
 
 fastuidraw::Image::
@@ -1094,14 +1250,13 @@ fastuidraw::Image::
   m_d = nullptr;
 }
 
-
 unsigned int
 fastuidraw::Image::
 number_index_lookups(void) const
 {
   ImagePrivate *d;
   d = static_cast<ImagePrivate*>(m_d);
-  return d->m_number_index_lookups;
+  return d->finest_resident_level().m_number_index_lookups;
 }
 
 fastuidraw::ivec2
@@ -1128,7 +1283,7 @@ master_index_tile(void) const
 {
   ImagePrivate *d;
   d = static_cast<ImagePrivate*>(m_d);
-  return d->m_master_index_tile;
+  return d->finest_resident_level().m_master_index_tile;
 }
 
 fastuidraw::vec2
@@ -1137,7 +1292,7 @@ master_index_tile_dims(void) const
 {
   ImagePrivate *d;
   d = static_cast<ImagePrivate*>(m_d);
-  return d->m_master_index_tile_dims;
+  return d->finest_resident_level().m_master_index_tile_dims;
 }
 
 float
@@ -1146,7 +1301,7 @@ dimensions_index_divisor(void) const
 {
   ImagePrivate *d;
   d = static_cast<ImagePrivate*>(m_d);
-  return d->m_dimensions_index_divisor;
+  return d->finest_resident_level().m_dimensions_index_divisor;
 }
 
 const fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas>&
@@ -1157,3 +1312,80 @@ atlas(void) const
   d = static_cast<ImagePrivate*>(m_d);
   return d->m_atlas;
 }
+
+unsigned int
+fastuidraw::Image::
+number_mipmap_levels(void) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  return d->m_levels.size();
+}
+
+unsigned int
+fastuidraw::Image::
+finest_resident_mipmap_level(void) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  return d->m_finest_resident_level;
+}
+
+fastuidraw::ivec2
+fastuidraw::Image::
+mipmap_dimensions(unsigned int L) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  assert(L < d->m_level_dimensions.size());
+  return d->m_level_dimensions[L];
+}
+
+fastuidraw::ivec3
+fastuidraw::Image::
+mipmap_master_index_tile(unsigned int L) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  assert(L < d->m_levels.size() && d->m_levels[L]);
+  return d->m_levels[L]->m_master_index_tile;
+}
+
+unsigned int
+fastuidraw::Image::
+mipmap_number_index_lookups(unsigned int L) const
+{
+  ImagePrivate *d;
+  d = static_cast<ImagePrivate*>(m_d);
+  assert(L < d->m_levels.size() && d->m_levels[L]);
+  return d->m_levels[L]->m_number_index_lookups;
+}
+
+bool
+fastuidraw::Image::
+refine(void)
+{
+  ImagePrivate *d;
+  unsigned int L;
+
+  d = static_cast<ImagePrivate*>(m_d);
+  if(d->m_finest_resident_level == 0)
+    {
+      return false;
+    }
+
+  L = d->m_finest_resident_level - 1;
+  if(!make_room_in_atlas(d->m_atlas.get(), const_c_array<ivec2>(&d->m_level_dimensions[L], 1), d->m_slack))
+    {
+      return false;
+    }
+
+  d->m_levels[L] = FASTUIDRAWnew ImageLevel(d->m_atlas, d->m_level_dimensions[L].x(),
+                                            d->m_level_dimensions[L].y(),
+                                            make_c_array(d->m_deferred_data[L]),
+                                            d->m_slack);
+  d->m_deferred_bytes.bytes(d->m_deferred_bytes.bytes() - 4u * d->m_deferred_data[L].size());
+  std::vector<u8vec4>().swap(d->m_deferred_data[L]);
+  d->m_finest_resident_level = L;
+  return true;
+}
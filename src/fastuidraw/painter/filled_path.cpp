@@ -23,16 +23,19 @@
 #include <set>
 #include <algorithm>
 #include <ctime>
+#include <atomic>
 #include <math.h>
 
 #include <fastuidraw/tessellated_path.hpp>
 #include <fastuidraw/path.hpp>
 #include <fastuidraw/painter/filled_path.hpp>
 #include <fastuidraw/painter/painter_attribute_data.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include "../private/util_private.hpp"
 #include "../private/util_private_ostream.hpp"
 #include "../private/bounding_box.hpp"
 #include "../private/clip.hpp"
+#include "../private/memory_accounting_private.hpp"
 #include "../../3rd_party/glu-tess/glu-tess.hpp"
 
 /* Actual triangulation is handled by GLU-tess.
@@ -70,6 +73,16 @@
    via the class SubPath. The class SubsetPrivate
    is the one that represents an element in the
    hierarchy that is triangulated on demand.
+
+   Triangulation of a SubsetPrivate can also be
+   performed by the worker threads of a TaskPool.
+   Each SubsetPrivate has a mutex guarding the
+   creation of its data; the mutex of a parent is
+   held while the mutex of a child is locked but
+   never the other way around. Once created, the
+   data of a SubsetPrivate is never modified which
+   allows for readers to check the atomic flags
+   m_ready and m_sizes_ready without locking.
  */
 
 /* Values to define how to create Subset objects.
@@ -79,7 +92,15 @@ namespace SubsetConstants
   enum
     {
       recursion_depth = 12,
-      points_per_subset = 64
+      points_per_subset = 64,
+
+      /* the triangles of a Subset without children
+         are sorted into a grid of cells_per_dimension
+         by cells_per_dimension cells so that those
+         cells outside of the clipping region can be
+         skipped.
+       */
+      cells_per_dimension = 4
     };
 
   /* if negative, aspect ratio is not
@@ -1029,6 +1050,8 @@ namespace
     }
   };
 
+  class SubsetPrivate;
+
   class ScratchSpacePrivate
   {
   public:
@@ -1037,6 +1060,16 @@ namespace
 
     fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_clip_scratch_vec2s;
     std::vector<float> m_clip_scratch_floats;
+
+    /* SubsetPrivate objects whose triangulation is needed
+       but is not ready, filled by the non-blocking select.
+     */
+    std::vector<SubsetPrivate*> m_not_ready;
+
+    /* of those in m_not_ready, the ones which have not
+       already been handed to a TaskPool.
+     */
+    std::vector<SubsetPrivate*> m_to_defer;
   };
 
   class SubsetPrivate
@@ -1052,9 +1085,30 @@ namespace
                    unsigned int max_index_cnt,
                    fastuidraw::c_array<unsigned int> dst);
 
+    /* same as select_subsets() except that it never
+       triangulates; those SubsetPrivate objects which
+       are needed but are not ready are added to
+       scratch.m_not_ready and scratch.m_to_defer.
+     */
+    unsigned int
+    select_ready_subsets(ScratchSpacePrivate &scratch,
+                         fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+                         const fastuidraw::float3x3 &clip_matrix_local,
+                         unsigned int max_attribute_cnt,
+                         unsigned int max_index_cnt,
+                         fastuidraw::c_array<unsigned int> dst);
+
+    /* thread safe; may be called from any thread.
+     */
     void
     make_ready(void);
 
+    bool
+    ready(void) const
+    {
+      return m_ready;
+    }
+
     fastuidraw::const_c_array<int>
     winding_numbers(void)
     {
@@ -1088,6 +1142,26 @@ namespace
       return *m_fuzz_painter_data;
     }
 
+    unsigned int
+    number_cells(void) const
+    {
+      assert(m_painter_data != nullptr);
+      return m_cell_bounds.size();
+    }
+
+    fastuidraw::range_type<unsigned int>
+    cell_range(int w, unsigned int C) const;
+
+    /* write to dst those cells whose bounding box
+       intersects the clipping region; returns the
+       number of cells written.
+     */
+    unsigned int
+    select_cells(ScratchSpacePrivate &scratch,
+                 fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+                 const fastuidraw::float3x3 &clip_matrix_local,
+                 fastuidraw::c_array<unsigned int> dst);
+
     static
     SubsetPrivate*
     create_root_subset(SubPath *P, std::vector<SubsetPrivate*> &out_values);
@@ -1103,6 +1177,7 @@ namespace
                              fastuidraw::c_array<unsigned int> dst,
                              unsigned int max_attribute_cnt,
                              unsigned int max_index_cnt,
+                             bool only_ready,
                              unsigned int &current);
 
     void
@@ -1111,12 +1186,45 @@ namespace
                                 unsigned int max_index_cnt,
                                 unsigned int &current);
 
+    void
+    select_ready_subsets_all_unculled(ScratchSpacePrivate &scratch,
+                                      fastuidraw::c_array<unsigned int> dst,
+                                      unsigned int max_attribute_cnt,
+                                      unsigned int max_index_cnt,
+                                      unsigned int &current);
+
+    void
+    select_ready_descendants(fastuidraw::c_array<unsigned int> dst,
+                             unsigned int &current);
+
+    void
+    mark_not_ready(ScratchSpacePrivate &scratch);
+
+    bool
+    fits(unsigned int max_attribute_cnt,
+         unsigned int max_index_cnt) const
+    {
+      return m_num_attributes <= max_attribute_cnt
+        && m_largest_index_block <= max_index_cnt
+        && 4 * m_aa_edge_list_counter.largest_edge_count() <= max_attribute_cnt
+        && 6 * m_aa_edge_list_counter.largest_edge_count() <= max_index_cnt;
+    }
+
+    void
+    ready_sizes_from_children(void);
+
+    void
+    set_sizes_from_children(void);
+
     void
     make_ready_from_children(void);
 
     void
     make_ready_from_sub_path(void);
 
+    void
+    create_cells(AttributeDataFiller &filler);
+
     void
     assign_neighbor_values(SubsetPrivate *parent, int child_id);
 
@@ -1156,10 +1264,37 @@ namespace
     AAEdgeListCounter m_aa_edge_list_counter;
     std::vector<std::vector<int> > m_winding_neighbors;
 
-    bool m_sizes_ready;
+    /* Only a SubsetPrivate without children has cells.
+       The triangles of each winding number are sorted
+       by which cell their centroid is in; only those
+       cells with triangles are kept. m_cell_bounds[C]
+       is the bounding box of the triangles of cell C and
+       the triangles of cell C with winding number
+       m_winding_numbers[I] are the range
+       [m_cell_offsets[K + C], m_cell_offsets[K + C + 1])
+       where K = I * (1 + m_cell_bounds.size()) within the
+       index chunk of that winding number.
+     */
+    std::vector<fastuidraw::BoundingBox<float> > m_cell_bounds;
+    std::vector<unsigned int> m_cell_offsets;
+
+    /* m_mutex guards the creation of m_painter_data,
+       m_fuzz_painter_data and the size values; m_ready
+       and m_sizes_ready are set (under m_mutex) after
+       the values they flag are written.
+     */
+    fastuidraw::mutex m_mutex;
+    std::atomic<bool> m_ready;
+    std::atomic<bool> m_sizes_ready;
+    fastuidraw::detail::AccountedBytes m_bytes;
     unsigned int m_num_attributes;
     unsigned int m_largest_index_block;
 
+    /* set to true when the triangulation of this
+       SubsetPrivate is handed to a TaskPool.
+     */
+    std::atomic<bool> m_deferred;
+
     /* m_sub_path is non-nullptr only if this SubsetPrivate
        has no children. In addition, it is set to nullptr
        and deleted when m_painter_data is created from
@@ -1178,6 +1313,41 @@ namespace
     uint32_t m_bd_mask;
   };
 
+  class SubsetTask:public fastuidraw::TaskPool::Task
+  {
+  public:
+    explicit
+    SubsetTask(SubsetPrivate *subset):
+      m_subset(subset),
+      m_cancelled(false)
+    {}
+
+    /* After cancel() the task does nothing when run;
+       used by the dtor of FilledPathPrivate so that
+       it need not triangulate what was not yet started.
+     */
+    void
+    cancel(void)
+    {
+      m_cancelled = true;
+    }
+
+  protected:
+    virtual
+    void
+    run_task(void)
+    {
+      if(!m_cancelled)
+        {
+          m_subset->make_ready();
+        }
+    }
+
+  private:
+    SubsetPrivate *m_subset;
+    std::atomic<bool> m_cancelled;
+  };
+
   class FilledPathPrivate
   {
   public:
@@ -1186,8 +1356,24 @@ namespace
 
     ~FilledPathPrivate();
 
+    void
+    defer(fastuidraw::TaskPool &task_pool,
+          fastuidraw::const_c_array<SubsetPrivate*> subsets);
+
+    unsigned int
+    number_deferred(void);
+
+    void
+    wait_deferred(void);
+
     SubsetPrivate *m_root;
     std::vector<SubsetPrivate*> m_subsets;
+
+    /* tasks handed to a TaskPool that have not been
+       observed as finished, guarded by m_tasks_mutex.
+     */
+    fastuidraw::mutex m_tasks_mutex;
+    std::vector<fastuidraw::reference_counted_ptr<SubsetTask> > m_tasks;
   };
 }
 
@@ -2521,7 +2707,10 @@ SubsetPrivate(SubsetPrivate *parent, SubPath *Q, int max_recursion,
              fastuidraw::vec2(m_bounds.max_point())),
   m_painter_data(nullptr),
   m_fuzz_painter_data(nullptr),
+  m_ready(false),
   m_sizes_ready(false),
+  m_bytes(fastuidraw::memory_accounting::filled_path_data),
+  m_deferred(false),
   m_sub_path(Q),
   m_children(nullptr, nullptr),
   m_splitting_coordinate(-1),
@@ -2631,7 +2820,30 @@ select_subsets(ScratchSpacePrivate &scratch,
       scratch.m_adjusted_clip_eqs[i] = clip_equations[i] * clip_matrix_local;
     }
 
-  select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, return_value);
+  select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, false, return_value);
+  return return_value;
+}
+
+unsigned int
+SubsetPrivate::
+select_ready_subsets(ScratchSpacePrivate &scratch,
+                     fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+                     const fastuidraw::float3x3 &clip_matrix_local,
+                     unsigned int max_attribute_cnt,
+                     unsigned int max_index_cnt,
+                     fastuidraw::c_array<unsigned int> dst)
+{
+  unsigned int return_value(0u);
+
+  scratch.m_adjusted_clip_eqs.resize(clip_equations.size());
+  for(unsigned int i = 0; i < clip_equations.size(); ++i)
+    {
+      scratch.m_adjusted_clip_eqs[i] = clip_equations[i] * clip_matrix_local;
+    }
+
+  scratch.m_not_ready.clear();
+  scratch.m_to_defer.clear();
+  select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, true, return_value);
   return return_value;
 }
 
@@ -2641,6 +2853,7 @@ select_subsets_implement(ScratchSpacePrivate &scratch,
                          fastuidraw::c_array<unsigned int> dst,
                          unsigned int max_attribute_cnt,
                          unsigned int max_index_cnt,
+                         bool only_ready,
                          unsigned int &current)
 {
   using namespace fastuidraw;
@@ -2665,12 +2878,19 @@ select_subsets_implement(ScratchSpacePrivate &scratch,
   assert((m_children[0] == nullptr) == (m_children[1] == nullptr));
   if(unclipped || m_children[0] == nullptr)
     {
-      select_subsets_all_unculled(dst, max_attribute_cnt, max_index_cnt, current);
+      if(only_ready)
+        {
+          select_ready_subsets_all_unculled(scratch, dst, max_attribute_cnt, max_index_cnt, current);
+        }
+      else
+        {
+          select_subsets_all_unculled(dst, max_attribute_cnt, max_index_cnt, current);
+        }
       return;
     }
 
-  m_children[0]->select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, current);
-  m_children[1]->select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, current);
+  m_children[0]->select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, only_ready, current);
+  m_children[1]->select_subsets_implement(scratch, dst, max_attribute_cnt, max_index_cnt, only_ready, current);
 }
 
 void
@@ -2680,20 +2900,16 @@ select_subsets_all_unculled(fastuidraw::c_array<unsigned int> dst,
                             unsigned int max_index_cnt,
                             unsigned int &current)
 {
-  if(!m_sizes_ready && m_children[0] == nullptr && m_sub_path != nullptr)
+  if(!m_sizes_ready && m_children[0] == nullptr)
     {
       /* we are going to need the attributes because
          the element will be selected.
        */
-      make_ready_from_sub_path();
+      make_ready();
       assert(m_painter_data != nullptr);
     }
 
-  if(m_sizes_ready
-     && m_num_attributes <= max_attribute_cnt
-     && m_largest_index_block <= max_index_cnt
-     && 4 * m_aa_edge_list_counter.largest_edge_count() <= max_attribute_cnt
-     && 6 * m_aa_edge_list_counter.largest_edge_count() <= max_index_cnt)
+  if(m_sizes_ready && fits(max_attribute_cnt, max_index_cnt))
     {
       dst[current] = m_ID;
       ++current;
@@ -2704,17 +2920,7 @@ select_subsets_all_unculled(fastuidraw::c_array<unsigned int> dst,
       m_children[1]->select_subsets_all_unculled(dst, max_attribute_cnt, max_index_cnt, current);
       if(!m_sizes_ready)
         {
-          m_sizes_ready = true;
-          assert(m_children[0]->m_sizes_ready);
-          assert(m_children[1]->m_sizes_ready);
-          m_num_attributes = m_children[0]->m_num_attributes + m_children[1]->m_num_attributes;
-          /* TODO: the actual value for m_largest_index_block might be smaller;
-             this happens if the largest index block of m_children[0] and m_children[1]
-             come from different index sets.
-          */
-          m_largest_index_block = m_children[0]->m_largest_index_block + m_children[1]->m_largest_index_block;
-          m_aa_edge_list_counter.add_counts(m_children[0]->m_aa_edge_list_counter);
-          m_aa_edge_list_counter.add_counts(m_children[1]->m_aa_edge_list_counter);
+          ready_sizes_from_children();
         }
     }
   else
@@ -2724,10 +2930,93 @@ select_subsets_all_unculled(fastuidraw::c_array<unsigned int> dst,
     }
 }
 
+void
+SubsetPrivate::
+select_ready_subsets_all_unculled(ScratchSpacePrivate &scratch,
+                                  fastuidraw::c_array<unsigned int> dst,
+                                  unsigned int max_attribute_cnt,
+                                  unsigned int max_index_cnt,
+                                  unsigned int &current)
+{
+  /* Mirrors select_subsets_all_unculled() except that
+     a SubsetPrivate is only selected if it is ready;
+     if it is not, its job is deferred and those of
+     its descendants that are ready are taken instead.
+   */
+  if(m_sizes_ready && fits(max_attribute_cnt, max_index_cnt))
+    {
+      if(m_ready)
+        {
+          dst[current] = m_ID;
+          ++current;
+        }
+      else
+        {
+          mark_not_ready(scratch);
+          if(m_children[0] != nullptr)
+            {
+              m_children[0]->select_ready_descendants(dst, current);
+              m_children[1]->select_ready_descendants(dst, current);
+            }
+        }
+    }
+  else if(m_children[0] != nullptr)
+    {
+      m_children[0]->select_ready_subsets_all_unculled(scratch, dst, max_attribute_cnt, max_index_cnt, current);
+      m_children[1]->select_ready_subsets_all_unculled(scratch, dst, max_attribute_cnt, max_index_cnt, current);
+      if(!m_sizes_ready && m_children[0]->m_sizes_ready && m_children[1]->m_sizes_ready)
+        {
+          ready_sizes_from_children();
+        }
+    }
+  else if(!m_sizes_ready)
+    {
+      mark_not_ready(scratch);
+    }
+  else
+    {
+      assert(!"Childless FilledPath::Subset has too many attributes or indices");
+    }
+}
+
+void
+SubsetPrivate::
+select_ready_descendants(fastuidraw::c_array<unsigned int> dst,
+                         unsigned int &current)
+{
+  if(m_ready)
+    {
+      dst[current] = m_ID;
+      ++current;
+    }
+  else if(m_children[0] != nullptr)
+    {
+      m_children[0]->select_ready_descendants(dst, current);
+      m_children[1]->select_ready_descendants(dst, current);
+    }
+}
+
+void
+SubsetPrivate::
+mark_not_ready(ScratchSpacePrivate &scratch)
+{
+  scratch.m_not_ready.push_back(this);
+  if(!m_deferred.exchange(true))
+    {
+      scratch.m_to_defer.push_back(this);
+    }
+}
+
 void
 SubsetPrivate::
 make_ready(void)
 {
+  if(m_ready)
+    {
+      return;
+    }
+
+  fastuidraw::autolock_mutex M(m_mutex);
   if(m_painter_data == nullptr)
     {
       if(m_sub_path != nullptr)
@@ -2738,7 +3027,39 @@ make_ready(void)
         {
           make_ready_from_children();
         }
+      m_bytes.bytes(fastuidraw::detail::attribute_data_bytes(*m_painter_data)
+                    + fastuidraw::detail::attribute_data_bytes(*m_fuzz_painter_data));
     }
+  m_ready = true;
+}
+
+void
+SubsetPrivate::
+ready_sizes_from_children(void)
+{
+  fastuidraw::autolock_mutex M(m_mutex);
+  if(!m_sizes_ready)
+    {
+      set_sizes_from_children();
+    }
+}
+
+void
+SubsetPrivate::
+set_sizes_from_children(void)
+{
+  assert(!m_sizes_ready);
+  assert(m_children[0]->m_sizes_ready);
+  assert(m_children[1]->m_sizes_ready);
+  m_num_attributes = m_children[0]->m_num_attributes + m_children[1]->m_num_attributes;
+  /* TODO: the actual value for m_largest_index_block might be smaller;
+     this happens if the largest index block of m_children[0] and m_children[1]
+     come from different index sets.
+  */
+  m_largest_index_block = m_children[0]->m_largest_index_block + m_children[1]->m_largest_index_block;
+  m_aa_edge_list_counter.add_counts(m_children[0]->m_aa_edge_list_counter);
+  m_aa_edge_list_counter.add_counts(m_children[1]->m_aa_edge_list_counter);
+  m_sizes_ready = true;
 }
 
 
@@ -2798,17 +3119,7 @@ make_ready_from_children(void)
 
   if(!m_sizes_ready)
     {
-      m_sizes_ready = true;
-      assert(m_children[0]->m_sizes_ready);
-      assert(m_children[1]->m_sizes_ready);
-      m_num_attributes = m_children[0]->m_num_attributes + m_children[1]->m_num_attributes;
-      /* TODO: the actual value for m_largest_index_block might be smaller;
-         this happens if the largest index block of m_children[0] and m_children[1]
-         come from different index sets.
-       */
-      m_largest_index_block = m_children[0]->m_largest_index_block + m_children[1]->m_largest_index_block;
-      m_aa_edge_list_counter.add_counts(m_children[0]->m_aa_edge_list_counter);
-      m_aa_edge_list_counter.add_counts(m_children[1]->m_aa_edge_list_counter);
+      set_sizes_from_children();
     }
 
   m_fuzz_painter_data = FASTUIDRAWnew fastuidraw::PainterAttributeData();
@@ -2822,6 +3133,8 @@ void
 SubsetPrivate::
 make_ready_from_sub_path(void)
 {
+  FASTUIDRAWtrace_zone("FilledPath::Subset::triangulate");
+
   assert(m_children[0] == nullptr);
   assert(m_children[1] == nullptr);
   assert(m_sub_path != nullptr);
@@ -2846,13 +3159,13 @@ make_ready_from_sub_path(void)
   filler.m_even_winding_indices = indices_ptr.sub_array(even_non_zero_start);
   filler.m_zero_winding_indices = indices_ptr.sub_array(zero_start);
 
-  m_sizes_ready = true;
   m1 = fastuidraw::t_max(filler.m_nonzero_winding_indices.size(),
                          filler.m_zero_winding_indices.size());
   m2 = fastuidraw::t_max(filler.m_odd_winding_indices.size(),
                          filler.m_even_winding_indices.size());
   m_largest_index_block = fastuidraw::t_max(m1, m2);
   m_num_attributes = filler.m_points.size();
+  m_sizes_ready = true;
 
   m_winding_numbers.reserve(filler.m_per_fill.size());
   for(std::map<int, fastuidraw::const_c_array<unsigned int> >::iterator
@@ -2862,6 +3175,7 @@ make_ready_from_sub_path(void)
       assert(!iter->second.empty());
       m_winding_numbers.push_back(iter->first);
     }
+  create_cells(filler);
 
   /* now fill m_painter_data.
    */
@@ -2898,6 +3212,201 @@ make_ready_from_sub_path(void)
 
 }
 
+void
+SubsetPrivate::
+create_cells(AttributeDataFiller &filler)
+{
+  using namespace fastuidraw;
+
+  const unsigned int N(SubsetConstants::cells_per_dimension);
+  const unsigned int num_cells(N * N);
+  std::vector<BoundingBox<float> > bounds(num_cells);
+  std::vector<unsigned int> offsets(m_winding_numbers.size() * (num_cells + 1), 0u);
+  std::vector<unsigned int> tri_cells, cursor(num_cells), sorted;
+  dvec2 sz(m_bounds.size());
+  dvec2 scale(0.0, 0.0);
+
+  if(sz.x() > 0.0)
+    {
+      scale.x() = static_cast<double>(N) / sz.x();
+    }
+  if(sz.y() > 0.0)
+    {
+      scale.y() = static_cast<double>(N) / sz.y();
+    }
+
+  for(unsigned int I = 0, endI = m_winding_numbers.size(); I < endI; ++I)
+    {
+      const_c_array<unsigned int> src(filler.m_per_fill[m_winding_numbers[I]]);
+      c_array<unsigned int> row(&offsets[I * (num_cells + 1)], num_cells + 1);
+      c_array<unsigned int> dst;
+      unsigned int num_tris;
+
+      /* the index values for the winding number live in
+         filler.m_indices, sort them in place.
+       */
+      dst = make_c_array(filler.m_indices).sub_array(src.c_ptr() - &filler.m_indices[0], src.size());
+      num_tris = src.size() / 3;
+      tri_cells.resize(num_tris);
+
+      for(unsigned int t = 0; t < num_tris; ++t)
+        {
+          dvec2 c(0.0, 0.0);
+          unsigned int cx, cy, cell;
+
+          for(unsigned int k = 0; k < 3; ++k)
+            {
+              const dvec2 &p(filler.m_points[dst[3 * t + k]]);
+              c += p;
+            }
+          c /= 3.0;
+          c = (c - m_bounds.min_point()) * scale;
+          cx = static_cast<unsigned int>(t_max(0.0, c.x()));
+          cy = static_cast<unsigned int>(t_max(0.0, c.y()));
+          cell = t_min(cx, N - 1) + N * t_min(cy, N - 1);
+
+          tri_cells[t] = cell;
+          ++row[cell + 1];
+          for(unsigned int k = 0; k < 3; ++k)
+            {
+              const dvec2 &p(filler.m_points[dst[3 * t + k]]);
+              bounds[cell].union_point(vec2(p));
+            }
+        }
+
+      for(unsigned int C = 0; C < num_cells; ++C)
+        {
+          row[C + 1] += row[C];
+          cursor[C] = row[C];
+        }
+
+      sorted.resize(dst.size());
+      for(unsigned int t = 0; t < num_tris; ++t)
+        {
+          unsigned int loc(3 * cursor[tri_cells[t]]);
+
+          ++cursor[tri_cells[t]];
+          sorted[loc + 0] = dst[3 * t + 0];
+          sorted[loc + 1] = dst[3 * t + 1];
+          sorted[loc + 2] = dst[3 * t + 2];
+        }
+      std::copy(sorted.begin(), sorted.end(), dst.begin());
+    }
+
+  /* only keep those cells that have triangles; the offsets
+     of an empty cell are the same for all winding numbers,
+     so dropping its end offset leaves the others correct.
+   */
+  unsigned int num_kept(0);
+  for(unsigned int C = 0; C < num_cells; ++C)
+    {
+      if(!bounds[C].empty())
+        {
+          ++num_kept;
+        }
+    }
+
+  m_cell_bounds.reserve(num_kept);
+  m_cell_offsets.resize(m_winding_numbers.size() * (num_kept + 1));
+  for(unsigned int I = 0, endI = m_winding_numbers.size(); I < endI; ++I)
+    {
+      unsigned int *row(&offsets[I * (num_cells + 1)]);
+      unsigned int *kept_row(&m_cell_offsets[I * (num_kept + 1)]);
+      unsigned int k(0);
+
+      kept_row[0] = 3 * row[0];
+      for(unsigned int C = 0; C < num_cells; ++C)
+        {
+          if(!bounds[C].empty())
+            {
+              kept_row[k + 1] = 3 * row[C + 1];
+              ++k;
+            }
+        }
+    }
+
+  for(unsigned int C = 0; C < num_cells; ++C)
+    {
+      if(!bounds[C].empty())
+        {
+          m_cell_bounds.push_back(bounds[C]);
+        }
+    }
+}
+
+fastuidraw::range_type<unsigned int>
+SubsetPrivate::
+cell_range(int w, unsigned int C) const
+{
+  std::vector<int>::const_iterator iter;
+  unsigned int I, K;
+
+  assert(C < m_cell_bounds.size());
+  iter = std::lower_bound(m_winding_numbers.begin(), m_winding_numbers.end(), w);
+  if(iter == m_winding_numbers.end() || *iter != w)
+    {
+      return fastuidraw::range_type<unsigned int>(0, 0);
+    }
+
+  I = iter - m_winding_numbers.begin();
+  K = I * (1 + m_cell_bounds.size());
+  return fastuidraw::range_type<unsigned int>(m_cell_offsets[K + C], m_cell_offsets[K + C + 1]);
+}
+
+unsigned int
+SubsetPrivate::
+select_cells(ScratchSpacePrivate &scratch,
+             fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+             const fastuidraw::float3x3 &clip_matrix_local,
+             fastuidraw::c_array<unsigned int> dst)
+{
+  using namespace fastuidraw;
+  using namespace fastuidraw::detail;
+
+  vecN<vec2, 4> bb;
+  unsigned int return_value(0u);
+  bool unclipped;
+
+  assert(dst.size() >= m_cell_bounds.size());
+  scratch.m_adjusted_clip_eqs.resize(clip_equations.size());
+  for(unsigned int i = 0; i < clip_equations.size(); ++i)
+    {
+      scratch.m_adjusted_clip_eqs[i] = clip_equations[i] * clip_matrix_local;
+    }
+
+  /* early out if all of the SubsetPrivate is unclipped
+   */
+  m_bounds_f.inflated_polygon(bb, 0.0f);
+  unclipped = clip_against_planes(make_c_array(scratch.m_adjusted_clip_eqs),
+                                  bb, scratch.m_clipped_rect,
+                                  scratch.m_clip_scratch_floats,
+                                  scratch.m_clip_scratch_vec2s);
+  if(unclipped || scratch.m_clipped_rect.empty())
+    {
+      return_value = (unclipped) ? m_cell_bounds.size() : 0u;
+      for(unsigned int C = 0; C < return_value; ++C)
+        {
+          dst[C] = C;
+        }
+      return return_value;
+    }
+
+  for(unsigned int C = 0, endC = m_cell_bounds.size(); C < endC; ++C)
+    {
+      m_cell_bounds[C].inflated_polygon(bb, 0.0f);
+      clip_against_planes(make_c_array(scratch.m_adjusted_clip_eqs),
+                          bb, scratch.m_clipped_rect,
+                          scratch.m_clip_scratch_floats,
+                          scratch.m_clip_scratch_vec2s);
+      if(!scratch.m_clipped_rect.empty())
+        {
+          dst[return_value] = C;
+          ++return_value;
+        }
+    }
+  return return_value;
+}
+
 /////////////////////////////////
 // FilledPathPrivate methods
 FilledPathPrivate::
@@ -2911,9 +3420,71 @@ FilledPathPrivate(const fastuidraw::TessellatedPath &P)
 FilledPathPrivate::
 ~FilledPathPrivate()
 {
+  /* the tasks refer to the SubsetPrivate objects, so
+     those that have started must finish before the
+     SubsetPrivate objects are deleted.
+   */
+  for(unsigned int i = 0, endi = m_tasks.size(); i < endi; ++i)
+    {
+      m_tasks[i]->cancel();
+      m_tasks[i]->run();
+    }
+  m_tasks.clear();
   FASTUIDRAWdelete(m_root);
 }
 
+void
+FilledPathPrivate::
+defer(fastuidraw::TaskPool &task_pool,
+      fastuidraw::const_c_array<SubsetPrivate*> subsets)
+{
+  fastuidraw::autolock_mutex M(m_tasks_mutex);
+  for(unsigned int i = 0; i < subsets.size(); ++i)
+    {
+      fastuidraw::reference_counted_ptr<SubsetTask> task;
+
+      task = FASTUIDRAWnew SubsetTask(subsets[i]);
+      m_tasks.push_back(task);
+      task_pool.add_task(task);
+    }
+}
+
+unsigned int
+FilledPathPrivate::
+number_deferred(void)
+{
+  fastuidraw::autolock_mutex M(m_tasks_mutex);
+  unsigned int j(0);
+
+  for(unsigned int i = 0, endi = m_tasks.size(); i < endi; ++i)
+    {
+      if(!m_tasks[i]->finished())
+        {
+          m_tasks[j] = m_tasks[i];
+          ++j;
+        }
+    }
+  m_tasks.resize(j);
+  return j;
+}
+
+void
+FilledPathPrivate::
+wait_deferred(void)
+{
+  std::vector<fastuidraw::reference_counted_ptr<SubsetTask> > tasks;
+
+  {
+    fastuidraw::autolock_mutex M(m_tasks_mutex);
+    tasks.swap(m_tasks);
+  }
+
+  for(unsigned int i = 0, endi = tasks.size(); i < endi; ++i)
+    {
+      tasks[i]->run();
+    }
+}
+
 ///////////////////////////////
 //fastuidraw::FilledPath::ScratchSpace methods
 fastuidraw::FilledPath::ScratchSpace::
@@ -2975,6 +3546,24 @@ winding_neighbors(int w) const
   return d->winding_neighbors(w);
 }
 
+unsigned int
+fastuidraw::FilledPath::Subset::
+number_cells(void) const
+{
+  SubsetPrivate *d;
+  d = static_cast<SubsetPrivate*>(m_d);
+  return d->number_cells();
+}
+
+fastuidraw::range_type<unsigned int>
+fastuidraw::FilledPath::Subset::
+cell_range(int w, unsigned int C) const
+{
+  SubsetPrivate *d;
+  d = static_cast<SubsetPrivate*>(m_d);
+  return d->cell_range(w, C);
+}
+
 unsigned int
 fastuidraw::FilledPath::Subset::
 chunk_from_winding_number(int winding_number)
@@ -3018,6 +3607,8 @@ chunk_for_aa_fuzz(int winding0, int winding1)
 fastuidraw::FilledPath::
 FilledPath(const TessellatedPath &P)
 {
+  FASTUIDRAWtrace_zone("FilledPath::FilledPath");
+
   m_d = FASTUIDRAWnew FilledPathPrivate(P);
 }
 
@@ -3064,34 +3655,87 @@ select_subsets(ScratchSpace &work_room,
                unsigned int max_index_cnt,
                c_array<unsigned int> dst) const
 {
+  FASTUIDRAWtrace_zone("FilledPath::select_subsets");
+
   FilledPathPrivate *d;
   unsigned int return_value;
 
   d = static_cast<FilledPathPrivate*>(m_d);
   assert(dst.size() >= d->m_subsets.size());
-  /* TODO:
-       - have another method in SubsetPrivate called
-         "fast_select_subsets" which ignores the requirements
-         coming from max_attribute_cnt and max_index_cnt.
-         By ignoring this requirement, we do NOT need
-         to do call make_ready() for any SubsetPrivate
-         object chosen.
-       - have the fast_select_subsets() also return
-         if paths needed require triangulation.
-       - if there such, spawn a thread and let the
-         caller decide if to wait for the thread to
-         finish before proceeding or to do something
-         else (like use a lower level of detail that
-         is ready). Another alternatic is to return
-         what Subset's need to have triangulation done
-         and spawn a set of threads to do the job (!)
-       - All this work means we need to make SubsetPrivate
-         thread safe (with regards to the SubsetPrivate
-         being made ready via make_ready()).
-   */
   return_value= d->m_root->select_subsets(*static_cast<ScratchSpacePrivate*>(work_room.m_d),
                                           clip_equations, clip_matrix_local,
                                           max_attribute_cnt, max_index_cnt, dst);
 
   return return_value;
 }
+
+unsigned int
+fastuidraw::FilledPath::
+select_subsets(ScratchSpace &work_room,
+               const_c_array<vec3> clip_equations,
+               const float3x3 &clip_matrix_local,
+               unsigned int max_attribute_cnt,
+               unsigned int max_index_cnt,
+               TaskPool &task_pool,
+               c_array<unsigned int> dst,
+               unsigned int *out_number_deferred) const
+{
+  FASTUIDRAWtrace_zone("FilledPath::select_subsets");
+
+  FilledPathPrivate *d;
+  ScratchSpacePrivate *scratch;
+  unsigned int return_value;
+
+  d = static_cast<FilledPathPrivate*>(m_d);
+  scratch = static_cast<ScratchSpacePrivate*>(work_room.m_d);
+  assert(dst.size() >= d->m_subsets.size());
+
+  return_value = d->m_root->select_ready_subsets(*scratch, clip_equations, clip_matrix_local,
+                                                 max_attribute_cnt, max_index_cnt, dst);
+  d->defer(task_pool, make_c_array(scratch->m_to_defer));
+
+  if(out_number_deferred)
+    {
+      *out_number_deferred = scratch->m_not_ready.size();
+    }
+
+  return return_value;
+}
+
+unsigned int
+fastuidraw::FilledPath::
+select_cells(ScratchSpace &work_room,
+             const_c_array<vec3> clip_equations,
+             const float3x3 &clip_matrix_local,
+             unsigned int I,
+             c_array<unsigned int> dst) const
+{
+  FilledPathPrivate *d;
+  SubsetPrivate *p;
+
+  d = static_cast<FilledPathPrivate*>(m_d);
+  assert(I < d->m_subsets.size());
+  p = d->m_subsets[I];
+  p->make_ready();
+
+  return p->select_cells(*static_cast<ScratchSpacePrivate*>(work_room.m_d),
+                         clip_equations, clip_matrix_local, dst);
+}
+
+unsigned int
+fastuidraw::FilledPath::
+number_deferred_subsets(void) const
+{
+  FilledPathPrivate *d;
+  d = static_cast<FilledPathPrivate*>(m_d);
+  return d->number_deferred();
+}
+
+void
+fastuidraw::FilledPath::
+wait_deferred_subsets(void) const
+{
+  FilledPathPrivate *d;
+  d = static_cast<FilledPathPrivate*>(m_d);
+  d->wait_deferred();
+}
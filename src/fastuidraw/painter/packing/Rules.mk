@@ -4,7 +4,9 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-LIBRARY_SOURCES += $(call filelist, painter_backend.cpp painter_draw.cpp painter_packer.cpp)
+LIBRARY_SOURCES += $(call filelist, painter_backend.cpp painter_backend_null.cpp \
+	painter_command_list.cpp painter_draw.cpp painter_packer.cpp \
+	painter_persistent_data_store.cpp painter_retained_geometry_store.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
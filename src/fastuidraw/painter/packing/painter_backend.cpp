@@ -54,6 +54,13 @@ namespace
     fastuidraw::PainterBackend::PerformanceHints m_hints;
     fastuidraw::PainterShaderSet m_default_shaders;
     bool m_default_shaders_registered;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRetainedGeometryStore> m_retained_geometry_store;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterPersistentDataStore> m_persistent_data_store;
+
+    /* if non-nullptr, the PainterBackend to which
+       shaders are registered, see share_shaders().
+     */
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_shader_source;
   };
 
   class ConfigurationPrivate
@@ -223,6 +230,15 @@ void
 fastuidraw::PainterBackend::
 register_shader(const reference_counted_ptr<PainterItemShader> &shader)
 {
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+
+  if(d->m_shader_source)
+    {
+      d->m_shader_source->register_shader(shader);
+      return;
+    }
+
   if(!shader || shader->registered_to() == this)
     {
       return;
@@ -248,6 +264,15 @@ void
 fastuidraw::PainterBackend::
 register_shader(const reference_counted_ptr<PainterBlendShader> &shader)
 {
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+
+  if(d->m_shader_source)
+    {
+      d->m_shader_source->register_shader(shader);
+      return;
+    }
+
   if(!shader || shader->registered_to() == this)
     {
       return;
@@ -386,3 +411,56 @@ configuration_base(void) const
   d = static_cast<PainterBackendPrivate*>(m_d);
   return d->m_config;
 }
+
+const fastuidraw::reference_counted_ptr<fastuidraw::PainterRetainedGeometryStore>&
+fastuidraw::PainterBackend::
+retained_geometry_store(void) const
+{
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+  return d->m_retained_geometry_store;
+}
+
+void
+fastuidraw::PainterBackend::
+set_retained_geometry_store(const reference_counted_ptr<PainterRetainedGeometryStore> &store)
+{
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+  d->m_retained_geometry_store = store;
+}
+
+const fastuidraw::reference_counted_ptr<fastuidraw::PainterPersistentDataStore>&
+fastuidraw::PainterBackend::
+persistent_data_store(void) const
+{
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+  return d->m_persistent_data_store;
+}
+
+void
+fastuidraw::PainterBackend::
+set_persistent_data_store(const reference_counted_ptr<PainterPersistentDataStore> &store)
+{
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+  d->m_persistent_data_store = store;
+}
+
+void
+fastuidraw::PainterBackend::
+glyphs_drawn(const_c_array<Glyph> glyphs)
+{
+  FASTUIDRAWunused(glyphs);
+}
+
+void
+fastuidraw::PainterBackend::
+share_shaders(const reference_counted_ptr<PainterBackend> &backend)
+{
+  PainterBackendPrivate *d;
+  d = static_cast<PainterBackendPrivate*>(m_d);
+  assert(backend.get() != this);
+  d->m_shader_source = backend;
+}
@@ -0,0 +1,921 @@
+/*!
+ * \file painter_backend_null.cpp
+ * \brief file painter_backend_null.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <fastuidraw/painter/packing/painter_backend_null.hpp>
+#include "../../private/util_private.hpp"
+
+namespace
+{
+  /* Common base for the backing stores of the atlases of
+     PainterBackendNull to record how many bytes are
+     written to them. The atlases call their stores behind
+     their own mutex, but different atlases may be written
+     from different threads, so the count is atomic.
+   */
+  class NullStoreCounter
+  {
+  public:
+    NullStoreCounter(void):
+      m_bytes(0)
+    {}
+
+    virtual
+    ~NullStoreCounter()
+    {}
+
+    uint64_t
+    bytes(void) const
+    {
+      return m_bytes;
+    }
+
+    void
+    reset_bytes(void) const
+    {
+      m_bytes = 0;
+    }
+
+  protected:
+    void
+    add_bytes(uint64_t v)
+    {
+      m_bytes += v;
+    }
+
+  private:
+    mutable std::atomic<uint64_t> m_bytes;
+  };
+
+  /* Holds the texels of a layered store in memory; a layer
+     is only allocated once it is written to.
+   */
+  template<typename T>
+  class LayeredTexels
+  {
+  public:
+    explicit
+    LayeredTexels(fastuidraw::ivec3 whl):
+      m_dims(whl),
+      m_layers(whl.z())
+    {}
+
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<T> data)
+    {
+      std::vector<T> &layer(m_layers[l]);
+
+      assert(x >= 0 && y >= 0 && x + w <= m_dims.x() && y + h <= m_dims.y());
+      assert(data.size() >= static_cast<unsigned int>(w * h));
+      if(layer.empty())
+        {
+          layer.resize(m_dims.x() * m_dims.y(), T());
+        }
+
+      for(int r = 0; r < h; ++r)
+        {
+          fastuidraw::const_c_array<T> src;
+
+          src = data.sub_array(r * w, w);
+          std::copy(src.begin(), src.end(), layer.begin() + (y + r) * m_dims.x() + x);
+        }
+    }
+
+    void
+    resize(int new_num_layers)
+    {
+      m_dims.z() = new_num_layers;
+      m_layers.resize(new_num_layers);
+    }
+
+  private:
+    fastuidraw::ivec3 m_dims;
+    std::vector<std::vector<T> > m_layers;
+  };
+
+  class GlyphTexelStoreNull:
+    public fastuidraw::GlyphAtlasTexelBackingStoreBase,
+    public NullStoreCounter
+  {
+  public:
+    explicit
+    GlyphTexelStoreNull(fastuidraw::ivec3 whl):
+      fastuidraw::GlyphAtlasTexelBackingStoreBase(whl, true),
+      m_texels(whl)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<uint8_t> data)
+    {
+      m_texels.set_data(x, y, l, w, h, data);
+      add_bytes(w * h * sizeof(uint8_t));
+    }
+
+    virtual
+    void
+    flush(void)
+    {}
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      m_texels.resize(new_num_layers);
+    }
+
+  private:
+    LayeredTexels<uint8_t> m_texels;
+  };
+
+  class GlyphGeometryStoreNull:
+    public fastuidraw::GlyphAtlasGeometryBackingStoreBase,
+    public NullStoreCounter
+  {
+  public:
+    GlyphGeometryStoreNull(unsigned int palignment, unsigned int psize):
+      fastuidraw::GlyphAtlasGeometryBackingStoreBase(palignment, psize, true),
+      m_values(palignment * psize)
+    {}
+
+    virtual
+    void
+    set_values(unsigned int location,
+               fastuidraw::const_c_array<fastuidraw::generic_data> pdata)
+    {
+      assert(pdata.size() % alignment() == 0);
+      assert(location * alignment() + pdata.size() <= m_values.size());
+      std::copy(pdata.begin(), pdata.end(), m_values.begin() + location * alignment());
+      add_bytes(pdata.size() * sizeof(fastuidraw::generic_data));
+    }
+
+    virtual
+    void
+    flush(void)
+    {}
+
+  protected:
+    virtual
+    void
+    resize_implement(unsigned int new_size)
+    {
+      m_values.resize(new_size * alignment());
+    }
+
+  private:
+    std::vector<fastuidraw::generic_data> m_values;
+  };
+
+  class ColorStoreNull:
+    public fastuidraw::AtlasColorBackingStoreBase,
+    public NullStoreCounter
+  {
+  public:
+    explicit
+    ColorStoreNull(fastuidraw::ivec3 whl):
+      fastuidraw::AtlasColorBackingStoreBase(whl, true),
+      m_texels(whl)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::u8vec4> data)
+    {
+      m_texels.set_data(x, y, l, w, h, data);
+      add_bytes(w * h * sizeof(fastuidraw::u8vec4));
+    }
+
+    virtual
+    void
+    flush(void)
+    {}
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      m_texels.resize(new_num_layers);
+    }
+
+  private:
+    LayeredTexels<fastuidraw::u8vec4> m_texels;
+  };
+
+  class IndexStoreNull:
+    public fastuidraw::AtlasIndexBackingStoreBase,
+    public NullStoreCounter
+  {
+  public:
+    explicit
+    IndexStoreNull(fastuidraw::ivec3 whl):
+      fastuidraw::AtlasIndexBackingStoreBase(whl, true),
+      m_texels(whl)
+    {}
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::ivec3> data,
+             int slack,
+             const fastuidraw::AtlasColorBackingStoreBase *c,
+             int color_tile_size)
+    {
+      FASTUIDRAWunused(slack);
+      FASTUIDRAWunused(c);
+      FASTUIDRAWunused(color_tile_size);
+      set_data(x, y, l, w, h, data);
+    }
+
+    virtual
+    void
+    set_data(int x, int y, int l, int w, int h,
+             fastuidraw::const_c_array<fastuidraw::ivec3> data)
+    {
+      m_texels.set_data(x, y, l, w, h, data);
+      add_bytes(w * h * sizeof(fastuidraw::ivec3));
+    }
+
+    virtual
+    void
+    flush(void)
+    {}
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      m_texels.resize(new_num_layers);
+    }
+
+  private:
+    LayeredTexels<fastuidraw::ivec3> m_texels;
+  };
+
+  class ColorStopStoreNull:
+    public fastuidraw::ColorStopBackingStore,
+    public NullStoreCounter
+  {
+  public:
+    explicit
+    ColorStopStoreNull(fastuidraw::ivec2 wl):
+      fastuidraw::ColorStopBackingStore(wl, true),
+      m_texels(fastuidraw::ivec3(wl.x(), 1, wl.y()))
+    {}
+
+    virtual
+    void
+    set_data(int x, int l, int w,
+             fastuidraw::const_c_array<fastuidraw::u8vec4> data)
+    {
+      m_texels.set_data(x, 0, l, w, 1, data);
+      add_bytes(w * sizeof(fastuidraw::u8vec4));
+    }
+
+  protected:
+    virtual
+    void
+    resize_implement(int new_num_layers)
+    {
+      m_texels.resize(new_num_layers);
+    }
+
+  private:
+    LayeredTexels<fastuidraw::u8vec4> m_texels;
+  };
+
+  class ConfigurationNullPrivate
+  {
+  public:
+    ConfigurationNullPrivate(void):
+      m_attributes_per_buffer(512 * 512),
+      m_indices_per_buffer((m_attributes_per_buffer * 6) / 4),
+      m_data_blocks_per_store_buffer(1024 * 64),
+      m_break_on_shader_change(false),
+      m_retained_geometry_attributes(0),
+      m_retained_geometry_indices(0),
+      m_persistent_data_store_blocks(0),
+      m_header_via_base_instance(false)
+    {}
+
+    unsigned int m_attributes_per_buffer;
+    unsigned int m_indices_per_buffer;
+    unsigned int m_data_blocks_per_store_buffer;
+    bool m_break_on_shader_change;
+    unsigned int m_retained_geometry_attributes;
+    unsigned int m_retained_geometry_indices;
+    unsigned int m_persistent_data_store_blocks;
+    bool m_header_via_base_instance;
+  };
+
+  /* Storage for one PainterDraw; the storage is recycled
+     through the BufferPool once the PainterDraw is deleted.
+   */
+  class Buffers
+  {
+  public:
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<uint32_t> m_header_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::generic_data> m_store;
+  };
+
+  class BufferPool:
+    public fastuidraw::reference_counted<BufferPool>::default_base
+  {
+  public:
+    BufferPool(const fastuidraw::PainterBackendNull::ConfigurationNull &params,
+               unsigned int alignment):
+      m_num_attributes(params.attributes_per_buffer()),
+      m_num_indices(params.indices_per_buffer()),
+      m_num_generic_datas(params.data_blocks_per_store_buffer() * alignment),
+      m_num_header_attributes(params.header_via_base_instance() ? 0 : m_num_attributes),
+      m_stats(0)
+    {}
+
+    ~BufferPool()
+    {
+      for(unsigned int i = 0, endi = m_free.size(); i < endi; ++i)
+        {
+          FASTUIDRAWdelete(m_free[i]);
+        }
+    }
+
+    Buffers*
+    request_buffers(void)
+    {
+      Buffers *return_value;
+
+      if(m_free.empty())
+        {
+          return_value = FASTUIDRAWnew Buffers();
+          return_value->m_attributes.resize(m_num_attributes);
+          return_value->m_header_attributes.resize(m_num_header_attributes);
+          return_value->m_indices.resize(m_num_indices);
+          return_value->m_store.resize(m_num_generic_datas);
+        }
+      else
+        {
+          return_value = m_free.back();
+          m_free.pop_back();
+        }
+      return return_value;
+    }
+
+    void
+    release_buffers(Buffers *b)
+    {
+      m_free.push_back(b);
+    }
+
+    uint64_t&
+    stat(enum fastuidraw::PainterBackendNull::stats_t st)
+    {
+      return m_stats[st];
+    }
+
+    void
+    reset_stats(void)
+    {
+      std::fill(m_stats.begin(), m_stats.end(), 0);
+    }
+
+  private:
+    unsigned int m_num_attributes, m_num_indices, m_num_generic_datas;
+    unsigned int m_num_header_attributes;
+    std::vector<Buffers*> m_free;
+    fastuidraw::vecN<uint64_t, fastuidraw::PainterBackendNull::num_stats> m_stats;
+  };
+
+  class RetainedGeometryStoreNull:public fastuidraw::PainterRetainedGeometryStore
+  {
+  public:
+    RetainedGeometryStoreNull(const fastuidraw::PainterBackendNull::ConfigurationNull &params,
+                              const fastuidraw::reference_counted_ptr<BufferPool> &pool):
+      fastuidraw::PainterRetainedGeometryStore(params.retained_geometry_attributes(),
+                                               params.retained_geometry_indices()),
+      m_pool(pool),
+      m_attributes(params.retained_geometry_attributes()),
+      m_indices(params.retained_geometry_indices())
+    {}
+
+  protected:
+    virtual
+    void
+    set_attributes(unsigned int location,
+                   fastuidraw::const_c_array<fastuidraw::PainterAttribute> data)
+    {
+      assert(location + data.size() <= m_attributes.size());
+      std::copy(data.begin(), data.end(), m_attributes.begin() + location);
+      m_pool->stat(fastuidraw::PainterBackendNull::retained_geometry_bytes) += data.size() * sizeof(fastuidraw::PainterAttribute);
+    }
+
+    virtual
+    void
+    set_indices(unsigned int location,
+                fastuidraw::const_c_array<fastuidraw::PainterIndex> data)
+    {
+      assert(location + data.size() <= m_indices.size());
+      std::copy(data.begin(), data.end(), m_indices.begin() + location);
+      m_pool->stat(fastuidraw::PainterBackendNull::retained_geometry_bytes) += data.size() * sizeof(fastuidraw::PainterIndex);
+    }
+
+  private:
+    fastuidraw::reference_counted_ptr<BufferPool> m_pool;
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+  };
+
+  class PersistentDataStoreNull:public fastuidraw::PainterPersistentDataStore
+  {
+  public:
+    PersistentDataStoreNull(const fastuidraw::PainterBackendNull::ConfigurationNull &params,
+                            unsigned int alignment,
+                            const fastuidraw::reference_counted_ptr<BufferPool> &pool):
+      fastuidraw::PainterPersistentDataStore(params.persistent_data_store_blocks(), alignment),
+      m_pool(pool),
+      m_store(params.persistent_data_store_blocks() * alignment)
+    {}
+
+  protected:
+    virtual
+    void
+    set_data(unsigned int location,
+             fastuidraw::const_c_array<fastuidraw::generic_data> data)
+    {
+      location *= alignment();
+      assert(location + data.size() <= m_store.size());
+      std::copy(data.begin(), data.end(), m_store.begin() + location);
+      m_pool->stat(fastuidraw::PainterBackendNull::persistent_data_store_bytes) += data.size() * sizeof(fastuidraw::generic_data);
+    }
+
+  private:
+    fastuidraw::reference_counted_ptr<BufferPool> m_pool;
+    std::vector<fastuidraw::generic_data> m_store;
+  };
+
+  class DrawCommandNull:public fastuidraw::PainterDraw
+  {
+  public:
+    explicit
+    DrawCommandNull(const fastuidraw::reference_counted_ptr<BufferPool> &pool);
+
+    ~DrawCommandNull();
+
+    virtual
+    void
+    draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+               const fastuidraw::PainterShaderGroup &new_shaders,
+               unsigned int attributes_written, unsigned int indices_written) const;
+
+    virtual
+    void
+    draw_retained(unsigned int index_offset, unsigned int index_count,
+                  int base_vertex, uint32_t header_location,
+                  unsigned int attributes_written,
+                  unsigned int indices_written) const;
+
+    virtual
+    void
+    header_changed(uint32_t header_location,
+                   unsigned int attributes_written,
+                   unsigned int indices_written) const;
+
+    virtual
+    void
+    draw(void) const;
+
+  protected:
+    virtual
+    void
+    unmap_implement(unsigned int attributes_written,
+                    unsigned int indices_written,
+                    unsigned int data_store_written) const;
+
+  private:
+    fastuidraw::reference_counted_ptr<BufferPool> m_pool;
+    Buffers *m_buffers;
+  };
+
+  class PainterBackendNullPrivate
+  {
+  public:
+    PainterBackendNullPrivate(const fastuidraw::PainterBackendNull::ConfigurationNull &params,
+                              fastuidraw::PainterBackendNull *p);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>
+    create_glyph_atlas(void);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas>
+    create_image_atlas(void);
+
+    static
+    fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas>
+    create_colorstop_atlas(void);
+
+    static
+    void
+    add_store(const NullStoreCounter *store,
+              std::vector<const NullStoreCounter*> &out_stores);
+
+    fastuidraw::PainterBackendNull::ConfigurationNull m_params;
+    fastuidraw::reference_counted_ptr<BufferPool> m_pool;
+
+    /* the backing stores of the atlases, to query and
+       reset the number of bytes written to them.
+     */
+    std::vector<const NullStoreCounter*> m_stores;
+  };
+}
+
+///////////////////////////////////////////
+// DrawCommandNull methods
+DrawCommandNull::
+DrawCommandNull(const fastuidraw::reference_counted_ptr<BufferPool> &pool):
+  m_pool(pool),
+  m_buffers(pool->request_buffers())
+{
+  m_attributes = fastuidraw::make_c_array(m_buffers->m_attributes);
+  m_header_attributes = fastuidraw::make_c_array(m_buffers->m_header_attributes);
+  m_indices = fastuidraw::make_c_array(m_buffers->m_indices);
+  m_store = fastuidraw::make_c_array(m_buffers->m_store);
+  ++m_pool->stat(fastuidraw::PainterBackendNull::num_draws);
+}
+
+DrawCommandNull::
+~DrawCommandNull()
+{
+  m_pool->release_buffers(m_buffers);
+}
+
+void
+DrawCommandNull::
+draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+           const fastuidraw::PainterShaderGroup &new_shaders,
+           unsigned int attributes_written, unsigned int indices_written) const
+{
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+
+  ++m_pool->stat(fastuidraw::PainterBackendNull::num_draw_breaks);
+  if(old_shaders.packed_blend_mode() != new_shaders.packed_blend_mode())
+    {
+      ++m_pool->stat(fastuidraw::PainterBackendNull::num_blend_mode_changes);
+    }
+}
+
+void
+DrawCommandNull::
+draw_retained(unsigned int index_offset, unsigned int index_count,
+              int base_vertex, uint32_t header_location,
+              unsigned int attributes_written,
+              unsigned int indices_written) const
+{
+  FASTUIDRAWunused(index_offset);
+  FASTUIDRAWunused(index_count);
+  FASTUIDRAWunused(base_vertex);
+  FASTUIDRAWunused(header_location);
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+  ++m_pool->stat(fastuidraw::PainterBackendNull::num_retained_draws);
+}
+
+void
+DrawCommandNull::
+header_changed(uint32_t header_location,
+               unsigned int attributes_written,
+               unsigned int indices_written) const
+{
+  FASTUIDRAWunused(header_location);
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+  ++m_pool->stat(fastuidraw::PainterBackendNull::num_header_changes);
+}
+
+void
+DrawCommandNull::
+draw(void) const
+{
+  assert(unmapped());
+}
+
+void
+DrawCommandNull::
+unmap_implement(unsigned int attributes_written,
+                unsigned int indices_written,
+                unsigned int data_store_written) const
+{
+  using namespace fastuidraw;
+  unsigned int attribute_size;
+
+  attribute_size = sizeof(PainterAttribute);
+  if(!m_header_attributes.empty())
+    {
+      attribute_size += sizeof(uint32_t);
+    }
+
+  m_pool->stat(PainterBackendNull::num_attributes) += attributes_written;
+  m_pool->stat(PainterBackendNull::num_indices) += indices_written;
+  m_pool->stat(PainterBackendNull::attribute_bytes) += attributes_written * attribute_size;
+  m_pool->stat(PainterBackendNull::index_bytes) += indices_written * sizeof(PainterIndex);
+  m_pool->stat(PainterBackendNull::data_store_bytes) += data_store_written * sizeof(generic_data);
+}
+
+/////////////////////////////////////////////////
+// PainterBackendNullPrivate methods
+PainterBackendNullPrivate::
+PainterBackendNullPrivate(const fastuidraw::PainterBackendNull::ConfigurationNull &params,
+                          fastuidraw::PainterBackendNull *p):
+  m_params(params)
+{
+  m_pool = FASTUIDRAWnew BufferPool(m_params, p->configuration_base().alignment());
+
+  add_store(dynamic_cast<const NullStoreCounter*>(p->glyph_atlas()->texel_store().get()), m_stores);
+  add_store(dynamic_cast<const NullStoreCounter*>(p->glyph_atlas()->geometry_store().get()), m_stores);
+  add_store(dynamic_cast<const NullStoreCounter*>(p->image_atlas()->color_store().get()), m_stores);
+  add_store(dynamic_cast<const NullStoreCounter*>(p->image_atlas()->index_store().get()), m_stores);
+  add_store(dynamic_cast<const NullStoreCounter*>(p->colorstop_atlas()->backing_store().get()), m_stores);
+}
+
+void
+PainterBackendNullPrivate::
+add_store(const NullStoreCounter *store,
+          std::vector<const NullStoreCounter*> &out_stores)
+{
+  assert(store != nullptr);
+  out_stores.push_back(store);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>
+PainterBackendNullPrivate::
+create_glyph_atlas(void)
+{
+  using namespace fastuidraw;
+
+  /* same dimensions as the defaults of gl::GlyphAtlasGL::params */
+  reference_counted_ptr<GlyphAtlasTexelBackingStoreBase> texels;
+  reference_counted_ptr<GlyphAtlasGeometryBackingStoreBase> geometry;
+
+  texels = FASTUIDRAWnew GlyphTexelStoreNull(ivec3(1024, 1024, 16));
+  geometry = FASTUIDRAWnew GlyphGeometryStoreNull(4, (1024 * 1024) / 4);
+  return FASTUIDRAWnew GlyphAtlas(texels, geometry);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ImageAtlas>
+PainterBackendNullPrivate::
+create_image_atlas(void)
+{
+  using namespace fastuidraw;
+
+  /* same tile sizes as the defaults of gl::ImageAtlasGL::params
+     but with fewer tiles, as the stores are resizable.
+   */
+  const int color_tile_size(32), index_tile_size(4), tiles_per_row(64);
+  reference_counted_ptr<AtlasColorBackingStoreBase> color;
+  reference_counted_ptr<AtlasIndexBackingStoreBase> index;
+
+  color = FASTUIDRAWnew ColorStoreNull(ivec3(color_tile_size * tiles_per_row,
+                                             color_tile_size * tiles_per_row,
+                                             1));
+  index = FASTUIDRAWnew IndexStoreNull(ivec3(index_tile_size * tiles_per_row,
+                                             index_tile_size * tiles_per_row,
+                                             4));
+  return FASTUIDRAWnew ImageAtlas(color_tile_size, index_tile_size, color, index);
+}
+
+fastuidraw::reference_counted_ptr<fastuidraw::ColorStopAtlas>
+PainterBackendNullPrivate::
+create_colorstop_atlas(void)
+{
+  using namespace fastuidraw;
+
+  /* same dimensions as the defaults of gl::ColorStopAtlasGL::params */
+  reference_counted_ptr<ColorStopBackingStore> store;
+
+  store = FASTUIDRAWnew ColorStopStoreNull(ivec2(1024, 32));
+  return FASTUIDRAWnew ColorStopAtlas(store);
+}
+
+//////////////////////////////////////////////////////////////
+// fastuidraw::PainterBackendNull::ConfigurationNull methods
+fastuidraw::PainterBackendNull::ConfigurationNull::
+ConfigurationNull(void)
+{
+  m_d = FASTUIDRAWnew ConfigurationNullPrivate();
+}
+
+fastuidraw::PainterBackendNull::ConfigurationNull::
+ConfigurationNull(const ConfigurationNull &obj)
+{
+  ConfigurationNullPrivate *d;
+  d = static_cast<ConfigurationNullPrivate*>(obj.m_d);
+  m_d = FASTUIDRAWnew ConfigurationNullPrivate(*d);
+}
+
+fastuidraw::PainterBackendNull::ConfigurationNull::
+~ConfigurationNull()
+{
+  ConfigurationNullPrivate *d;
+  d = static_cast<ConfigurationNullPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+fastuidraw::PainterBackendNull::ConfigurationNull&
+fastuidraw::PainterBackendNull::ConfigurationNull::
+operator=(const ConfigurationNull &rhs)
+{
+  if(this != &rhs)
+    {
+      ConfigurationNullPrivate *d, *rhs_d;
+      d = static_cast<ConfigurationNullPrivate*>(m_d);
+      rhs_d = static_cast<ConfigurationNullPrivate*>(rhs.m_d);
+      *d = *rhs_d;
+    }
+  return *this;
+}
+
+#define setget_implement(type, name)                                    \
+  fastuidraw::PainterBackendNull::ConfigurationNull&                    \
+  fastuidraw::PainterBackendNull::ConfigurationNull::                   \
+  name(type v)                                                          \
+  {                                                                     \
+    ConfigurationNullPrivate *d;                                        \
+    d = static_cast<ConfigurationNullPrivate*>(m_d);                    \
+    d->m_##name = v;                                                    \
+    return *this;                                                       \
+  }                                                                     \
+                                                                        \
+  type                                                                  \
+  fastuidraw::PainterBackendNull::ConfigurationNull::                   \
+  name(void) const                                                      \
+  {                                                                     \
+    ConfigurationNullPrivate *d;                                        \
+    d = static_cast<ConfigurationNullPrivate*>(m_d);                    \
+    return d->m_##name;                                                 \
+  }
+
+setget_implement(unsigned int, attributes_per_buffer)
+setget_implement(unsigned int, indices_per_buffer)
+setget_implement(unsigned int, data_blocks_per_store_buffer)
+setget_implement(bool, break_on_shader_change)
+setget_implement(unsigned int, retained_geometry_attributes)
+setget_implement(unsigned int, retained_geometry_indices)
+setget_implement(unsigned int, persistent_data_store_blocks)
+setget_implement(bool, header_via_base_instance)
+
+#undef setget_implement
+
+///////////////////////////////////////////////
+// fastuidraw::PainterBackendNull methods
+fastuidraw::PainterBackendNull::
+PainterBackendNull(const ConfigurationNull &config_null,
+                   const ConfigurationBase &config_base):
+  PainterBackendGLSL(PainterBackendNullPrivate::create_glyph_atlas(),
+                     PainterBackendNullPrivate::create_image_atlas(),
+                     PainterBackendNullPrivate::create_colorstop_atlas(),
+                     ConfigurationGLSL(),
+                     config_base)
+{
+  PainterBackendNullPrivate *d;
+
+  d = FASTUIDRAWnew PainterBackendNullPrivate(config_null, this);
+  m_d = d;
+  if(config_null.retained_geometry_attributes() > 0 && config_null.retained_geometry_indices() > 0)
+    {
+      set_retained_geometry_store(FASTUIDRAWnew RetainedGeometryStoreNull(config_null, d->m_pool));
+    }
+  if(config_null.persistent_data_store_blocks() > 0)
+    {
+      set_persistent_data_store(FASTUIDRAWnew PersistentDataStoreNull(config_null, configuration_base().alignment(), d->m_pool));
+    }
+}
+
+fastuidraw::PainterBackendNull::
+~PainterBackendNull()
+{
+  PainterBackendNullPrivate *d;
+  d = static_cast<PainterBackendNullPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+const fastuidraw::PainterBackendNull::ConfigurationNull&
+fastuidraw::PainterBackendNull::
+configuration_null(void) const
+{
+  PainterBackendNullPrivate *d;
+  d = static_cast<PainterBackendNullPrivate*>(m_d);
+  return d->m_params;
+}
+
+uint64_t
+fastuidraw::PainterBackendNull::
+query_stat(enum stats_t st) const
+{
+  PainterBackendNullPrivate *d;
+  d = static_cast<PainterBackendNullPrivate*>(m_d);
+
+  if(st == atlas_bytes)
+    {
+      uint64_t return_value(0);
+      for(unsigned int i = 0, endi = d->m_stores.size(); i < endi; ++i)
+        {
+          return_value += d->m_stores[i]->bytes();
+        }
+      return return_value;
+    }
+  return d->m_pool->stat(st);
+}
+
+void
+fastuidraw::PainterBackendNull::
+reset_stats(void)
+{
+  PainterBackendNullPrivate *d;
+  d = static_cast<PainterBackendNullPrivate*>(m_d);
+
+  d->m_pool->reset_stats();
+  for(unsigned int i = 0, endi = d->m_stores.size(); i < endi; ++i)
+    {
+      d->m_stores[i]->reset_bytes();
+    }
+}
+
+uint32_t
+fastuidraw::PainterBackendNull::
+compute_item_shader_group(PainterShader::Tag tag,
+                          const reference_counted_ptr<PainterItemShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  return configuration_null().break_on_shader_change() ? tag.m_ID : 0u;
+}
+
+uint32_t
+fastuidraw::PainterBackendNull::
+compute_blend_shader_group(PainterShader::Tag tag,
+                           const reference_counted_ptr<PainterBlendShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  return configuration_null().break_on_shader_change() ? tag.m_ID : 0u;
+}
+
+unsigned int
+fastuidraw::PainterBackendNull::
+attribs_per_mapping(void) const
+{
+  return configuration_null().attributes_per_buffer();
+}
+
+unsigned int
+fastuidraw::PainterBackendNull::
+indices_per_mapping(void) const
+{
+  return configuration_null().indices_per_buffer();
+}
+
+void
+fastuidraw::PainterBackendNull::
+on_pre_draw(void)
+{
+}
+
+void
+fastuidraw::PainterBackendNull::
+on_post_draw(void)
+{
+}
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw>
+fastuidraw::PainterBackendNull::
+map_draw(void)
+{
+  PainterBackendNullPrivate *d;
+  d = static_cast<PainterBackendNullPrivate*>(m_d);
+  return FASTUIDRAWnew DrawCommandNull(d->m_pool);
+}
@@ -0,0 +1,535 @@
+/*!
+ * \file painter_command_list.cpp
+ * \brief file painter_command_list.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <vector>
+#include <algorithm>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/painter/painter_header.hpp>
+#include <fastuidraw/painter/packing/painter_command_list.hpp>
+#include "../../private/util_private.hpp"
+#include "../../text/private/pinned_glyphs.hpp"
+
+namespace
+{
+  /* Storage into which a PainterDraw is written; once
+     the PainterDraw is unmapped, the storage is owned by
+     the recording until it is cleared, after which the
+     storage is recycled.
+   */
+  class Buffers
+  {
+  public:
+    std::vector<fastuidraw::PainterAttribute> m_attributes;
+    std::vector<uint32_t> m_header_attributes;
+    std::vector<fastuidraw::PainterIndex> m_indices;
+    std::vector<fastuidraw::generic_data> m_store;
+  };
+
+  /* The data of a recorded PainterDraw; the data written
+     is kept in the Buffers it was written to instead of
+     being copied.
+   */
+  class RecordedDrawData
+  {
+  public:
+    RecordedDrawData(void):
+      m_buffers(nullptr)
+    {}
+
+    Buffers *m_buffers;
+    std::vector<uint32_t> m_header_locations;
+    std::vector<fastuidraw::PainterCommandList::StateChange> m_state_changes;
+  };
+
+  /* The recording of a PainterCommandList; it is held by
+     reference by the PainterDraw objects so that they can
+     write to it when they are unmapped.
+   */
+  class Recording:
+    public fastuidraw::reference_counted<Recording>::non_concurrent
+  {
+  public:
+    Recording(unsigned int num_attributes,
+              unsigned int num_indices,
+              unsigned int num_generic_datas,
+              unsigned int alignment):
+      m_num_attributes(num_attributes),
+      m_num_indices(num_indices),
+      m_num_generic_datas(num_generic_datas),
+      m_alignment(alignment),
+      m_z_range(0)
+    {}
+
+    ~Recording()
+    {
+      clear();
+      for(unsigned int i = 0, endi = m_free.size(); i < endi; ++i)
+        {
+          FASTUIDRAWdelete(m_free[i]);
+        }
+    }
+
+    Buffers*
+    request_buffers(void)
+    {
+      Buffers *return_value;
+
+      if(m_free.empty())
+        {
+          return_value = FASTUIDRAWnew Buffers();
+          return_value->m_attributes.resize(m_num_attributes);
+          return_value->m_header_attributes.resize(m_num_attributes);
+          return_value->m_indices.resize(m_num_indices);
+          return_value->m_store.resize(m_num_generic_datas);
+        }
+      else
+        {
+          return_value = m_free.back();
+          m_free.pop_back();
+        }
+      return return_value;
+    }
+
+    void
+    release_buffers(Buffers *b)
+    {
+      m_free.push_back(b);
+    }
+
+    /* reserve the slot for the next PainterDraw, so that
+       the recorded draws are in the order they are mapped
+       even if they are unmapped in a different order.
+     */
+    unsigned int
+    reserve_draw(void)
+    {
+      m_draws.push_back(FASTUIDRAWnew RecordedDrawData());
+      m_recorded_draws.push_back(fastuidraw::PainterCommandList::RecordedDraw());
+      return m_draws.size() - 1;
+    }
+
+    /* takes ownership of buffers */
+    void
+    record(unsigned int slot, Buffers *buffers,
+           std::vector<fastuidraw::PainterCommandList::StateChange> &state_changes,
+           unsigned int attributes_written,
+           unsigned int indices_written,
+           unsigned int data_store_written);
+
+    void
+    clear(void)
+    {
+      for(unsigned int i = 0, endi = m_draws.size(); i < endi; ++i)
+        {
+          if(m_draws[i]->m_buffers)
+            {
+              release_buffers(m_draws[i]->m_buffers);
+            }
+          FASTUIDRAWdelete(m_draws[i]);
+        }
+      m_draws.clear();
+      m_recorded_draws.clear();
+      m_z_range = 0;
+    }
+
+    unsigned int m_num_attributes, m_num_indices, m_num_generic_datas;
+    unsigned int m_alignment;
+    std::vector<RecordedDrawData*> m_draws;
+    std::vector<fastuidraw::PainterCommandList::RecordedDraw> m_recorded_draws;
+    unsigned int m_z_range;
+
+  private:
+    std::vector<Buffers*> m_free;
+  };
+
+  class DrawCommandRecord:public fastuidraw::PainterDraw
+  {
+  public:
+    explicit
+    DrawCommandRecord(const fastuidraw::reference_counted_ptr<Recording> &recording);
+
+    ~DrawCommandRecord();
+
+    virtual
+    void
+    draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+               const fastuidraw::PainterShaderGroup &new_shaders,
+               unsigned int attributes_written, unsigned int indices_written) const;
+
+    virtual
+    void
+    draw(void) const;
+
+  protected:
+    virtual
+    void
+    unmap_implement(unsigned int attributes_written,
+                    unsigned int indices_written,
+                    unsigned int data_store_written) const;
+
+  private:
+    fastuidraw::reference_counted_ptr<Recording> m_recording;
+    mutable Buffers *m_buffers;
+    unsigned int m_slot;
+    mutable std::vector<fastuidraw::PainterCommandList::StateChange> m_state_changes;
+  };
+
+  class PainterCommandListPrivate
+  {
+  public:
+    PainterCommandListPrivate(const fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> &target,
+                              unsigned int data_blocks_per_draw,
+                              unsigned int attributes_per_draw,
+                              unsigned int indices_per_draw):
+      m_target(target),
+      m_recording(FASTUIDRAWnew Recording(attributes_per_draw, indices_per_draw,
+                                          data_blocks_per_draw * target->configuration_base().alignment(),
+                                          target->configuration_base().alignment()))
+    {}
+
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_target;
+    fastuidraw::reference_counted_ptr<Recording> m_recording;
+    fastuidraw::detail::PinnedGlyphs m_glyphs;
+  };
+}
+
+///////////////////////////////////
+// Recording methods
+void
+Recording::
+record(unsigned int slot, Buffers *buffers,
+       std::vector<fastuidraw::PainterCommandList::StateChange> &state_changes,
+       unsigned int attributes_written,
+       unsigned int indices_written,
+       unsigned int data_store_written)
+{
+  RecordedDrawData *dst;
+  fastuidraw::const_c_array<uint32_t> header_attributes;
+  fastuidraw::const_c_array<fastuidraw::generic_data> store;
+
+  assert(slot < m_draws.size());
+  dst = m_draws[slot];
+  assert(dst->m_buffers == nullptr);
+
+  dst->m_buffers = buffers;
+  dst->m_state_changes.swap(state_changes);
+  header_attributes = fastuidraw::make_c_array(buffers->m_header_attributes).sub_array(0, attributes_written);
+  store = fastuidraw::make_c_array(buffers->m_store).sub_array(0, data_store_written);
+
+  /* the attributes of a header are written contiguously,
+     thus comparing against the previous value removes
+     nearly all duplicates before sorting.
+   */
+  for(unsigned int i = 0; i < attributes_written; ++i)
+    {
+      uint32_t h(header_attributes[i]);
+      if(dst->m_header_locations.empty() || dst->m_header_locations.back() != h)
+        {
+          dst->m_header_locations.push_back(h);
+        }
+    }
+  std::sort(dst->m_header_locations.begin(), dst->m_header_locations.end());
+  dst->m_header_locations.erase(std::unique(dst->m_header_locations.begin(), dst->m_header_locations.end()),
+                                dst->m_header_locations.end());
+
+  /* the z-values are read after the PainterDraw::DelayedAction
+     objects have run, since they may write the z-value of
+     headers (for example for the occluders of clipping).
+   */
+  for(unsigned int i = 0, endi = dst->m_header_locations.size(); i < endi; ++i)
+    {
+      unsigned int loc;
+
+      loc = dst->m_header_locations[i] * m_alignment + fastuidraw::PainterHeader::z_offset;
+      assert(loc < store.size());
+      m_z_range = std::max(m_z_range, store[loc].u + 1u);
+    }
+
+  fastuidraw::PainterCommandList::RecordedDraw &R(m_recorded_draws[slot]);
+  R.m_attributes = fastuidraw::make_c_array(buffers->m_attributes).sub_array(0, attributes_written);
+  R.m_header_attributes = header_attributes;
+  R.m_indices = fastuidraw::make_c_array(buffers->m_indices).sub_array(0, indices_written);
+  R.m_store = store;
+  R.m_header_locations = fastuidraw::make_c_array(dst->m_header_locations);
+  R.m_state_changes = fastuidraw::make_c_array(dst->m_state_changes);
+}
+
+///////////////////////////////////
+// DrawCommandRecord methods
+DrawCommandRecord::
+DrawCommandRecord(const fastuidraw::reference_counted_ptr<Recording> &recording):
+  m_recording(recording),
+  m_buffers(recording->request_buffers()),
+  m_slot(recording->reserve_draw())
+{
+  fastuidraw::PainterCommandList::StateChange initial;
+
+  m_attributes = fastuidraw::make_c_array(m_buffers->m_attributes);
+  m_header_attributes = fastuidraw::make_c_array(m_buffers->m_header_attributes);
+  m_indices = fastuidraw::make_c_array(m_buffers->m_indices);
+  m_store = fastuidraw::make_c_array(m_buffers->m_store);
+
+  initial.m_item_group = 0;
+  initial.m_blend_group = 0;
+  initial.m_brush = 0;
+  initial.m_blend_mode = 0;
+  initial.m_indices_written = 0;
+  m_state_changes.push_back(initial);
+}
+
+DrawCommandRecord::
+~DrawCommandRecord()
+{
+  if(m_buffers)
+    {
+      m_recording->release_buffers(m_buffers);
+    }
+}
+
+void
+DrawCommandRecord::
+draw_break(const fastuidraw::PainterShaderGroup &old_shaders,
+           const fastuidraw::PainterShaderGroup &new_shaders,
+           unsigned int attributes_written, unsigned int indices_written) const
+{
+  fastuidraw::PainterCommandList::StateChange st;
+
+  FASTUIDRAWunused(old_shaders);
+  FASTUIDRAWunused(attributes_written);
+
+  st.m_item_group = new_shaders.item_group();
+  st.m_blend_group = new_shaders.blend_group();
+  st.m_brush = new_shaders.brush();
+  st.m_blend_mode = new_shaders.packed_blend_mode();
+  st.m_indices_written = indices_written;
+
+  /* a state change without any indices before
+     it replaces the previous one.
+   */
+  assert(!m_state_changes.empty());
+  if(m_state_changes.back().m_indices_written == indices_written)
+    {
+      m_state_changes.back() = st;
+    }
+  else
+    {
+      m_state_changes.push_back(st);
+    }
+}
+
+void
+DrawCommandRecord::
+draw(void) const
+{
+  /* the data was recorded when the
+     PainterDraw was unmapped.
+   */
+}
+
+void
+DrawCommandRecord::
+unmap_implement(unsigned int attributes_written,
+                unsigned int indices_written,
+                unsigned int data_store_written) const
+{
+  m_recording->record(m_slot, m_buffers, m_state_changes,
+                      attributes_written, indices_written,
+                      data_store_written);
+  m_buffers = nullptr;
+}
+
+///////////////////////////////////////
+// fastuidraw::PainterCommandList methods
+fastuidraw::PainterCommandList::
+PainterCommandList(const reference_counted_ptr<PainterBackend> &target,
+                   unsigned int data_blocks_per_draw,
+                   unsigned int attributes_per_draw,
+                   unsigned int indices_per_draw):
+  PainterBackend(target->glyph_atlas(),
+                 target->image_atlas(),
+                 target->colorstop_atlas(),
+                 target->configuration_base(),
+                 target->default_shaders())
+{
+  attributes_per_draw = t_min(attributes_per_draw, target->attribs_per_mapping());
+  indices_per_draw = t_min(indices_per_draw, target->indices_per_mapping());
+  m_d = FASTUIDRAWnew PainterCommandListPrivate(target, data_blocks_per_draw,
+                                                attributes_per_draw, indices_per_draw);
+
+  /* the headers recorded are to be drawn by the target,
+     so the shaders must be those of the target.
+   */
+  share_shaders(target);
+  set_hints().clipping_via_hw_clip_planes(target->hints().clipping_via_hw_clip_planes());
+}
+
+fastuidraw::PainterCommandList::
+~PainterCommandList()
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+const fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend>&
+fastuidraw::PainterCommandList::
+target(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_target;
+}
+
+void
+fastuidraw::PainterCommandList::
+clear(void)
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  d->m_recording->clear();
+  d->m_glyphs.clear();
+}
+
+unsigned int
+fastuidraw::PainterCommandList::
+number_draws(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_recording->m_recorded_draws.size();
+}
+
+const fastuidraw::PainterCommandList::RecordedDraw&
+fastuidraw::PainterCommandList::
+recorded_draw(unsigned int I) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  assert(I < d->m_recording->m_recorded_draws.size());
+  return d->m_recording->m_recorded_draws[I];
+}
+
+unsigned int
+fastuidraw::PainterCommandList::
+z_range(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_recording->m_z_range;
+}
+
+unsigned int
+fastuidraw::PainterCommandList::
+attribs_per_mapping(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_recording->m_num_attributes;
+}
+
+unsigned int
+fastuidraw::PainterCommandList::
+indices_per_mapping(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_recording->m_num_indices;
+}
+
+void
+fastuidraw::PainterCommandList::
+target_resolution(int w, int h)
+{
+  FASTUIDRAWunused(w);
+  FASTUIDRAWunused(h);
+}
+
+void
+fastuidraw::PainterCommandList::
+on_pre_draw(void)
+{}
+
+void
+fastuidraw::PainterCommandList::
+on_post_draw(void)
+{}
+
+fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw>
+fastuidraw::PainterCommandList::
+map_draw(void)
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return FASTUIDRAWnew DrawCommandRecord(d->m_recording);
+}
+
+void
+fastuidraw::PainterCommandList::
+glyphs_drawn(const_c_array<Glyph> glyphs)
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  d->m_glyphs.add(glyphs);
+}
+
+fastuidraw::const_c_array<fastuidraw::Glyph>
+fastuidraw::PainterCommandList::
+glyphs(void) const
+{
+  PainterCommandListPrivate *d;
+  d = static_cast<PainterCommandListPrivate*>(m_d);
+  return d->m_glyphs.glyphs();
+}
+
+fastuidraw::PainterShader::Tag
+fastuidraw::PainterCommandList::
+absorb_item_shader(const reference_counted_ptr<PainterItemShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  assert(!"PainterCommandList::absorb_item_shader() should never be called");
+  return PainterShader::Tag();
+}
+
+uint32_t
+fastuidraw::PainterCommandList::
+compute_item_sub_shader_group(const reference_counted_ptr<PainterItemShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  assert(!"PainterCommandList::compute_item_sub_shader_group() should never be called");
+  return 0;
+}
+
+fastuidraw::PainterShader::Tag
+fastuidraw::PainterCommandList::
+absorb_blend_shader(const reference_counted_ptr<PainterBlendShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  assert(!"PainterCommandList::absorb_blend_shader() should never be called");
+  return PainterShader::Tag();
+}
+
+uint32_t
+fastuidraw::PainterCommandList::
+compute_blend_sub_shader_group(const reference_counted_ptr<PainterBlendShader> &shader)
+{
+  FASTUIDRAWunused(shader);
+  assert(!"PainterCommandList::compute_blend_sub_shader_group() should never be called");
+  return 0;
+}
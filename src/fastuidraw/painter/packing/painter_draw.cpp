@@ -122,6 +122,34 @@ fastuidraw::PainterDraw::
   m_d = nullptr;
 }
 
+void
+fastuidraw::PainterDraw::
+draw_retained(unsigned int index_offset, unsigned int index_count,
+              int base_vertex, uint32_t header_location,
+              unsigned int attributes_written,
+              unsigned int indices_written) const
+{
+  FASTUIDRAWunused(index_offset);
+  FASTUIDRAWunused(index_count);
+  FASTUIDRAWunused(base_vertex);
+  FASTUIDRAWunused(header_location);
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+  assert(!"PainterDraw::draw_retained() not implemented by a PainterBackend that has a PainterRetainedGeometryStore");
+}
+
+void
+fastuidraw::PainterDraw::
+header_changed(uint32_t header_location,
+               unsigned int attributes_written,
+               unsigned int indices_written) const
+{
+  FASTUIDRAWunused(header_location);
+  FASTUIDRAWunused(attributes_written);
+  FASTUIDRAWunused(indices_written);
+  assert(!"PainterDraw::header_changed() not implemented by a PainterDraw without header attributes");
+}
+
 void
 fastuidraw::PainterDraw::
 add_action(const reference_counted_ptr<DelayedAction> &h) const
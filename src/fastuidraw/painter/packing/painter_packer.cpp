@@ -20,10 +20,17 @@
 
 #include <vector>
 #include <list>
+#include <set>
+#include <algorithm>
 #include <cstring>
+#include <atomic>
+#include <mutex>
 
 #include <fastuidraw/painter/packing/painter_packer.hpp>
+#include <fastuidraw/painter/packing/painter_command_list.hpp>
 #include <fastuidraw/painter/painter_header.hpp>
+#include <fastuidraw/util/tracing.hpp>
+#include <fastuidraw/util/bulk_copy.hpp>
 #include "../../private/util_private.hpp"
 
 namespace
@@ -74,10 +81,15 @@ namespace
     }
   };
 
-  /* QUESTION
-      - does the reference count to a pool need to be thread safe?
+  /* The free slots of a PoolBase form a lock-free (Treiber)
+     stack whose links are in m_next. The head packs the slot
+     on top of the stack in its low 32 bits and a tag in its
+     high 32 bits; the tag is incremented on each change of the
+     head so that a pop whose slot was popped and pushed back
+     by other threads in the meantime fails its
+     compare-exchange (the ABA problem).
    */
-  class PoolBase:public fastuidraw::reference_counted<PoolBase>::non_concurrent
+  class PoolBase:public fastuidraw::reference_counted<PoolBase>::atomic
   {
   public:
     enum
@@ -85,40 +97,81 @@ namespace
         pool_size = 1024
       };
 
-    PoolBase(void):
-      m_free_slots_back(pool_size - 1)
+    PoolBase(void)
     {
-      for(unsigned int i = 0; i < pool_size; ++i)
+      for(int i = 0; i < pool_size; ++i)
         {
-          m_free_slots[i] = pool_size - 1 - i;
+          m_next[i].store((i + 1 < pool_size) ? i + 1 : -1, std::memory_order_relaxed);
         }
+      m_head.store(pack_head(0, 0), std::memory_order_release);
     }
 
     ~PoolBase()
     {
-      assert(m_free_slots_back == pool_size - 1);
+      #ifndef NDEBUG
+        {
+          int count(0);
+          for(int slot = head_slot(m_head.load(std::memory_order_acquire));
+              slot >= 0; slot = m_next[slot].load(std::memory_order_relaxed))
+            {
+              ++count;
+            }
+          assert(count == pool_size);
+        }
+      #endif
     }
 
+    /* Returns -1 if there are no free slots
+     */
     int
     aquire_slot(void)
     {
-      /* Should we make this thread safe? We can make it
-         thread safe by using atomic operation on m_free_slots_back.
-         The following code would make it thread safe.
+      uint64_t head;
 
-         return_value = m_free_slots_back.fetch_sub(1, std::memory_order_aquire)
-         if(return_value < 0)
-           {
-              m_free_slots_back.fetch_add(1, std::memory_order_aquire);
-           }
-         return return_value;
-       */
-      int return_value(-1);
+      head = m_head.load(std::memory_order_acquire);
+      for(;;)
+        {
+          int slot, next;
+
+          slot = head_slot(head);
+          if(slot < 0)
+            {
+              return -1;
+            }
+
+          /* if slot was taken by another thread since head was
+             read, the value of next is garbage but then the
+             compare-exchange fails because the tag changed.
+           */
+          next = m_next[slot].load(std::memory_order_relaxed);
+          if(m_head.compare_exchange_weak(head, pack_head(head_tag(head) + 1u, next),
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire))
+            {
+              return slot;
+            }
+        }
+    }
+
+    /* Aquire up to out_slots.size() slots, returning the
+       number of slots aquired.
+     */
+    unsigned int
+    aquire_slots(fastuidraw::c_array<int> out_slots)
+    {
+      unsigned int return_value(0);
 
-      if(m_free_slots_back >= 0)
+      while(return_value < out_slots.size())
         {
-          return_value = m_free_slots[m_free_slots_back];
-          --m_free_slots_back;
+          int slot;
+
+          slot = aquire_slot();
+          if(slot < 0)
+            {
+              break;
+            }
+          out_slots[return_value] = slot;
+          ++return_value;
         }
       return return_value;
     }
@@ -126,28 +179,45 @@ namespace
     void
     release_slot(int v)
     {
-      /* Should we make this thread safe? We can make it
-         thread safe by using atomic operation on m_free_slots_back.
-         The following code would make it thread safe.
+      uint64_t head;
 
-         int S;
-         S = m_free_slots_back.fetch_add(1, std::memory_order_release);
-         std::atomic_thread_fence(std::memory_order_acquire);
-         assert(S < pool_size);
-         m_free_slots[S] = v;
-       */
       assert(v >= 0);
       assert(v < pool_size);
 
-      ++m_free_slots_back;
-
-      assert(m_free_slots_back < pool_size);
-      m_free_slots[m_free_slots_back] = v;
+      head = m_head.load(std::memory_order_relaxed);
+      do
+        {
+          m_next[v].store(head_slot(head), std::memory_order_relaxed);
+        }
+      while(!m_head.compare_exchange_weak(head, pack_head(head_tag(head) + 1u, v),
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
     }
 
   private:
-    int m_free_slots_back;
-    fastuidraw::vecN<int, pool_size> m_free_slots;
+    static
+    uint64_t
+    pack_head(uint32_t tag, int slot)
+    {
+      return (uint64_t(tag) << 32u) | uint64_t(uint32_t(slot));
+    }
+
+    static
+    int
+    head_slot(uint64_t head)
+    {
+      return int(uint32_t(head & 0xFFFFFFFFu));
+    }
+
+    static
+    uint32_t
+    head_tag(uint64_t head)
+    {
+      return uint32_t(head >> 32u);
+    }
+
+    std::atomic<uint64_t> m_head;
+    std::atomic<int> m_next[pool_size];
   };
 
   class EntryBase
@@ -155,16 +225,32 @@ namespace
   public:
 
     EntryBase(void):
+      m_long_lived(false),
+      m_unique_id(0),
+      m_persistent_batch(0),
+      m_persistent_location(0),
       m_raw_value(nullptr),
-      m_pool_slot(-1)
+      m_pool_slot(-1),
+      m_count(0)
     {}
 
+    void
+    set_long_lived(bool v)
+    {
+      static std::atomic<uint64_t> unique_id_counter(0);
+
+      m_long_lived = v;
+      m_unique_id = (v) ?
+        unique_id_counter.fetch_add(1, std::memory_order_relaxed) :
+        0;
+    }
+
     void
     aquire(void)
     {
       assert(m_pool);
       assert(m_pool_slot >= 0);
-      m_count.add_reference();
+      m_count.fetch_add(1, std::memory_order_relaxed);
     }
 
     void
@@ -172,11 +258,20 @@ namespace
     {
       assert(m_pool);
       assert(m_pool_slot >= 0);
-      if(m_count.remove_reference())
+      if(m_count.fetch_sub(1, std::memory_order_release) == 1)
         {
-          m_pool->release_slot(m_pool_slot);
+          fastuidraw::reference_counted_ptr<PoolBase> pool;
+          int slot(m_pool_slot);
+
+          std::atomic_thread_fence(std::memory_order_acquire);
+
+          /* the slot can be handed to another thread as soon
+             as it is released, so the entry must be reset
+             before releasing the slot.
+           */
+          pool.swap(m_pool);
           m_pool_slot = -1;
-          m_pool = nullptr;
+          pool->release_slot(slot);
         }
     }
 
@@ -198,6 +293,22 @@ namespace
      */
     unsigned int m_alignment;
 
+    /* if long lived, the data is fetched from the
+       PainterPersistentDataStore of the PainterBackend
+       keyed by m_unique_id, which is never reused so
+       that the key of a reused entry is different.
+     */
+    bool m_long_lived;
+    uint64_t m_unique_id;
+
+    /* if long lived, the value of
+       PainterPackerPrivate::m_persistent_batch when
+       m_persistent_location was fetched from the
+       PainterPersistentDataStore of m_painter.
+     */
+    uint64_t m_persistent_batch;
+    uint32_t m_persistent_location;
+
   protected:
     /* pointer to raw state member held
        by derived class
@@ -210,10 +321,12 @@ namespace
     int m_pool_slot;
 
   private:
-    /* Entry reference count is not thread safe because
-       the objects themselves are not.
+    /* PainterPackedValue handles to the same entry can be
+       copied and destroyed from different threads, thus the
+       reference count is atomic. The reference_count_atomic
+       class is not used because it allocates its counter.
     */
-    fastuidraw::reference_count_non_concurrent m_count;
+    std::atomic<int> m_count;
   };
 
   template<typename T>
@@ -239,6 +352,7 @@ namespace
       this->m_draw_command_id = 0;
       this->m_offset = 0;
       this->m_painter = nullptr;
+      this->m_persistent_batch = 0;
       this->m_alignment = alignment;
       this->m_data.resize(m_state.data_size(alignment));
       m_state.pack_data(alignment, fastuidraw::make_c_array(this->m_data));
@@ -251,20 +365,17 @@ namespace
   class Pool:public PoolBase
   {
   public:
-    /* Returning nullptr indicates no free entries left in the pool
+    /* slot must have been aquired with aquire_slot()
+       or aquire_slots().
      */
     Entry<T>*
-    allocate(const T &st, int alignment)
+    allocate(int slot, const T &st, int alignment)
     {
-      Entry<T> *return_value(nullptr);
-      int slot;
+      Entry<T> *return_value;
 
-      slot = this->aquire_slot();
-      if(slot >= 0)
-        {
-          return_value = &m_data[slot];
-          return_value->set(st, alignment, this, slot);
-        }
+      assert(slot >= 0 && slot < PoolBase::pool_size);
+      return_value = &m_data[slot];
+      return_value->set(st, alignment, this, slot);
       return return_value;
     }
 
@@ -272,34 +383,193 @@ namespace
     fastuidraw::vecN<Entry<T>, PoolBase::pool_size> m_data;
   };
 
+  /* A PoolSetToken identifies a PoolSet to the per-thread
+     magazines; it outlives the PoolSet for as long as a
+     magazine refers to it.
+   */
+  class PoolSetToken:public fastuidraw::reference_counted<PoolSetToken>::atomic
+  {
+  public:
+    PoolSetToken(void):
+      m_alive(true)
+    {}
+
+    std::atomic<bool> m_alive;
+  };
+
+  /* A Magazine holds slots, all of the same PoolBase, that a
+     thread took from the free list of the PoolBase; it is only
+     accessed by that thread so allocating from it does not
+     need any synchronization. Slots of a released entry go
+     back to the free list of its PoolBase directly since the
+     entry may be released by a different thread.
+   */
+  class Magazine:fastuidraw::noncopyable
+  {
+  public:
+    enum
+      {
+        magazine_size = 32
+      };
+
+    explicit
+    Magazine(const fastuidraw::reference_counted_ptr<PoolSetToken> &token):
+      m_token(token),
+      m_count(0)
+    {}
+
+    ~Magazine()
+    {
+      for(unsigned int i = 0; i < m_count; ++i)
+        {
+          m_pool->release_slot(m_slots[i]);
+        }
+    }
+
+    fastuidraw::reference_counted_ptr<PoolSetToken> m_token;
+    fastuidraw::reference_counted_ptr<PoolBase> m_pool;
+    fastuidraw::vecN<int, magazine_size> m_slots;
+    unsigned int m_count;
+  };
+
+  /* The magazines of a thread, one for each PoolSet the thread
+     allocated from. The magazines of PoolSet objects that are
+     gone are deleted when the thread fetches a magazine it does
+     not yet have or when the thread exits.
+   */
+  class ThreadMagazines:fastuidraw::noncopyable
+  {
+  public:
+    ~ThreadMagazines()
+    {
+      for(unsigned int i = 0, endi = m_magazines.size(); i < endi; ++i)
+        {
+          FASTUIDRAWdelete(m_magazines[i]);
+        }
+    }
+
+    Magazine*
+    fetch(const fastuidraw::reference_counted_ptr<PoolSetToken> &token)
+    {
+      for(unsigned int i = 0, endi = m_magazines.size(); i < endi; ++i)
+        {
+          if(m_magazines[i]->m_token == token)
+            {
+              return m_magazines[i];
+            }
+        }
+
+      for(unsigned int i = 0; i < m_magazines.size();)
+        {
+          if(!m_magazines[i]->m_token->m_alive.load(std::memory_order_relaxed))
+            {
+              FASTUIDRAWdelete(m_magazines[i]);
+              m_magazines[i] = m_magazines.back();
+              m_magazines.pop_back();
+            }
+          else
+            {
+              ++i;
+            }
+        }
+
+      m_magazines.push_back(FASTUIDRAWnew Magazine(token));
+      return m_magazines.back();
+    }
+
+    static
+    ThreadMagazines&
+    current(void)
+    {
+      static thread_local ThreadMagazines R;
+      return R;
+    }
+
+  private:
+    std::vector<Magazine*> m_magazines;
+  };
+
+  /* Allocation takes a slot from the magazine of the calling
+     thread; only refilling a magazine touches the free list of
+     a Pool and only when all the Pool objects that the thread
+     has tried are exhausted is a mutex locked to find or
+     create another Pool.
+   */
   template<typename T>
   class PoolSet:fastuidraw::noncopyable
   {
   public:
 
-    PoolSet(void)
+    PoolSet(void):
+      m_token(FASTUIDRAWnew PoolSetToken()),
+      m_next_pool(0)
+    {}
+
+    ~PoolSet()
     {
-      m_pools.push_back(FASTUIDRAWnew Pool<T>());
+      m_token->m_alive.store(false, std::memory_order_relaxed);
     }
 
     Entry<T>*
     allocate(const T &st, int alignment)
     {
-      Entry<T> *return_value;
+      Magazine *M;
+      Pool<T> *pool;
 
-      return_value = m_pools.back()->allocate(st, alignment);
-      if(!return_value)
+      M = ThreadMagazines::current().fetch(m_token);
+      if(M->m_count == 0)
         {
-          m_pools.push_back(FASTUIDRAWnew Pool<T>());
-          return_value = m_pools.back()->allocate(st, alignment);
+          refill(M);
         }
 
-      assert(return_value);
-      return return_value;
+      assert(M->m_count > 0);
+      --M->m_count;
+      pool = static_cast<Pool<T>*>(M->m_pool.get());
+      return pool->allocate(M->m_slots[M->m_count], st, alignment);
     }
 
   private:
+    void
+    refill(Magazine *M)
+    {
+      assert(M->m_count == 0);
+      if(M->m_pool)
+        {
+          M->m_count = M->m_pool->aquire_slots(M->m_slots);
+          if(M->m_count > 0)
+            {
+              return;
+            }
+        }
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      /* start at a different pool each time so that
+         threads do not all refill from the same pool.
+       */
+      for(unsigned int i = 0, endi = m_pools.size(); i < endi; ++i)
+        {
+          unsigned int p;
+
+          p = (m_next_pool + i) % endi;
+          M->m_count = m_pools[p]->aquire_slots(M->m_slots);
+          if(M->m_count > 0)
+            {
+              M->m_pool = m_pools[p];
+              m_next_pool = p + 1;
+              return;
+            }
+        }
+
+      m_pools.push_back(FASTUIDRAWnew Pool<T>());
+      M->m_pool = m_pools.back();
+      M->m_count = M->m_pool->aquire_slots(M->m_slots);
+    }
+
+    fastuidraw::reference_counted_ptr<PoolSetToken> m_token;
+    std::mutex m_mutex;
     std::vector<fastuidraw::reference_counted_ptr<Pool<T> > > m_pools;
+    unsigned int m_next_pool;
   };
 
   class PainterPackedValuePoolPrivate
@@ -331,11 +601,77 @@ namespace
 
   class PainterPackerPrivate;
 
+  /* how an item may be moved in deferred submission mode */
+  enum deferred_class_t
+    {
+      /* the output of the item does not depend on the
+         framebuffer, it can be drawn before items of
+         lower z.
+       */
+      deferred_opaque,
+
+      /* the item blends with the framebuffer and must be
+         drawn after the items of lower z it overlaps
+       */
+      deferred_translucent,
+
+      /* the z of the item is not known (it can be changed
+         by a DataCallBack); no item can be moved across it
+       */
+      deferred_barrier
+    };
+
+  /* A deferred_piece is either a range of the indices written
+     to a PainterDraw or a draw from the retained geometry store.
+   */
+  class deferred_piece
+  {
+  public:
+    bool m_retained;
+    unsigned int m_index_offset, m_index_count;
+    int m_base_vertex;
+  };
+
+  /* A deferred_header is a header packed in deferred submission
+     mode together with the pieces drawn with it, which are
+     m_pieces[m_pieces_begin, m_pieces_end) of its per_draw_command.
+   */
+  class deferred_header
+  {
+  public:
+    PainterShaderGroupPrivate m_state;
+    uint32_t m_header_location;
+    unsigned int m_z;
+    enum deferred_class_t m_class;
+    unsigned int m_pieces_begin, m_pieces_end;
+  };
+
+  /* orders deferred_header values by the state that
+     requires a draw break when it changes.
+   */
+  class deferred_header_sorter
+  {
+  public:
+    deferred_header_sorter(const std::vector<deferred_header> &headers,
+                           uint32_t brush_shader_mask):
+      m_headers(headers),
+      m_brush_shader_mask(brush_shader_mask)
+    {}
+
+    bool
+    operator()(unsigned int lhs, unsigned int rhs) const;
+
+  private:
+    const std::vector<deferred_header> &m_headers;
+    uint32_t m_brush_shader_mask;
+  };
+
   class per_draw_command
   {
   public:
     per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
-                     const fastuidraw::PainterBackend::ConfigurationBase &config);
+                     const fastuidraw::PainterBackend::ConfigurationBase &config,
+                     bool deferred);
 
     unsigned int
     attribute_room(void)
@@ -369,6 +705,18 @@ namespace
     void
     unmap(void)
     {
+      if(m_deferred)
+        {
+          submit_deferred();
+        }
+      FASTUIDRAWtrace_zone("PainterDraw::unmap");
+      FASTUIDRAWtrace_counter(attribute_bytes, m_attributes_written * sizeof(fastuidraw::PainterAttribute));
+      FASTUIDRAWtrace_counter(index_bytes, m_indices_written * sizeof(fastuidraw::PainterIndex));
+      FASTUIDRAWtrace_counter(data_store_bytes, store_written() * sizeof(fastuidraw::generic_data));
+      if(m_have_header_attributes)
+        {
+          FASTUIDRAWtrace_counter(header_attribute_bytes, m_attributes_written * sizeof(uint32_t));
+        }
       m_draw_command->unmap(m_attributes_written, m_indices_written, store_written());
     }
 
@@ -384,12 +732,125 @@ namespace
                 const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
                 unsigned int z,
                 const painter_state_location &loc,
-                const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
+                const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back,
+                enum deferred_class_t deferred_class);
+
+    /* returns where to write the next count indices: the
+       PainterDraw, or in deferred submission mode a staging
+       array from which submit_deferred() writes the indices
+       to the PainterDraw in their final order, so that the
+       (possibly write-only) mapped indices are written once
+       and never read back.
+     */
+    fastuidraw::c_array<fastuidraw::PainterIndex>
+    index_destination(unsigned int count);
+
+    /* returns true if index_destination() returns the staging
+       array, which the packer reads back and thus should not
+       be written with non-temporal stores.
+     */
+    bool
+    indices_staged(void) const
+    {
+      return m_deferred;
+    }
+
+    /* to be called after indices are written to the
+       index_destination() for the last header packed.
+     */
+    void
+    add_indices(unsigned int index_offset, unsigned int index_count);
+
+    void
+    draw_retained(unsigned int index_offset, unsigned int index_count,
+                  int base_vertex, uint32_t header_location);
+
+    /* append the data of a PainterDraw recorded by a
+       PainterCommandList, the caller must make sure
+       there is enough room.
+     */
+    void
+    add_recorded_draw(const fastuidraw::PainterCommandList::RecordedDraw &draw,
+                      unsigned int z);
 
     fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> m_draw_command;
     unsigned int m_attributes_written, m_indices_written;
+    unsigned int m_draw_breaks;
+
+    /* false if PainterDraw::m_header_attributes is empty, in
+       which case the header of the indices is given to the
+       PainterDraw with PainterDraw::header_changed().
+     */
+    bool m_have_header_attributes;
 
   private:
+    bool
+    needs_draw_break(const PainterShaderGroupPrivate &current) const
+    {
+      return current.m_item_group != m_prev_state.m_item_group
+        || current.m_blend_group != m_prev_state.m_blend_group
+        || (m_brush_shader_mask & (current.m_brush ^ m_prev_state.m_brush)) != 0u
+        || current.m_blend_mode != m_prev_state.m_blend_mode;
+    }
+
+    /* record in the tracing counters which parts of the
+       shader state caused a draw break
+     */
+    void
+    trace_draw_break(const PainterShaderGroupPrivate &current) const
+    {
+      FASTUIDRAWunused(current);
+      if(current.m_item_group != m_prev_state.m_item_group)
+        {
+          FASTUIDRAWtrace_counter(draw_breaks_item_shader_group, 1u);
+        }
+      if(current.m_blend_group != m_prev_state.m_blend_group)
+        {
+          FASTUIDRAWtrace_counter(draw_breaks_blend_shader_group, 1u);
+        }
+      if((m_brush_shader_mask & (current.m_brush ^ m_prev_state.m_brush)) != 0u)
+        {
+          FASTUIDRAWtrace_counter(draw_breaks_brush_shader, 1u);
+        }
+      if(current.m_blend_mode != m_prev_state.m_blend_mode)
+        {
+          FASTUIDRAWtrace_counter(draw_breaks_blend_mode, 1u);
+        }
+    }
+
+    void
+    header_changed(uint32_t header_location, unsigned int indices_written)
+    {
+      if(!m_have_header_attributes)
+        {
+          m_draw_command->header_changed(header_location,
+                                         m_attributes_written,
+                                         indices_written);
+        }
+    }
+
+    /* change the state and header with which the indices that
+       follow are drawn; in deferred submission mode, the state
+       is recorded as a barrier header.
+     */
+    void
+    add_state(const PainterShaderGroupPrivate &state,
+              uint32_t header_location, unsigned int z);
+
+    /* reorder the recorded headers and send their draw
+       breaks and draws to m_draw_command.
+     */
+    void
+    submit_deferred(void);
+
+    /* append to order the headers of [begin, end), first
+       the opaque ones sorted by state, then the others
+       in the order they were packed.
+     */
+    void
+    order_deferred_segment(unsigned int begin, unsigned int end,
+                           std::vector<unsigned int> &order);
+
     fastuidraw::c_array<fastuidraw::generic_data>
     allocate_store(unsigned int num_elements);
 
@@ -443,6 +904,11 @@ namespace
     uint32_t m_brush_shader_mask;
     PainterShaderGroupPrivate m_prev_state;
     fastuidraw::BlendMode m_prev_blend_mode;
+
+    bool m_deferred;
+    std::vector<deferred_header> m_headers;
+    std::vector<deferred_piece> m_pieces;
+    std::vector<fastuidraw::PainterIndex> m_staged_indices;
   };
 
   class PainterPackerPrivateWorkroom
@@ -457,15 +923,20 @@ namespace
     AttributeIndexSrcFromArray(fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attrib_chunks,
                                fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
                                fastuidraw::const_c_array<int> index_adjusts,
-                               fastuidraw::const_c_array<unsigned int> attrib_chunk_selector):
+                               fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
+                               fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*> index_chunk_sources =
+                               fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*>()):
       m_attrib_chunks(attrib_chunks),
       m_index_chunks(index_chunks),
       m_index_adjusts(index_adjusts),
-      m_attrib_chunk_selector(attrib_chunk_selector)
+      m_attrib_chunk_selector(attrib_chunk_selector),
+      m_index_chunk_sources(index_chunk_sources),
+      m_indices_read_back(false)
     {
       assert((m_attrib_chunk_selector.empty() && m_attrib_chunks.size() == m_index_chunks.size())
              || (m_attrib_chunk_selector.size() == m_index_chunks.size()) );
       assert(m_index_adjusts.size() == m_index_chunks.size());
+      assert(m_index_chunk_sources.empty() || m_index_chunk_sources.size() == m_index_chunks.size());
     }
 
     unsigned int
@@ -508,16 +979,34 @@ namespace
                   unsigned int index_offset_value,
                   unsigned int index_chunk) const
     {
+      unsigned int value;
+
       fastuidraw::const_c_array<fastuidraw::PainterIndex> src;
 
       assert(index_chunk < m_index_chunks.size());
       src = m_index_chunks[index_chunk];
 
       assert(dst.size() == src.size());
-      for(unsigned int i = 0; i < dst.size(); ++i)
+      #ifndef NDEBUG
+        {
+          for(unsigned int i = 0; i < src.size(); ++i)
+            {
+              assert(int(src[i]) + m_index_adjusts[index_chunk] >= 0);
+            }
+        }
+      #endif
+
+      /* the sum wraps as unsigned, giving the same value
+         as adding index_offset_value and the adjust in turn.
+       */
+      value = index_offset_value + m_index_adjusts[index_chunk];
+      if(m_indices_read_back)
         {
-          assert(int(src[i]) + m_index_adjusts[index_chunk] >= 0);
-          dst[i] = int(src[i] + index_offset_value) + m_index_adjusts[index_chunk];
+          fastuidraw::bulk_copy::copy_add_cached(dst.c_ptr(), src.c_ptr(), dst.size(), value);
+        }
+      else
+        {
+          fastuidraw::bulk_copy::copy_add(dst.c_ptr(), src.c_ptr(), dst.size(), value);
         }
     }
 
@@ -531,13 +1020,30 @@ namespace
       src = m_attrib_chunks[attribute_chunk];
 
       assert(dst.size() == src.size());
-      std::memcpy(dst.c_ptr(), src.c_ptr(), sizeof(fastuidraw::PainterAttribute) * dst.size());
+      fastuidraw::bulk_copy::copy(dst.c_ptr(), src.c_ptr(), sizeof(fastuidraw::PainterAttribute) * dst.size());
     }
 
     fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_attrib_chunks;
     fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_index_chunks;
     fastuidraw::const_c_array<int> m_index_adjusts;
     fastuidraw::const_c_array<unsigned int> m_attrib_chunk_selector;
+    fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*> m_index_chunk_sources;
+
+    /* true if the indices are written to an array the packer
+       reads back (see per_draw_command::indices_staged()),
+       in which case they are written with regular stores.
+     */
+    bool m_indices_read_back;
+  };
+
+  /* where in the PainterRetainedGeometryStore the
+     indices of an index chunk are.
+   */
+  class RetainedChunk
+  {
+  public:
+    unsigned int m_index_offset;
+    int m_base_vertex;
   };
 
   class PainterPackerPrivate
@@ -569,6 +1075,11 @@ namespace
             {
               return 0;
             }
+          else if(d->m_painter == m_p && d->m_long_lived
+                  && d->m_persistent_batch == m_persistent_batch)
+            {
+              return 0;
+            }
           else
             {
               return d->m_data.size();
@@ -585,6 +1096,24 @@ namespace
         }
     };
 
+    /* returns true if the index chunk can be drawn from
+       m_retained_geometry_store, uploading its data to the
+       store if necessary.
+     */
+    bool
+    fetch_retained_chunk(const AttributeIndexSrcFromArray &src,
+                         unsigned int chunk, RetainedChunk *out_chunk);
+
+    bool
+    fetch_retained_chunk(const fastuidraw::PainterPacker::DataWriter&,
+                         unsigned int, RetainedChunk*)
+    {
+      return false;
+    }
+
+    void
+    draw_command_list(const fastuidraw::PainterCommandList &list, unsigned int z);
+
     template<typename T>
     void
     draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
@@ -594,6 +1123,13 @@ namespace
                            const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
 
     fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_backend;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterRetainedGeometryStore> m_retained_geometry_store;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterPersistentDataStore> m_persistent_data_store;
+
+    /* incremented each time m_persistent_data_store->end_batch()
+       is called, after which data fetched from it may move.
+     */
+    uint64_t m_persistent_batch;
     fastuidraw::PainterShaderSet m_default_shaders;
     unsigned int m_alignment;
     unsigned int m_header_size;
@@ -606,23 +1142,57 @@ namespace
     std::vector<per_draw_command> m_accumulated_draws;
     fastuidraw::PainterPacker *m_p;
 
+    bool m_deferred_submission;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> m_blend_src, m_blend_clear;
+
     PainterPackerPrivateWorkroom m_work_room;
     fastuidraw::vecN<unsigned int, fastuidraw::PainterPacker::num_stats> m_stats;
   };
 }
 
 
+//////////////////////////////////////////
+// deferred_header_sorter methods
+bool
+deferred_header_sorter::
+operator()(unsigned int lhs, unsigned int rhs) const
+{
+  const PainterShaderGroupPrivate &L(m_headers[lhs].m_state);
+  const PainterShaderGroupPrivate &R(m_headers[rhs].m_state);
+
+  if(L.m_item_group != R.m_item_group)
+    {
+      return L.m_item_group < R.m_item_group;
+    }
+
+  if(L.m_blend_group != R.m_blend_group)
+    {
+      return L.m_blend_group < R.m_blend_group;
+    }
+
+  if(L.m_blend_mode != R.m_blend_mode)
+    {
+      return L.m_blend_mode < R.m_blend_mode;
+    }
+
+  return (m_brush_shader_mask & L.m_brush) < (m_brush_shader_mask & R.m_brush);
+}
+
 //////////////////////////////////////////
 // per_draw_command methods
 per_draw_command::
 per_draw_command(const fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> &r,
-                 const fastuidraw::PainterBackend::ConfigurationBase &config):
+                 const fastuidraw::PainterBackend::ConfigurationBase &config,
+                 bool deferred):
   m_draw_command(r),
   m_attributes_written(0),
   m_indices_written(0),
+  m_draw_breaks(0),
+  m_have_header_attributes(!r->m_header_attributes.empty()),
   m_store_blocks_written(0),
   m_alignment(config.alignment()),
-  m_brush_shader_mask(config.brush_shader_mask())
+  m_brush_shader_mask(config.brush_shader_mask()),
+  m_deferred(deferred)
 {
   m_prev_state.m_item_group = 0;
   m_prev_state.m_brush = 0;
@@ -644,109 +1214,502 @@ allocate_store(unsigned int num_elements)
 
 void
 per_draw_command::
-pack_state_data(PainterPackerPrivate *p,
-                EntryBase *d, uint32_t &location)
+pack_state_data(PainterPackerPrivate *p,
+                EntryBase *d, uint32_t &location)
+{
+  if(d->m_painter == p->m_p && d->m_begin_id == p->m_number_begins
+     && d->m_draw_command_id == p->m_accumulated_draws.size())
+    {
+      location = d->m_offset;
+      return;
+    }
+
+  /* long lived data is referenced from the persistent data
+     store; the location fetched is valid until the store's
+     end_batch() is called.
+   */
+  if(d->m_long_lived && p->m_persistent_data_store)
+    {
+      if(d->m_painter != p->m_p || d->m_persistent_batch != p->m_persistent_batch)
+        {
+          if(p->m_persistent_data_store->fetch(d->m_unique_id,
+                                               fastuidraw::make_c_array(d->m_data),
+                                               &d->m_persistent_location))
+            {
+              d->m_painter = p->m_p;
+              d->m_persistent_batch = p->m_persistent_batch;
+              d->m_begin_id = -1;
+            }
+        }
+
+      if(d->m_painter == p->m_p && d->m_persistent_batch == p->m_persistent_batch)
+        {
+          location = d->m_persistent_location;
+          ++p->m_stats[fastuidraw::PainterPacker::num_persistent_data_references];
+          return;
+        }
+    }
+
+  /* data not in current data store add
+     it to the current store.
+   */
+  fastuidraw::const_c_array<fastuidraw::generic_data> src;
+  fastuidraw::c_array<fastuidraw::generic_data> dst;
+
+  location = current_block();
+  src = fastuidraw::make_c_array(d->m_data);
+  dst = allocate_store(src.size());
+  std::copy(src.begin(), src.end(), dst.begin());
+
+  d->m_painter = p->m_p;
+  d->m_begin_id = p->m_number_begins;
+  d->m_draw_command_id = p->m_accumulated_draws.size();
+  d->m_offset = location;
+  d->m_persistent_batch = 0;
+}
+
+void
+per_draw_command::
+pack_painter_state(const fastuidraw::PainterPackerData &state,
+                   PainterPackerPrivate *p, painter_state_location &out_data)
+{
+  pack_state_data(p, state.m_clip, out_data.m_clipping_data_loc);
+  pack_state_data(p, state.m_matrix, out_data.m_item_matrix_data_loc);
+  pack_state_data(p, state.m_item_shader_data, out_data.m_item_shader_data_loc);
+  pack_state_data(p, state.m_blend_shader_data, out_data.m_blend_shader_data_loc);
+  pack_state_data(p, state.m_brush, out_data.m_brush_shader_data_loc);
+}
+
+unsigned int
+per_draw_command::
+pack_header(unsigned int header_size,
+            uint32_t brush_shader,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
+            uint64_t blend_mode,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
+            unsigned int z,
+            const painter_state_location &loc,
+            const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back,
+            enum deferred_class_t deferred_class)
+{
+  unsigned int return_value;
+  fastuidraw::c_array<fastuidraw::generic_data> dst;
+  fastuidraw::PainterHeader header;
+
+  return_value = current_block();
+  dst = allocate_store(header_size);
+
+  if(call_back)
+    {
+      call_back->current_draw(m_draw_command);
+    }
+
+  PainterShaderGroupPrivate current;
+  fastuidraw::PainterShader::Tag blend;
+
+  if(blend_shader)
+    {
+      blend = blend_shader->tag();
+    }
+  current.m_item_group = item_shader->group();
+  current.m_brush = brush_shader;
+  current.m_blend_group = blend.m_group;
+  current.m_blend_mode = blend_mode;
+
+  header.m_clip_equations_location = loc.m_clipping_data_loc;
+  header.m_item_matrix_location = loc.m_item_matrix_data_loc;
+  header.m_brush_shader_data_location = loc.m_brush_shader_data_loc;
+  header.m_item_shader_data_location = loc.m_item_shader_data_loc;
+  header.m_blend_shader_data_location = loc.m_blend_shader_data_loc;
+  header.m_item_shader = item_shader->ID();
+  header.m_brush_shader = current.m_brush;
+  header.m_blend_shader = blend.m_ID;
+  header.m_z = z;
+  header.pack_data(m_alignment, dst);
+
+  if(m_deferred)
+    {
+      deferred_header H;
+
+      H.m_state = current;
+      H.m_header_location = return_value;
+      H.m_z = z;
+      H.m_class = deferred_class;
+      H.m_pieces_begin = H.m_pieces_end = m_pieces.size();
+      m_headers.push_back(H);
+    }
+  else
+    {
+      if(needs_draw_break(current))
+        {
+          trace_draw_break(current);
+          m_draw_command->draw_break(m_prev_state, current,
+                                     m_attributes_written,
+                                     m_indices_written);
+          ++m_draw_breaks;
+        }
+      m_prev_state = current;
+      header_changed(return_value, m_indices_written);
+    }
+
+  if(call_back)
+    {
+      call_back->header_added(header, dst);
+    }
+
+  return return_value;
+}
+
+fastuidraw::c_array<fastuidraw::PainterIndex>
+per_draw_command::
+index_destination(unsigned int count)
+{
+  assert(count <= index_room());
+  if(!m_deferred)
+    {
+      return m_draw_command->m_indices.sub_array(m_indices_written, count);
+    }
+
+  if(m_staged_indices.size() < m_indices_written + count)
+    {
+      m_staged_indices.resize(m_indices_written + count);
+    }
+  return fastuidraw::make_c_array(m_staged_indices).sub_array(m_indices_written, count);
+}
+
+void
+per_draw_command::
+add_indices(unsigned int index_offset, unsigned int index_count)
+{
+  if(!m_deferred)
+    {
+      return;
+    }
+
+  assert(!m_headers.empty());
+  assert(m_headers.back().m_pieces_end == m_pieces.size());
+  if(m_headers.back().m_pieces_begin != m_pieces.size()
+     && !m_pieces.back().m_retained
+     && m_pieces.back().m_index_offset + m_pieces.back().m_index_count == index_offset)
+    {
+      m_pieces.back().m_index_count += index_count;
+    }
+  else
+    {
+      deferred_piece P;
+
+      P.m_retained = false;
+      P.m_index_offset = index_offset;
+      P.m_index_count = index_count;
+      P.m_base_vertex = 0;
+      m_pieces.push_back(P);
+      ++m_headers.back().m_pieces_end;
+    }
+}
+
+void
+per_draw_command::
+draw_retained(unsigned int index_offset, unsigned int index_count,
+              int base_vertex, uint32_t header_location)
+{
+  if(!m_deferred)
+    {
+      m_draw_command->draw_retained(index_offset, index_count,
+                                    base_vertex, header_location,
+                                    m_attributes_written,
+                                    m_indices_written);
+      return;
+    }
+
+  deferred_piece P;
+
+  assert(!m_headers.empty());
+  assert(m_headers.back().m_header_location == header_location);
+  P.m_retained = true;
+  P.m_index_offset = index_offset;
+  P.m_index_count = index_count;
+  P.m_base_vertex = base_vertex;
+  m_pieces.push_back(P);
+  ++m_headers.back().m_pieces_end;
+}
+
+void
+per_draw_command::
+add_state(const PainterShaderGroupPrivate &state,
+          uint32_t header_location, unsigned int z)
+{
+  if(m_deferred)
+    {
+      deferred_header H;
+
+      H.m_state = state;
+      H.m_header_location = header_location;
+      H.m_z = z;
+      H.m_class = deferred_barrier;
+      H.m_pieces_begin = H.m_pieces_end = m_pieces.size();
+      m_headers.push_back(H);
+    }
+  else
+    {
+      if(needs_draw_break(state))
+        {
+          trace_draw_break(state);
+          m_draw_command->draw_break(m_prev_state, state,
+                                     m_attributes_written,
+                                     m_indices_written);
+          ++m_draw_breaks;
+        }
+      m_prev_state = state;
+      header_changed(header_location, m_indices_written);
+    }
+}
+
+void
+per_draw_command::
+add_recorded_draw(const fastuidraw::PainterCommandList::RecordedDraw &draw,
+                  unsigned int z)
 {
-  if(d->m_painter == p->m_p && d->m_begin_id == p->m_number_begins
-     && d->m_draw_command_id == p->m_accumulated_draws.size())
+  unsigned int store_offset, attrib_offset;
+  fastuidraw::c_array<fastuidraw::generic_data> store;
+
+  assert(draw.m_attributes.size() <= attribute_room());
+  assert(draw.m_indices.size() <= index_room());
+  assert(draw.m_store.size() <= store_room());
+  assert(draw.m_store.size() % m_alignment == 0);
+
+  /* copy the data store, rebasing the locations and
+     the z-value of the headers in it.
+   */
+  store_offset = current_block();
+  store = allocate_store(draw.m_store.size());
+  std::copy(draw.m_store.begin(), draw.m_store.end(), store.begin());
+  for(unsigned int i = 0, endi = draw.m_header_locations.size(); i < endi; ++i)
     {
-      location = d->m_offset;
-      return;
+      fastuidraw::c_array<fastuidraw::generic_data> header;
+
+      header = store.sub_array(draw.m_header_locations[i] * m_alignment,
+                               fastuidraw::PainterHeader::header_size);
+      header[fastuidraw::PainterHeader::clip_equations_location_offset].u += store_offset;
+      header[fastuidraw::PainterHeader::item_matrix_location_offset].u += store_offset;
+      header[fastuidraw::PainterHeader::brush_shader_data_location_offset].u += store_offset;
+      header[fastuidraw::PainterHeader::item_shader_data_location_offset].u += store_offset;
+      header[fastuidraw::PainterHeader::blend_shader_data_location_offset].u += store_offset;
+      header[fastuidraw::PainterHeader::z_offset].u += z;
     }
 
-  /* data not in current data store add
-     it to the current store.
+  /* copy the attributes, rebasing the header locations */
+  attrib_offset = m_attributes_written;
+  fastuidraw::bulk_copy::copy(m_draw_command->m_attributes.c_ptr() + attrib_offset,
+                              draw.m_attributes.c_ptr(),
+                              sizeof(fastuidraw::PainterAttribute) * draw.m_attributes.size());
+  if(m_have_header_attributes)
+    {
+      fastuidraw::bulk_copy::copy_add(m_draw_command->m_header_attributes.c_ptr() + attrib_offset,
+                                      draw.m_header_attributes.c_ptr(),
+                                      draw.m_header_attributes.size(), store_offset);
+    }
+  m_attributes_written += draw.m_attributes.size();
+
+  /* copy the indices, rebasing them, with a state change
+     before each run of indices of the recording. Without
+     header attributes, each run of the recording is further
+     split into the runs of indices of the same header.
    */
-  fastuidraw::const_c_array<fastuidraw::generic_data> src;
-  fastuidraw::c_array<fastuidraw::generic_data> dst;
+  for(unsigned int s = 0, ends = draw.m_state_changes.size(); s < ends; ++s)
+    {
+      const fastuidraw::PainterCommandList::StateChange &st(draw.m_state_changes[s]);
+      unsigned int begin, end;
+      PainterShaderGroupPrivate state;
+
+      begin = st.m_indices_written;
+      end = (s + 1 < ends) ?
+        draw.m_state_changes[s + 1].m_indices_written :
+        draw.m_indices.size();
+      if(begin == end)
+        {
+          continue;
+        }
 
-  location = current_block();
-  src = fastuidraw::make_c_array(d->m_data);
-  dst = allocate_store(src.size());
-  std::copy(src.begin(), src.end(), dst.begin());
+      state.m_item_group = st.m_item_group;
+      state.m_blend_group = st.m_blend_group;
+      state.m_brush = st.m_brush;
+      state.m_blend_mode = st.m_blend_mode;
 
-  d->m_painter = p->m_p;
-  d->m_begin_id = p->m_number_begins;
-  d->m_draw_command_id = p->m_accumulated_draws.size();
-  d->m_offset = location;
+      while(begin < end)
+        {
+          unsigned int run_end(end);
+          uint32_t header_location(store_offset);
+
+          if(!m_have_header_attributes)
+            {
+              header_location = draw.m_header_attributes[draw.m_indices[begin]];
+              for(run_end = begin + 1;
+                  run_end < end && draw.m_header_attributes[draw.m_indices[run_end]] == header_location;
+                  ++run_end)
+                {}
+              header_location += store_offset;
+            }
+          add_state(state, header_location, z);
+
+          if(indices_staged())
+            {
+              fastuidraw::bulk_copy::copy_add_cached(index_destination(run_end - begin).c_ptr(),
+                                                     draw.m_indices.c_ptr() + begin,
+                                                     run_end - begin, attrib_offset);
+            }
+          else
+            {
+              fastuidraw::bulk_copy::copy_add(index_destination(run_end - begin).c_ptr(),
+                                              draw.m_indices.c_ptr() + begin,
+                                              run_end - begin, attrib_offset);
+            }
+          add_indices(m_indices_written, run_end - begin);
+          m_indices_written += run_end - begin;
+          begin = run_end;
+        }
+    }
 }
 
 void
 per_draw_command::
-pack_painter_state(const fastuidraw::PainterPackerData &state,
-                   PainterPackerPrivate *p, painter_state_location &out_data)
+order_deferred_segment(unsigned int begin, unsigned int end,
+                       std::vector<unsigned int> &order)
 {
-  pack_state_data(p, state.m_clip, out_data.m_clipping_data_loc);
-  pack_state_data(p, state.m_matrix, out_data.m_item_matrix_data_loc);
-  pack_state_data(p, state.m_item_shader_data, out_data.m_item_shader_data_loc);
-  pack_state_data(p, state.m_blend_shader_data, out_data.m_blend_shader_data_loc);
-  pack_state_data(p, state.m_brush, out_data.m_brush_shader_data_loc);
+  unsigned int opaque_begin(order.size());
+
+  for(unsigned int i = begin; i < end; ++i)
+    {
+      if(m_headers[i].m_class == deferred_opaque)
+        {
+          order.push_back(i);
+        }
+    }
+  std::stable_sort(order.begin() + opaque_begin, order.end(),
+                   deferred_header_sorter(m_headers, m_brush_shader_mask));
+
+  for(unsigned int i = begin; i < end; ++i)
+    {
+      if(m_headers[i].m_class != deferred_opaque)
+        {
+          order.push_back(i);
+        }
+    }
 }
 
-unsigned int
+void
 per_draw_command::
-pack_header(unsigned int header_size,
-            uint32_t brush_shader,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterBlendShader> &blend_shader,
-            uint64_t blend_mode,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &item_shader,
-            unsigned int z,
-            const painter_state_location &loc,
-            const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
+submit_deferred(void)
 {
-  unsigned int return_value;
-  fastuidraw::c_array<fastuidraw::generic_data> dst;
-  fastuidraw::PainterHeader header;
-
-  return_value = current_block();
-  dst = allocate_store(header_size);
+  /* Painter gives each item its own range of z-values,
+     increasing with the order in which items are drawn,
+     and depth testing makes the item of the largest z
+     win. Thus an opaque item can be drawn before the
+     items that precede it if they have lower z, and the
+     order among opaque items does not matter. The headers
+     are split into segments within which every opaque
+     item has a z larger than the items that precede it;
+     a segment is drawn as its opaque items sorted by
+     state followed by its other items in order.
+   */
+  std::vector<unsigned int> order;
+  std::set<unsigned int> opaque_zs;
+  unsigned int segment_begin(0), max_z(0);
+  bool have_non_opaque(false);
 
-  if(call_back)
+  order.reserve(m_headers.size());
+  for(unsigned int i = 0, endi = m_headers.size(); i < endi; ++i)
     {
-      call_back->current_draw(m_draw_command);
-    }
+      const deferred_header &H(m_headers[i]);
+      bool end_segment;
 
-  PainterShaderGroupPrivate current;
-  fastuidraw::PainterShader::Tag blend;
+      switch(H.m_class)
+        {
+        case deferred_opaque:
+          end_segment = (have_non_opaque && H.m_z <= max_z)
+            || opaque_zs.find(H.m_z) != opaque_zs.end();
+          break;
 
-  if(blend_shader)
-    {
-      blend = blend_shader->tag();
-    }
-  current.m_item_group = item_shader->group();
-  current.m_brush = brush_shader;
-  current.m_blend_group = blend.m_group;
-  current.m_blend_mode = blend_mode;
+        case deferred_barrier:
+          end_segment = true;
+          break;
 
-  header.m_clip_equations_location = loc.m_clipping_data_loc;
-  header.m_item_matrix_location = loc.m_item_matrix_data_loc;
-  header.m_brush_shader_data_location = loc.m_brush_shader_data_loc;
-  header.m_item_shader_data_location = loc.m_item_shader_data_loc;
-  header.m_blend_shader_data_location = loc.m_blend_shader_data_loc;
-  header.m_item_shader = item_shader->ID();
-  header.m_brush_shader = current.m_brush;
-  header.m_blend_shader = blend.m_ID;
-  header.m_z = z;
-  header.pack_data(m_alignment, dst);
+        default:
+          end_segment = false;
+        }
 
-  if(current.m_item_group != m_prev_state.m_item_group
-     || current.m_blend_group != m_prev_state.m_blend_group
-     || (m_brush_shader_mask & (current.m_brush ^ m_prev_state.m_brush)) != 0u
-     || current.m_blend_mode != m_prev_state.m_blend_mode)
-    {
-      m_draw_command->draw_break(m_prev_state, current,
-                                 m_attributes_written,
-                                 m_indices_written);
+      if(end_segment)
+        {
+          order_deferred_segment(segment_begin, i, order);
+          segment_begin = i;
+          opaque_zs.clear();
+          have_non_opaque = false;
+        }
+
+      if(H.m_class == deferred_opaque)
+        {
+          opaque_zs.insert(H.m_z);
+        }
+      else
+        {
+          max_z = (have_non_opaque) ? std::max(max_z, H.m_z) : H.m_z;
+          have_non_opaque = true;
+        }
+
+      if(H.m_class == deferred_barrier)
+        {
+          order_deferred_segment(segment_begin, i + 1, order);
+          segment_begin = i + 1;
+          have_non_opaque = false;
+        }
     }
+  order_deferred_segment(segment_begin, m_headers.size(), order);
+  assert(order.size() == m_headers.size());
 
-  m_prev_state = current;
+  /* write the staged indices to the PainterDraw in the new
+     order and send the draw breaks and retained draws at the
+     new index locations.
+   */
+  unsigned int indices_written(0);
 
-  if(call_back)
+  for(unsigned int i = 0, endi = order.size(); i < endi; ++i)
     {
-      call_back->header_added(header, dst);
+      const deferred_header &H(m_headers[order[i]]);
+
+      if(needs_draw_break(H.m_state))
+        {
+          trace_draw_break(H.m_state);
+          m_draw_command->draw_break(m_prev_state, H.m_state,
+                                     m_attributes_written,
+                                     indices_written);
+          ++m_draw_breaks;
+        }
+      m_prev_state = H.m_state;
+      header_changed(H.m_header_location, indices_written);
+
+      for(unsigned int p = H.m_pieces_begin; p < H.m_pieces_end; ++p)
+        {
+          const deferred_piece &P(m_pieces[p]);
+          if(P.m_retained)
+            {
+              m_draw_command->draw_retained(P.m_index_offset, P.m_index_count,
+                                            P.m_base_vertex, H.m_header_location,
+                                            m_attributes_written,
+                                            indices_written);
+            }
+          else
+            {
+              fastuidraw::bulk_copy::copy(m_draw_command->m_indices.c_ptr() + indices_written,
+                                          m_staged_indices.data() + P.m_index_offset,
+                                          sizeof(fastuidraw::PainterIndex) * P.m_index_count);
+              indices_written += P.m_index_count;
+            }
+        }
     }
+  assert(indices_written == m_indices_written);
 
-  return return_value;
+  m_headers.clear();
+  m_pieces.clear();
+  std::vector<fastuidraw::PainterIndex>().swap(m_staged_indices);
 }
 
 ///////////////////////////////////////////
@@ -755,7 +1718,8 @@ PainterPackerPrivate::
 PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend,
                      fastuidraw::PainterPacker *p):
   m_backend(backend),
-  m_p(p)
+  m_p(p),
+  m_deferred_submission(false)
 {
   m_alignment = m_backend->configuration_base().alignment();
   m_header_size = fastuidraw::PainterHeader::data_size(m_alignment);
@@ -765,7 +1729,17 @@ PainterPackerPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBacken
   // we skip the check in PainterBackend::default_shaders() to register
   // the shaders as well.
   m_default_shaders = m_backend->default_shaders();
+  m_retained_geometry_store = m_backend->retained_geometry_store();
+  m_persistent_data_store = m_backend->persistent_data_store();
+  m_persistent_batch = 1;
   m_number_begins = 0;
+
+  /* the blend shaders whose output does not depend on
+     the framebuffer; items drawn with them can be
+     reordered in deferred submission mode.
+   */
+  m_blend_src = m_default_shaders.blend_shaders().shader(fastuidraw::PainterEnums::blend_porter_duff_src);
+  m_blend_clear = m_default_shaders.blend_shaders().shader(fastuidraw::PainterEnums::blend_porter_duff_clear);
 }
 
 void
@@ -782,11 +1756,16 @@ start_new_command(void)
       m_stats[fastuidraw::PainterPacker::num_draws] += 1u;
 
       c.unmap();
+      m_stats[fastuidraw::PainterPacker::num_draw_breaks] += c.m_draw_breaks;
     }
 
   fastuidraw::reference_counted_ptr<const fastuidraw::PainterDraw> r;
-  r = m_backend->map_draw();
-  m_accumulated_draws.push_back(per_draw_command(r, m_backend->configuration_base()));
+  {
+    FASTUIDRAWtrace_zone("PainterBackend::map_draw");
+    r = m_backend->map_draw();
+  }
+  m_accumulated_draws.push_back(per_draw_command(r, m_backend->configuration_base(),
+                                                 m_deferred_submission));
 }
 
 unsigned int
@@ -817,6 +1796,92 @@ upload_draw_state(const fastuidraw::PainterPackerData &draw_state)
   m_accumulated_draws.back().pack_painter_state(draw_state, this, m_painter_state_location);
 }
 
+bool
+PainterPackerPrivate::
+fetch_retained_chunk(const AttributeIndexSrcFromArray &src,
+                     unsigned int chunk, RetainedChunk *out_chunk)
+{
+  const fastuidraw::PainterAttributeData *data;
+
+  if(!m_retained_geometry_store || src.m_index_chunk_sources.empty())
+    {
+      return false;
+    }
+
+  data = src.m_index_chunk_sources[chunk];
+  if(data == nullptr)
+    {
+      return false;
+    }
+
+  fastuidraw::const_c_array<fastuidraw::PainterAttribute> attribs, all_attribs;
+  fastuidraw::const_c_array<fastuidraw::PainterIndex> indices, all_indices;
+
+  attribs = src.m_attrib_chunks[src.attribute_chunk_selection(chunk)];
+  indices = src.m_index_chunks[chunk];
+  all_attribs = data->attribute_data();
+  all_indices = data->index_data();
+
+  /* the chunks must be sub-arrays of the data of the
+     PainterAttributeData for the data in the store to
+     be the data of the chunks.
+   */
+  if(attribs.c_ptr() < all_attribs.c_ptr()
+     || attribs.c_ptr() + attribs.size() > all_attribs.c_ptr() + all_attribs.size()
+     || indices.c_ptr() < all_indices.c_ptr()
+     || indices.c_ptr() + indices.size() > all_indices.c_ptr() + all_indices.size())
+    {
+      assert(!"Chunks passed to draw_generic() do not come from the PainterAttributeData claimed");
+      return false;
+    }
+
+  fastuidraw::PainterRetainedGeometryStore::Region region;
+  if(!m_retained_geometry_store->fetch(*data, &region))
+    {
+      return false;
+    }
+
+  out_chunk->m_index_offset = region.m_index_offset + (indices.c_ptr() - all_indices.c_ptr());
+  out_chunk->m_base_vertex = region.m_attribute_offset + (attribs.c_ptr() - all_attribs.c_ptr())
+    + src.m_index_adjusts[chunk];
+  return true;
+}
+
+void
+PainterPackerPrivate::
+draw_command_list(const fastuidraw::PainterCommandList &list, unsigned int z)
+{
+  assert(list.target() == m_backend);
+  for(unsigned int i = 0, endi = list.number_draws(); i < endi; ++i)
+    {
+      const fastuidraw::PainterCommandList::RecordedDraw &draw(list.recorded_draw(i));
+
+      if(draw.m_indices.empty())
+        {
+          continue;
+        }
+
+      if(draw.m_attributes.size() > m_accumulated_draws.back().attribute_room()
+         || draw.m_indices.size() > m_accumulated_draws.back().index_room()
+         || draw.m_store.size() > m_accumulated_draws.back().store_room())
+        {
+          start_new_command();
+        }
+
+      per_draw_command &cmd(m_accumulated_draws.back());
+      if(draw.m_attributes.size() > cmd.attribute_room()
+         || draw.m_indices.size() > cmd.index_room()
+         || draw.m_store.size() > cmd.store_room())
+        {
+          assert(!"Unable to fit recorded draw into freshly allocated draw command, not good!");
+          continue;
+        }
+
+      cmd.add_recorded_draw(draw, z);
+      m_stats[fastuidraw::PainterPacker::num_headers] += draw.m_header_locations.size();
+    }
+}
+
 template<typename T>
 void
 PainterPackerPrivate::
@@ -849,11 +1914,30 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
   upload_draw_state(draw);
   allocate_header = true;
 
+  /* an item whose header z can be modified by a DataCallBack
+     cannot be moved in deferred submission mode.
+   */
+  enum deferred_class_t deferred_class;
+  if(call_back)
+    {
+      deferred_class = deferred_barrier;
+    }
+  else if(m_blend_shader == m_blend_src || m_blend_shader == m_blend_clear)
+    {
+      deferred_class = deferred_opaque;
+    }
+  else
+    {
+      deferred_class = deferred_translucent;
+    }
+
   for(unsigned chunk = 0; chunk < number_index_chunks; ++chunk)
     {
       unsigned int attrib_room, index_room, data_room;
-      unsigned int attrib_src, needed_attrib_room;
+      unsigned int attrib_src, needed_attrib_room, needed_index_room;
       unsigned int num_attribs, num_indices;
+      RetainedChunk retained;
+      bool is_retained;
 
       attrib_room = m_accumulated_draws.back().attribute_room();
       index_room = m_accumulated_draws.back().index_room();
@@ -869,10 +1953,15 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
           continue;
         }
 
-      needed_attrib_room = (m_work_room.m_attribs_loaded[attrib_src] == NOT_LOADED) ?
+      /* a chunk drawn from the retained geometry store
+         only needs room for the header.
+       */
+      is_retained = fetch_retained_chunk(src, chunk, &retained);
+      needed_attrib_room = (!is_retained && m_work_room.m_attribs_loaded[attrib_src] == NOT_LOADED) ?
         num_attribs : 0;
+      needed_index_room = (is_retained) ? 0 : num_indices;
 
-      if(attrib_room < needed_attrib_room || index_room < num_indices
+      if(attrib_room < needed_attrib_room || index_room < needed_index_room
          || (allocate_header && data_room < m_header_size))
         {
           start_new_command();
@@ -881,14 +1970,14 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
           /* reset attribs_loaded[] and recompute needed_attrib_room
            */
           std::fill(m_work_room.m_attribs_loaded.begin(), m_work_room.m_attribs_loaded.end(), NOT_LOADED);
-          needed_attrib_room = num_attribs;
+          needed_attrib_room = (is_retained) ? 0 : num_attribs;
 
           attrib_room = m_accumulated_draws.back().attribute_room();
           index_room = m_accumulated_draws.back().index_room();
           data_room = m_accumulated_draws.back().store_room();
           allocate_header = true;
 
-          if(attrib_room < needed_attrib_room || index_room < num_indices)
+          if(attrib_room < needed_attrib_room || index_room < needed_index_room)
             {
               assert(!"Unable to fit chunk into freshly allocated draw command, not good!");
               continue;
@@ -908,7 +1997,15 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
                                        m_blend_mode,
                                        shader,
                                        z, m_painter_state_location,
-                                       call_back);
+                                       call_back, deferred_class);
+        }
+
+      if(is_retained)
+        {
+          cmd.draw_retained(retained.m_index_offset, num_indices,
+                            retained.m_base_vertex, header_loc);
+          m_stats[fastuidraw::PainterPacker::num_retained_indices] += num_indices;
+          continue;
         }
 
       /* copy attribute data and get offset into attribute buffer
@@ -922,10 +2019,12 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
           fastuidraw::c_array<uint32_t> header_dst_ptr;
 
           attrib_dst_ptr = cmd.m_draw_command->m_attributes.sub_array(cmd.m_attributes_written, num_attribs);
-          header_dst_ptr = cmd.m_draw_command->m_header_attributes.sub_array(cmd.m_attributes_written, num_attribs);
-
           src.write_attributes(attrib_dst_ptr, attrib_src);
-          std::fill(header_dst_ptr.begin(), header_dst_ptr.end(), header_loc);
+          if(cmd.m_have_header_attributes)
+            {
+              header_dst_ptr = cmd.m_draw_command->m_header_attributes.sub_array(cmd.m_attributes_written, num_attribs);
+              fastuidraw::bulk_copy::fill(header_dst_ptr.c_ptr(), header_dst_ptr.size(), header_loc);
+            }
 
           assert(m_work_room.m_attribs_loaded[attrib_src] == NOT_LOADED);
           m_work_room.m_attribs_loaded[attrib_src] = cmd.m_attributes_written;
@@ -943,8 +2042,9 @@ draw_generic_implement(const fastuidraw::reference_counted_ptr<fastuidraw::Paint
        */
       fastuidraw::c_array<fastuidraw::PainterIndex> index_dst_ptr;
 
-      index_dst_ptr = cmd.m_draw_command->m_indices.sub_array(cmd.m_indices_written, num_indices);
+      index_dst_ptr = cmd.index_destination(num_indices);
       src.write_indices(index_dst_ptr, attrib_offset, chunk);
+      cmd.add_indices(cmd.m_indices_written, index_dst_ptr.size());
       cmd.m_indices_written += index_dst_ptr.size();
     }
 }
@@ -1015,6 +2115,7 @@ begin(void)
   assert(d->m_accumulated_draws.empty());
   d->m_backend->image_atlas()->delay_tile_freeing();
   d->m_backend->colorstop_atlas()->delay_interval_freeing();
+  d->m_backend->glyph_atlas()->begin_frame();
   std::fill(d->m_stats.begin(), d->m_stats.end(), 0u);
   d->start_new_command();
   ++d->m_number_begins;
@@ -1034,14 +2135,28 @@ query_stat(enum stats_t st) const
       tmp[num_attributes] = c.m_attributes_written;
       tmp[num_indices] = c.m_indices_written;
       tmp[num_generic_datas] = c.store_written();
+      tmp[num_draw_breaks] = c.m_draw_breaks;
     }
   return d->m_stats[st] + tmp[st];
 }
 
+void
+fastuidraw::PainterPacker::
+increment_stat(enum stats_t st, unsigned int amount)
+{
+  PainterPackerPrivate *d;
+  d = static_cast<PainterPackerPrivate*>(m_d);
+
+  assert(st < num_stats);
+  d->m_stats[st] += amount;
+}
+
 void
 fastuidraw::PainterPacker::
 flush(void)
 {
+  FASTUIDRAWtrace_zone("PainterPacker::flush");
+
   PainterPackerPrivate *d;
   d = static_cast<PainterPackerPrivate*>(m_d);
   if(!d->m_accumulated_draws.empty())
@@ -1054,17 +2169,39 @@ flush(void)
       d->m_stats[fastuidraw::PainterPacker::num_draws] += 1u;
 
       c.unmap();
+      d->m_stats[fastuidraw::PainterPacker::num_draw_breaks] += c.m_draw_breaks;
+    }
+
+  {
+    FASTUIDRAWtrace_zone("PainterPacker::flush::draw");
+    d->m_backend->on_pre_draw();
+    for(std::vector<per_draw_command>::iterator iter = d->m_accumulated_draws.begin(),
+          end = d->m_accumulated_draws.end(); iter != end; ++iter)
+      {
+        assert(iter->m_draw_command->unmapped());
+        iter->m_draw_command->draw();
+      }
+    d->m_backend->on_post_draw();
+  }
+  d->m_accumulated_draws.clear();
+
+  /* the draws that use the data fetched from the retained
+     geometry store have been sent, so that data may now
+     be evicted.
+   */
+  if(d->m_retained_geometry_store)
+    {
+      d->m_retained_geometry_store->end_batch();
     }
 
-  d->m_backend->on_pre_draw();
-  for(std::vector<per_draw_command>::iterator iter = d->m_accumulated_draws.begin(),
-        end = d->m_accumulated_draws.end(); iter != end; ++iter)
+  /* likewise for the persistent data store, after which
+     the locations of the data fetched from it may change.
+   */
+  if(d->m_persistent_data_store)
     {
-      assert(iter->m_draw_command->unmapped());
-      iter->m_draw_command->draw();
+      d->m_persistent_data_store->end_batch();
+      ++d->m_persistent_batch;
     }
-  d->m_backend->on_post_draw();
-  d->m_accumulated_draws.clear();
 }
 
 void
@@ -1074,6 +2211,8 @@ end(void)
   flush();
   image_atlas()->undelay_tile_freeing();
   colorstop_atlas()->undelay_interval_freeing();
+  glyph_atlas()->end_frame();
+  glyph_atlas()->compact_geometry_data();
 }
 
 void
@@ -1106,6 +2245,28 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
   d = static_cast<PainterPackerPrivate*>(m_d);
 
   AttributeIndexSrcFromArray src(attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector);
+  src.m_indices_read_back = d->m_deferred_submission;
+  d->draw_generic_implement(shader, draw, src, z, call_back);
+}
+
+void
+fastuidraw::PainterPacker::
+draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
+             const PainterPackerData &draw,
+             const_c_array<const_c_array<PainterAttribute> > attrib_chunks,
+             const_c_array<const_c_array<PainterIndex> > index_chunks,
+             const_c_array<int> index_adjusts,
+             const_c_array<unsigned int> attrib_chunk_selector,
+             const_c_array<const PainterAttributeData*> index_chunk_sources,
+             unsigned int z,
+             const reference_counted_ptr<DataCallBack> &call_back)
+{
+  PainterPackerPrivate *d;
+  d = static_cast<PainterPackerPrivate*>(m_d);
+
+  AttributeIndexSrcFromArray src(attrib_chunks, index_chunks, index_adjusts,
+                                 attrib_chunk_selector, index_chunk_sources);
+  src.m_indices_read_back = d->m_deferred_submission;
   d->draw_generic_implement(shader, draw, src, z, call_back);
 }
 
@@ -1122,6 +2283,15 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader,
   d->draw_generic_implement(shader, data, src, z, call_back);
 }
 
+void
+fastuidraw::PainterPacker::
+draw_command_list(const PainterCommandList &list, unsigned int z)
+{
+  PainterPackerPrivate *d;
+  d = static_cast<PainterPackerPrivate*>(m_d);
+  d->draw_command_list(list, z);
+}
+
 const fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas>&
 fastuidraw::PainterPacker::
 glyph_atlas(void) const
@@ -1179,6 +2349,24 @@ blend_shader(const fastuidraw::reference_counted_ptr<PainterBlendShader> &h,
   d->m_blend_mode = pblend_mode;
 }
 
+void
+fastuidraw::PainterPacker::
+deferred_submission(bool v)
+{
+  PainterPackerPrivate *d;
+  d = static_cast<PainterPackerPrivate*>(m_d);
+  d->m_deferred_submission = v;
+}
+
+bool
+fastuidraw::PainterPacker::
+deferred_submission(void) const
+{
+  PainterPackerPrivate *d;
+  d = static_cast<PainterPackerPrivate*>(m_d);
+  return d->m_deferred_submission;
+}
+
 const fastuidraw::PainterShaderSet&
 fastuidraw::PainterPacker::
 default_shaders(void) const
@@ -1347,6 +2535,15 @@ alignment_packing(void) const
   return (d != nullptr) ? d->m_alignment : 0;
 }
 
+bool
+fastuidraw::PainterPackedValueBase::
+long_lived(void) const
+{
+  EntryBase *d;
+  d = static_cast<EntryBase*>(m_d);
+  return d != nullptr && d->m_long_lived;
+}
+
 const void*
 fastuidraw::PainterPackedValueBase::
 raw_value(void) const
@@ -1377,60 +2574,65 @@ fastuidraw::PainterPackedValuePool::
 
 fastuidraw::PainterPackedValue<fastuidraw::PainterBrush>
 fastuidraw::PainterPackedValuePool::
-create_packed_value(const PainterBrush &value)
+create_packed_value(const PainterBrush &value, bool long_lived)
 {
   PainterPackedValuePoolPrivate *d;
   Entry<PainterBrush> *e;
 
   d = static_cast<PainterPackedValuePoolPrivate*>(m_d);
   e = d->m_brush_pool.allocate(value, d->m_alignment);
+  e->set_long_lived(long_lived);
   return fastuidraw::PainterPackedValue<PainterBrush>(e);
 }
 
 fastuidraw::PainterPackedValue<fastuidraw::PainterClipEquations>
 fastuidraw::PainterPackedValuePool::
-create_packed_value(const PainterClipEquations &value)
+create_packed_value(const PainterClipEquations &value, bool long_lived)
 {
   PainterPackedValuePoolPrivate *d;
   Entry<PainterClipEquations> *e;
 
   d = static_cast<PainterPackedValuePoolPrivate*>(m_d);
   e = d->m_clip_equations_pool.allocate(value, d->m_alignment);
+  e->set_long_lived(long_lived);
   return fastuidraw::PainterPackedValue<PainterClipEquations>(e);
 }
 
 fastuidraw::PainterPackedValue<fastuidraw::PainterItemMatrix>
 fastuidraw::PainterPackedValuePool::
-create_packed_value(const PainterItemMatrix &value)
+create_packed_value(const PainterItemMatrix &value, bool long_lived)
 {
   PainterPackedValuePoolPrivate *d;
   Entry<PainterItemMatrix> *e;
 
   d = static_cast<PainterPackedValuePoolPrivate*>(m_d);
   e = d->m_item_matrix_pool.allocate(value, d->m_alignment);
+  e->set_long_lived(long_lived);
   return fastuidraw::PainterPackedValue<PainterItemMatrix>(e);
 }
 
 fastuidraw::PainterPackedValue<fastuidraw::PainterItemShaderData>
 fastuidraw::PainterPackedValuePool::
-create_packed_value(const PainterItemShaderData &value)
+create_packed_value(const PainterItemShaderData &value, bool long_lived)
 {
   PainterPackedValuePoolPrivate *d;
   Entry<PainterItemShaderData> *e;
 
   d = static_cast<PainterPackedValuePoolPrivate*>(m_d);
   e = d->m_item_shader_data_pool.allocate(value, d->m_alignment);
+  e->set_long_lived(long_lived);
   return fastuidraw::PainterPackedValue<PainterItemShaderData>(e);
 }
 
 fastuidraw::PainterPackedValue<fastuidraw::PainterBlendShaderData>
 fastuidraw::PainterPackedValuePool::
-create_packed_value(const PainterBlendShaderData &value)
+create_packed_value(const PainterBlendShaderData &value, bool long_lived)
 {
   PainterPackedValuePoolPrivate *d;
   Entry<PainterBlendShaderData> *e;
 
   d = static_cast<PainterPackedValuePoolPrivate*>(m_d);
   e = d->m_blend_shader_data_pool.allocate(value, d->m_alignment);
+  e->set_long_lived(long_lived);
   return fastuidraw::PainterPackedValue<PainterBlendShaderData>(e);
 }
@@ -0,0 +1,407 @@
+/*!
+ * \file painter_persistent_data_store.cpp
+ * \brief file painter_persistent_data_store.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <map>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <fastuidraw/painter/packing/painter_persistent_data_store.hpp>
+#include "../../private/interval_allocator.hpp"
+
+namespace
+{
+  class Entry
+  {
+  public:
+    unsigned int m_location, m_number_blocks;
+    uint64_t m_batch;
+    std::list<uint64_t>::iterator m_lru_location;
+  };
+
+  class EntrySorter
+  {
+  public:
+    bool
+    operator()(const Entry *lhs, const Entry *rhs) const
+    {
+      return lhs->m_location < rhs->m_location;
+    }
+  };
+
+  class PainterPersistentDataStorePrivate
+  {
+  public:
+    PainterPersistentDataStorePrivate(unsigned int number_blocks,
+                                      unsigned int alignment):
+      m_number_blocks(number_blocks),
+      m_alignment(alignment),
+      m_allocator(number_blocks),
+      m_shadow(number_blocks * alignment),
+      m_batch(0),
+      m_batch_has_fetches(false),
+      m_compact_at_end_batch(false),
+      m_number_blocks_resident(0),
+      m_stats(0)
+    {}
+
+    /* allocate room for an entry, evicting the least
+       recently used entries not used in the current batch
+       as needed; returns false on failure or if compacting
+       would make room.
+     */
+    bool
+    allocate(Entry &entry);
+
+    void
+    evict(std::map<uint64_t, Entry>::iterator iter);
+
+    /* move all resident entries to the start of the store,
+       returning the data to upload (in one call) to the start
+       of the store. Must only be called when no entry is used
+       in the current batch.
+     */
+    fastuidraw::const_c_array<fastuidraw::generic_data>
+    compact(void);
+
+    unsigned int m_number_blocks, m_alignment;
+    fastuidraw::interval_allocator m_allocator;
+
+    /* copy of the data of the store, used to re-upload
+       data when compacting.
+     */
+    std::vector<fastuidraw::generic_data> m_shadow;
+
+    /* keyed by the key passed to fetch() */
+    std::map<uint64_t, Entry> m_entries;
+
+    /* keys ordered from least to most recently used. */
+    std::list<uint64_t> m_lru;
+
+    uint64_t m_batch;
+    bool m_batch_has_fetches, m_compact_at_end_batch;
+    unsigned int m_number_blocks_resident;
+    fastuidraw::vecN<uint64_t, fastuidraw::PainterPersistentDataStore::num_stats> m_stats;
+    std::vector<Entry*> m_work_room;
+  };
+}
+
+///////////////////////////////////////////////
+// PainterPersistentDataStorePrivate methods
+void
+PainterPersistentDataStorePrivate::
+evict(std::map<uint64_t, Entry>::iterator iter)
+{
+  Entry &entry(iter->second);
+
+  m_allocator.free_interval(entry.m_location, entry.m_number_blocks);
+  m_number_blocks_resident -= entry.m_number_blocks;
+  m_lru.erase(entry.m_lru_location);
+  m_entries.erase(iter);
+}
+
+fastuidraw::const_c_array<fastuidraw::generic_data>
+PainterPersistentDataStorePrivate::
+compact(void)
+{
+  unsigned int cursor(0);
+
+  assert(!m_batch_has_fetches);
+
+  m_work_room.clear();
+  for(std::map<uint64_t, Entry>::iterator iter = m_entries.begin(),
+        end = m_entries.end(); iter != end; ++iter)
+    {
+      m_work_room.push_back(&iter->second);
+    }
+
+  /* moving the entries in order of location means an
+     entry is only ever moved down over room that is
+     free or that was already moved.
+   */
+  std::sort(m_work_room.begin(), m_work_room.end(), EntrySorter());
+  for(unsigned int i = 0, endi = m_work_room.size(); i < endi; ++i)
+    {
+      Entry *entry(m_work_room[i]);
+
+      assert(entry->m_location >= cursor);
+      if(entry->m_location != cursor)
+        {
+          std::copy(m_shadow.begin() + entry->m_location * m_alignment,
+                    m_shadow.begin() + (entry->m_location + entry->m_number_blocks) * m_alignment,
+                    m_shadow.begin() + cursor * m_alignment);
+          entry->m_location = cursor;
+        }
+      cursor += entry->m_number_blocks;
+    }
+
+  assert(cursor == m_number_blocks_resident);
+  m_allocator.reset(m_number_blocks);
+  ++m_stats[fastuidraw::PainterPersistentDataStore::num_compactions];
+  m_stats[fastuidraw::PainterPersistentDataStore::num_blocks_uploaded] += cursor;
+  m_compact_at_end_batch = false;
+
+  if(cursor == 0)
+    {
+      return fastuidraw::const_c_array<fastuidraw::generic_data>();
+    }
+
+  int loc;
+  loc = m_allocator.allocate_interval(cursor);
+  FASTUIDRAWunused(loc);
+  assert(loc == 0);
+
+  return fastuidraw::const_c_array<fastuidraw::generic_data>(&m_shadow[0], cursor * m_alignment);
+}
+
+bool
+PainterPersistentDataStorePrivate::
+allocate(Entry &entry)
+{
+  if(entry.m_number_blocks > m_number_blocks)
+    {
+      return false;
+    }
+
+  for(;;)
+    {
+      int loc;
+
+      loc = m_allocator.allocate_interval(entry.m_number_blocks);
+      if(loc >= 0)
+        {
+          entry.m_location = loc;
+          return true;
+        }
+
+      /* if there is enough free room but it is fragmented,
+         compact if no entry has been used in the current
+         batch (so that no location handed out can move);
+         otherwise make room by evicting and compact at the
+         end of the batch.
+       */
+      if(m_number_blocks - m_number_blocks_resident >= entry.m_number_blocks)
+        {
+          if(!m_batch_has_fetches)
+            {
+              return false;
+            }
+          m_compact_at_end_batch = true;
+        }
+
+      /* entries used in the current batch are at the back of
+         m_lru, so if the front is used in the current batch,
+         no entry can be evicted.
+       */
+      std::map<uint64_t, Entry>::iterator iter;
+      if(m_lru.empty())
+        {
+          return false;
+        }
+
+      iter = m_entries.find(m_lru.front());
+      assert(iter != m_entries.end());
+      if(iter->second.m_batch == m_batch)
+        {
+          return false;
+        }
+
+      evict(iter);
+      ++m_stats[fastuidraw::PainterPersistentDataStore::num_evictions];
+    }
+}
+
+////////////////////////////////////////////////
+// fastuidraw::PainterPersistentDataStore methods
+fastuidraw::PainterPersistentDataStore::
+PainterPersistentDataStore(unsigned int number_blocks,
+                           unsigned int alignment)
+{
+  assert(alignment > 0);
+  m_d = FASTUIDRAWnew PainterPersistentDataStorePrivate(number_blocks, alignment);
+}
+
+fastuidraw::PainterPersistentDataStore::
+~PainterPersistentDataStore()
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+unsigned int
+fastuidraw::PainterPersistentDataStore::
+number_blocks(void) const
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  return d->m_number_blocks;
+}
+
+unsigned int
+fastuidraw::PainterPersistentDataStore::
+alignment(void) const
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  return d->m_alignment;
+}
+
+bool
+fastuidraw::PainterPersistentDataStore::
+fetch(uint64_t key, const_c_array<generic_data> data,
+      uint32_t *out_location)
+{
+  PainterPersistentDataStorePrivate *d;
+  std::map<uint64_t, Entry>::iterator iter;
+
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  assert(data.size() % d->m_alignment == 0);
+  if(data.empty())
+    {
+      return false;
+    }
+
+  iter = d->m_entries.find(key);
+  if(iter == d->m_entries.end())
+    {
+      Entry entry;
+
+      entry.m_number_blocks = data.size() / d->m_alignment;
+      if(!d->allocate(entry))
+        {
+          /* allocate() only fails without evicting a used
+             entry when the free room is fragmented and nothing
+             is used in the current batch yet, in which case
+             compacting makes room.
+           */
+          if(!d->m_batch_has_fetches
+             && d->m_number_blocks - d->m_number_blocks_resident >= entry.m_number_blocks)
+            {
+              const_c_array<generic_data> compacted;
+
+              compacted = d->compact();
+              if(!compacted.empty())
+                {
+                  set_data(0, compacted);
+                }
+              d->allocate(entry);
+            }
+          else
+            {
+              ++d->m_stats[num_failed_fetches];
+              return false;
+            }
+        }
+
+      std::copy(data.begin(), data.end(), d->m_shadow.begin() + entry.m_location * d->m_alignment);
+      set_data(entry.m_location, data);
+
+      d->m_number_blocks_resident += entry.m_number_blocks;
+      ++d->m_stats[num_uploads];
+      d->m_stats[num_blocks_uploaded] += entry.m_number_blocks;
+
+      d->m_lru.push_back(key);
+      entry.m_lru_location = --d->m_lru.end();
+      iter = d->m_entries.insert(std::make_pair(key, entry)).first;
+    }
+  else
+    {
+      /* move to the back of the LRU list */
+      d->m_lru.splice(d->m_lru.end(), d->m_lru, iter->second.m_lru_location);
+    }
+
+  iter->second.m_batch = d->m_batch;
+  d->m_batch_has_fetches = true;
+  *out_location = iter->second.m_location | (1u << location_bit);
+  return true;
+}
+
+void
+fastuidraw::PainterPersistentDataStore::
+end_batch(void)
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+
+  ++d->m_batch;
+  d->m_batch_has_fetches = false;
+  if(d->m_compact_at_end_batch)
+    {
+      const_c_array<generic_data> compacted;
+
+      compacted = d->compact();
+      if(!compacted.empty())
+        {
+          set_data(0, compacted);
+        }
+    }
+}
+
+void
+fastuidraw::PainterPersistentDataStore::
+clear(void)
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+
+  assert(!d->m_batch_has_fetches);
+  d->m_entries.clear();
+  d->m_lru.clear();
+  d->m_allocator.reset(d->m_number_blocks);
+  d->m_number_blocks_resident = 0;
+  d->m_compact_at_end_batch = false;
+}
+
+unsigned int
+fastuidraw::PainterPersistentDataStore::
+number_resident(void) const
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  return d->m_entries.size();
+}
+
+unsigned int
+fastuidraw::PainterPersistentDataStore::
+number_blocks_resident(void) const
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  return d->m_number_blocks_resident;
+}
+
+uint64_t
+fastuidraw::PainterPersistentDataStore::
+query_stat(enum stats_t st) const
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  assert(st < num_stats);
+  return d->m_stats[st];
+}
+
+void
+fastuidraw::PainterPersistentDataStore::
+reset_stats(void)
+{
+  PainterPersistentDataStorePrivate *d;
+  d = static_cast<PainterPersistentDataStorePrivate*>(m_d);
+  std::fill(d->m_stats.begin(), d->m_stats.end(), 0u);
+}
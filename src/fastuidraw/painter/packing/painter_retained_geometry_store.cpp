@@ -0,0 +1,305 @@
+/*!
+ * \file painter_retained_geometry_store.cpp
+ * \brief file painter_retained_geometry_store.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <map>
+#include <list>
+#include <fastuidraw/painter/packing/painter_retained_geometry_store.hpp>
+#include "../../private/interval_allocator.hpp"
+
+namespace
+{
+  class Entry
+  {
+  public:
+    fastuidraw::PainterRetainedGeometryStore::Region m_region;
+    unsigned int m_number_attributes, m_number_indices;
+    uint64_t m_batch;
+    std::list<uint64_t>::iterator m_lru_location;
+  };
+
+  class PainterRetainedGeometryStorePrivate
+  {
+  public:
+    PainterRetainedGeometryStorePrivate(unsigned int number_attributes,
+                                        unsigned int number_indices):
+      m_number_attributes(number_attributes),
+      m_number_indices(number_indices),
+      m_attribute_allocator(number_attributes),
+      m_index_allocator(number_indices),
+      m_batch(0),
+      m_number_attributes_resident(0),
+      m_number_indices_resident(0),
+      m_stats(0)
+    {}
+
+    /* allocate room for an entry, evicting the least
+       recently used entries not used in the current
+       batch as needed; returns false on failure.
+     */
+    bool
+    allocate(Entry &entry);
+
+    void
+    evict(std::map<uint64_t, Entry>::iterator iter);
+
+    unsigned int m_number_attributes, m_number_indices;
+    fastuidraw::interval_allocator m_attribute_allocator;
+    fastuidraw::interval_allocator m_index_allocator;
+
+    /* keyed by PainterAttributeData::unique_id() */
+    std::map<uint64_t, Entry> m_entries;
+
+    /* unique_id() values ordered from least to most
+       recently used.
+     */
+    std::list<uint64_t> m_lru;
+
+    uint64_t m_batch;
+    unsigned int m_number_attributes_resident;
+    unsigned int m_number_indices_resident;
+    fastuidraw::vecN<uint64_t, fastuidraw::PainterRetainedGeometryStore::num_stats> m_stats;
+  };
+}
+
+///////////////////////////////////////////////
+// PainterRetainedGeometryStorePrivate methods
+void
+PainterRetainedGeometryStorePrivate::
+evict(std::map<uint64_t, Entry>::iterator iter)
+{
+  Entry &entry(iter->second);
+
+  m_attribute_allocator.free_interval(entry.m_region.m_attribute_offset, entry.m_number_attributes);
+  m_index_allocator.free_interval(entry.m_region.m_index_offset, entry.m_number_indices);
+  m_number_attributes_resident -= entry.m_number_attributes;
+  m_number_indices_resident -= entry.m_number_indices;
+  m_lru.erase(entry.m_lru_location);
+  m_entries.erase(iter);
+}
+
+bool
+PainterRetainedGeometryStorePrivate::
+allocate(Entry &entry)
+{
+  if(entry.m_number_attributes > m_number_attributes
+     || entry.m_number_indices > m_number_indices)
+    {
+      return false;
+    }
+
+  for(;;)
+    {
+      int attr, index;
+
+      attr = m_attribute_allocator.allocate_interval(entry.m_number_attributes);
+      index = (attr >= 0) ?
+        m_index_allocator.allocate_interval(entry.m_number_indices) :
+        -1;
+
+      if(attr >= 0 && index >= 0)
+        {
+          entry.m_region.m_attribute_offset = attr;
+          entry.m_region.m_index_offset = index;
+          return true;
+        }
+
+      if(attr >= 0)
+        {
+          m_attribute_allocator.free_interval(attr, entry.m_number_attributes);
+        }
+
+      /* entries used in the current batch are at the back of
+         m_lru, so if the front is used in the current batch,
+         no entry can be evicted.
+       */
+      std::map<uint64_t, Entry>::iterator iter;
+      if(m_lru.empty())
+        {
+          return false;
+        }
+
+      iter = m_entries.find(m_lru.front());
+      assert(iter != m_entries.end());
+      if(iter->second.m_batch == m_batch)
+        {
+          return false;
+        }
+
+      evict(iter);
+      ++m_stats[fastuidraw::PainterRetainedGeometryStore::num_evictions];
+    }
+}
+
+////////////////////////////////////////////////
+// fastuidraw::PainterRetainedGeometryStore methods
+fastuidraw::PainterRetainedGeometryStore::
+PainterRetainedGeometryStore(unsigned int number_attributes,
+                             unsigned int number_indices)
+{
+  m_d = FASTUIDRAWnew PainterRetainedGeometryStorePrivate(number_attributes, number_indices);
+}
+
+fastuidraw::PainterRetainedGeometryStore::
+~PainterRetainedGeometryStore()
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+unsigned int
+fastuidraw::PainterRetainedGeometryStore::
+number_attributes(void) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  return d->m_number_attributes;
+}
+
+unsigned int
+fastuidraw::PainterRetainedGeometryStore::
+number_indices(void) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  return d->m_number_indices;
+}
+
+bool
+fastuidraw::PainterRetainedGeometryStore::
+fetch(const PainterAttributeData &data, Region *out_region)
+{
+  PainterRetainedGeometryStorePrivate *d;
+  std::map<uint64_t, Entry>::iterator iter;
+  const_c_array<PainterAttribute> attributes(data.attribute_data());
+  const_c_array<PainterIndex> indices(data.index_data());
+
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  if(attributes.empty() || indices.empty())
+    {
+      return false;
+    }
+
+  iter = d->m_entries.find(data.unique_id());
+  if(iter == d->m_entries.end())
+    {
+      Entry entry;
+
+      entry.m_number_attributes = attributes.size();
+      entry.m_number_indices = indices.size();
+      if(!d->allocate(entry))
+        {
+          ++d->m_stats[num_failed_fetches];
+          return false;
+        }
+
+      set_attributes(entry.m_region.m_attribute_offset, attributes);
+      set_indices(entry.m_region.m_index_offset, indices);
+
+      d->m_number_attributes_resident += entry.m_number_attributes;
+      d->m_number_indices_resident += entry.m_number_indices;
+      ++d->m_stats[num_uploads];
+      d->m_stats[num_attributes_uploaded] += entry.m_number_attributes;
+      d->m_stats[num_indices_uploaded] += entry.m_number_indices;
+
+      d->m_lru.push_back(data.unique_id());
+      entry.m_lru_location = --d->m_lru.end();
+      iter = d->m_entries.insert(std::make_pair(data.unique_id(), entry)).first;
+    }
+  else
+    {
+      /* move to the back of the LRU list */
+      d->m_lru.splice(d->m_lru.end(), d->m_lru, iter->second.m_lru_location);
+    }
+
+  iter->second.m_batch = d->m_batch;
+  *out_region = iter->second.m_region;
+  return true;
+}
+
+void
+fastuidraw::PainterRetainedGeometryStore::
+end_batch(void)
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  ++d->m_batch;
+}
+
+void
+fastuidraw::PainterRetainedGeometryStore::
+clear(void)
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+
+  d->m_entries.clear();
+  d->m_lru.clear();
+  d->m_attribute_allocator.reset(d->m_number_attributes);
+  d->m_index_allocator.reset(d->m_number_indices);
+  d->m_number_attributes_resident = 0;
+  d->m_number_indices_resident = 0;
+}
+
+unsigned int
+fastuidraw::PainterRetainedGeometryStore::
+number_resident(void) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  return d->m_entries.size();
+}
+
+unsigned int
+fastuidraw::PainterRetainedGeometryStore::
+number_attributes_resident(void) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  return d->m_number_attributes_resident;
+}
+
+unsigned int
+fastuidraw::PainterRetainedGeometryStore::
+number_indices_resident(void) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  return d->m_number_indices_resident;
+}
+
+uint64_t
+fastuidraw::PainterRetainedGeometryStore::
+query_stat(enum stats_t st) const
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  assert(st < num_stats);
+  return d->m_stats[st];
+}
+
+void
+fastuidraw::PainterRetainedGeometryStore::
+reset_stats(void)
+{
+  PainterRetainedGeometryStorePrivate *d;
+  d = static_cast<PainterRetainedGeometryStorePrivate*>(m_d);
+  std::fill(d->m_stats.begin(), d->m_stats.end(), 0u);
+}
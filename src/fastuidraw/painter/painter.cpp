@@ -21,6 +21,7 @@
 #include <bitset>
 
 #include <fastuidraw/util/math.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include <fastuidraw/painter/painter_header.hpp>
 #include <fastuidraw/painter/painter.hpp>
 
@@ -629,18 +630,24 @@ namespace
     std::vector<fastuidraw::PainterIndex> m_polygon_indices;
     std::vector<fastuidraw::PainterAttribute> m_polygon_attribs;
     std::vector<unsigned int> m_edge_chunks;
+    std::vector<unsigned int> m_join_chunks;
+    std::vector<unsigned int> m_cap_chunks;
     std::vector<unsigned int> m_stroke_dashed_join_chunks;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_stroke_attrib_chunks;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_stroke_index_chunks;
     std::vector<int> m_stroke_index_adjusts;
+    std::vector<const fastuidraw::PainterAttributeData*> m_stroke_sources;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_fill_attrib_chunks;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_fill_index_chunks;
     std::vector<int> m_fill_index_adjusts;
+    std::vector<const fastuidraw::PainterAttributeData*> m_fill_sources;
     std::vector<unsigned int> m_fill_selector, m_fill_subset_selector;
+    std::vector<unsigned int> m_fill_cell_selector;
     WindingSet m_fill_ws;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > m_fill_aa_fuzz_attrib_chunks;
     std::vector<fastuidraw::const_c_array<fastuidraw::PainterIndex> > m_fill_aa_fuzz_index_chunks;
     std::vector<int> m_fill_aa_fuzz_index_adjusts;
+    std::vector<const fastuidraw::PainterAttributeData*> m_fill_aa_fuzz_sources;
     fastuidraw::StrokedPath::ScratchSpace m_stroked_path_scratch;
     fastuidraw::FilledPath::ScratchSpace m_filled_path_scratch;
   };
@@ -651,6 +658,19 @@ namespace
     explicit
     PainterPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> backend);
 
+    /* in deferred submission mode, give each item drawn its
+       own z-value so that the PainterPacker can draw opaque
+       items ahead of the items below them.
+     */
+    void
+    finish_item(void)
+    {
+      if(m_core->deferred_submission())
+        {
+          ++m_current_z;
+        }
+    }
+
     void
     draw_generic(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
                  const fastuidraw::PainterData &draw,
@@ -658,6 +678,7 @@ namespace
                  fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
                  fastuidraw::const_c_array<int> index_adjusts,
                  fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
+                 fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*> index_chunk_sources,
                  unsigned int z,
                  const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back);
 
@@ -681,6 +702,21 @@ namespace
     float
     select_path_thresh(const fastuidraw::Path &path);
 
+    unsigned int
+    select_subsets(const fastuidraw::FilledPath &filled_path,
+                   unsigned int *out_number_deferred);
+
+    unsigned int
+    select_subsets(const fastuidraw::FilledPath &filled_path);
+
+    bool
+    add_fill_cell_chunks(const fastuidraw::FilledPath &filled_path, unsigned int s,
+                         const fastuidraw::CustomFillRuleBase &fill_rule,
+                         unsigned int attrib_selector_value);
+
+    const fastuidraw::FilledPath&
+    select_filled_path(const fastuidraw::Path &path);
+
     float
     select_path_thresh_non_perspective(void);
 
@@ -694,6 +730,21 @@ namespace
                         bool close_countours,
                         std::vector<unsigned int> &out_chunks);
 
+    void
+    compute_join_chunks(const fastuidraw::StrokedPath &stroked_path,
+                        const fastuidraw::PainterAttributeData &join_data,
+                        const fastuidraw::PainterShaderData::DataBase *raw_data,
+                        const fastuidraw::StrokingDataSelectorBase &selector,
+                        bool close_countours,
+                        std::vector<unsigned int> &out_chunks);
+
+    void
+    compute_cap_chunks(const fastuidraw::StrokedPath &stroked_path,
+                       const fastuidraw::PainterAttributeData &cap_data,
+                       const fastuidraw::PainterShaderData::DataBase *raw_data,
+                       const fastuidraw::StrokingDataSelectorBase &selector,
+                       std::vector<unsigned int> &out_chunks);
+
     fastuidraw::vec2 m_resolution;
     fastuidraw::vec2 m_one_pixel_width;
     float m_curve_flatness;
@@ -701,6 +752,7 @@ namespace
     clip_rect_state m_clip_rect_state;
     std::vector<occluder_stack_entry> m_occluder_stack;
     std::vector<state_stack_entry> m_state_stack;
+    fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> m_backend;
     fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker> m_core;
     fastuidraw::PainterPackedValuePool m_pool;
     fastuidraw::PainterPackedValue<fastuidraw::PainterBrush> m_reset_brush, m_black_brush;
@@ -708,6 +760,15 @@ namespace
     ClipEquationStore m_clip_store;
     PainterWorkRoom m_work_room;
     unsigned int m_max_attribs_per_block, m_max_indices_per_block;
+    fastuidraw::reference_counted_ptr<fastuidraw::TaskPool> m_filled_path_task_pool;
+    bool m_retain_path_geometry;
+
+    /* the FilledPath returned by select_filled_path() whose
+       subset selection is still in m_work_room, so that the
+       fill_path() that draws it does not select again.
+     */
+    const fastuidraw::FilledPath *m_selected_filled_path;
+    unsigned int m_selected_number_subsets, m_selected_number_deferred;
   };
 
   inline
@@ -982,7 +1043,12 @@ PainterPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> bac
   m_resolution(1.0f, 1.0f),
   m_one_pixel_width(1.0f, 1.0f),
   m_curve_flatness(1.0f),
-  m_pool(backend->configuration_base().alignment())
+  m_backend(backend),
+  m_pool(backend->configuration_base().alignment()),
+  m_retain_path_geometry(true),
+  m_selected_filled_path(nullptr),
+  m_selected_number_subsets(0),
+  m_selected_number_deferred(0)
 {
   m_core = FASTUIDRAWnew fastuidraw::PainterPacker(backend);
   m_reset_brush = m_pool.create_packed_value(fastuidraw::PainterBrush());
@@ -994,6 +1060,212 @@ PainterPrivate(fastuidraw::reference_counted_ptr<fastuidraw::PainterBackend> bac
   m_max_indices_per_block = backend->indices_per_mapping();
 }
 
+unsigned int
+PainterPrivate::
+select_subsets(const fastuidraw::FilledPath &filled_path,
+               unsigned int *out_number_deferred)
+{
+  m_work_room.m_fill_subset_selector.resize(filled_path.number_subsets());
+  if(m_filled_path_task_pool)
+    {
+      return filled_path.select_subsets(m_work_room.m_filled_path_scratch,
+                                        m_clip_store.current(),
+                                        m_clip_rect_state.item_matrix(),
+                                        m_max_attribs_per_block,
+                                        m_max_indices_per_block,
+                                        *m_filled_path_task_pool,
+                                        fastuidraw::make_c_array(m_work_room.m_fill_subset_selector),
+                                        out_number_deferred);
+    }
+
+  *out_number_deferred = 0;
+  return filled_path.select_subsets(m_work_room.m_filled_path_scratch,
+                                    m_clip_store.current(),
+                                    m_clip_rect_state.item_matrix(),
+                                    m_max_attribs_per_block,
+                                    m_max_indices_per_block,
+                                    fastuidraw::make_c_array(m_work_room.m_fill_subset_selector));
+}
+
+unsigned int
+PainterPrivate::
+select_subsets(const fastuidraw::FilledPath &filled_path)
+{
+  unsigned int return_value, num_deferred;
+
+  if(m_selected_filled_path == &filled_path)
+    {
+      return_value = m_selected_number_subsets;
+      num_deferred = m_selected_number_deferred;
+      m_selected_filled_path = nullptr;
+    }
+  else
+    {
+      m_selected_filled_path = nullptr;
+      return_value = select_subsets(filled_path, &num_deferred);
+    }
+  m_core->increment_stat(fastuidraw::PainterPacker::num_deferred_filled_path_subsets, num_deferred);
+  return return_value;
+}
+
+bool
+PainterPrivate::
+add_fill_cell_chunks(const fastuidraw::FilledPath &filled_path, unsigned int s,
+                     const fastuidraw::CustomFillRuleBase &fill_rule,
+                     unsigned int attrib_selector_value)
+{
+  /* If some cells of the subset are outside of the clipping
+     region, add to m_work_room the index ranges of the
+     triangles in the other cells whose winding number is
+     accepted by fill_rule and return true. Otherwise add
+     nothing and return false, in which case the caller
+     should use the index chunks of the entire subset.
+   */
+  using namespace fastuidraw;
+
+  FilledPath::Subset subset(filled_path.subset(s));
+  unsigned int num_cells, num_selected, num_culled(0);
+
+  num_cells = subset.number_cells();
+  if(num_cells == 0)
+    {
+      return false;
+    }
+
+  m_work_room.m_fill_cell_selector.resize(num_cells);
+  num_selected = filled_path.select_cells(m_work_room.m_filled_path_scratch,
+                                          m_clip_store.current(),
+                                          m_clip_rect_state.item_matrix(),
+                                          s, make_c_array(m_work_room.m_fill_cell_selector));
+  if(num_selected == num_cells)
+    {
+      return false;
+    }
+
+  const PainterAttributeData &data(subset.painter_data());
+  const_c_array<unsigned int> cells;
+  const_c_array<int> windings(subset.winding_numbers());
+
+  cells = make_c_array(m_work_room.m_fill_cell_selector).sub_array(0, num_selected);
+  for(unsigned int i = 0; i < windings.size(); ++i)
+    {
+      int w(windings[i]);
+      unsigned int chunk;
+      const_c_array<PainterIndex> index_chunk;
+
+      chunk = FilledPath::Subset::chunk_from_winding_number(w);
+      index_chunk = data.index_data_chunk(chunk);
+      if(index_chunk.empty() || !fill_rule(w))
+        {
+          continue;
+        }
+
+      num_culled += index_chunk.size();
+      for(unsigned int c = 0; c < cells.size();)
+        {
+          range_type<unsigned int> R(subset.cell_range(w, cells[c]));
+
+          /* the ranges of adjacent cells are adjacent, so
+             merge runs of selected cells into one chunk.
+           */
+          for(++c; c < cells.size() && cells[c] == cells[c - 1] + 1; ++c)
+            {
+              R.m_end = subset.cell_range(w, cells[c]).m_end;
+            }
+
+          if(R.difference() > 0)
+            {
+              m_work_room.m_fill_selector.push_back(attrib_selector_value);
+              m_work_room.m_fill_index_chunks.push_back(index_chunk.sub_array(R.m_begin, R.difference()));
+              m_work_room.m_fill_index_adjusts.push_back(data.index_adjust_chunk(chunk));
+              num_culled -= R.difference();
+            }
+        }
+    }
+
+  m_core->increment_stat(PainterPacker::num_culled_fill_indices, num_culled);
+  return true;
+}
+
+const fastuidraw::FilledPath&
+PainterPrivate::
+select_filled_path(const fastuidraw::Path &path)
+{
+  typedef fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath> tessellated_path_ref;
+  tessellated_path_ref requested, candidate, coarsest;
+  float thresh;
+  bool is_match, use_coarser(false);
+
+  m_selected_filled_path = nullptr;
+  thresh = select_path_thresh(path);
+  if(!m_filled_path_task_pool || m_clip_rect_state.m_all_content_culled)
+    {
+      return *path.tessellation(thresh)->filled();
+    }
+
+  /* do not block on constructing a finer TessellatedPath;
+     instead hand its construction to the TaskPool and use
+     the finest one already constructed.
+   */
+  requested = path.cached_tessellation(thresh, &is_match);
+  if(!is_match)
+    {
+      path.prefetch_tessellation(thresh, *m_filled_path_task_pool, true);
+      use_coarser = (requested.get() != nullptr);
+      if(!requested)
+        {
+          requested = path.tessellation(-1.0f);
+        }
+    }
+
+  /* walk from the requested tessellation to coarser ones
+     (which Path has already made) until one is found whose
+     triangulation is ready for the region to draw; the
+     selection also hands the triangulation of those that
+     are not ready to the TaskPool.
+   */
+  coarsest = path.tessellation(-1.0f);
+  candidate = requested;
+  for(;;)
+    {
+      unsigned int num_subsets, num_deferred;
+      float t;
+
+      num_subsets = select_subsets(*candidate->filled(), &num_deferred);
+      if(num_deferred == 0 || candidate == coarsest)
+        {
+          if(num_deferred != 0 && candidate != requested)
+            {
+              /* m_work_room holds the selection of coarsest,
+                 fill_path() selects again for requested.
+               */
+              candidate = requested;
+            }
+          else
+            {
+              m_selected_filled_path = candidate->filled().get();
+              m_selected_number_subsets = num_subsets;
+              m_selected_number_deferred = num_deferred;
+            }
+
+          if(use_coarser || candidate != requested)
+            {
+              m_core->increment_stat(fastuidraw::PainterPacker::num_coarser_fill_fallbacks);
+            }
+          return *candidate->filled();
+        }
+
+      t = candidate->effective_curve_distance_threshhold();
+      tessellated_path_ref next(candidate);
+      while(next == candidate)
+        {
+          t *= 2.0f;
+          next = path.tessellation(t);
+        }
+      candidate = next;
+    }
+}
+
 bool
 PainterPrivate::
 update_clip_equation_series(const fastuidraw::vec2 &pmin,
@@ -1239,6 +1511,68 @@ compute_edge_chunks(const fastuidraw::StrokedPath &stroked_path,
   out_chunks.resize(sz);
 }
 
+void
+PainterPrivate::
+compute_join_chunks(const fastuidraw::StrokedPath &stroked_path,
+                    const fastuidraw::PainterAttributeData &join_data,
+                    const fastuidraw::PainterShaderData::DataBase *raw_data,
+                    const fastuidraw::StrokingDataSelectorBase &selector,
+                    bool close_countours,
+                    std::vector<unsigned int> &out_chunks)
+{
+  float pixels_additional_room(0.0f), item_space_additional_room(0.0f);
+  unsigned int sz;
+
+  out_chunks.resize(join_data.attribute_data_chunks().size());
+  selector.stroking_distances(raw_data,
+                              &pixels_additional_room,
+                              &item_space_additional_room);
+
+  sz = stroked_path.join_chunks(m_work_room.m_stroked_path_scratch,
+                                join_data,
+                                m_clip_store.current(),
+                                m_clip_rect_state.item_matrix(),
+                                m_one_pixel_width,
+                                pixels_additional_room,
+                                item_space_additional_room,
+                                close_countours,
+                                m_max_attribs_per_block,
+                                m_max_indices_per_block,
+                                fastuidraw::make_c_array(out_chunks));
+  assert(sz <= out_chunks.size());
+  out_chunks.resize(sz);
+}
+
+void
+PainterPrivate::
+compute_cap_chunks(const fastuidraw::StrokedPath &stroked_path,
+                   const fastuidraw::PainterAttributeData &cap_data,
+                   const fastuidraw::PainterShaderData::DataBase *raw_data,
+                   const fastuidraw::StrokingDataSelectorBase &selector,
+                   std::vector<unsigned int> &out_chunks)
+{
+  float pixels_additional_room(0.0f), item_space_additional_room(0.0f);
+  unsigned int sz;
+
+  out_chunks.resize(cap_data.attribute_data_chunks().size());
+  selector.stroking_distances(raw_data,
+                              &pixels_additional_room,
+                              &item_space_additional_room);
+
+  sz = stroked_path.cap_chunks(m_work_room.m_stroked_path_scratch,
+                               cap_data,
+                               m_clip_store.current(),
+                               m_clip_rect_state.item_matrix(),
+                               m_one_pixel_width,
+                               pixels_additional_room,
+                               item_space_additional_room,
+                               m_max_attribs_per_block,
+                               m_max_indices_per_block,
+                               fastuidraw::make_c_array(out_chunks));
+  assert(sz <= out_chunks.size());
+  out_chunks.resize(sz);
+}
+
 void
 PainterPrivate::
 draw_generic(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShader> &shader,
@@ -1247,13 +1581,19 @@ draw_generic(const fastuidraw::reference_counted_ptr<fastuidraw::PainterItemShad
              fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
              fastuidraw::const_c_array<int> index_adjusts,
              fastuidraw::const_c_array<unsigned int> attrib_chunk_selector,
+             fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*> index_chunk_sources,
              unsigned int z,
              const fastuidraw::reference_counted_ptr<fastuidraw::PainterPacker::DataCallBack> &call_back)
 {
   fastuidraw::PainterPackerData p(draw);
   p.m_clip = m_clip_rect_state.clip_equations_state(m_pool);
   p.m_matrix = m_clip_rect_state.current_item_marix_state(m_pool);
-  m_core->draw_generic(shader, p, attrib_chunks, index_chunks, index_adjusts, attrib_chunk_selector, z, call_back);
+  if(!m_retain_path_geometry)
+    {
+      index_chunk_sources = fastuidraw::const_c_array<const fastuidraw::PainterAttributeData*>();
+    }
+  m_core->draw_generic(shader, p, attrib_chunks, index_chunks, index_adjusts,
+                       attrib_chunk_selector, index_chunk_sources, z, call_back);
 }
 
 void
@@ -1281,6 +1621,7 @@ draw_anti_alias_fuzz(const fastuidraw::PainterFillShader &shader, const fastuidr
   m_work_room.m_fill_aa_fuzz_attrib_chunks.clear();
   m_work_room.m_fill_aa_fuzz_index_chunks.clear();
   m_work_room.m_fill_aa_fuzz_index_adjusts.clear();
+  m_work_room.m_fill_aa_fuzz_sources.clear();
   for(unsigned int i = 0; i < subsets.size(); ++i)
     {
       unsigned int s(subsets[i]);
@@ -1300,6 +1641,7 @@ draw_anti_alias_fuzz(const fastuidraw::PainterFillShader &shader, const fastuidr
                   m_work_room.m_fill_aa_fuzz_attrib_chunks.push_back(data.attribute_data_chunk(chunk));
                   m_work_room.m_fill_aa_fuzz_index_chunks.push_back(data.index_data_chunk(chunk));
                   m_work_room.m_fill_aa_fuzz_index_adjusts.push_back(data.index_adjust_chunk(chunk));
+                  m_work_room.m_fill_aa_fuzz_sources.push_back(&data);
                 }
             }
 
@@ -1316,6 +1658,7 @@ draw_anti_alias_fuzz(const fastuidraw::PainterFillShader &shader, const fastuidr
                       m_work_room.m_fill_aa_fuzz_attrib_chunks.push_back(data.attribute_data_chunk(chunk));
                       m_work_room.m_fill_aa_fuzz_index_chunks.push_back(data.index_data_chunk(chunk));
                       m_work_room.m_fill_aa_fuzz_index_adjusts.push_back(data.index_adjust_chunk(chunk));
+                      m_work_room.m_fill_aa_fuzz_sources.push_back(&data);
                     }
                 }
             }
@@ -1327,6 +1670,7 @@ draw_anti_alias_fuzz(const fastuidraw::PainterFillShader &shader, const fastuidr
                fastuidraw::make_c_array(m_work_room.m_fill_aa_fuzz_index_chunks),
                fastuidraw::make_c_array(m_work_room.m_fill_aa_fuzz_index_adjusts),
                fastuidraw::const_c_array<unsigned int>(),
+               fastuidraw::make_c_array(m_work_room.m_fill_aa_fuzz_sources),
                m_current_z,
                call_back);
 }
@@ -1394,6 +1738,8 @@ void
 fastuidraw::Painter::
 end(void)
 {
+  FASTUIDRAWtrace_zone("Painter::end");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -1425,7 +1771,9 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const Paint
     {
       d->draw_generic(shader, draw, attrib_chunks, index_chunks,
                       index_adjusts, const_c_array<unsigned int>(),
+                      const_c_array<const PainterAttributeData*>(),
                       current_z(), call_back);
+      d->finish_item();
     }
 }
 
@@ -1444,7 +1792,9 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const Paint
     {
       d->draw_generic(shader, draw, attrib_chunks, index_chunks,
                       index_adjusts, attrib_chunk_selector,
+                      const_c_array<const PainterAttributeData*>(),
                       current_z(), call_back);
+      d->finish_item();
     }
 }
 
@@ -1459,9 +1809,32 @@ draw_generic(const reference_counted_ptr<PainterItemShader> &shader, const Paint
   if(!d->m_clip_rect_state.m_all_content_culled)
     {
       d->draw_generic(shader, draw, src, current_z(), call_back);
+      d->finish_item();
     }
 }
 
+void
+fastuidraw::Painter::
+draw_command_list(const PainterCommandList &list)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  if(!d->m_clip_rect_state.m_all_content_culled)
+    {
+      const_c_array<Glyph> glyphs(list.glyphs());
+      for(unsigned int i = 0; i < glyphs.size(); ++i)
+        {
+          glyphs[i].mark_used();
+        }
+      if(!glyphs.empty())
+        {
+          d->m_backend->glyphs_drawn(glyphs);
+        }
+
+      d->m_core->draw_command_list(list, d->m_current_z);
+      d->m_current_z += list.z_range();
+    }
+}
 
 void
 fastuidraw::Painter::
@@ -1511,11 +1884,14 @@ draw_convex_polygon(const PainterFillShader &shader,
     {
       ++d->m_current_z;
     }
-  draw_generic(shader.item_shader(), draw,
-               make_c_array(d->m_work_room.m_polygon_attribs),
-               make_c_array(d->m_work_room.m_polygon_indices),
-               0,
-               call_back);
+  d->draw_generic(shader.item_shader(), draw,
+                  vecN<const_c_array<PainterAttribute>, 1>(make_c_array(d->m_work_room.m_polygon_attribs)),
+                  vecN<const_c_array<PainterIndex>, 1>(make_c_array(d->m_work_room.m_polygon_indices)),
+                  vecN<int, 1>(0),
+                  const_c_array<unsigned int>(),
+                  const_c_array<const PainterAttributeData*>(),
+                  d->m_current_z,
+                  call_back);
 
   /* each point spawns an edge, each edge is 4 attributes and 6 indices
    */
@@ -1562,11 +1938,13 @@ draw_convex_polygon(const PainterFillShader &shader,
 		      vecN<const_c_array<PainterIndex>, 1>(indices),
 		      vecN<int, 1>(0),
 		      const_c_array<unsigned int>(),
+		      const_c_array<const PainterAttributeData*>(),
 		      d->m_current_z,
 		      call_back);
       ++d->m_current_z;
 		      
     }
+  d->finish_item();
 }
 
 void
@@ -1632,7 +2010,8 @@ fastuidraw::Painter::
 stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
             const PainterAttributeData *edge_data, const_c_array<unsigned int> edge_chunks,
             unsigned int inc_edge,
-            const PainterAttributeData *cap_data, unsigned int cap_chunk,
+            const PainterAttributeData *cap_data, const_c_array<unsigned int> cap_chunks,
+            unsigned int inc_cap,
             const PainterAttributeData* join_data, const_c_array<unsigned int> join_chunks,
             unsigned int inc_join, bool with_anti_aliasing,
             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
@@ -1644,12 +2023,13 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       return;
     }
 
-  unsigned int startz, zinc_sum(0), inc_cap(0), num_joins(0), num_edges(0);
+  unsigned int startz, zinc_sum(0), num_joins(0), num_edges(0), num_caps(0);
   bool modify_z;
   const reference_counted_ptr<PainterItemShader> *sh;
   c_array<const_c_array<PainterAttribute> > attrib_chunks;
   c_array<const_c_array<PainterIndex> > index_chunks;
   c_array<int> index_adjusts;
+  c_array<const PainterAttributeData*> sources;
 
   if(join_data == nullptr)
     {
@@ -1663,19 +2043,27 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       inc_edge = 0;
     }
 
+  if(cap_data == nullptr)
+    {
+      cap_chunks = const_c_array<unsigned int>();
+      inc_cap = 0;
+    }
+
   /* clear first to blank the values, std::vector::clear
      does not call deallocation on its backing store,
      thus there is no malloc/free noise
    */
   d->m_work_room.m_stroke_attrib_chunks.clear();
   d->m_work_room.m_stroke_index_chunks.clear();
-  d->m_work_room.m_stroke_index_adjusts.resize(1 + edge_chunks.size() + join_chunks.size());
-  d->m_work_room.m_stroke_attrib_chunks.resize(1 + edge_chunks.size() + join_chunks.size());
-  d->m_work_room.m_stroke_index_chunks.resize(1 + edge_chunks.size() + join_chunks.size());
+  d->m_work_room.m_stroke_index_adjusts.resize(cap_chunks.size() + edge_chunks.size() + join_chunks.size());
+  d->m_work_room.m_stroke_attrib_chunks.resize(cap_chunks.size() + edge_chunks.size() + join_chunks.size());
+  d->m_work_room.m_stroke_index_chunks.resize(cap_chunks.size() + edge_chunks.size() + join_chunks.size());
+  d->m_work_room.m_stroke_sources.resize(cap_chunks.size() + edge_chunks.size() + join_chunks.size());
 
   attrib_chunks = make_c_array(d->m_work_room.m_stroke_attrib_chunks);
   index_chunks = make_c_array(d->m_work_room.m_stroke_index_chunks);
   index_adjusts = make_c_array(d->m_work_room.m_stroke_index_adjusts);
+  sources = make_c_array(d->m_work_room.m_stroke_sources);
 
   num_joins = join_chunks.size();
   for(unsigned int J = 0; J < num_joins; ++J)
@@ -1683,6 +2071,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       attrib_chunks[J] = join_data->attribute_data_chunk(join_chunks[J]);
       index_chunks[J] = join_data->index_data_chunk(join_chunks[J]);
       index_adjusts[J] = join_data->index_adjust_chunk(join_chunks[J]);
+      sources[J] = join_data;
     }
 
   num_edges = edge_chunks.size();
@@ -1691,20 +2080,16 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       attrib_chunks[num_joins + E] = edge_data->attribute_data_chunk(edge_chunks[E]);
       index_chunks[num_joins + E] = edge_data->index_data_chunk(edge_chunks[E]);
       index_adjusts[num_joins + E] = edge_data->index_adjust_chunk(edge_chunks[E]);
+      sources[num_joins + E] = edge_data;
     }
 
-  if(cap_data != nullptr)
-    {
-      attrib_chunks[num_joins + num_edges] = cap_data->attribute_data_chunk(cap_chunk);
-      index_chunks[num_joins + num_edges] = cap_data->index_data_chunk(cap_chunk);
-      index_adjusts[num_joins + num_edges] = cap_data->index_adjust_chunk(cap_chunk);
-      inc_cap = cap_data->increment_z_value(cap_chunk);
-    }
-  else
+  num_caps = cap_chunks.size();
+  for(unsigned int C = 0; C < num_caps; ++C)
     {
-      attrib_chunks = attrib_chunks.sub_array(0, num_joins + num_edges);
-      index_chunks = index_chunks.sub_array(0, num_joins + num_edges);
-      index_adjusts = index_adjusts.sub_array(0, num_joins + num_edges);
+      attrib_chunks[num_joins + num_edges + C] = cap_data->attribute_data_chunk(cap_chunks[C]);
+      index_chunks[num_joins + num_edges + C] = cap_data->index_data_chunk(cap_chunks[C]);
+      index_adjusts[num_joins + num_edges + C] = cap_data->index_adjust_chunk(cap_chunks[C]);
+      sources[num_joins + num_edges + C] = cap_data;
     }
 
   startz = d->m_current_z;
@@ -1730,6 +2115,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
                           index_chunks.sub_array(0, num_joins),
                           index_adjusts.sub_array(0, num_joins),
                           fastuidraw::const_c_array<unsigned int>(),
+                          sources.sub_array(0, num_joins),
                           startz + incr_z + 1, call_back);
         }
 
@@ -1741,6 +2127,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
                           index_chunks.sub_array(num_joins, num_edges),
                           index_adjusts.sub_array(num_joins, num_edges),
                           fastuidraw::const_c_array<unsigned int>(),
+                          sources.sub_array(num_joins, num_edges),
                           startz + incr_z + 1, call_back);
         }
 
@@ -1748,10 +2135,11 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
         {
           incr_z -= inc_cap;
           d->draw_generic(*sh, draw,
-                          attrib_chunks.sub_array(num_joins + num_edges, 1),
-                          index_chunks.sub_array(num_joins + num_edges, 1),
-                          index_adjusts.sub_array(num_joins + num_edges, 1),
+                          attrib_chunks.sub_array(num_joins + num_edges, num_caps),
+                          index_chunks.sub_array(num_joins + num_edges, num_caps),
+                          index_adjusts.sub_array(num_joins + num_edges, num_caps),
                           fastuidraw::const_c_array<unsigned int>(),
+                          sources.sub_array(num_joins + num_edges, num_caps),
                           startz + incr_z + 1, call_back);
         }
     }
@@ -1760,7 +2148,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       d->draw_generic(*sh, draw, attrib_chunks,
                       index_chunks, index_adjusts,
                       fastuidraw::const_c_array<unsigned int>(),
-                      d->m_current_z, call_back);
+                      sources, d->m_current_z, call_back);
     }
 
   if(with_anti_aliasing)
@@ -1772,7 +2160,7 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       d->draw_generic(shader.aa_shader_pass2(), draw, attrib_chunks,
                       index_chunks, index_adjusts,
                       fastuidraw::const_c_array<unsigned int>(),
-                      startz, call_back);
+                      sources, startz, call_back);
     }
 
   if(modify_z)
@@ -1789,6 +2177,8 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
             bool with_anti_aliasing,
             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
+  FASTUIDRAWtrace_zone("Painter::stroke_path");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -1798,24 +2188,23 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
     }
 
   const PainterAttributeData *edge_data(nullptr), *cap_data(nullptr), *join_data(nullptr);
-  unsigned int inc_edge, cap_chunk(0);
+  const PainterShaderData::DataBase *raw_data;
+  unsigned int inc_edge, inc_cap(0);
   unsigned int join_chunk(chunk_for_stroking(close_contours));
   unsigned int inc_join(0);
   float rounded_thresh;
 
+  raw_data = draw.m_item_shader_data.data().data_base();
+
   if(js == PainterEnums::rounded_joins
      || (cp == PainterEnums::rounded_caps && !close_contours))
     {
-      const PainterShaderData::DataBase *raw_data;
-
-      raw_data = draw.m_item_shader_data.data().data_base();
       rounded_thresh = shader.stroking_data_selector()->compute_rounded_thresh(raw_data, thresh, d->m_curve_flatness);
     }
 
   edge_data = &path.edges(close_contours);
   inc_edge = path.z_increment_edge(close_contours);
-  d->compute_edge_chunks(path,
-                         draw.m_item_shader_data.data().data_base(),
+  d->compute_edge_chunks(path, raw_data,
                          *shader.stroking_data_selector(),
                          close_contours, d->m_work_room.m_edge_chunks);
 
@@ -1854,15 +2243,39 @@ stroke_path(const PainterStrokeShader &shader, const PainterData &draw,
       join_data = nullptr;
     }
 
+  /* the joins and caps are culled, like the edges, against the
+     current clipping; the z-increments are still those of
+     all joins and caps so that the depth values of the drawn
+     elements are unchanged.
+   */
   if(join_data != nullptr)
     {
       inc_join = join_data->increment_z_value(join_chunk);
+      d->compute_join_chunks(path, *join_data, raw_data,
+                             *shader.stroking_data_selector(),
+                             close_contours, d->m_work_room.m_join_chunks);
+    }
+  else
+    {
+      d->m_work_room.m_join_chunks.clear();
+    }
+
+  if(cap_data != nullptr)
+    {
+      inc_cap = cap_data->increment_z_value(0);
+      d->compute_cap_chunks(path, *cap_data, raw_data,
+                            *shader.stroking_data_selector(),
+                            d->m_work_room.m_cap_chunks);
+    }
+  else
+    {
+      d->m_work_room.m_cap_chunks.clear();
     }
 
   stroke_path(shader, draw,
               edge_data, make_c_array(d->m_work_room.m_edge_chunks), inc_edge,
-              cap_data, cap_chunk,
-              join_data, const_c_array<unsigned int>(&join_chunk, 1),
+              cap_data, make_c_array(d->m_work_room.m_cap_chunks), inc_cap,
+              join_data, make_c_array(d->m_work_room.m_join_chunks),
               inc_join, with_anti_aliasing, call_back);
 }
 
@@ -1909,7 +2322,8 @@ fastuidraw::Painter::
 stroke_dashed_path(const PainterStrokeShader &shader, const PainterData &draw,
                    const PainterAttributeData *edge_data, const_c_array<unsigned int> edge_chunks,
                    unsigned int inc_edge,
-                   const PainterAttributeData *cap_data, unsigned int cap_chunk,
+                   const PainterAttributeData *cap_data, const_c_array<unsigned int> cap_chunks,
+                   unsigned int inc_cap,
                    bool include_joins_from_closing_edge,
                    const DashEvaluatorBase *dash_evaluator, const PainterAttributeData *join_data,
                    bool with_anti_aliasing,
@@ -1958,7 +2372,7 @@ stroke_dashed_path(const PainterStrokeShader &shader, const PainterData &draw,
     }
 
   stroke_path(shader, draw, edge_data, edge_chunks, inc_edge,
-              cap_data, cap_chunk,
+              cap_data, cap_chunks, inc_cap,
               join_data, make_c_array(d->m_work_room.m_stroke_dashed_join_chunks),
               inc_join, with_anti_aliasing, call_back);
 }
@@ -1971,6 +2385,8 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
                    bool with_anti_aliasing,
                    const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
+  FASTUIDRAWtrace_zone("Painter::stroke_dashed_path");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -1980,7 +2396,7 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
     }
 
   const PainterAttributeData *edge_data(nullptr), *cap_data(nullptr), *join_data(nullptr);
-  unsigned int inc_edge, cap_chunk(0);
+  unsigned int inc_edge, inc_cap(0);
 
   edge_data = &path.edges(close_contours);
   inc_edge = path.z_increment_edge(close_contours);
@@ -1988,9 +2404,15 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
                          draw.m_item_shader_data.data().data_base(),
                          *shader.shader(cp).stroking_data_selector(),
                          close_contours, d->m_work_room.m_edge_chunks);
+  d->m_work_room.m_cap_chunks.clear();
   if(!close_contours)
     {
       cap_data = &path.adjustable_caps();
+      inc_cap = cap_data->increment_z_value(0);
+      d->compute_cap_chunks(path, *cap_data,
+                            draw.m_item_shader_data.data().data_base(),
+                            *shader.shader(cp).stroking_data_selector(),
+                            d->m_work_room.m_cap_chunks);
     }
 
   switch(js)
@@ -2020,7 +2442,7 @@ stroke_dashed_path(const PainterDashedStrokeShaderSet &shader, const PainterData
 
   stroke_dashed_path(shader.shader(cp), draw,
                      edge_data, make_c_array(d->m_work_room.m_edge_chunks), inc_edge,
-                     cap_data, cap_chunk,
+                     cap_data, make_c_array(d->m_work_room.m_cap_chunks), inc_cap,
                      close_contours,
                      shader.dash_evaluator().get(), join_data,
                      with_anti_aliasing, call_back);
@@ -2071,6 +2493,8 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
           bool with_anti_aliasing,
           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
+  FASTUIDRAWtrace_zone("Painter::fill_path");
+
   PainterPrivate *d;
   unsigned int idx_chunk, atr_chunk, num_subsets;
 
@@ -2083,13 +2507,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   idx_chunk = FilledPath::Subset::chunk_from_fill_rule(fill_rule);
   atr_chunk = 0;
 
-  d->m_work_room.m_fill_subset_selector.resize(filled_path.number_subsets());
-  num_subsets = filled_path.select_subsets(d->m_work_room.m_filled_path_scratch,
-                                           d->m_clip_store.current(),
-                                           d->m_clip_rect_state.item_matrix(),
-                                           d->m_max_attribs_per_block,
-                                           d->m_max_indices_per_block,
-                                           make_c_array(d->m_work_room.m_fill_subset_selector));
+  num_subsets = d->select_subsets(filled_path);
 
   if(num_subsets == 0)
     {
@@ -2099,29 +2517,50 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   fastuidraw::const_c_array<unsigned int> subset_list;
   subset_list = make_c_array(d->m_work_room.m_fill_subset_selector).sub_array(0, num_subsets);
 
+  CustomFillRuleFunction fill_rule_function(fill_rule);
+
   d->m_work_room.m_fill_attrib_chunks.clear();
   d->m_work_room.m_fill_index_chunks.clear();
   d->m_work_room.m_fill_index_adjusts.clear();
+  d->m_work_room.m_fill_selector.clear();
+  d->m_work_room.m_fill_sources.clear();
   for(unsigned int i = 0; i < num_subsets; ++i)
     {
       unsigned int s(subset_list[i]);
       FilledPath::Subset subset(filled_path.subset(s));
       const PainterAttributeData &data(subset.painter_data());
+      unsigned int attrib_selector_value, num_index_chunks;
 
-      d->m_work_room.m_fill_attrib_chunks.push_back(data.attribute_data_chunk(atr_chunk));
-      d->m_work_room.m_fill_index_chunks.push_back(data.index_data_chunk(idx_chunk));
-      d->m_work_room.m_fill_index_adjusts.push_back(data.index_adjust_chunk(idx_chunk));
+      attrib_selector_value = d->m_work_room.m_fill_attrib_chunks.size();
+      num_index_chunks = d->m_work_room.m_fill_index_chunks.size();
+      if(!d->add_fill_cell_chunks(filled_path, s, fill_rule_function, attrib_selector_value))
+        {
+          d->m_work_room.m_fill_selector.push_back(attrib_selector_value);
+          d->m_work_room.m_fill_index_chunks.push_back(data.index_data_chunk(idx_chunk));
+          d->m_work_room.m_fill_index_adjusts.push_back(data.index_adjust_chunk(idx_chunk));
+        }
+
+      if(num_index_chunks != d->m_work_room.m_fill_index_chunks.size())
+        {
+          d->m_work_room.m_fill_attrib_chunks.push_back(data.attribute_data_chunk(atr_chunk));
+          d->m_work_room.m_fill_sources.resize(d->m_work_room.m_fill_index_chunks.size(), &data);
+        }
     }
 
   if(with_anti_aliasing)
     {
       ++d->m_current_z;
     }
-  draw_generic(shader.item_shader(), draw,
-               fastuidraw::make_c_array(d->m_work_room.m_fill_attrib_chunks),
-               fastuidraw::make_c_array(d->m_work_room.m_fill_index_chunks),
-               fastuidraw::make_c_array(d->m_work_room.m_fill_index_adjusts),
-               call_back);
+  if(!d->m_work_room.m_fill_index_chunks.empty())
+    {
+      d->draw_generic(shader.item_shader(), draw,
+                      make_c_array(d->m_work_room.m_fill_attrib_chunks),
+                      make_c_array(d->m_work_room.m_fill_index_chunks),
+                      make_c_array(d->m_work_room.m_fill_index_adjusts),
+                      make_c_array(d->m_work_room.m_fill_selector),
+                      make_c_array(d->m_work_room.m_fill_sources),
+                      d->m_current_z, call_back);
+    }
 
   if(with_anti_aliasing)
     {
@@ -2133,6 +2572,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
                               call_back);
       ++d->m_current_z;
     }
+  d->finish_item();
 }
 
 void
@@ -2143,11 +2583,9 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
   PainterPrivate *d;
-  float thresh;
 
   d = static_cast<PainterPrivate*>(m_d);
-  thresh = d->select_path_thresh(path);
-  fill_path(shader, draw, *path.tessellation(thresh)->filled(), fill_rule,
+  fill_path(shader, draw, d->select_filled_path(path), fill_rule,
             with_anti_aliasing, call_back);
 }
 
@@ -2168,6 +2606,8 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
           bool with_anti_aliasing,
           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
+  FASTUIDRAWtrace_zone("Painter::fill_path");
+
   unsigned int num_subsets;
   PainterPrivate *d;
 
@@ -2177,13 +2617,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
       return;
     }
 
-  d->m_work_room.m_fill_subset_selector.resize(filled_path.number_subsets());
-  num_subsets = filled_path.select_subsets(d->m_work_room.m_filled_path_scratch,
-                                           d->m_clip_store.current(),
-                                           d->m_clip_rect_state.item_matrix(),
-                                           d->m_max_attribs_per_block,
-                                           d->m_max_indices_per_block,
-                                           make_c_array(d->m_work_room.m_fill_subset_selector));
+  num_subsets = d->select_subsets(filled_path);
 
   if(num_subsets == 0)
     {
@@ -2199,6 +2633,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
   d->m_work_room.m_fill_index_chunks.clear();
   d->m_work_room.m_fill_index_adjusts.clear();
   d->m_work_room.m_fill_selector.clear();
+  d->m_work_room.m_fill_sources.clear();
 
   for(unsigned int i = 0; i < num_subsets; ++i)
     {
@@ -2206,34 +2641,38 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
       FilledPath::Subset subset(filled_path.subset(s));
       const PainterAttributeData &data(subset.painter_data());
       const_c_array<fastuidraw::PainterAttribute> attrib_chunk;
-      unsigned int attrib_selector_value;
+      unsigned int attrib_selector_value, num_index_chunks;
       bool added_chunk;
 
-      added_chunk = false;
       attrib_selector_value = d->m_work_room.m_fill_attrib_chunks.size();
+      num_index_chunks = d->m_work_room.m_fill_index_chunks.size();
 
-      for(const_c_array<int>::iterator iter = subset.winding_numbers().begin(),
-            end = subset.winding_numbers().end(); iter != end; ++iter)
+      if(!d->add_fill_cell_chunks(filled_path, s, fill_rule, attrib_selector_value))
         {
-          int winding_number(*iter);
-          int chunk;
-          const_c_array<PainterIndex> index_chunk;
-
-          chunk = FilledPath::Subset::chunk_from_winding_number(winding_number);
-          index_chunk = data.index_data_chunk(chunk);
-          if(!index_chunk.empty() && d->m_work_room.m_fill_ws(winding_number))
+          for(const_c_array<int>::iterator iter = subset.winding_numbers().begin(),
+                end = subset.winding_numbers().end(); iter != end; ++iter)
             {
-              d->m_work_room.m_fill_selector.push_back(attrib_selector_value);
-              d->m_work_room.m_fill_index_chunks.push_back(index_chunk);
-              d->m_work_room.m_fill_index_adjusts.push_back(data.index_adjust_chunk(chunk));
-              added_chunk = true;
+              int winding_number(*iter);
+              int chunk;
+              const_c_array<PainterIndex> index_chunk;
+
+              chunk = FilledPath::Subset::chunk_from_winding_number(winding_number);
+              index_chunk = data.index_data_chunk(chunk);
+              if(!index_chunk.empty() && d->m_work_room.m_fill_ws(winding_number))
+                {
+                  d->m_work_room.m_fill_selector.push_back(attrib_selector_value);
+                  d->m_work_room.m_fill_index_chunks.push_back(index_chunk);
+                  d->m_work_room.m_fill_index_adjusts.push_back(data.index_adjust_chunk(chunk));
+                }
             }
         }
+      added_chunk = (num_index_chunks != d->m_work_room.m_fill_index_chunks.size());
 
       if(added_chunk)
         {
           attrib_chunk = data.attribute_data_chunk(0);
           d->m_work_room.m_fill_attrib_chunks.push_back(attrib_chunk);
+          d->m_work_room.m_fill_sources.resize(d->m_work_room.m_fill_index_chunks.size(), &data);
         }
     }
 
@@ -2249,6 +2688,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
                       make_c_array(d->m_work_room.m_fill_index_chunks),
                       make_c_array(d->m_work_room.m_fill_index_adjusts),
                       make_c_array(d->m_work_room.m_fill_selector),
+                      make_c_array(d->m_work_room.m_fill_sources),
                       d->m_current_z, call_back);
 
       if(with_anti_aliasing)
@@ -2260,6 +2700,7 @@ fill_path(const PainterFillShader &shader, const PainterData &draw,
           ++d->m_current_z;
         }
     }
+  d->finish_item();
 }
 
 void
@@ -2270,11 +2711,9 @@ fill_path(const PainterFillShader &shader,
           const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
   PainterPrivate *d;
-  float thresh;
 
   d = static_cast<PainterPrivate*>(m_d);
-  thresh = d->select_path_thresh(path);
-  fill_path(shader, draw, *path.tessellation(thresh)->filled(), fill_rule,
+  fill_path(shader, draw, d->select_filled_path(path), fill_rule,
             with_anti_aliasing, call_back);
 }
 
@@ -2294,6 +2733,8 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
             const PainterAttributeData &data,
             const reference_counted_ptr<PainterPacker::DataCallBack> &call_back)
 {
+  FASTUIDRAWtrace_zone("Painter::draw_glyphs");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -2302,6 +2743,21 @@ draw_glyphs(const PainterGlyphShader &shader, const PainterData &draw,
       return;
     }
 
+  /* the glyphs are pinned by the PainterAttributeData; mark
+     them for the least recently used ordering of their
+     GlyphCache and let a backend that keeps the draws
+     beyond the frame pin them too.
+   */
+  const_c_array<Glyph> glyphs(data.glyphs());
+  for(unsigned int i = 0; i < glyphs.size(); ++i)
+    {
+      glyphs[i].mark_used();
+    }
+  if(!glyphs.empty())
+    {
+      d->m_backend->glyphs_drawn(glyphs);
+    }
+
   const_c_array<unsigned int> chks(data.non_empty_index_data_chunks());
   for(unsigned int i = 0; i < chks.size(); ++i)
     {
@@ -2474,6 +2930,60 @@ curveFlatness(void)
   return d->m_curve_flatness;
 }
 
+void
+fastuidraw::Painter::
+filled_path_task_pool(const reference_counted_ptr<TaskPool> &task_pool)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  d->m_filled_path_task_pool = task_pool;
+}
+
+const fastuidraw::reference_counted_ptr<fastuidraw::TaskPool>&
+fastuidraw::Painter::
+filled_path_task_pool(void) const
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  return d->m_filled_path_task_pool;
+}
+
+void
+fastuidraw::Painter::
+retain_path_geometry(bool v)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  d->m_retain_path_geometry = v;
+}
+
+bool
+fastuidraw::Painter::
+retain_path_geometry(void) const
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  return d->m_retain_path_geometry;
+}
+
+void
+fastuidraw::Painter::
+deferred_submission(bool v)
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  d->m_core->deferred_submission(v);
+}
+
+bool
+fastuidraw::Painter::
+deferred_submission(void) const
+{
+  PainterPrivate *d;
+  d = static_cast<PainterPrivate*>(m_d);
+  return d->m_core->deferred_submission();
+}
+
 void
 fastuidraw::Painter::
 save(void)
@@ -2543,6 +3053,8 @@ void
 fastuidraw::Painter::
 clipOutPath(const Path &path, enum PainterEnums::fill_rule_t fill_rule)
 {
+  FASTUIDRAWtrace_zone("Painter::clipOutPath");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -2577,6 +3089,8 @@ void
 fastuidraw::Painter::
 clipOutPath(const Path &path, const CustomFillRuleBase &fill_rule)
 {
+  FASTUIDRAWtrace_zone("Painter::clipOutPath");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -2611,6 +3125,8 @@ void
 fastuidraw::Painter::
 clipInPath(const Path &path, enum PainterEnums::fill_rule_t fill_rule)
 {
+  FASTUIDRAWtrace_zone("Painter::clipInPath");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -2632,6 +3148,8 @@ void
 fastuidraw::Painter::
 clipInPath(const Path &path, const CustomFillRuleBase &fill_rule)
 {
+  FASTUIDRAWtrace_zone("Painter::clipInPath");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
@@ -2653,6 +3171,8 @@ void
 fastuidraw::Painter::
 clipInRect(const vec2 &pmin, const vec2 &wh)
 {
+  FASTUIDRAWtrace_zone("Painter::clipInRect");
+
   PainterPrivate *d;
   d = static_cast<PainterPrivate*>(m_d);
 
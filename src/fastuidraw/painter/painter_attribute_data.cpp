@@ -18,15 +18,30 @@
 
 
 #include <vector>
+#include <atomic>
 #include <fastuidraw/util/fastuidraw_memory.hpp>
 #include <fastuidraw/painter/painter_attribute_data.hpp>
+#include <fastuidraw/text/glyph.hpp>
 #include "../private/util_private.hpp"
+#include "../text/private/pinned_glyphs.hpp"
 
 namespace
 {
   class PainterAttributeDataPrivate
   {
   public:
+    PainterAttributeDataPrivate(void):
+      m_unique_id(next_unique_id())
+    {}
+
+    static
+    uint64_t
+    next_unique_id(void)
+    {
+      static std::atomic<uint64_t> counter(0);
+      return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
     void
     ready_non_empty_index_data_chunks(void);
 
@@ -38,6 +53,8 @@ namespace
     std::vector<unsigned int> m_increment_z;
     std::vector<unsigned int> m_non_empty_index_data_chunks;
     std::vector<int> m_index_adjust_chunks;
+    fastuidraw::detail::PinnedGlyphs m_glyphs;
+    uint64_t m_unique_id;
   };
 }
 
@@ -107,7 +124,37 @@ set_data(const PainterAttributeDataFiller &filler)
                    make_c_array(d->m_increment_z),
                    make_c_array(d->m_index_adjust_chunks));
 
+  d->m_glyphs.set(filler.glyphs());
+
   d->ready_non_empty_index_data_chunks();
+  d->m_unique_id = PainterAttributeDataPrivate::next_unique_id();
+}
+
+uint64_t
+fastuidraw::PainterAttributeData::
+unique_id(void) const
+{
+  PainterAttributeDataPrivate *d;
+  d = static_cast<PainterAttributeDataPrivate*>(m_d);
+  return d->m_unique_id;
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterAttribute>
+fastuidraw::PainterAttributeData::
+attribute_data(void) const
+{
+  PainterAttributeDataPrivate *d;
+  d = static_cast<PainterAttributeDataPrivate*>(m_d);
+  return make_c_array(d->m_attribute_data);
+}
+
+fastuidraw::const_c_array<fastuidraw::PainterIndex>
+fastuidraw::PainterAttributeData::
+index_data(void) const
+{
+  PainterAttributeDataPrivate *d;
+  d = static_cast<PainterAttributeDataPrivate*>(m_d);
+  return make_c_array(d->m_index_data);
 }
 
 fastuidraw::const_c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> >
@@ -198,3 +245,12 @@ non_empty_index_data_chunks(void) const
   d = static_cast<PainterAttributeDataPrivate*>(m_d);
   return make_c_array(d->m_non_empty_index_data_chunks);
 }
+
+fastuidraw::const_c_array<fastuidraw::Glyph>
+fastuidraw::PainterAttributeData::
+glyphs(void) const
+{
+  PainterAttributeDataPrivate *d;
+  d = static_cast<PainterAttributeDataPrivate*>(m_d);
+  return d->m_glyphs.glyphs();
+}
@@ -313,3 +313,12 @@ fill_data(c_array<PainterAttribute> attribute_data,
         }
     }
 }
+
+fastuidraw::const_c_array<fastuidraw::Glyph>
+fastuidraw::PainterAttributeDataFillerGlyphs::
+glyphs(void) const
+{
+  FillGlyphsPrivate *d;
+  d = static_cast<FillGlyphsPrivate*>(m_d);
+  return d->m_glyphs.sub_array(0, d->m_number_glyphs);
+}
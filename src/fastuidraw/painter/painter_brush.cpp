@@ -35,6 +35,13 @@ data_size(unsigned int alignment) const
       return_value += round_up_to_multiple(image_data_size, alignment);
     }
 
+  if(pshader & image_mipmap_levels_mask)
+    {
+      uint32_t num_levels;
+      num_levels = unpack_bits(image_mipmap_levels_bit0, image_mipmap_levels_num_bits, pshader);
+      return_value += round_up_to_multiple(image_mipmap_data_size(num_levels), alignment);
+    }
+
   if(pshader & radial_gradient_mask)
     {
       assert(pshader & gradient_mask);
@@ -112,6 +119,45 @@ pack_data(unsigned int alignment, c_array<generic_data> dst) const
         | pack_bits(image_slack_bit0, image_slack_num_bits, slack);
     }
 
+  if(pshader & image_mipmap_levels_mask)
+    {
+      uint32_t num_levels, finest;
+
+      num_levels = unpack_bits(image_mipmap_levels_bit0, image_mipmap_levels_num_bits, pshader);
+      sz = round_up_to_multiple(image_mipmap_data_size(num_levels), alignment);
+      sub_dest = dst.sub_array(current, sz);
+      current += sz;
+
+      assert(m_data.m_image);
+      assert(num_levels == m_data.m_image->number_mipmap_levels());
+      finest = m_data.m_image->finest_resident_mipmap_level();
+      sub_dest[image_mipmap_finest_level_offset].u = finest;
+      for(uint32_t L = 0; L < num_levels; ++L)
+        {
+          c_array<generic_data> level_dest;
+
+          level_dest = sub_dest.sub_array(image_mipmap_levels_offset + L * image_mipmap_level_data_size,
+                                          image_mipmap_level_data_size);
+          if(L < finest)
+            {
+              /* not on the atlas, never read by the shader */
+              level_dest[image_mipmap_level_atlas_location_xyz_offset].u = 0u;
+              level_dest[image_mipmap_level_number_lookups_offset].u = 0u;
+            }
+          else
+            {
+              uvec3 level_loc(m_data.m_image->mipmap_master_index_tile(L));
+
+              level_dest[image_mipmap_level_atlas_location_xyz_offset].u =
+                pack_bits(image_atlas_location_x_bit0, image_atlas_location_x_num_bits, level_loc.x())
+                | pack_bits(image_atlas_location_y_bit0, image_atlas_location_y_num_bits, level_loc.y())
+                | pack_bits(image_atlas_location_z_bit0, image_atlas_location_z_num_bits, level_loc.z());
+              level_dest[image_mipmap_level_number_lookups_offset].u =
+                m_data.m_image->mipmap_number_index_lookups(L);
+            }
+        }
+    }
+
   if(pshader & gradient_mask)
     {
       if(pshader & radial_gradient_mask)
@@ -194,16 +240,19 @@ fastuidraw::PainterBrush::
 sub_image(const reference_counted_ptr<const Image> &im,
           uvec2 xy, uvec2 wh, enum image_filter f)
 {
-  uint32_t filter_bits;
+  uint32_t filter_bits, mipmap_bits;
 
   filter_bits = im ? f : 0;
+  mipmap_bits = (im && im->number_mipmap_levels() > 1) ? im->number_mipmap_levels() : 0;
+  assert(mipmap_bits <= FASTUIDRAW_MAX_VALUE_FROM_NUM_BITS(image_mipmap_levels_num_bits));
 
   m_data.m_image = im;
   m_data.m_image_start = xy;
   m_data.m_image_size = wh;
 
-  m_data.m_shader_raw &= ~(filter_bits << image_filter_bit0);
+  m_data.m_shader_raw &= ~(image_mask | image_mipmap_levels_mask);
   m_data.m_shader_raw |= (filter_bits << image_filter_bit0);
+  m_data.m_shader_raw |= pack_bits(image_mipmap_levels_bit0, image_mipmap_levels_num_bits, mipmap_bits);
 
   return *this;
 }
@@ -25,10 +25,12 @@
 #include <fastuidraw/painter/stroked_path.hpp>
 #include <fastuidraw/painter/painter_attribute_data.hpp>
 #include <fastuidraw/painter/painter_attribute_data_filler.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include "../private/util_private.hpp"
 #include "../private/bounding_box.hpp"
 #include "../private/path_util_private.hpp"
 #include "../private/clip.hpp"
+#include "../private/memory_accounting_private.hpp"
 
 namespace
 {
@@ -203,6 +205,165 @@ namespace
 
     fastuidraw::vecN<std::vector<fastuidraw::vec2>, 2> m_clip_scratch_vec2s;
     std::vector<float> m_clip_scratch_floats;
+
+    /* clip equations in local coordinates without any
+       additional room (m_clip_eqs_base) and the amount
+       the pixel additional room pushes them by (m_clip_eqs_room);
+       used by ElementCuller to scale the pixel additional room
+       by the room factor of a join or cap.
+     */
+    std::vector<fastuidraw::vec3> m_clip_eqs_base;
+    std::vector<fastuidraw::vec3> m_clip_eqs_room;
+  };
+
+  /* A CullableElement is a single join or a single cap;
+     the geometry of the element is contained within m_bb
+     inflated by m_room_factor times the stroking radius.
+   */
+  class CullableElement
+  {
+  public:
+    CullableElement(void):
+      m_room_factor(1.0f)
+    {}
+
+    fastuidraw::BoundingBox<float> m_bb;
+    float m_room_factor;
+
+    /* set when the attribute data is filled
+     */
+    fastuidraw::range_type<unsigned int> m_vertex_data_range;
+    fastuidraw::range_type<unsigned int> m_index_data_range;
+  };
+
+  /* ElementCullingHierarchy is a node of a hierarchy over a
+     range of CullableElement values. Joins and caps are created
+     in contour order, so neighboring elements are spatially
+     close; splitting the range in half gives a hierarchy whose
+     nodes are contiguous in the attribute and index data without
+     needing to reorder the data.
+   */
+  class ElementCullingHierarchy:fastuidraw::noncopyable
+  {
+  public:
+    enum
+      {
+        splitting_threshhold = 16
+      };
+
+    ElementCullingHierarchy(fastuidraw::const_c_array<CullableElement> elements,
+                            fastuidraw::range_type<unsigned int> R,
+                            unsigned int &chunk);
+
+    ~ElementCullingHierarchy();
+
+    void
+    fill_chunks(fastuidraw::const_c_array<CullableElement> elements,
+                fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
+                fastuidraw::c_array<fastuidraw::PainterIndex> index_data,
+                fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
+                fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+                fastuidraw::c_array<int> index_adjusts);
+
+    fastuidraw::vecN<ElementCullingHierarchy*, 2> m_children;
+    fastuidraw::range_type<unsigned int> m_elements;
+    unsigned int m_chunk;
+    fastuidraw::BoundingBox<float> m_bb;
+    float m_room_factor;
+    fastuidraw::range_type<unsigned int> m_vertex_data_range;
+    fastuidraw::range_type<unsigned int> m_index_data_range;
+  };
+
+  /* An ElementCuller holds the CullableElement values of a
+     PainterAttributeData of joins or caps, together with
+     upto two hierarchies; for joins, the first is over the
+     joins not of the closing edges and the second over the
+     joins of the closing edges, for caps only the first is
+     used. An element E is in the chunk m_first_element_chunk + E,
+     the nodes of the hierarchies take the chunks starting
+     at m_first_node_chunk.
+   */
+  class ElementCuller:fastuidraw::noncopyable
+  {
+  public:
+    ElementCuller(void);
+    ~ElementCuller();
+
+    void
+    create_hierarchies(unsigned int first_element_chunk,
+                       unsigned int first_node_chunk,
+                       unsigned int number_elements_first_hierarchy);
+
+    unsigned int
+    number_chunks(void) const
+    {
+      return m_number_chunks;
+    }
+
+    void
+    set_element_data(unsigned int E,
+                     fastuidraw::range_type<unsigned int> vertex_data_range,
+                     fastuidraw::range_type<unsigned int> index_data_range)
+    {
+      assert(E < m_elements.size());
+      m_elements[E].m_vertex_data_range = vertex_data_range;
+      m_elements[E].m_index_data_range = index_data_range;
+    }
+
+    void
+    fill_chunks(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
+                fastuidraw::c_array<fastuidraw::PainterIndex> index_data,
+                fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
+                fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+                fastuidraw::c_array<int> index_adjusts);
+
+    unsigned int
+    chunks(ScratchSpacePrivate &work_room,
+           fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+           const fastuidraw::float3x3 &clip_matrix_local,
+           const fastuidraw::vec2 &recip_dimensions,
+           float pixels_additional_room,
+           float item_space_additional_room,
+           bool include_second_hierarchy,
+           unsigned int max_attribute_cnt,
+           unsigned int max_index_cnt,
+           fastuidraw::c_array<unsigned int> dst) const;
+
+    std::vector<CullableElement> m_elements;
+
+  private:
+    bool
+    intersects(ScratchSpacePrivate &work_room,
+               const fastuidraw::BoundingBox<float> &bb,
+               float room_factor,
+               float item_space_additional_room,
+               bool &unclipped) const;
+
+    void
+    chunks_implement(const ElementCullingHierarchy *node,
+                     ScratchSpacePrivate &work_room,
+                     float item_space_additional_room,
+                     unsigned int max_attribute_cnt,
+                     unsigned int max_index_cnt,
+                     fastuidraw::c_array<unsigned int> dst,
+                     unsigned int &current) const;
+
+    void
+    chunks_take_all(const ElementCullingHierarchy *node,
+                    unsigned int max_attribute_cnt,
+                    unsigned int max_index_cnt,
+                    fastuidraw::c_array<unsigned int> dst,
+                    unsigned int &current) const;
+
+    void
+    add_element_chunk(unsigned int E,
+                      unsigned int max_attribute_cnt,
+                      unsigned int max_index_cnt,
+                      fastuidraw::c_array<unsigned int> dst,
+                      unsigned int &current) const;
+
+    unsigned int m_first_element_chunk, m_number_chunks;
+    fastuidraw::vecN<ElementCullingHierarchy*, 2> m_hierarchies;
   };
 
   class EdgesElement
@@ -365,8 +526,7 @@ namespace
   class JoinCreatorBase:public fastuidraw::PainterAttributeDataFiller
   {
   public:
-    explicit
-    JoinCreatorBase(const PathData &P);
+    JoinCreatorBase(const PathData &P, ElementCuller &culler);
 
     virtual
     ~JoinCreatorBase() {}
@@ -404,16 +564,31 @@ namespace
              unsigned int contour, unsigned int edge,
              unsigned int &vert_count, unsigned int &index_count) const = 0;
 
+    /* returns by how much the stroking radius is to be
+       multiplied to contain the geometry of a join
+     */
+    virtual
+    float
+    room_factor(const fastuidraw::vec2 &n0_from_stroking,
+                const fastuidraw::vec2 &n1_from_stroking) const
+    {
+      FASTUIDRAWunused(n0_from_stroking);
+      FASTUIDRAWunused(n1_from_stroking);
+      return 1.0f;
+    }
+
+    void
+    add_cullable_element(const fastuidraw::vec2 &n0_from_stroking,
+                         const fastuidraw::vec2 &n1_from_stroking,
+                         unsigned int contour, unsigned int edge);
+
 
     void
     fill_join(unsigned int join_id,
               unsigned int contour, unsigned int edge,
               fastuidraw::c_array<fastuidraw::PainterAttribute> pts,
               fastuidraw::c_array<unsigned int> indices,
-              unsigned int &vertex_offset, unsigned int &index_offset,
-              fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
-              fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
-              fastuidraw::c_array<int> index_adjusts) const;
+              unsigned int &vertex_offset, unsigned int &index_offset) const;
 
     virtual
     void
@@ -426,6 +601,7 @@ namespace
                         unsigned int &vertex_offset, unsigned int &index_offset) const = 0;
 
     const PathData &m_P;
+    ElementCuller &m_culler;
     unsigned int m_num_non_closed_verts, m_num_non_closed_indices;
     unsigned int m_num_closed_verts, m_num_closed_indices;
     unsigned int m_num_joins, m_num_joins_without_closing_edge;
@@ -436,7 +612,7 @@ namespace
   class RoundedJoinCreator:public JoinCreatorBase
   {
   public:
-    RoundedJoinCreator(const PathData &P, float thresh);
+    RoundedJoinCreator(const PathData &P, float thresh, ElementCuller &culler);
 
   private:
 
@@ -487,8 +663,7 @@ namespace
   class BevelJoinCreator:public JoinCreatorBase
   {
   public:
-    explicit
-    BevelJoinCreator(const PathData &P);
+    BevelJoinCreator(const PathData &P, ElementCuller &culler);
 
   private:
 
@@ -517,10 +692,14 @@ namespace
   class MiterJoinCreator:public JoinCreatorBase
   {
   public:
-    explicit
-    MiterJoinCreator(const PathData &P);
+    MiterJoinCreator(const PathData &P, ElementCuller &culler);
 
   private:
+    virtual
+    float
+    room_factor(const fastuidraw::vec2 &n0_from_stroking,
+                const fastuidraw::vec2 &n1_from_stroking) const;
+
     virtual
     void
     add_join(unsigned int join_id,
@@ -579,7 +758,8 @@ namespace
   class CapCreatorBase:public fastuidraw::PainterAttributeDataFiller
   {
   public:
-    CapCreatorBase(const PathData &P, PointIndexCapSize sz);
+    CapCreatorBase(const PathData &P, PointIndexCapSize sz,
+                   float room_factor, ElementCuller &culler);
 
     virtual
     ~CapCreatorBase()
@@ -615,12 +795,13 @@ namespace
 
     const PathData &m_P;
     PointIndexCapSize m_size;
+    ElementCuller &m_culler;
   };
 
   class RoundedCapCreator:public CapCreatorBase
   {
   public:
-    RoundedCapCreator(const PathData &P, float thresh);
+    RoundedCapCreator(const PathData &P, float thresh, ElementCuller &culler);
 
   private:
     static
@@ -644,9 +825,8 @@ namespace
   class SquareCapCreator:public CapCreatorBase
   {
   public:
-    explicit
-    SquareCapCreator(const PathData &P):
-      CapCreatorBase(P, compute_size(P))
+    SquareCapCreator(const PathData &P, ElementCuller &culler):
+      CapCreatorBase(P, compute_size(P), std::sqrt(2.0f), culler)
     {}
 
   private:
@@ -667,8 +847,8 @@ namespace
   class AdjustableCapCreator:public CapCreatorBase
   {
   public:
-    AdjustableCapCreator(const PathData &P):
-      CapCreatorBase(P, compute_size(P))
+    AdjustableCapCreator(const PathData &P, ElementCuller &culler):
+      CapCreatorBase(P, compute_size(P), std::sqrt(2.0f), culler)
     {}
 
   private:
@@ -712,11 +892,13 @@ namespace
   public:
     ThreshWithData(void):
       m_data(nullptr),
+      m_culler(nullptr),
       m_thresh(-1)
     {}
 
-    ThreshWithData(fastuidraw::PainterAttributeData *d, float t):
-      m_data(d), m_thresh(t)
+    ThreshWithData(fastuidraw::PainterAttributeData *d,
+                   ElementCuller *c, float t):
+      m_data(d), m_culler(c), m_thresh(t)
     {}
 
     static
@@ -727,6 +909,7 @@ namespace
     }
 
     fastuidraw::PainterAttributeData *m_data;
+    ElementCuller *m_culler;
     float m_thresh;
   };
 
@@ -744,18 +927,33 @@ namespace
     const fastuidraw::PainterAttributeData&
     fetch_create(float thresh, std::vector<ThreshWithData> &values);
 
+    /* returns the ElementCuller for join or cap data,
+       returns nullptr if data is not join or cap data
+       of this StrokedPathPrivate.
+     */
+    const ElementCuller*
+    element_culler(const fastuidraw::PainterAttributeData &data);
+
     fastuidraw::vecN<EdgesElement*, 2> m_edge_culler;
     fastuidraw::vecN<fastuidraw::PainterAttributeData, 2> m_edges;
 
     fastuidraw::PainterAttributeData m_bevel_joins, m_miter_joins;
     fastuidraw::PainterAttributeData m_square_caps, m_adjustable_caps;
+    ElementCuller m_bevel_joins_culler, m_miter_joins_culler;
+    ElementCuller m_square_caps_culler, m_adjustable_caps_culler;
     PathData m_path_data;
 
+    /* m_rounded_mutex guards m_rounded_joins and
+       m_rounded_caps which are filled lazily.
+     */
+    fastuidraw::mutex m_rounded_mutex;
     std::vector<ThreshWithData> m_rounded_joins;
     std::vector<ThreshWithData> m_rounded_caps;
 
     bool m_empty_path;
     float m_effective_curve_distance_threshhold;
+
+    fastuidraw::detail::AccountedBytes m_bytes;
   };
 
 }
@@ -1603,11 +1801,355 @@ process_sub_edge(const SingleSubEdge &sub_edge, unsigned int raw_depth,
   vert_offset += EdgesElement::points_per_segment;
 }
 
+/////////////////////////////////////////////////
+// ElementCullingHierarchy methods
+ElementCullingHierarchy::
+ElementCullingHierarchy(fastuidraw::const_c_array<CullableElement> elements,
+                        fastuidraw::range_type<unsigned int> R,
+                        unsigned int &chunk):
+  m_children(nullptr, nullptr),
+  m_elements(R),
+  m_chunk(chunk),
+  m_room_factor(0.0f)
+{
+  assert(R.m_end > R.m_begin);
+  assert(R.m_end <= elements.size());
+
+  ++chunk;
+  if(R.difference() > splitting_threshhold)
+    {
+      unsigned int mid;
+
+      mid = R.m_begin + R.difference() / 2;
+      m_children[0] = FASTUIDRAWnew ElementCullingHierarchy(elements,
+                                                            fastuidraw::range_type<unsigned int>(R.m_begin, mid),
+                                                            chunk);
+      m_children[1] = FASTUIDRAWnew ElementCullingHierarchy(elements,
+                                                            fastuidraw::range_type<unsigned int>(mid, R.m_end),
+                                                            chunk);
+      for(unsigned int c = 0; c < 2; ++c)
+        {
+          m_bb.union_box(m_children[c]->m_bb);
+          m_room_factor = fastuidraw::t_max(m_room_factor, m_children[c]->m_room_factor);
+        }
+    }
+  else
+    {
+      for(unsigned int i = R.m_begin; i < R.m_end; ++i)
+        {
+          m_bb.union_box(elements[i].m_bb);
+          m_room_factor = fastuidraw::t_max(m_room_factor, elements[i].m_room_factor);
+        }
+    }
+}
+
+ElementCullingHierarchy::
+~ElementCullingHierarchy()
+{
+  if(m_children[0] != nullptr)
+    {
+      FASTUIDRAWdelete(m_children[0]);
+    }
+
+  if(m_children[1] != nullptr)
+    {
+      FASTUIDRAWdelete(m_children[1]);
+    }
+}
+
+void
+ElementCullingHierarchy::
+fill_chunks(fastuidraw::const_c_array<CullableElement> elements,
+            fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
+            fastuidraw::c_array<fastuidraw::PainterIndex> index_data,
+            fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
+            fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+            fastuidraw::c_array<int> index_adjusts)
+{
+  const CullableElement &first(elements[m_elements.m_begin]);
+  const CullableElement &last(elements[m_elements.m_end - 1]);
+
+  /* the elements are packed in order, so the
+     data of a range of elements is contiguous.
+   */
+  m_vertex_data_range.m_begin = first.m_vertex_data_range.m_begin;
+  m_vertex_data_range.m_end = last.m_vertex_data_range.m_end;
+  m_index_data_range.m_begin = first.m_index_data_range.m_begin;
+  m_index_data_range.m_end = last.m_index_data_range.m_end;
+
+  attribute_chunks[m_chunk] = attribute_data.sub_array(m_vertex_data_range);
+  index_chunks[m_chunk] = index_data.sub_array(m_index_data_range);
+  index_adjusts[m_chunk] = -int(m_vertex_data_range.m_begin);
+
+  for(unsigned int c = 0; c < 2; ++c)
+    {
+      if(m_children[c] != nullptr)
+        {
+          m_children[c]->fill_chunks(elements, attribute_data, index_data,
+                                     attribute_chunks, index_chunks, index_adjusts);
+        }
+    }
+}
+
+/////////////////////////////////////////////////
+// ElementCuller methods
+ElementCuller::
+ElementCuller(void):
+  m_first_element_chunk(0),
+  m_number_chunks(0),
+  m_hierarchies(nullptr, nullptr)
+{}
+
+ElementCuller::
+~ElementCuller()
+{
+  for(unsigned int i = 0; i < 2; ++i)
+    {
+      if(m_hierarchies[i] != nullptr)
+        {
+          FASTUIDRAWdelete(m_hierarchies[i]);
+        }
+    }
+}
+
+void
+ElementCuller::
+create_hierarchies(unsigned int first_element_chunk,
+                   unsigned int first_node_chunk,
+                   unsigned int number_elements_first_hierarchy)
+{
+  fastuidraw::const_c_array<CullableElement> elements(fastuidraw::make_c_array(m_elements));
+  fastuidraw::vecN<fastuidraw::range_type<unsigned int>, 2> R;
+
+  assert(m_hierarchies[0] == nullptr && m_hierarchies[1] == nullptr);
+  assert(number_elements_first_hierarchy <= elements.size());
+  assert(first_element_chunk + elements.size() <= first_node_chunk);
+
+  m_first_element_chunk = first_element_chunk;
+  m_number_chunks = first_node_chunk;
+
+  R[0] = fastuidraw::range_type<unsigned int>(0, number_elements_first_hierarchy);
+  R[1] = fastuidraw::range_type<unsigned int>(number_elements_first_hierarchy, elements.size());
+  for(unsigned int i = 0; i < 2; ++i)
+    {
+      if(R[i].m_end > R[i].m_begin)
+        {
+          m_hierarchies[i] = FASTUIDRAWnew ElementCullingHierarchy(elements, R[i], m_number_chunks);
+        }
+    }
+}
+
+void
+ElementCuller::
+fill_chunks(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
+            fastuidraw::c_array<fastuidraw::PainterIndex> index_data,
+            fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
+            fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
+            fastuidraw::c_array<int> index_adjusts)
+{
+  for(unsigned int E = 0, endE = m_elements.size(); E < endE; ++E)
+    {
+      const CullableElement &element(m_elements[E]);
+      unsigned int K;
+
+      K = m_first_element_chunk + E;
+      attribute_chunks[K] = attribute_data.sub_array(element.m_vertex_data_range);
+      index_chunks[K] = index_data.sub_array(element.m_index_data_range);
+      index_adjusts[K] = -int(element.m_vertex_data_range.m_begin);
+    }
+
+  for(unsigned int i = 0; i < 2; ++i)
+    {
+      if(m_hierarchies[i] != nullptr)
+        {
+          m_hierarchies[i]->fill_chunks(fastuidraw::make_c_array(m_elements),
+                                        attribute_data, index_data,
+                                        attribute_chunks, index_chunks,
+                                        index_adjusts);
+        }
+    }
+}
+
+unsigned int
+ElementCuller::
+chunks(ScratchSpacePrivate &scratch,
+       fastuidraw::const_c_array<fastuidraw::vec3> clip_equations,
+       const fastuidraw::float3x3 &clip_matrix_local,
+       const fastuidraw::vec2 &recip_dimensions,
+       float pixels_additional_room,
+       float item_space_additional_room,
+       bool include_second_hierarchy,
+       unsigned int max_attribute_cnt,
+       unsigned int max_index_cnt,
+       fastuidraw::c_array<unsigned int> dst) const
+{
+  unsigned int return_value(0u);
+
+  /* The amount of room an element needs is its room factor
+     times the stroking radius; since transforming the clip
+     equations is linear we can compute the clip equations
+     without the room and how much a unit of room pushes
+     them once and then scale per hierarchy node.
+   */
+  scratch.m_clip_eqs_base.resize(clip_equations.size());
+  scratch.m_clip_eqs_room.resize(clip_equations.size());
+  for(unsigned int i = 0; i < clip_equations.size(); ++i)
+    {
+      const fastuidraw::vec3 &c(clip_equations[i]);
+      float f;
+
+      f = fastuidraw::t_abs(c.x()) * recip_dimensions.x()
+        + fastuidraw::t_abs(c.y()) * recip_dimensions.y();
+
+      scratch.m_clip_eqs_base[i] = c * clip_matrix_local;
+      scratch.m_clip_eqs_room[i] = fastuidraw::vec3(0.0f, 0.0f, pixels_additional_room * f) * clip_matrix_local;
+    }
+
+  for(unsigned int i = 0, endi = (include_second_hierarchy) ? 2 : 1; i < endi; ++i)
+    {
+      if(m_hierarchies[i] != nullptr)
+        {
+          chunks_implement(m_hierarchies[i], scratch, item_space_additional_room,
+                           max_attribute_cnt, max_index_cnt,
+                           dst, return_value);
+        }
+    }
+  return return_value;
+}
+
+bool
+ElementCuller::
+intersects(ScratchSpacePrivate &scratch,
+           const fastuidraw::BoundingBox<float> &bb,
+           float room_factor,
+           float item_space_additional_room,
+           bool &unclipped) const
+{
+  using namespace fastuidraw;
+  using namespace fastuidraw::detail;
+
+  vecN<vec2, 4> poly;
+
+  scratch.m_adjusted_clip_eqs.resize(scratch.m_clip_eqs_base.size());
+  for(unsigned int i = 0, endi = scratch.m_clip_eqs_base.size(); i < endi; ++i)
+    {
+      scratch.m_adjusted_clip_eqs[i] = scratch.m_clip_eqs_base[i]
+        + room_factor * scratch.m_clip_eqs_room[i];
+    }
+
+  bb.inflated_polygon(poly, room_factor * item_space_additional_room);
+  unclipped = clip_against_planes(make_c_array(scratch.m_adjusted_clip_eqs),
+                                  poly, scratch.m_clipped_rect,
+                                  scratch.m_clip_scratch_floats,
+                                  scratch.m_clip_scratch_vec2s);
+  return unclipped || !scratch.m_clipped_rect.empty();
+}
+
+void
+ElementCuller::
+chunks_implement(const ElementCullingHierarchy *node,
+                 ScratchSpacePrivate &scratch,
+                 float item_space_additional_room,
+                 unsigned int max_attribute_cnt,
+                 unsigned int max_index_cnt,
+                 fastuidraw::c_array<unsigned int> dst,
+                 unsigned int &current) const
+{
+  bool unclipped;
+
+  if(!intersects(scratch, node->m_bb, node->m_room_factor,
+                 item_space_additional_room, unclipped))
+    {
+      //completely clipped
+      return;
+    }
+
+  if(unclipped)
+    {
+      chunks_take_all(node, max_attribute_cnt, max_index_cnt, dst, current);
+      return;
+    }
+
+  if(node->m_children[0] != nullptr)
+    {
+      assert(node->m_children[1] != nullptr);
+      chunks_implement(node->m_children[0], scratch, item_space_additional_room,
+                       max_attribute_cnt, max_index_cnt, dst, current);
+      chunks_implement(node->m_children[1], scratch, item_space_additional_room,
+                       max_attribute_cnt, max_index_cnt, dst, current);
+    }
+  else
+    {
+      for(unsigned int E = node->m_elements.m_begin; E < node->m_elements.m_end; ++E)
+        {
+          const CullableElement &element(m_elements[E]);
+          if(intersects(scratch, element.m_bb, element.m_room_factor,
+                        item_space_additional_room, unclipped))
+            {
+              add_element_chunk(E, max_attribute_cnt, max_index_cnt, dst, current);
+            }
+        }
+    }
+}
+
+void
+ElementCuller::
+chunks_take_all(const ElementCullingHierarchy *node,
+                unsigned int max_attribute_cnt,
+                unsigned int max_index_cnt,
+                fastuidraw::c_array<unsigned int> dst,
+                unsigned int &current) const
+{
+  if(node->m_vertex_data_range.difference() <= max_attribute_cnt
+     && node->m_index_data_range.difference() <= max_index_cnt)
+    {
+      dst[current] = node->m_chunk;
+      ++current;
+    }
+  else if(node->m_children[0] != nullptr)
+    {
+      assert(node->m_children[1] != nullptr);
+      chunks_take_all(node->m_children[0], max_attribute_cnt, max_index_cnt, dst, current);
+      chunks_take_all(node->m_children[1], max_attribute_cnt, max_index_cnt, dst, current);
+    }
+  else
+    {
+      for(unsigned int E = node->m_elements.m_begin; E < node->m_elements.m_end; ++E)
+        {
+          add_element_chunk(E, max_attribute_cnt, max_index_cnt, dst, current);
+        }
+    }
+}
+
+void
+ElementCuller::
+add_element_chunk(unsigned int E,
+                  unsigned int max_attribute_cnt,
+                  unsigned int max_index_cnt,
+                  fastuidraw::c_array<unsigned int> dst,
+                  unsigned int &current) const
+{
+  const CullableElement &element(m_elements[E]);
+
+  FASTUIDRAWunused(max_attribute_cnt);
+  FASTUIDRAWunused(max_index_cnt);
+  assert(element.m_vertex_data_range.difference() <= max_attribute_cnt
+         && element.m_index_data_range.difference() <= max_index_cnt
+         && "StrokedPath: join or cap has too many attribute and indices");
+
+  if(element.m_index_data_range.difference() > 0)
+    {
+      dst[current] = m_first_element_chunk + E;
+      ++current;
+    }
+}
+
 /////////////////////////////////////////////////
 // JoinCreatorBase methods
 JoinCreatorBase::
-JoinCreatorBase(const PathData &P):
+JoinCreatorBase(const PathData &P, ElementCuller &culler):
   m_P(P),
+  m_culler(culler),
   m_num_non_closed_verts(0u),
   m_num_non_closed_indices(0u),
   m_num_closed_verts(0u),
@@ -1631,6 +2173,10 @@ post_ctor_initalize(void)
                    m_P.m_per_contour_data[o].edge_data(e - 1).m_end_normal,
                    m_P.m_per_contour_data[o].edge_data(e).m_begin_normal,
                    o, e, m_num_non_closed_verts, m_num_non_closed_indices);
+
+          add_cullable_element(m_P.m_per_contour_data[o].edge_data(e - 1).m_end_normal,
+                               m_P.m_per_contour_data[o].edge_data(e).m_begin_normal,
+                               o, e);
         }
     }
 
@@ -1646,15 +2192,42 @@ post_ctor_initalize(void)
                    o, m_P.number_edges(o) - 1,
                    m_num_closed_verts, m_num_closed_indices);
 
+          add_cullable_element(m_P.m_per_contour_data[o].edge_data(m_P.number_edges(o) - 2).m_end_normal,
+                               m_P.m_per_contour_data[o].edge_data(m_P.number_edges(o) - 1).m_begin_normal,
+                               o, m_P.number_edges(o) - 1);
+
           add_join(m_num_joins + 1, m_P,
                    m_P.m_per_contour_data[o].m_edge_data_store.back().m_end_normal,
                    m_P.m_per_contour_data[o].m_edge_data_store.front().m_begin_normal,
                    o, m_P.number_edges(o),
                    m_num_closed_verts, m_num_closed_indices);
 
+          add_cullable_element(m_P.m_per_contour_data[o].m_edge_data_store.back().m_end_normal,
+                               m_P.m_per_contour_data[o].m_edge_data_store.front().m_begin_normal,
+                               o, m_P.number_edges(o));
+
           m_num_joins += 2;
         }
     }
+
+  assert(m_culler.m_elements.size() == m_num_joins);
+  m_culler.create_hierarchies(fastuidraw::StrokedPath::join_chunk_start_individual_joins,
+                              fastuidraw::StrokedPath::join_chunk_start_individual_joins + m_num_joins,
+                              m_num_joins_without_closing_edge);
+}
+
+void
+JoinCreatorBase::
+add_cullable_element(const fastuidraw::vec2 &n0_from_stroking,
+                     const fastuidraw::vec2 &n1_from_stroking,
+                     unsigned int contour, unsigned int edge)
+{
+  CullableElement element;
+
+  element.m_bb.union_point(m_P.m_per_contour_data[contour].edge_data(edge - 1).m_end_pt.m_p);
+  element.m_bb.union_point(m_P.m_per_contour_data[contour].edge_data(edge).m_start_pt.m_p);
+  element.m_room_factor = room_factor(n0_from_stroking, n1_from_stroking);
+  m_culler.m_elements.push_back(element);
 }
 
 void
@@ -1668,7 +2241,7 @@ compute_sizes(unsigned int &num_attributes,
   assert(m_post_ctor_initalized_called);
   num_attributes = m_num_non_closed_verts + m_num_closed_verts;
   num_indices = m_num_non_closed_indices + m_num_closed_indices;
-  num_attribute_chunks = num_index_chunks = m_num_joins + 2;
+  num_attribute_chunks = num_index_chunks = m_culler.number_chunks();
   number_z_increments = 2;
 }
 
@@ -1678,22 +2251,20 @@ fill_join(unsigned int join_id,
           unsigned int contour, unsigned int edge,
           fastuidraw::c_array<fastuidraw::PainterAttribute> pts,
           fastuidraw::c_array<unsigned int> indices,
-          unsigned int &vertex_offset, unsigned int &index_offset,
-          fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterAttribute> > attribute_chunks,
-          fastuidraw::c_array<fastuidraw::const_c_array<fastuidraw::PainterIndex> > index_chunks,
-          fastuidraw::c_array<int> index_adjusts) const
+          unsigned int &vertex_offset, unsigned int &index_offset) const
 {
   unsigned int v(vertex_offset), i(index_offset);
-  unsigned int depth, K;
+  unsigned int depth;
 
   assert(join_id < m_num_joins);
   depth = m_num_joins - 1 - join_id;
   fill_join_implement(join_id, m_P, contour, edge, pts, depth, indices, vertex_offset, index_offset);
 
-  K = join_id + fastuidraw::StrokedPath::join_chunk_start_individual_joins;
-  attribute_chunks[K] = pts.sub_array(v, vertex_offset - v);
-  index_chunks[K] = indices.sub_array(i, index_offset - i);
-  index_adjusts[K] = -int(v);
+  /* the chunk of the join is set by m_culler.fill_chunks()
+   */
+  m_culler.set_element_data(join_id,
+                            fastuidraw::range_type<unsigned int>(v, vertex_offset),
+                            fastuidraw::range_type<unsigned int>(i, index_offset));
 }
 
 void
@@ -1726,9 +2297,7 @@ fill_data(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
         {
           fill_join(join_id, o, e,
                     attribute_data, index_data,
-                    vertex_offset, index_offset,
-                    attribute_chunks, index_chunks,
-                    index_adjusts);
+                    vertex_offset, index_offset);
         }
     }
   assert(vertex_offset == m_num_non_closed_verts);
@@ -1740,21 +2309,21 @@ fill_data(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
         {
           fill_join(join_id, o, m_P.number_edges(o) - 1,
                     attribute_data, index_data,
-                    vertex_offset, index_offset,
-                    attribute_chunks, index_chunks,
-                    index_adjusts);
+                    vertex_offset, index_offset);
 
           fill_join(join_id + 1, o, m_P.number_edges(o),
                     attribute_data, index_data,
-                    vertex_offset, index_offset,
-                    attribute_chunks, index_chunks,
-                    index_adjusts);
+                    vertex_offset, index_offset);
 
           join_id += 2;
         }
     }
   assert(vertex_offset == m_num_non_closed_verts + m_num_closed_verts);
   assert(index_offset == m_num_non_closed_indices + m_num_closed_indices);
+
+  m_culler.fill_chunks(attribute_data, index_data,
+                       attribute_chunks, index_chunks,
+                       index_adjusts);
 }
 
 
@@ -1882,8 +2451,8 @@ add_data(unsigned int depth,
 ///////////////////////////////////////////////////
 // RoundedJoinCreator methods
 RoundedJoinCreator::
-RoundedJoinCreator(const PathData &P, float thresh):
-  JoinCreatorBase(P),
+RoundedJoinCreator(const PathData &P, float thresh, ElementCuller &culler):
+  JoinCreatorBase(P, culler),
   m_thresh(thresh)
 {
   JoinCount J(P);
@@ -1936,8 +2505,8 @@ fill_join_implement(unsigned int join_id,
 ///////////////////////////////////////////////////
 // BevelJoinCreator methods
 BevelJoinCreator::
-BevelJoinCreator(const PathData &P):
-  JoinCreatorBase(P)
+BevelJoinCreator(const PathData &P, ElementCuller &culler):
+  JoinCreatorBase(P, culler)
 {
   post_ctor_initalize();
 }
@@ -2030,12 +2599,40 @@ fill_join_implement(unsigned int join_id,
 ///////////////////////////////////////////////////
 // MiterJoinCreator methods
 MiterJoinCreator::
-MiterJoinCreator(const PathData &P):
-  JoinCreatorBase(P)
+MiterJoinCreator(const PathData &P, ElementCuller &culler):
+  JoinCreatorBase(P, culler)
 {
   post_ctor_initalize();
 }
 
+float
+MiterJoinCreator::
+room_factor(const fastuidraw::vec2 &n0_from_stroking,
+            const fastuidraw::vec2 &n1_from_stroking) const
+{
+  /* The miter point is offset from the join by
+     sqrt(1 + r * r) times the stroking radius
+     where r is as in StrokedPath::point::offset_vector();
+     the miter limit can only make the offset smaller.
+     When the join (nearly) reverses direction, r is
+     unbounded; we then give a very large factor so that
+     the join is essentially never culled.
+   */
+  const float max_factor(1e6f);
+  fastuidraw::vec2 v0(-n0_from_stroking.y(), n0_from_stroking.x());
+  float numer, denom, r;
+
+  numer = fastuidraw::dot(n0_from_stroking, n1_from_stroking) - 1.0f;
+  denom = fastuidraw::dot(v0, n1_from_stroking);
+  if(fastuidraw::t_abs(numer) >= max_factor * fastuidraw::t_abs(denom))
+    {
+      return (fastuidraw::t_abs(numer) > 1e-6f) ? max_factor : 1.0f;
+    }
+
+  r = numer / denom;
+  return std::sqrt(1.0f + r * r);
+}
+
 void
 MiterJoinCreator::
 add_join(unsigned int join_id,
@@ -2185,10 +2782,30 @@ fill_join_implement(unsigned int join_id,
 ///////////////////////////////////////////////
 // CapCreatorBase methods
 CapCreatorBase::
-CapCreatorBase(const PathData &P, PointIndexCapSize sz):
+CapCreatorBase(const PathData &P, PointIndexCapSize sz,
+               float room_factor, ElementCuller &culler):
   m_P(P),
-  m_size(sz)
-{}
+  m_size(sz),
+  m_culler(culler)
+{
+  /* chunk 0 holds all the caps, chunk 1 + C holds the cap C
+     where the caps are ordered as start then end cap of
+     each contour.
+   */
+  m_culler.m_elements.resize(2 * m_P.number_contours());
+  for(unsigned int o = 0; o < m_P.number_contours(); ++o)
+    {
+      CullableElement &start_cap(m_culler.m_elements[2 * o]);
+      CullableElement &end_cap(m_culler.m_elements[2 * o + 1]);
+
+      start_cap.m_bb.union_point(m_P.m_per_contour_data[o].m_start_contour_pt.m_p);
+      start_cap.m_room_factor = room_factor;
+      end_cap.m_bb.union_point(m_P.m_per_contour_data[o].m_end_contour_pt.m_p);
+      end_cap.m_room_factor = room_factor;
+    }
+  m_culler.create_hierarchies(1, 1 + m_culler.m_elements.size(),
+                              m_culler.m_elements.size());
+}
 
 void
 CapCreatorBase::
@@ -2200,7 +2817,8 @@ compute_sizes(unsigned int &num_attributes,
 {
   num_attributes = m_size.m_verts;
   num_indices = m_size.m_indices;
-  number_z_increments = num_attribute_chunks = num_index_chunks = 1;
+  number_z_increments = 1;
+  num_attribute_chunks = num_index_chunks = m_culler.number_chunks();
 }
 
 void
@@ -2217,16 +2835,26 @@ fill_data(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
   depth = 2 * m_P.number_contours();
   for(unsigned int o = 0; o < m_P.number_contours(); ++o, depth -= 2u)
     {
+      unsigned int v(vertex_offset), i(index_offset);
+
       assert(depth >= 2);
       add_cap(m_P.m_per_contour_data[o].m_begin_cap_normal,
               true, depth - 1, m_P.m_per_contour_data[o].m_start_contour_pt,
               attribute_data, index_data,
               vertex_offset, index_offset);
+      m_culler.set_element_data(2 * o,
+                                fastuidraw::range_type<unsigned int>(v, vertex_offset),
+                                fastuidraw::range_type<unsigned int>(i, index_offset));
 
+      v = vertex_offset;
+      i = index_offset;
       add_cap(m_P.m_per_contour_data[o].m_end_cap_normal,
               false, depth - 2, m_P.m_per_contour_data[o].m_end_contour_pt,
               attribute_data, index_data,
               vertex_offset, index_offset);
+      m_culler.set_element_data(2 * o + 1,
+                                fastuidraw::range_type<unsigned int>(v, vertex_offset),
+                                fastuidraw::range_type<unsigned int>(i, index_offset));
     }
 
   assert(vertex_offset == m_size.m_verts);
@@ -2235,13 +2863,17 @@ fill_data(fastuidraw::c_array<fastuidraw::PainterAttribute> attribute_data,
   index_chunks[0] = index_data;
   zincrements[0] = 2 * m_P.number_contours();
   index_adjusts[0] = 0;
+
+  m_culler.fill_chunks(attribute_data, index_data,
+                       attribute_chunks, index_chunks,
+                       index_adjusts);
 }
 
 ///////////////////////////////////////////////////
 // RoundedCapCreator methods
 RoundedCapCreator::
-RoundedCapCreator(const PathData &P, float thresh):
-  CapCreatorBase(P, compute_size(P, thresh))
+RoundedCapCreator(const PathData &P, float thresh, ElementCuller &culler):
+  CapCreatorBase(P, compute_size(P, thresh), 1.0f, culler)
 {
   m_num_arc_points_per_cap = fastuidraw::detail::number_segments_for_tessellation(M_PI, thresh);
   m_delta_theta = static_cast<float>(M_PI) / static_cast<float>(m_num_arc_points_per_cap - 1);
@@ -2568,17 +3200,24 @@ add_cap(const fastuidraw::vec2 &normal_from_stroking,
 /////////////////////////////////////////////
 // StrokedPathPrivate methods
 StrokedPathPrivate::
-StrokedPathPrivate(const fastuidraw::TessellatedPath &P)
+StrokedPathPrivate(const fastuidraw::TessellatedPath &P):
+  m_bytes(fastuidraw::memory_accounting::stroked_path_data)
 {
   if(!P.point_data().empty())
     {
       m_empty_path = false;
       create_edges(P);
-      m_bevel_joins.set_data(BevelJoinCreator(m_path_data));
-      m_miter_joins.set_data(MiterJoinCreator(m_path_data));
-      m_square_caps.set_data(SquareCapCreator(m_path_data));
-      m_adjustable_caps.set_data(AdjustableCapCreator(m_path_data));
+      m_bevel_joins.set_data(BevelJoinCreator(m_path_data, m_bevel_joins_culler));
+      m_miter_joins.set_data(MiterJoinCreator(m_path_data, m_miter_joins_culler));
+      m_square_caps.set_data(SquareCapCreator(m_path_data, m_square_caps_culler));
+      m_adjustable_caps.set_data(AdjustableCapCreator(m_path_data, m_adjustable_caps_culler));
       m_effective_curve_distance_threshhold = P.effective_curve_distance_threshhold();
+      m_bytes.bytes(fastuidraw::detail::attribute_data_bytes(m_edges[0])
+                    + fastuidraw::detail::attribute_data_bytes(m_edges[1])
+                    + fastuidraw::detail::attribute_data_bytes(m_bevel_joins)
+                    + fastuidraw::detail::attribute_data_bytes(m_miter_joins)
+                    + fastuidraw::detail::attribute_data_bytes(m_square_caps)
+                    + fastuidraw::detail::attribute_data_bytes(m_adjustable_caps));
     }
   else
     {
@@ -2593,11 +3232,13 @@ StrokedPathPrivate::
   for(unsigned int i = 0, endi = m_rounded_joins.size(); i < endi; ++i)
     {
       FASTUIDRAWdelete(m_rounded_joins[i].m_data);
+      FASTUIDRAWdelete(m_rounded_joins[i].m_culler);
     }
 
   for(unsigned int i = 0, endi = m_rounded_caps.size(); i < endi; ++i)
     {
       FASTUIDRAWdelete(m_rounded_caps[i].m_data);
+      FASTUIDRAWdelete(m_rounded_caps[i].m_culler);
     }
 
   if(!m_empty_path)
@@ -2631,12 +3272,17 @@ const fastuidraw::PainterAttributeData&
 StrokedPathPrivate::
 fetch_create(float thresh, std::vector<ThreshWithData> &values)
 {
+  fastuidraw::autolock_mutex M(m_rounded_mutex);
   if(values.empty())
     {
       fastuidraw::PainterAttributeData *newD;
+      ElementCuller *newC;
+
       newD = FASTUIDRAWnew fastuidraw::PainterAttributeData();
-      newD->set_data(T(m_path_data, 1.0f));
-      values.push_back(ThreshWithData(newD, 1.0f));
+      newC = FASTUIDRAWnew ElementCuller();
+      newD->set_data(T(m_path_data, 1.0f, *newC));
+      values.push_back(ThreshWithData(newD, newC, 1.0f));
+      m_bytes.add(fastuidraw::detail::attribute_data_bytes(*newD));
     }
 
   /* we set a hard tolerance of 1e-6. Should we
@@ -2661,16 +3307,63 @@ fetch_create(float thresh, std::vector<ThreshWithData> &values)
       while(t > thresh)
         {
           fastuidraw::PainterAttributeData *newD;
+          ElementCuller *newC;
 
           t *= 0.5f;
           newD = FASTUIDRAWnew fastuidraw::PainterAttributeData();
-          newD->set_data(T(m_path_data, t));
-          values.push_back(ThreshWithData(newD, t));
+          newC = FASTUIDRAWnew ElementCuller();
+          newD->set_data(T(m_path_data, t, *newC));
+          values.push_back(ThreshWithData(newD, newC, t));
+          m_bytes.add(fastuidraw::detail::attribute_data_bytes(*newD));
         }
       return *values.back().m_data;
     }
 }
 
+const ElementCuller*
+StrokedPathPrivate::
+element_culler(const fastuidraw::PainterAttributeData &data)
+{
+  if(&data == &m_bevel_joins)
+    {
+      return &m_bevel_joins_culler;
+    }
+
+  if(&data == &m_miter_joins)
+    {
+      return &m_miter_joins_culler;
+    }
+
+  if(&data == &m_square_caps)
+    {
+      return &m_square_caps_culler;
+    }
+
+  if(&data == &m_adjustable_caps)
+    {
+      return &m_adjustable_caps_culler;
+    }
+
+  fastuidraw::autolock_mutex M(m_rounded_mutex);
+  for(unsigned int i = 0, endi = m_rounded_joins.size(); i < endi; ++i)
+    {
+      if(&data == m_rounded_joins[i].m_data)
+        {
+          return m_rounded_joins[i].m_culler;
+        }
+    }
+
+  for(unsigned int i = 0, endi = m_rounded_caps.size(); i < endi; ++i)
+    {
+      if(&data == m_rounded_caps[i].m_data)
+        {
+          return m_rounded_caps[i].m_culler;
+        }
+    }
+
+  return nullptr;
+}
+
 //////////////////////////////////////
 // fastuidraw::StrokedPath::point methods
 void
@@ -2829,6 +3522,8 @@ chunk_for_named_join(unsigned int J)
 fastuidraw::StrokedPath::
 StrokedPath(const fastuidraw::TessellatedPath &P)
 {
+  FASTUIDRAWtrace_zone("StrokedPath::StrokedPath");
+
   assert(number_offset_types < FASTUIDRAW_MAX_VALUE_FROM_NUM_BITS(offset_type_num_bits));
   m_d = FASTUIDRAWnew StrokedPathPrivate(P);
 }
@@ -2969,3 +3664,72 @@ rounded_caps(float thresh) const
     d->fetch_create<RoundedCapCreator>(thresh, d->m_rounded_caps) :
     d->m_square_caps;
 }
+
+unsigned int
+fastuidraw::StrokedPath::
+join_chunks(ScratchSpace &work_room,
+            const PainterAttributeData &join_data,
+            const_c_array<vec3> clip_equations,
+            const float3x3 &clip_matrix_local,
+            const vec2 &recip_dimensions,
+            float pixels_additional_room,
+            float item_space_additional_room,
+            bool include_closing_edges,
+            unsigned int max_attribute_cnt,
+            unsigned int max_index_cnt,
+            c_array<unsigned int> dst) const
+{
+  StrokedPathPrivate *d;
+  const ElementCuller *e;
+
+  d = static_cast<StrokedPathPrivate*>(m_d);
+  e = d->element_culler(join_data);
+  if(e == nullptr)
+    {
+      assert(!"StrokedPath::join_chunks() passed join data not from the StrokedPath");
+      dst[0] = include_closing_edges ?
+        join_chunk_with_closing_edge :
+        join_chunk_without_closing_edge;
+      return 1;
+    }
+
+  return e->chunks(*static_cast<ScratchSpacePrivate*>(work_room.m_d),
+                   clip_equations, clip_matrix_local,
+                   recip_dimensions, pixels_additional_room,
+                   item_space_additional_room, include_closing_edges,
+                   max_attribute_cnt, max_index_cnt,
+                   dst);
+}
+
+unsigned int
+fastuidraw::StrokedPath::
+cap_chunks(ScratchSpace &work_room,
+           const PainterAttributeData &cap_data,
+           const_c_array<vec3> clip_equations,
+           const float3x3 &clip_matrix_local,
+           const vec2 &recip_dimensions,
+           float pixels_additional_room,
+           float item_space_additional_room,
+           unsigned int max_attribute_cnt,
+           unsigned int max_index_cnt,
+           c_array<unsigned int> dst) const
+{
+  StrokedPathPrivate *d;
+  const ElementCuller *e;
+
+  d = static_cast<StrokedPathPrivate*>(m_d);
+  e = d->element_culler(cap_data);
+  if(e == nullptr)
+    {
+      assert(!"StrokedPath::cap_chunks() passed cap data not from the StrokedPath");
+      dst[0] = 0;
+      return 1;
+    }
+
+  return e->chunks(*static_cast<ScratchSpacePrivate*>(work_room.m_d),
+                   clip_equations, clip_matrix_local,
+                   recip_dimensions, pixels_additional_room,
+                   item_space_additional_room, false,
+                   max_attribute_cnt, max_index_cnt,
+                   dst);
+}
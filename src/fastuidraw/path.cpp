@@ -20,11 +20,13 @@
 #include <algorithm>
 #include <cmath>
 #include <vector>
+#include <deque>
 #include <iostream>
 #include <fastuidraw/path.hpp>
 #include <fastuidraw/tessellated_path.hpp>
 #include "private/util_private.hpp"
 #include "private/path_util_private.hpp"
+#include "private/memory_accounting_private.hpp"
 
 namespace
 {
@@ -299,6 +301,118 @@ namespace
     bool m_is_flat;
   };
 
+  /* TessellationLODs holds the TessellatedPath objects
+     of a Path. It is reference counted so that it can be
+     shared between copies of a Path and with the tasks
+     that prefetch a level of detail; when a Path changes
+     its geometry it drops its TessellationLODs for a new
+     one.
+   */
+  class TessellationLODs:
+    public fastuidraw::reference_counted<TessellationLODs>::default_base,
+    public fastuidraw::detail::EvictableCache
+  {
+  public:
+    typedef fastuidraw::TessellatedPath TessellatedPath;
+    typedef fastuidraw::reference_counted_ptr<const TessellatedPath> tessellated_path_ref;
+
+    TessellationLODs(void):
+      fastuidraw::detail::EvictableCache(1u << fastuidraw::memory_accounting::tessellation),
+      m_done(false),
+      m_number_prefetches(0),
+      m_finest_prefetch(0.0f)
+    {
+      register_cache();
+    }
+
+    ~TessellationLODs()
+    {
+      unregister_cache();
+    }
+
+    /* drops all levels of detail except the coarsest,
+       which tessellation(float) const returns for
+       a non-positive threshhold; does nothing and
+       returns false while a prefetch is pending.
+     */
+    virtual
+    bool
+    evict(enum fastuidraw::memory_accounting::category_t c);
+
+    /* returns the level of detail for thresh, constructing
+       TessellatedPath objects as needed.
+     */
+    const tessellated_path_ref&
+    fetch(const fastuidraw::Path &path, float thresh);
+
+    /* returns the level of detail for thresh if it is already
+       constructed, otherwise returns the finest level of detail
+       that is constructed (which may be nullptr).
+     */
+    tessellated_path_ref
+    cached(const fastuidraw::Path &path, float thresh, bool *out_is_match);
+
+    /* returns true if a prefetch for thresh is to be started;
+       returns false if the level of detail is already made or
+       a prefetch of at least that level of detail is pending.
+     */
+    bool
+    begin_prefetch(const fastuidraw::Path &path, float thresh);
+
+    void
+    end_prefetch(void);
+
+  private:
+    /* must be called with m_mutex locked; returns nullptr
+       if the level of detail needs to be constructed.
+     */
+    const tessellated_path_ref*
+    find(const fastuidraw::Path &path, float thresh);
+
+    /* m_mutex guards m_lods, m_done and the prefetch values.
+       m_construct_mutex is held by a thread constructing
+       TessellatedPath objects so that only one thread at
+       a time does so; readers of already constructed levels
+       of detail only lock m_mutex.
+     */
+    fastuidraw::mutex m_mutex, m_construct_mutex;
+
+    /* m_lods are gauranteed to be sorted from lowest to highest LOD.
+       A std::deque is used because push_back() does not invalidate
+       references to the elements.
+     */
+    std::deque<tessellated_path_ref> m_lods;
+    bool m_done;
+
+    unsigned int m_number_prefetches;
+    float m_finest_prefetch;
+  };
+
+  class TessellationPrefetchTask:public fastuidraw::TaskPool::Task
+  {
+  public:
+    TessellationPrefetchTask(const fastuidraw::Path &path,
+                             const fastuidraw::reference_counted_ptr<TessellationLODs> &lods,
+                             float thresh, bool with_filled, bool with_stroked):
+      m_path(path),
+      m_lods(lods),
+      m_thresh(thresh),
+      m_with_filled(with_filled),
+      m_with_stroked(with_stroked)
+    {}
+
+  protected:
+    virtual
+    void
+    run_task(void);
+
+  private:
+    fastuidraw::Path m_path;
+    fastuidraw::reference_counted_ptr<TessellationLODs> m_lods;
+    float m_thresh;
+    bool m_with_filled, m_with_stroked;
+  };
+
   class PathPrivate
   {
   public:
@@ -306,7 +420,6 @@ namespace
     typedef fastuidraw::reference_counted_ptr<const TessellatedPath> tessellated_path_ref;
 
     PathPrivate(void):
-      m_tessellation_done(false),
       m_start_check_bb(0),
       m_is_flat(true)
     {}
@@ -318,7 +431,6 @@ namespace
     {
       assert(!m_contours.empty());
       m_tessellation.clear();
-      m_tessellation_done = false;
       return m_contours.back();
     }
 
@@ -327,7 +439,6 @@ namespace
     {
       bool last_contour_flat;
       m_tessellation.clear();
-      m_tessellation_done = false;
 
       last_contour_flat = m_contours.empty() || m_contours.back()->is_flat();
       m_is_flat = m_is_flat && last_contour_flat;
@@ -337,10 +448,16 @@ namespace
 
     std::vector<fastuidraw::reference_counted_ptr<fastuidraw::PathContour> > m_contours;
 
-    /* m_tessellation are gauranteed to be sorted from lowest to highest LOD.
+    /* returns m_tessellation, creating it if necessary.
      */
-    std::vector<tessellated_path_ref> m_tessellation;
-    bool m_tessellation_done;
+    fastuidraw::reference_counted_ptr<TessellationLODs>
+    tessellation_lods(void);
+
+    /* m_tessellation is created lazily, m_tessellation_mutex
+       guards its creation.
+     */
+    fastuidraw::mutex m_tessellation_mutex;
+    fastuidraw::reference_counted_ptr<TessellationLODs> m_tessellation;
 
     /* m_start_check_bb gives the index into m_contours that
        have not had their bounding box absorbed into
@@ -353,7 +470,7 @@ namespace
 
   inline
   bool
-  reverse_compare_curve_distance_thresh(const PathPrivate::tessellated_path_ref &lhs,
+  reverse_compare_curve_distance_thresh(const TessellationLODs::tessellated_path_ref &lhs,
                                         float rhs)
   {
     return lhs->effective_curve_distance_threshhold() > rhs;
@@ -1501,13 +1618,235 @@ approximate_bounding_box(vec2 *out_min_bb, vec2 *out_max_bb) const
   return true;
 }
 
+/////////////////////////////////
+// TessellationLODs methods
+const TessellationLODs::tessellated_path_ref*
+TessellationLODs::
+find(const fastuidraw::Path &path, float thresh)
+{
+  if(m_lods.empty())
+    {
+      return nullptr;
+    }
+
+  if(thresh <= 0.0f || path.is_flat())
+    {
+      return &m_lods.front();
+    }
+
+  if(m_lods.back()->effective_curve_distance_threshhold() <= thresh)
+    {
+      std::deque<tessellated_path_ref>::const_iterator iter;
+      iter = std::lower_bound(m_lods.begin(), m_lods.end(),
+                              thresh, reverse_compare_curve_distance_thresh);
+
+      assert(iter != m_lods.end());
+      assert(*iter);
+      assert((*iter)->effective_curve_distance_threshhold() <= thresh);
+      return &*iter;
+    }
+
+  if(m_done)
+    {
+      return &m_lods.back();
+    }
+
+  return nullptr;
+}
+
+const TessellationLODs::tessellated_path_ref&
+TessellationLODs::
+fetch(const fastuidraw::Path &path, float thresh)
+{
+  const tessellated_path_ref *p;
+
+  touch();
+  {
+    fastuidraw::autolock_mutex M(m_mutex);
+    p = find(path, thresh);
+    if(p)
+      {
+        return *p;
+      }
+  }
+
+  fastuidraw::autolock_mutex C(m_construct_mutex);
+  tessellated_path_ref ref;
+  TessellatedPath::TessellationParams params;
+  bool done(false);
+
+  {
+    /* another thread may have constructed what is
+       needed while we waited on m_construct_mutex.
+     */
+    fastuidraw::autolock_mutex M(m_mutex);
+    p = find(path, thresh);
+    if(p)
+      {
+        return *p;
+      }
+
+    if(!m_lods.empty())
+      {
+        ref = m_lods.back();
+      }
+  }
+
+  if(!ref)
+    {
+      ref = FASTUIDRAWnew TessellatedPath(path, params);
+
+      fastuidraw::autolock_mutex M(m_mutex);
+      m_lods.push_back(ref);
+      p = find(path, thresh);
+      if(p)
+        {
+          return *p;
+        }
+    }
+
+  params
+    .max_segments(2 * ref->max_segments())
+    .curve_distance_tessellate(ref->effective_curve_distance_threshhold());
+
+  while(!done && ref->effective_curve_distance_threshhold() > thresh)
+    {
+      float last_tess;
+
+      params.m_threshhold *= 0.5f;
+      last_tess = ref->effective_curve_distance_threshhold();
+      ref = FASTUIDRAWnew TessellatedPath(path, params);
+      done = (last_tess <= ref->effective_curve_distance_threshhold());
+
+      while(!done && ref->effective_curve_distance_threshhold() > params.m_threshhold)
+        {
+          params.m_max_segments *= 2;
+          last_tess = ref->effective_curve_distance_threshhold();
+          ref = FASTUIDRAWnew TessellatedPath(path, params);
+          done = (last_tess <= ref->effective_curve_distance_threshhold());
+        }
+
+      /* each level of detail is made visible to other
+         threads as soon as it is constructed.
+       */
+      fastuidraw::autolock_mutex M(m_mutex);
+      m_lods.push_back(ref);
+      m_done = done;
+    }
+
+  fastuidraw::autolock_mutex M(m_mutex);
+  return m_lods.back();
+}
+
+TessellationLODs::tessellated_path_ref
+TessellationLODs::
+cached(const fastuidraw::Path &path, float thresh, bool *out_is_match)
+{
+  fastuidraw::autolock_mutex M(m_mutex);
+  const tessellated_path_ref *p;
+
+  touch();
+  p = find(path, thresh);
+  if(out_is_match)
+    {
+      *out_is_match = (p != nullptr);
+    }
+
+  if(p)
+    {
+      return *p;
+    }
+  return m_lods.empty() ? tessellated_path_ref() : m_lods.back();
+}
+
+bool
+TessellationLODs::
+begin_prefetch(const fastuidraw::Path &path, float thresh)
+{
+  fastuidraw::autolock_mutex M(m_mutex);
+
+  if(find(path, thresh) != nullptr
+     || (m_number_prefetches > 0 && m_finest_prefetch <= thresh))
+    {
+      return false;
+    }
+
+  m_finest_prefetch = (m_number_prefetches > 0) ?
+    fastuidraw::t_min(m_finest_prefetch, thresh) :
+    thresh;
+  ++m_number_prefetches;
+  return true;
+}
+
+void
+TessellationLODs::
+end_prefetch(void)
+{
+  fastuidraw::autolock_mutex M(m_mutex);
+  assert(m_number_prefetches > 0);
+  --m_number_prefetches;
+}
+
+bool
+TessellationLODs::
+evict(enum fastuidraw::memory_accounting::category_t c)
+{
+  std::vector<tessellated_path_ref> evicted;
+
+  assert(c == fastuidraw::memory_accounting::tessellation);
+  FASTUIDRAWunused(c);
+
+  /* skip if a thread is constructing levels of detail */
+  if(!m_construct_mutex.try_lock())
+    {
+      return false;
+    }
+
+  m_mutex.lock();
+  if(m_lods.size() > 1 && m_number_prefetches == 0)
+    {
+      evicted.assign(m_lods.begin() + 1, m_lods.end());
+      m_lods.resize(1);
+      m_done = false;
+    }
+  m_mutex.unlock();
+  m_construct_mutex.unlock();
+
+  /* the TessellatedPath objects are released (and
+     possibly destroyed) with the locks released.
+   */
+  return !evicted.empty();
+}
+
+///////////////////////////////////////
+// TessellationPrefetchTask methods
+void
+TessellationPrefetchTask::
+run_task(void)
+{
+  /* hold a handle rather than a reference into m_lods,
+     which evict() may shrink from another thread.
+   */
+  TessellationLODs::tessellated_path_ref tess(m_lods->fetch(m_path, m_thresh));
+
+  if(m_with_filled)
+    {
+      tess->filled();
+    }
+
+  if(m_with_stroked)
+    {
+      tess->stroked();
+    }
+  m_lods->end_prefetch();
+}
+
 /////////////////////////////////
 // PathPrivate methods
 PathPrivate::
 PathPrivate(const PathPrivate &obj):
   m_contours(obj.m_contours),
   m_tessellation(obj.m_tessellation),
-  m_tessellation_done(obj.m_tessellation_done),
   m_start_check_bb(obj.m_start_check_bb),
   m_max_bb(obj.m_max_bb),
   m_min_bb(obj.m_min_bb),
@@ -1516,13 +1855,25 @@ PathPrivate(const PathPrivate &obj):
   /* if the last contour is not ended, we need to do a
      deep copy on it.
    */
-  if(!m_contours.back()->ended())
+  if(!m_contours.empty() && !m_contours.back()->ended())
     {
       m_contours.back() = m_contours.back()->deep_copy();
       m_is_flat = m_is_flat && m_contours.back()->is_flat();
     }
 }
 
+fastuidraw::reference_counted_ptr<TessellationLODs>
+PathPrivate::
+tessellation_lods(void)
+{
+  fastuidraw::autolock_mutex M(m_tessellation_mutex);
+  if(!m_tessellation)
+    {
+      m_tessellation = FASTUIDRAWnew TessellationLODs();
+    }
+  return m_tessellation;
+}
+
 /////////////////////////////////////////
 // fastuidraw::Path methods
 fastuidraw::Path::
@@ -1585,7 +1936,6 @@ clear(void)
   d = static_cast<PathPrivate*>(m_d);
   d->m_tessellation.clear();
   d->m_contours.clear();
-  d->m_tessellation_done = false;
   d->m_start_check_bb = 0u;
 }
 
@@ -1714,78 +2064,36 @@ tessellation(float thresh) const
   PathPrivate *d;
   d = static_cast<PathPrivate*>(m_d);
 
-  if(d->m_tessellation.empty())
-    {
-      PathPrivate::tessellated_path_ref ref;
-      TessellatedPath::TessellationParams params;
-      ref = FASTUIDRAWnew TessellatedPath(*this, params);
-      d->m_tessellation.push_back(ref);
-    }
+  /* the TessellationLODs object stays alive as long as this
+     Path does not change, so the reference returned by
+     fetch() remains valid after the local handle is gone.
+   */
+  return d->tessellation_lods()->fetch(*this, thresh);
+}
 
-  if(thresh <= 0.0f || is_flat())
-    {
-      return d->m_tessellation.front();
-    }
+fastuidraw::reference_counted_ptr<const fastuidraw::TessellatedPath>
+fastuidraw::Path::
+cached_tessellation(float thresh, bool *out_is_match) const
+{
+  PathPrivate *d;
+  d = static_cast<PathPrivate*>(m_d);
+  return d->tessellation_lods()->cached(*this, thresh, out_is_match);
+}
 
-  if(d->m_tessellation.back()->effective_curve_distance_threshhold() <= thresh)
-    {
-      std::vector<PathPrivate::tessellated_path_ref>::const_iterator iter;
-      iter = std::lower_bound(d->m_tessellation.begin(),
-                              d->m_tessellation.end(),
-                              thresh,
-                              reverse_compare_curve_distance_thresh);
+void
+fastuidraw::Path::
+prefetch_tessellation(float thresh, TaskPool &task_pool,
+                      bool with_filled, bool with_stroked) const
+{
+  PathPrivate *d;
+  reference_counted_ptr<TessellationLODs> lods;
 
-      assert(iter != d->m_tessellation.end());
-      assert(*iter);
-      assert((*iter)->effective_curve_distance_threshhold() <= thresh);
-      return *iter;
-    }
-  else
+  d = static_cast<PathPrivate*>(m_d);
+  lods = d->tessellation_lods();
+  if(lods->begin_prefetch(*this, thresh))
     {
-      if(d->m_tessellation_done)
-        {
-          return d->m_tessellation.back();
-        }
-
-      PathPrivate::tessellated_path_ref prev_ref, ref;
-      TessellatedPath::TessellationParams params;
-
-      ref = d->m_tessellation.back();
-      params
-        .max_segments(2 * ref->max_segments())
-        .curve_distance_tessellate(ref->effective_curve_distance_threshhold());
-
-      while(!d->m_tessellation_done
-            && ref->effective_curve_distance_threshhold() > thresh)
-        {
-          float last_tess;
-
-          params.m_threshhold *= 0.5f;
-          last_tess = ref->effective_curve_distance_threshhold();
-          ref = FASTUIDRAWnew TessellatedPath(*this, params);
-          d->m_tessellation_done = (last_tess <= ref->effective_curve_distance_threshhold());
-
-          while(!d->m_tessellation_done && ref->effective_curve_distance_threshhold() > params.m_threshhold)
-            {
-              params.m_max_segments *= 2;
-              last_tess = ref->effective_curve_distance_threshhold();
-              ref = FASTUIDRAWnew TessellatedPath(*this, params);
-              d->m_tessellation_done = (last_tess <= ref->effective_curve_distance_threshhold());
-            }
-
-          if(d->m_tessellation_done)
-            {
-              /*
-              std::cout << "Tapped out at (max_segs = "
-                        << ref->max_segments() << ", tess_factor = "
-                        << ref->effective_curve_distance_threshhold()
-                        << ", num_points = " << ref->point_data().size()
-                        << ")\n";
-              */
-            }
-          d->m_tessellation.push_back(ref);
-        }
-      return d->m_tessellation.back();
+      task_pool.add_task(FASTUIDRAWnew TessellationPrefetchTask(*this, lods, thresh,
+                                                                with_filled, with_stroked));
     }
 }
 
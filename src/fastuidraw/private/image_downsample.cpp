@@ -0,0 +1,282 @@
+/*!
+ * \file image_downsample.cpp
+ * \brief file image_downsample.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <assert.h>
+#include <cmath>
+#include <vector>
+#include <fastuidraw/util/util.hpp>
+#include "image_downsample.hpp"
+
+/* The SSE2 path is compiled with a function target attribute
+   so that it does not require the library to be built for SSE2.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define FASTUIDRAW_DOWNSAMPLE_X86
+  #include <immintrin.h>
+#endif
+
+namespace
+{
+  enum
+    {
+      /* number of source pixels, along one dimension, that
+         contribute to a pixel of the Lanczos downsample:
+         the Lanczos kernel with a = 3 stretched by 2.
+       */
+      lanczos_number_taps = 12,
+
+      /* offset from 2 * x of the first source pixel
+         of the Lanczos downsample of pixel x.
+       */
+      lanczos_first_tap = -5
+    };
+
+  inline
+  int
+  clamp_coordinate(int v, int size)
+  {
+    return fastuidraw::t_max(0, fastuidraw::t_min(v, size - 1));
+  }
+
+  inline
+  const fastuidraw::u8vec4&
+  fetch(fastuidraw::const_c_array<fastuidraw::u8vec4> src,
+        fastuidraw::ivec2 src_dims, int x, int y)
+  {
+    return src[clamp_coordinate(x, src_dims.x()) + clamp_coordinate(y, src_dims.y()) * src_dims.x()];
+  }
+
+  void
+  downsample_box_pixel(fastuidraw::const_c_array<fastuidraw::u8vec4> src,
+                       fastuidraw::ivec2 src_dims, int x, int y,
+                       fastuidraw::u8vec4 &dst)
+  {
+    const fastuidraw::u8vec4 &p00(fetch(src, src_dims, 2 * x, 2 * y));
+    const fastuidraw::u8vec4 &p10(fetch(src, src_dims, 2 * x + 1, 2 * y));
+    const fastuidraw::u8vec4 &p01(fetch(src, src_dims, 2 * x, 2 * y + 1));
+    const fastuidraw::u8vec4 &p11(fetch(src, src_dims, 2 * x + 1, 2 * y + 1));
+
+    for(unsigned int c = 0; c < 4; ++c)
+      {
+        unsigned int v;
+        v = p00[c] + p10[c] + p01[c] + p11[c] + 2u;
+        dst[c] = static_cast<uint8_t>(v >> 2u);
+      }
+  }
+
+  /* returns the number of pixels at the start of
+     dst_row that downsample_box_row() has written.
+   */
+  typedef int (*box_row_function)(const fastuidraw::u8vec4 *row0,
+                                  const fastuidraw::u8vec4 *row1,
+                                  int dst_width, int src_width,
+                                  fastuidraw::u8vec4 *dst_row);
+
+  int
+  downsample_box_row_scalar(const fastuidraw::u8vec4*, const fastuidraw::u8vec4*,
+                            int, int, fastuidraw::u8vec4*)
+  {
+    return 0;
+  }
+
+#ifdef FASTUIDRAW_DOWNSAMPLE_X86
+  /* each iteration reads 4 pixels of each of the two source
+     rows and writes 2 pixels of the destination row.
+   */
+  __attribute__((target("sse2")))
+  int
+  downsample_box_row_sse2(const fastuidraw::u8vec4 *row0,
+                          const fastuidraw::u8vec4 *row1,
+                          int dst_width, int src_width,
+                          fastuidraw::u8vec4 *dst_row)
+  {
+    const __m128i zero(_mm_setzero_si128());
+    const __m128i round(_mm_set1_epi16(2));
+    int x;
+
+    for(x = 0; x + 1 < dst_width && 2 * x + 3 < src_width; x += 2)
+      {
+        __m128i a, b, lo, hi;
+
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x));
+        b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x));
+
+        /* vertical sums of the 4 pixels as 16-bit values */
+        lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+        /* horizontal sums of neighbouring pixels */
+        lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+        hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+        lo = _mm_unpacklo_epi64(lo, hi);
+
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst_row + x), _mm_packus_epi16(lo, zero));
+      }
+    return x;
+  }
+
+  box_row_function
+  choose_box_row_function(void)
+  {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") ?
+      downsample_box_row_sse2 :
+      downsample_box_row_scalar;
+  }
+#else
+  box_row_function
+  choose_box_row_function(void)
+  {
+    return downsample_box_row_scalar;
+  }
+#endif
+
+  class LanczosWeights
+  {
+  public:
+    LanczosWeights(void)
+    {
+      const float a(3.0f);
+      float sum(0.0f);
+
+      for(int k = 0; k < lanczos_number_taps; ++k)
+        {
+          float t;
+
+          /* distance, in units of destination pixels, from
+             the center of source pixel 2x + k + lanczos_first_tap
+             to the center of destination pixel x.
+           */
+          t = (static_cast<float>(k + lanczos_first_tap) - 0.5f) * 0.5f;
+          m_values[k] = sinc(t) * sinc(t / a);
+          sum += m_values[k];
+        }
+
+      for(int k = 0; k < lanczos_number_taps; ++k)
+        {
+          m_values[k] /= sum;
+        }
+    }
+
+    float m_values[lanczos_number_taps];
+
+  private:
+    static
+    float
+    sinc(float t)
+    {
+      float pt;
+
+      if(t == 0.0f)
+        {
+          return 1.0f;
+        }
+      pt = static_cast<float>(M_PI) * t;
+      return std::sin(pt) / pt;
+    }
+  };
+}
+
+void
+fastuidraw::detail::
+downsample_box(const_c_array<u8vec4> src, ivec2 src_dims,
+               c_array<u8vec4> dst)
+{
+  static const box_row_function row_function(choose_box_row_function());
+  ivec2 dst_dims(downsample_dimensions(src_dims));
+
+  assert(src.size() == static_cast<unsigned int>(src_dims.x() * src_dims.y()));
+  assert(dst.size() == static_cast<unsigned int>(dst_dims.x() * dst_dims.y()));
+
+  for(int y = 0; y < dst_dims.y(); ++y)
+    {
+      const u8vec4 *row0, *row1;
+      u8vec4 *dst_row;
+      int x;
+
+      row0 = src.c_ptr() + 2 * y * src_dims.x();
+      row1 = src.c_ptr() + clamp_coordinate(2 * y + 1, src_dims.y()) * src_dims.x();
+      dst_row = dst.c_ptr() + y * dst_dims.x();
+
+      x = row_function(row0, row1, dst_dims.x(), src_dims.x(), dst_row);
+      for(; x < dst_dims.x(); ++x)
+        {
+          downsample_box_pixel(src, src_dims, x, y, dst_row[x]);
+        }
+    }
+}
+
+void
+fastuidraw::detail::
+downsample_lanczos(const_c_array<u8vec4> src, ivec2 src_dims,
+                   c_array<u8vec4> dst)
+{
+  static const LanczosWeights weights;
+  ivec2 dst_dims(downsample_dimensions(src_dims));
+  std::vector<vec4> horizontal(dst_dims.x() * src_dims.y());
+
+  assert(src.size() == static_cast<unsigned int>(src_dims.x() * src_dims.y()));
+  assert(dst.size() == static_cast<unsigned int>(dst_dims.x() * dst_dims.y()));
+
+  /* horizontal pass: src_dims.y() rows of dst_dims.x() pixels,
+     kept as floats so that the vertical pass does not round
+     twice.
+   */
+  for(int y = 0; y < src_dims.y(); ++y)
+    {
+      for(int x = 0; x < dst_dims.x(); ++x)
+        {
+          vec4 sum(0.0f, 0.0f, 0.0f, 0.0f);
+          for(int k = 0; k < lanczos_number_taps; ++k)
+            {
+              const u8vec4 &p(fetch(src, src_dims, 2 * x + k + lanczos_first_tap, y));
+              sum += weights.m_values[k] * vec4(p);
+            }
+          horizontal[x + y * dst_dims.x()] = sum;
+        }
+    }
+
+  /* vertical pass */
+  for(int y = 0; y < dst_dims.y(); ++y)
+    {
+      for(int x = 0; x < dst_dims.x(); ++x)
+        {
+          vec4 sum(0.0f, 0.0f, 0.0f, 0.0f);
+          u8vec4 &out(dst[x + y * dst_dims.x()]);
+
+          for(int k = 0; k < lanczos_number_taps; ++k)
+            {
+              int sy;
+              sy = clamp_coordinate(2 * y + k + lanczos_first_tap, src_dims.y());
+              sum += weights.m_values[k] * horizontal[x + sy * dst_dims.x()];
+            }
+
+          /* the negative lobes of the filter can take
+             the value outside of [0, 255]
+           */
+          for(unsigned int c = 0; c < 4; ++c)
+            {
+              float v;
+              v = t_max(0.0f, t_min(255.0f, sum[c] + 0.5f));
+              out[c] = static_cast<uint8_t>(v);
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*!
+ * \file image_downsample.hpp
+ * \brief file image_downsample.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <fastuidraw/util/vecN.hpp>
+#include <fastuidraw/util/c_array.hpp>
+
+namespace fastuidraw {
+namespace detail {
+
+/*!\fn
+  Returns the dimensions of the next mipmap level of
+  an image, i.e. half the dimensions rounded up.
+ */
+inline
+ivec2
+downsample_dimensions(ivec2 dims)
+{
+  return ivec2((dims.x() + 1) / 2, (dims.y() + 1) / 2);
+}
+
+/*!\fn
+  Downsample an RGBA8 image by 2 in each dimension, each
+  pixel of dst being the average of a 2x2 block of src;
+  where the block goes past the last row or column of src,
+  that row or column is repeated. Uses SSE2 when available.
+  \param src pixels of the source image
+  \param src_dims dimensions of the source image
+  \param dst location to which to write the downsampled
+             image, must be downsample_dimensions(src_dims)
+             in size
+ */
+void
+downsample_box(const_c_array<u8vec4> src, ivec2 src_dims,
+               c_array<u8vec4> dst);
+
+/*!\fn
+  Downsample an RGBA8 image by 2 in each dimension with
+  a separable Lanczos filter (a = 3) stretched over 12
+  source pixels; pixels past the edges of src are taken
+  from the edge.
+  \param src pixels of the source image
+  \param src_dims dimensions of the source image
+  \param dst location to which to write the downsampled
+             image, must be downsample_dimensions(src_dims)
+             in size
+ */
+void
+downsample_lanczos(const_c_array<u8vec4> src, ivec2 src_dims,
+                   c_array<u8vec4> dst);
+
+} //namespace detail
+} //namespace fastuidraw
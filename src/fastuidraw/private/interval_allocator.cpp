@@ -46,13 +46,33 @@ void
 fastuidraw::interval_allocator::
 resize(int size)
 {
-  assert(size >= m_size);
+  assert(size >= 0);
   if(size > m_size)
     {
       int old_size(m_size);
       m_size = size;
       free_interval(old_size, size - old_size);
     }
+  else if(size < m_size)
+    {
+      interval_ref iter;
+      int begin;
+
+      /* the range [size, m_size) is free, thus it is
+         the end of the free interval that ends at m_size.
+       */
+      iter = m_free_intervals.find(m_size);
+      assert(iter != m_free_intervals.end());
+      assert(iter->second.m_begin <= size);
+
+      begin = iter->second.m_begin;
+      remove_free_interval(iter);
+      m_size = size;
+      if(begin < size)
+        {
+          free_interval(begin, size - begin);
+        }
+    }
 }
 
 
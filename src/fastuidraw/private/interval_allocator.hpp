@@ -76,8 +76,9 @@ namespace fastuidraw
     reset(int size);
 
     /*!\fn
-      Resize the \ref interval_allocator. The new size must be atleast
-      as large as the old size.
+      Resize the \ref interval_allocator. If the new size is smaller
+      than the old size, the range from the new size to the old size
+      must be free.
       \param size new size to which to size the \ref interval_allocator
      */
     void
@@ -0,0 +1,147 @@
+/*!
+ * \file memory_accounting_private.hpp
+ * \brief file memory_accounting_private.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/memory_accounting.hpp>
+#include <fastuidraw/painter/painter_attribute_data.hpp>
+
+namespace fastuidraw
+{
+  namespace detail
+  {
+    /* add (or with a negative value, remove) bytes
+       to a category of memory_accounting.
+     */
+    void
+    account_bytes(enum memory_accounting::category_t c, int64_t delta);
+
+    /* Holds a number of bytes of a category, giving
+       them back to the category at dtor.
+     */
+    class AccountedBytes:fastuidraw::noncopyable
+    {
+    public:
+      explicit
+      AccountedBytes(enum memory_accounting::category_t c):
+        m_category(c),
+        m_bytes(0)
+      {}
+
+      ~AccountedBytes()
+      {
+        bytes(0);
+      }
+
+      void
+      bytes(uint64_t v)
+      {
+        account_bytes(m_category, static_cast<int64_t>(v) - static_cast<int64_t>(m_bytes));
+        m_bytes = v;
+      }
+
+      void
+      add(uint64_t v)
+      {
+        bytes(m_bytes + v);
+      }
+
+      uint64_t
+      bytes(void) const
+      {
+        return m_bytes;
+      }
+
+    private:
+      enum memory_accounting::category_t m_category;
+      uint64_t m_bytes;
+    };
+
+    inline
+    uint64_t
+    attribute_data_bytes(const PainterAttributeData &data)
+    {
+      return data.attribute_data().size() * sizeof(PainterAttribute)
+        + data.index_data().size() * sizeof(PainterIndex);
+    }
+
+    /* An EvictableCache is a lazily built cache that
+       memory_accounting::enforce_budgets() may evict.
+       A derived class calls register_cache() once it
+       is ready to be evicted and MUST call unregister_cache()
+       first thing in its dtor, so that enforce_budgets()
+       running on another thread does not call evict()
+       on a partially destroyed object.
+     */
+    class EvictableCache:fastuidraw::noncopyable
+    {
+    public:
+      /* category_mask is a bit mask of those
+         memory_accounting::category_t that
+         evict() frees.
+       */
+      explicit
+      EvictableCache(uint32_t category_mask);
+
+      virtual
+      ~EvictableCache();
+
+      /* mark the cache as used, a cache used since the last
+         call to enforce_budgets() is not evicted by it.
+       */
+      void
+      touch(void);
+
+      uint32_t
+      category_mask(void) const
+      {
+        return m_category_mask;
+      }
+
+      uint64_t
+      last_used(void) const
+      {
+        return m_last_used.load(std::memory_order_relaxed);
+      }
+
+      /* evict the cached data of category c; return true
+         if anything was evicted. An implementation is to skip
+         (and return false) if its data is busy, i.e. if it
+         cannot immediately lock the mutexes guarding the data.
+       */
+      virtual
+      bool
+      evict(enum memory_accounting::category_t c) = 0;
+
+    protected:
+      void
+      register_cache(void);
+
+      void
+      unregister_cache(void);
+
+    private:
+      uint32_t m_category_mask;
+      std::atomic<uint64_t> m_last_used;
+      bool m_registered;
+    };
+  }
+}
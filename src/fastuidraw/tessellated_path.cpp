@@ -23,16 +23,24 @@
 #include <fastuidraw/path.hpp>
 #include <fastuidraw/painter/stroked_path.hpp>
 #include <fastuidraw/painter/filled_path.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include "private/util_private.hpp"
+#include "private/memory_accounting_private.hpp"
 
 namespace
 {
-  class TessellatedPathPrivate
+  class TessellatedPathPrivate:public fastuidraw::detail::EvictableCache
   {
   public:
     TessellatedPathPrivate(const fastuidraw::Path &input,
                            fastuidraw::TessellatedPath::TessellationParams TP);
 
+    ~TessellatedPathPrivate();
+
+    virtual
+    bool
+    evict(enum fastuidraw::memory_accounting::category_t c);
+
     std::vector<std::vector<fastuidraw::range_type<unsigned int> > > m_edge_ranges;
     std::vector<fastuidraw::TessellatedPath::point> m_point_data;
     fastuidraw::vec2 m_box_min, m_box_max;
@@ -40,8 +48,14 @@ namespace
     float m_effective_curve_distance_threshhold;
     float m_effective_curvature_threshhold;
     unsigned int m_max_segments;
+
+    /* m_mutex guards the lazy creation of m_stroked and m_filled.
+     */
+    fastuidraw::mutex m_mutex;
     fastuidraw::reference_counted_ptr<const fastuidraw::StrokedPath> m_stroked;
     fastuidraw::reference_counted_ptr<const fastuidraw::FilledPath> m_filled;
+
+    fastuidraw::detail::AccountedBytes m_bytes;
   };
 }
 
@@ -50,13 +64,16 @@ namespace
 TessellatedPathPrivate::
 TessellatedPathPrivate(const fastuidraw::Path &input,
                        fastuidraw::TessellatedPath::TessellationParams TP):
+  fastuidraw::detail::EvictableCache((1u << fastuidraw::memory_accounting::filled_path_data)
+                                     | (1u << fastuidraw::memory_accounting::stroked_path_data)),
   m_edge_ranges(input.number_contours()),
   m_box_min(0.0f, 0.0f),
   m_box_max(0.0f, 0.0f),
   m_params(TP),
   m_effective_curve_distance_threshhold(0.0f),
   m_effective_curvature_threshhold(0.0f),
-  m_max_segments(0u)
+  m_max_segments(0u),
+  m_bytes(fastuidraw::memory_accounting::tessellation)
 {
   if(input.number_contours() > 0)
     {
@@ -159,6 +176,47 @@ TessellatedPathPrivate(const fastuidraw::Path &input,
     {
       m_box_min = m_box_max = fastuidraw::vec2(0.0f, 0.0f);
     }
+
+  uint64_t bytes;
+  bytes = m_point_data.capacity() * sizeof(fastuidraw::TessellatedPath::point);
+  for(unsigned int o = 0, endo = m_edge_ranges.size(); o < endo; ++o)
+    {
+      bytes += m_edge_ranges[o].capacity() * sizeof(fastuidraw::range_type<unsigned int>);
+    }
+  m_bytes.bytes(bytes);
+  register_cache();
+}
+
+TessellatedPathPrivate::
+~TessellatedPathPrivate()
+{
+  unregister_cache();
+}
+
+bool
+TessellatedPathPrivate::
+evict(enum fastuidraw::memory_accounting::category_t c)
+{
+  fastuidraw::reference_counted_ptr<const fastuidraw::StrokedPath> stroked;
+  fastuidraw::reference_counted_ptr<const fastuidraw::FilledPath> filled;
+
+  if(!m_mutex.try_lock())
+    {
+      return false;
+    }
+
+  /* swap out under the lock, release after it */
+  if(c == fastuidraw::memory_accounting::filled_path_data)
+    {
+      filled.swap(m_filled);
+    }
+  else if(c == fastuidraw::memory_accounting::stroked_path_data)
+    {
+      stroked.swap(m_stroked);
+    }
+  m_mutex.unlock();
+
+  return filled || stroked;
 }
 
 //////////////////////////////////////
@@ -167,6 +225,8 @@ fastuidraw::TessellatedPath::
 TessellatedPath(const Path &input,
                 fastuidraw::TessellatedPath::TessellationParams TP)
 {
+  FASTUIDRAWtrace_zone("TessellatedPath::TessellatedPath");
+
   m_d = FASTUIDRAWnew TessellatedPathPrivate(input, TP);
 }
 
@@ -185,6 +245,9 @@ stroked(void) const
 {
   TessellatedPathPrivate *d;
   d = static_cast<TessellatedPathPrivate*>(m_d);
+
+  d->touch();
+  autolock_mutex M(d->m_mutex);
   if(!d->m_stroked)
     {
       d->m_stroked = FASTUIDRAWnew StrokedPath(*this);
@@ -198,6 +261,9 @@ filled(void) const
 {
   TessellatedPathPrivate *d;
   d = static_cast<TessellatedPathPrivate*>(m_d);
+
+  d->touch();
+  autolock_mutex M(d->m_mutex);
   if(!d->m_filled)
     {
       d->m_filled = FASTUIDRAWnew FilledPath(*this);
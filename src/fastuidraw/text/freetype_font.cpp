@@ -16,6 +16,8 @@
  *
  */
 
+#include <string>
+#include <vector>
 #include <fastuidraw/text/freetype_font.hpp>
 #include <fastuidraw/text/glyph_layout_data.hpp>
 #include <fastuidraw/text/glyph_render_data.hpp>
@@ -61,11 +63,13 @@ namespace
     RenderParamsPrivate(void):
       m_distance_field_pixel_size(48),
       m_distance_field_max_distance(96.0f),
+      m_distance_field_generator(fastuidraw::FontFreeType::distance_field_exact),
       m_curve_pair_pixel_size(32)
     {}
 
     unsigned int m_distance_field_pixel_size;
     float m_distance_field_max_distance;
+    enum fastuidraw::FontFreeType::distance_field_generator_t m_distance_field_generator;
     unsigned int m_curve_pair_pixel_size;
   };
 
@@ -129,8 +133,22 @@ namespace
     void
     common_init(void);
 
+    /* Returns an FT_Face for the calling thread to use
+       exclusively until it is passed to release_face().
+       If m_face is in use by another thread and the font
+       was created from a file, a copy of m_face opened
+       from the same file is returned; that copy is kept
+       for reuse once released. Otherwise, waits for m_face.
+     */
+    FT_Face
+    acquire_face(void);
+
+    void
+    release_face(FT_Face face);
+
     void
-    common_compute_rendering_data(int pixel_size, FT_Int32 load_flags,
+    common_compute_rendering_data(FT_Face face,
+                                  int pixel_size, FT_Int32 load_flags,
                                   fastuidraw::GlyphLayoutData &layout,
                                   uint32_t glyph_code);
 
@@ -157,6 +175,18 @@ namespace
     fastuidraw::FontFreeType::RenderParams m_render_params;
     fastuidraw::reference_counted_ptr<fastuidraw::FreetypeLib> m_lib;
     fastuidraw::FontFreeType *m_p;
+
+    /* source of m_face, set only when the font is made
+       by FontFreeType::create() from a file; used to open
+       copies of m_face.
+     */
+    std::string m_source_filename;
+    int m_source_face_index;
+
+    /* copies of m_face not in use, guarded by m_free_faces_mutex
+     */
+    fastuidraw::mutex m_free_faces_mutex;
+    std::vector<FT_Face> m_free_faces;
   };
 }
 
@@ -286,7 +316,8 @@ FontFreeTypePrivate(fastuidraw::FontFreeType *p, FT_Face pface,
                     const fastuidraw::FontFreeType::RenderParams &render_params):
   m_face(pface),
   m_render_params(render_params),
-  m_p(p)
+  m_p(p),
+  m_source_face_index(0)
 {
   common_init();
 }
@@ -298,7 +329,8 @@ FontFreeTypePrivate(fastuidraw::FontFreeType *p, FT_Face pface,
   m_face(pface),
   m_render_params(render_params),
   m_lib(lib),
-  m_p(p)
+  m_p(p),
+  m_source_face_index(0)
 {
   common_init();
 }
@@ -308,7 +340,73 @@ FontFreeTypePrivate::
 {
   if(m_lib)
     {
+      m_lib->lock();
+      for(unsigned int i = 0, endi = m_free_faces.size(); i < endi; ++i)
+        {
+          FT_Done_Face(m_free_faces[i]);
+        }
       FT_Done_Face(m_face);
+      m_lib->unlock();
+    }
+  assert(m_lib || m_free_faces.empty());
+}
+
+FT_Face
+FontFreeTypePrivate::
+acquire_face(void)
+{
+  if(m_mutex.try_lock())
+    {
+      return m_face;
+    }
+
+  if(m_lib && !m_source_filename.empty())
+    {
+      FT_Face face(nullptr);
+      int error_code;
+
+      {
+        fastuidraw::autolock_mutex M(m_free_faces_mutex);
+        if(!m_free_faces.empty())
+          {
+            face = m_free_faces.back();
+            m_free_faces.pop_back();
+            return face;
+          }
+      }
+
+      m_lib->lock();
+      error_code = FT_New_Face(m_lib->lib(), m_source_filename.c_str(), m_source_face_index, &face);
+      if(error_code != 0 && face != nullptr)
+        {
+          FT_Done_Face(face);
+          face = nullptr;
+        }
+      m_lib->unlock();
+
+      if(face != nullptr)
+        {
+          FT_Set_Transform(face, nullptr, nullptr);
+          return face;
+        }
+    }
+
+  m_mutex.lock();
+  return m_face;
+}
+
+void
+FontFreeTypePrivate::
+release_face(FT_Face face)
+{
+  if(face == m_face)
+    {
+      m_mutex.unlock();
+    }
+  else
+    {
+      fastuidraw::autolock_mutex M(m_free_faces_mutex);
+      m_free_faces.push_back(face);
     }
 }
 
@@ -323,23 +421,24 @@ common_init(void)
 
 void
 FontFreeTypePrivate::
-common_compute_rendering_data(int pixel_size, FT_Int32 load_flags,
+common_compute_rendering_data(FT_Face face,
+                              int pixel_size, FT_Int32 load_flags,
                               fastuidraw::GlyphLayoutData &output,
                               uint32_t glyph_code)
 {
   fastuidraw::ivec2 bitmap_sz, bitmap_offset, iadvance;
 
-  FT_Set_Pixel_Sizes(m_face, pixel_size, pixel_size);
-  FT_Load_Glyph(m_face, glyph_code, load_flags);
-
-  output.m_size.x() = to_pixel_sizes(m_face->glyph->metrics.width);
-  output.m_size.y() = to_pixel_sizes(m_face->glyph->metrics.height);
-  output.m_horizontal_layout_offset.x() = to_pixel_sizes(m_face->glyph->metrics.horiBearingX);
-  output.m_horizontal_layout_offset.y() = to_pixel_sizes(m_face->glyph->metrics.horiBearingY) - output.m_size.y();
-  output.m_vertical_layout_offset.x() = to_pixel_sizes(m_face->glyph->metrics.vertBearingX);
-  output.m_vertical_layout_offset.y() = to_pixel_sizes(m_face->glyph->metrics.vertBearingY) - output.m_size.y();
-  output.m_advance.x() = to_pixel_sizes(m_face->glyph->metrics.horiAdvance);
-  output.m_advance.y() = to_pixel_sizes(m_face->glyph->metrics.vertAdvance);
+  FT_Set_Pixel_Sizes(face, pixel_size, pixel_size);
+  FT_Load_Glyph(face, glyph_code, load_flags);
+
+  output.m_size.x() = to_pixel_sizes(face->glyph->metrics.width);
+  output.m_size.y() = to_pixel_sizes(face->glyph->metrics.height);
+  output.m_horizontal_layout_offset.x() = to_pixel_sizes(face->glyph->metrics.horiBearingX);
+  output.m_horizontal_layout_offset.y() = to_pixel_sizes(face->glyph->metrics.horiBearingY) - output.m_size.y();
+  output.m_vertical_layout_offset.x() = to_pixel_sizes(face->glyph->metrics.vertBearingX);
+  output.m_vertical_layout_offset.y() = to_pixel_sizes(face->glyph->metrics.vertBearingY) - output.m_size.y();
+  output.m_advance.x() = to_pixel_sizes(face->glyph->metrics.horiAdvance);
+  output.m_advance.y() = to_pixel_sizes(face->glyph->metrics.vertAdvance);
   output.m_glyph_code = glyph_code;
   output.m_pixel_size = pixel_size;
   output.m_font = m_p;
@@ -353,14 +452,15 @@ compute_rendering_data(int pixel_size, uint32_t glyph_code,
                        fastuidraw::Path &path)
 {
   fastuidraw::ivec2 bitmap_sz;
-  fastuidraw::autolock_mutex m(m_mutex);
+  FT_Face face;
 
-  common_compute_rendering_data(pixel_size, FT_LOAD_DEFAULT, layout, glyph_code);
-  PathCreator::decompose_to_path(&m_face->glyph->outline, path);
-  FT_Render_Glyph(m_face->glyph, FT_RENDER_MODE_NORMAL);
+  face = acquire_face();
+  common_compute_rendering_data(face, pixel_size, FT_LOAD_DEFAULT, layout, glyph_code);
+  PathCreator::decompose_to_path(&face->glyph->outline, path);
+  FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
 
-  bitmap_sz.x() = m_face->glyph->bitmap.width;
-  bitmap_sz.y() = m_face->glyph->bitmap.rows;
+  bitmap_sz.x() = face->glyph->bitmap.width;
+  bitmap_sz.y() = face->glyph->bitmap.rows;
 
   /* add one pixel slack on glyph
    */
@@ -368,7 +468,7 @@ compute_rendering_data(int pixel_size, uint32_t glyph_code,
     {
       int pitch;
 
-      pitch = m_face->glyph->bitmap.pitch;
+      pitch = face->glyph->bitmap.pitch;
       output.resize(bitmap_sz + fastuidraw::ivec2(1, 1));
       std::fill(output.coverage_values().begin(), output.coverage_values().end(), 0);
       for(int y = 0; y < bitmap_sz.y(); ++y)
@@ -379,7 +479,7 @@ compute_rendering_data(int pixel_size, uint32_t glyph_code,
 
               write_location = x + y * output.resolution().x();
               read_location = x + (bitmap_sz.y() - 1 - y) * pitch;
-              output.coverage_values()[write_location] = m_face->glyph->bitmap.buffer[read_location];
+              output.coverage_values()[write_location] = face->glyph->bitmap.buffer[read_location];
             }
         }
     }
@@ -387,6 +487,7 @@ compute_rendering_data(int pixel_size, uint32_t glyph_code,
     {
       output.resize(fastuidraw::ivec2(0, 0));
     }
+  release_face(face);
 }
 
 void
@@ -403,20 +504,21 @@ compute_rendering_data(uint32_t glyph_code,
   std::vector<fastuidraw::detail::point_type> pts;
   std::ostream *stream_ptr(nullptr);
   fastuidraw::detail::geometry_data dbg(stream_ptr, pts);
+  FT_Face face;
 
-  m_mutex.lock();
+  face = acquire_face();
 
-    common_compute_rendering_data(pixel_size, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING, layout, glyph_code);
-    FT_Render_Glyph(m_face->glyph, FT_RENDER_MODE_NORMAL);
+    common_compute_rendering_data(face, pixel_size, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING, layout, glyph_code);
+    FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
 
-    bitmap_sz.x() = m_face->glyph->bitmap.width;
-    bitmap_sz.y() = m_face->glyph->bitmap.rows;
-    bitmap_offset.x() = m_face->glyph->bitmap_left;
-    bitmap_offset.y() = m_face->glyph->bitmap_top - m_face->glyph->bitmap.rows;
+    bitmap_sz.x() = face->glyph->bitmap.width;
+    bitmap_sz.y() = face->glyph->bitmap.rows;
+    bitmap_offset.x() = face->glyph->bitmap_left;
+    bitmap_offset.y() = face->glyph->bitmap_top - face->glyph->bitmap.rows;
 
-    fastuidraw::detail::OutlineData outline_data(m_face->glyph->outline, bitmap_sz, bitmap_offset, dbg);
+    fastuidraw::detail::OutlineData outline_data(face->glyph->outline, bitmap_sz, bitmap_offset, dbg);
 
-  m_mutex.unlock();
+  release_face(face);
 
   outline_data.extract_path(path);
   if(bitmap_sz.x() != 0 && bitmap_sz.y() != 0)
@@ -427,7 +529,14 @@ compute_rendering_data(uint32_t glyph_code,
       std::fill(output.distance_values().begin(), output.distance_values().end(), 0);
       fastuidraw::array2d<fastuidraw::detail::distance_return_type> distance_values(bitmap_sz.x(), bitmap_sz.y());
 
-      outline_data.compute_distance_values(distance_values, max_distance, true);
+      if(m_render_params.distance_field_generator() == fastuidraw::FontFreeType::distance_field_sweep)
+        {
+          outline_data.compute_distance_values_sweep(distance_values, max_distance, true);
+        }
+      else
+        {
+          outline_data.compute_distance_values(distance_values, max_distance, true);
+        }
       for(int y = 0; y < bitmap_sz.y(); ++y)
         {
           for(int x = 0; x < bitmap_sz.x(); ++x)
@@ -461,16 +570,17 @@ compute_rendering_data(uint32_t glyph_code,
 {
   int pixel_size(m_render_params.curve_pair_pixel_size());
   fastuidraw::ivec2 bitmap_offset, bitmap_sz;
-
-  m_mutex.lock();
-    common_compute_rendering_data(pixel_size, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING, layout, glyph_code);
-    FT_Render_Glyph(m_face->glyph, FT_RENDER_MODE_NORMAL);
-    bitmap_sz.x() = m_face->glyph->bitmap.width;
-    bitmap_sz.y() = m_face->glyph->bitmap.rows;
-    bitmap_offset.x() = m_face->glyph->bitmap_left;
-    bitmap_offset.y() = m_face->glyph->bitmap_top - m_face->glyph->bitmap.rows;
-    fastuidraw::detail::CurvePairGenerator gen(m_face->glyph->outline, bitmap_sz, bitmap_offset, output);
-  m_mutex.unlock();
+  FT_Face face;
+
+  face = acquire_face();
+    common_compute_rendering_data(face, pixel_size, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING, layout, glyph_code);
+    FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+    bitmap_sz.x() = face->glyph->bitmap.width;
+    bitmap_sz.y() = face->glyph->bitmap.rows;
+    bitmap_offset.x() = face->glyph->bitmap_left;
+    bitmap_offset.y() = face->glyph->bitmap_top - face->glyph->bitmap.rows;
+    fastuidraw::detail::CurvePairGenerator gen(face->glyph->outline, bitmap_sz, bitmap_offset, output);
+  release_face(face);
 
   gen.extract_data(output);
   gen.extract_path(path);
@@ -550,6 +660,25 @@ distance_field_max_distance(void) const
   return d->m_distance_field_max_distance;
 }
 
+fastuidraw::FontFreeType::RenderParams&
+fastuidraw::FontFreeType::RenderParams::
+distance_field_generator(enum distance_field_generator_t v)
+{
+  RenderParamsPrivate *d;
+  d = static_cast<RenderParamsPrivate*>(m_d);
+  d->m_distance_field_generator = v;
+  return *this;
+}
+
+enum fastuidraw::FontFreeType::distance_field_generator_t
+fastuidraw::FontFreeType::RenderParams::
+distance_field_generator(void) const
+{
+  RenderParamsPrivate *d;
+  d = static_cast<RenderParamsPrivate*>(m_d);
+  return d->m_distance_field_generator;
+}
+
 fastuidraw::FontFreeType::RenderParams&
 fastuidraw::FontFreeType::RenderParams::
 curve_pair_pixel_size(unsigned int v)
@@ -710,7 +839,10 @@ create(c_array<reference_counted_ptr<FontFreeType> > fonts, const char *filename
   int error_code;
   unsigned int num(0);
 
+  lib->lock();
   error_code = FT_New_Face(lib->lib(), filename, -1, &face);
+  lib->unlock();
+
   if(error_code == 0 && face != nullptr && (face->face_flags & FT_FACE_FLAG_SCALABLE) == 0)
     {
       reference_counted_ptr<fastuidraw::FontFreeType> f;
@@ -724,7 +856,9 @@ create(c_array<reference_counted_ptr<FontFreeType> > fonts, const char *filename
 
   if(face != nullptr)
     {
+      lib->lock();
       FT_Done_Face(face);
+      lib->unlock();
     }
 
   return num;
@@ -742,6 +876,7 @@ create(const char *filename, reference_counted_ptr<FreetypeLib> lib,
 
   int error_code;
   FT_Face face(nullptr);
+  lib->lock();
   error_code = FT_New_Face(lib->lib(), filename, face_index, &face);
   if(error_code != 0 || face == nullptr || (face->face_flags & FT_FACE_FLAG_SCALABLE) == 0)
     {
@@ -749,17 +884,31 @@ create(const char *filename, reference_counted_ptr<FreetypeLib> lib,
         {
           FT_Done_Face(face);
         }
+      lib->unlock();
       return reference_counted_ptr<FontFreeType>();
     }
+  lib->unlock();
 
   FontProperties p;
   std::ostringstream str;
+  reference_counted_ptr<FontFreeType> return_value;
+  FontFreeTypePrivate *d;
 
   str << filename << ":" << face_index;
   compute_font_propertes_from_face(face, p);
   p.source_label(str.str().c_str());
 
-  return FASTUIDRAWnew FontFreeType(face, lib, p, render_params);
+  return_value = FASTUIDRAWnew FontFreeType(face, lib, p, render_params);
+
+  /* record the source so that copies of the FT_Face
+     can be opened for generating glyph data from
+     several threads at once.
+   */
+  d = static_cast<FontFreeTypePrivate*>(return_value->m_d);
+  d->m_source_filename = filename;
+  d->m_source_face_index = face_index;
+
+  return return_value;
 }
 
 fastuidraw::reference_counted_ptr<fastuidraw::FontFreeType>
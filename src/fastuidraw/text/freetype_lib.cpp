@@ -18,6 +18,8 @@
 
 
 #include <fastuidraw/text/freetype_lib.hpp>
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include "../private/util_private.hpp"
 
 fastuidraw::FreetypeLib::
 FreetypeLib(void)
@@ -29,6 +31,7 @@ FreetypeLib(void)
     {
       m_lib = nullptr;
     }
+  m_mutex = FASTUIDRAWnew mutex();
 }
 
 fastuidraw::FreetypeLib::
@@ -38,4 +41,23 @@ fastuidraw::FreetypeLib::
     {
       FT_Done_FreeType(m_lib);
     }
+
+  mutex *m;
+  m = static_cast<mutex*>(m_mutex);
+  FASTUIDRAWdelete(m);
+  m_mutex = nullptr;
+}
+
+void
+fastuidraw::FreetypeLib::
+lock(void)
+{
+  static_cast<mutex*>(m_mutex)->lock();
+}
+
+void
+fastuidraw::FreetypeLib::
+unlock(void)
+{
+  static_cast<mutex*>(m_mutex)->unlock();
 }
@@ -17,9 +17,14 @@
  */
 
 
+#include <chrono>
+#include <map>
+#include <limits>
 #include <fastuidraw/text/glyph_atlas.hpp>
+#include <fastuidraw/util/tracing.hpp>
 
 #include "../private/interval_allocator.hpp"
+#include "../private/memory_accounting_private.hpp"
 #include "../private/util_private.hpp"
 #include "private/rect_atlas.hpp"
 
@@ -30,9 +35,9 @@ namespace
     public fastuidraw::detail::RectAtlas
   {
   public:
-    explicit
-    rect_atlas_layer(const fastuidraw::ivec2 &dimensions, int player):
-      fastuidraw::detail::RectAtlas(dimensions),
+    rect_atlas_layer(const fastuidraw::ivec2 &dimensions, int player,
+                     enum fastuidraw::detail::RectAtlas::allocator_t allocator):
+      fastuidraw::detail::RectAtlas(dimensions, allocator),
       m_layer(player)
     {}
 
@@ -80,42 +85,275 @@ namespace
     unsigned int m_size;
   };
 
+  class GeometryBlock
+  {
+  public:
+    GeometryBlock(int count):
+      m_count(count),
+      m_location_ref(nullptr)
+    {}
+
+    int m_count;
+
+    /* copy of the data of the block from which to write
+       it when it is moved; only kept while compaction is
+       on (a non-zero compaction budget), a block without
+       a copy is never moved.
+     */
+    std::vector<fastuidraw::generic_data> m_data;
+
+    /* if non-null, where to write the location of
+       the block when it is moved.
+     */
+    int *m_location_ref;
+  };
+
   class GlyphAtlasPrivate
   {
   public:
     GlyphAtlasPrivate(fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlasTexelBackingStoreBase> ptexel_store,
-                      fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlasGeometryBackingStoreBase> pgeometry_store):
+                      fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlasGeometryBackingStoreBase> pgeometry_store,
+                      enum fastuidraw::GlyphAtlas::texel_allocator_t ptexel_allocator):
+      m_texel_allocator(ptexel_allocator),
       m_texel_store(ptexel_store),
       m_geometry_store(pgeometry_store),
-      m_geometry_data_allocator(pgeometry_store->size())
+      m_geometry_data_allocator(pgeometry_store->size()),
+      m_geometry_data_allocated(0),
+      m_initial_geometry_size(pgeometry_store->size()),
+      m_geometry_shadow_bytes(fastuidraw::memory_accounting::glyph_render_data),
+      m_compaction_budget(0),
+      m_compaction_cursor(std::numeric_limits<int>::max()),
+      m_geometry_generation(0u),
+      m_frame_counter(0),
+      m_frame(0u)
     {
       assert(m_texel_store);
       assert(m_geometry_store);
       allocate_atlas_bookkeeping(m_texel_store->dimensions().z());
     };
 
+    /* drop the copies of the data of the blocks,
+       after which no block is moved.
+     */
+    void
+    release_geometry_shadows(void);
+
+    /* move the block at location into the lowest free
+       room the allocator gives, returns true if moved.
+     */
+    bool
+    move_geometry_block(std::map<int, GeometryBlock>::iterator iter);
+
+    /* move blocks down, starting at m_compaction_cursor, for
+       budget microseconds or, if budget is negative, until
+       the bottom is reached; returns the number moved.
+     */
+    unsigned int
+    compact_geometry(int64_t budget);
+
+    /* shrink a resizeable geometry store, but not below its
+       initial size, once its top three quarters are free.
+     */
+    void
+    trim_geometry_store(void);
+
+    /* moving blocks is safe only if there are copies of
+       their data and if no frame is in progress, since the
+       draws of a frame refer to the locations of the blocks.
+     */
+    bool
+    can_move_geometry(void) const
+    {
+      return m_compaction_budget > 0 && m_frame_counter == 0;
+    }
+
     void
     allocate_atlas_bookkeeping(int new_size)
     {
       fastuidraw::ivec2 dims(m_texel_store->dimensions().x(), m_texel_store->dimensions().y());
       int old_size(m_private_data.size());
+      enum fastuidraw::detail::RectAtlas::allocator_t allocator;
+
+      allocator = (m_texel_allocator == fastuidraw::GlyphAtlas::skyline_texel_allocator) ?
+        fastuidraw::detail::RectAtlas::skyline_allocator :
+        fastuidraw::detail::RectAtlas::binary_tree_allocator;
 
       assert(new_size > old_size);
       m_private_data.resize(new_size);
       for(int i = old_size; i < new_size; ++i)
         {
-          m_private_data[i] = FASTUIDRAWnew rect_atlas_layer(dims, i);
+          m_private_data[i] = FASTUIDRAWnew rect_atlas_layer(dims, i, allocator);
         }
     }
 
     fastuidraw::mutex m_mutex;
+    enum fastuidraw::GlyphAtlas::texel_allocator_t m_texel_allocator;
     fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlasTexelBackingStoreBase> m_texel_store;
     fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlasGeometryBackingStoreBase> m_geometry_store;
     std::vector<fastuidraw::reference_counted_ptr<rect_atlas_layer> > m_private_data;
     fastuidraw::interval_allocator m_geometry_data_allocator;
+
+    /* the allocated geometry data blocks keyed by location
+       and the number of blocks of the geometry store they
+       use; m_geometry_shadow_bytes accounts for the copies
+       of their data held by GeometryBlock::m_data.
+     */
+    std::map<int, GeometryBlock> m_geometry_blocks;
+    int m_geometry_data_allocated;
+    unsigned int m_initial_geometry_size;
+    fastuidraw::detail::AccountedBytes m_geometry_shadow_bytes;
+
+    /* compact_geometry_data() moves the blocks below
+       m_compaction_cursor in order of decreasing location,
+       starting again from the top once it reaches the bottom.
+     */
+    int64_t m_compaction_budget;
+    int m_compaction_cursor;
+
+    /* incremented each time compact_geometry_data() moves data */
+    uint64_t m_geometry_generation;
+
+    int m_frame_counter;
+    uint64_t m_frame;
   };
 }
 
+//////////////////////////////////////
+// GlyphAtlasPrivate methods
+bool
+GlyphAtlasPrivate::
+move_geometry_block(std::map<int, GeometryBlock>::iterator iter)
+{
+  int location(iter->first), new_location;
+  GeometryBlock block(iter->second);
+  unsigned int alignment;
+
+  if(block.m_location_ref == nullptr
+     || block.m_data.empty()
+     || m_geometry_data_allocator.largest_free_interval() < block.m_count)
+    {
+      return false;
+    }
+
+  /* the allocator takes the smallest free interval that fits,
+     which may be above the block; only moving down packs
+     the blocks towards the start of the store.
+   */
+  new_location = m_geometry_data_allocator.allocate_interval(block.m_count);
+  assert(new_location != -1);
+  if(new_location > location)
+    {
+      m_geometry_data_allocator.free_interval(new_location, block.m_count);
+      return false;
+    }
+
+  alignment = m_geometry_store->alignment();
+  FASTUIDRAWunused(alignment);
+  assert(block.m_data.size() == static_cast<unsigned int>(block.m_count) * alignment);
+  m_geometry_store->set_values(new_location, fastuidraw::make_c_array(block.m_data));
+  m_geometry_data_allocator.free_interval(location, block.m_count);
+
+  assert(*block.m_location_ref == location);
+  *block.m_location_ref = new_location;
+  m_geometry_blocks.erase(iter);
+  m_geometry_blocks.insert(std::make_pair(new_location, block));
+  return true;
+}
+
+unsigned int
+GlyphAtlasPrivate::
+compact_geometry(int64_t budget)
+{
+  std::chrono::steady_clock::time_point start;
+  unsigned int return_value(0);
+  int64_t elapsed(0);
+
+  if(budget < 0)
+    {
+      m_compaction_cursor = std::numeric_limits<int>::max();
+    }
+
+  start = std::chrono::steady_clock::now();
+  do
+    {
+      std::map<int, GeometryBlock>::iterator iter;
+
+      iter = m_geometry_blocks.lower_bound(m_compaction_cursor);
+      if(iter == m_geometry_blocks.begin())
+        {
+          /* reached the bottom, start from the top next time */
+          m_compaction_cursor = std::numeric_limits<int>::max();
+          break;
+        }
+
+      --iter;
+      m_compaction_cursor = iter->first;
+      if(move_geometry_block(iter))
+        {
+          ++return_value;
+        }
+
+      if(budget >= 0)
+        {
+          elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+  while(budget < 0 || elapsed < budget);
+
+  if(return_value > 0)
+    {
+      ++m_geometry_generation;
+    }
+  return return_value;
+}
+
+void
+GlyphAtlasPrivate::
+trim_geometry_store(void)
+{
+  unsigned int size, top, new_size;
+
+  size = m_geometry_store->size();
+  if(!m_geometry_store->resizeable() || size <= m_initial_geometry_size)
+    {
+      return;
+    }
+
+  top = 0;
+  if(!m_geometry_blocks.empty())
+    {
+      std::map<int, GeometryBlock>::const_reverse_iterator iter(m_geometry_blocks.rbegin());
+      top = iter->first + iter->second.m_count;
+    }
+
+  /* leave half of the new size free so that the store
+     does not grow back right after it is shrunk.
+   */
+  if(4 * top > size)
+    {
+      return;
+    }
+
+  new_size = fastuidraw::t_max(m_initial_geometry_size, 2 * top);
+  if(new_size < size)
+    {
+      m_geometry_data_allocator.resize(new_size);
+      m_geometry_store->resize(new_size);
+    }
+}
+
+void
+GlyphAtlasPrivate::
+release_geometry_shadows(void)
+{
+  for(std::map<int, GeometryBlock>::iterator iter = m_geometry_blocks.begin(),
+        end = m_geometry_blocks.end(); iter != end; ++iter)
+    {
+      std::vector<fastuidraw::generic_data>().swap(iter->second.m_data);
+    }
+  m_geometry_shadow_bytes.bytes(0);
+}
+
 /////////////////////////////////////////////////////
 // fastuidraw::GlyphAtlasTexelBackingStoreBase methods
 fastuidraw::GlyphAtlasTexelBackingStoreBase::
@@ -223,7 +461,7 @@ resize(unsigned int new_size)
   GlyphAtlasGeometryBackingStoreBasePrivate *d;
   d = static_cast<GlyphAtlasGeometryBackingStoreBasePrivate*>(m_d);
   assert(d->m_resizeable);
-  assert(new_size > d->m_size);
+  assert(new_size > 0);
   resize_implement(new_size);
   d->m_size = new_size;
 }
@@ -276,9 +514,10 @@ size(void) const
 // fastuidraw::GlyphAtlas methods
 fastuidraw::GlyphAtlas::
 GlyphAtlas(reference_counted_ptr<GlyphAtlasTexelBackingStoreBase> ptexel_store,
-           reference_counted_ptr<GlyphAtlasGeometryBackingStoreBase> pgeometry_store)
+           reference_counted_ptr<GlyphAtlasGeometryBackingStoreBase> pgeometry_store,
+           enum texel_allocator_t ptexel_allocator)
 {
-  m_d = FASTUIDRAWnew GlyphAtlasPrivate(ptexel_store, pgeometry_store);
+  m_d = FASTUIDRAWnew GlyphAtlasPrivate(ptexel_store, pgeometry_store, ptexel_allocator);
 };
 
 fastuidraw::GlyphAtlas::
@@ -383,6 +622,17 @@ allocate_geometry_data(const_c_array<generic_data> pdata)
 
   block_count = count / alignment;
   return_value = d->m_geometry_data_allocator.allocate_interval(block_count);
+  if(return_value == -1
+     && d->can_move_geometry()
+     && d->m_geometry_data_allocator.size() - d->m_geometry_data_allocated >= block_count)
+    {
+      /* there is enough free room but in pieces, pack the
+         blocks together before growing the store.
+       */
+      d->compact_geometry(-1);
+      return_value = d->m_geometry_data_allocator.allocate_interval(block_count);
+    }
+
   if(return_value == -1)
     {
       if(d->m_geometry_store->resizeable())
@@ -399,6 +649,15 @@ allocate_geometry_data(const_c_array<generic_data> pdata)
     }
 
   d->m_geometry_store->set_values(return_value, pdata);
+
+  std::map<int, GeometryBlock>::iterator iter;
+  iter = d->m_geometry_blocks.insert(std::make_pair(return_value, GeometryBlock(block_count))).first;
+  if(d->m_compaction_budget > 0)
+    {
+      iter->second.m_data.assign(pdata.begin(), pdata.end());
+      d->m_geometry_shadow_bytes.add(pdata.size() * sizeof(generic_data));
+    }
+  d->m_geometry_data_allocated += block_count;
   return return_value;
 }
 
@@ -418,7 +677,104 @@ deallocate_geometry_data(int location, int count)
   autolock_mutex m(d->m_mutex);
 
   assert(count > 0);
+  assert(d->m_geometry_blocks.find(location) != d->m_geometry_blocks.end());
+  std::map<int, GeometryBlock>::iterator iter;
+
+  iter = d->m_geometry_blocks.find(location);
+  assert(iter != d->m_geometry_blocks.end());
+  assert(iter->second.m_count == count);
+  d->m_geometry_shadow_bytes.bytes(d->m_geometry_shadow_bytes.bytes()
+                                   - iter->second.m_data.size() * sizeof(generic_data));
   d->m_geometry_data_allocator.free_interval(location, count);
+  d->m_geometry_blocks.erase(iter);
+  d->m_geometry_data_allocated -= count;
+}
+
+void
+fastuidraw::GlyphAtlas::
+track_geometry_data(int location, int *location_ref)
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  std::map<int, GeometryBlock>::iterator iter;
+
+  iter = d->m_geometry_blocks.find(location);
+  assert(iter != d->m_geometry_blocks.end());
+  assert(location_ref == nullptr || *location_ref == location);
+  if(iter != d->m_geometry_blocks.end())
+    {
+      iter->second.m_location_ref = location_ref;
+    }
+}
+
+unsigned int
+fastuidraw::GlyphAtlas::
+compact_geometry_data(void)
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  unsigned int return_value(0);
+
+  if(!d->can_move_geometry())
+    {
+      return 0;
+    }
+
+  /* if the free room is in one piece, there is nothing to move */
+  if(d->m_geometry_data_allocator.largest_free_interval()
+     == d->m_geometry_data_allocator.size() - d->m_geometry_data_allocated)
+    {
+      d->m_compaction_cursor = std::numeric_limits<int>::max();
+    }
+  else
+    {
+      FASTUIDRAWtrace_zone("GlyphAtlas::compact_geometry_data");
+      return_value = d->compact_geometry(d->m_compaction_budget);
+    }
+
+  d->trim_geometry_store();
+  return return_value;
+}
+
+int64_t
+fastuidraw::GlyphAtlas::
+geometry_compaction_budget(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  return d->m_compaction_budget;
+}
+
+void
+fastuidraw::GlyphAtlas::
+geometry_compaction_budget(int64_t us)
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  d->m_compaction_budget = us;
+  if(us <= 0)
+    {
+      d->release_geometry_shadows();
+    }
+}
+
+uint64_t
+fastuidraw::GlyphAtlas::
+geometry_generation(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  return d->m_geometry_generation;
 }
 
 
@@ -432,12 +788,65 @@ clear(void)
   autolock_mutex m(d->m_mutex);
 
   d->m_geometry_data_allocator.reset(d->m_geometry_data_allocator.size());
+  d->m_geometry_blocks.clear();
+  d->m_geometry_shadow_bytes.bytes(0);
+  d->m_geometry_data_allocated = 0;
+  d->m_compaction_cursor = std::numeric_limits<int>::max();
   for(unsigned int i = 0, endi = d->m_private_data.size(); i < endi; ++i)
     {
       d->m_private_data[i]->clear();
     }
 }
 
+void
+fastuidraw::GlyphAtlas::
+begin_frame(void)
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  if(d->m_frame_counter == 0)
+    {
+      ++d->m_frame;
+    }
+  ++d->m_frame_counter;
+}
+
+void
+fastuidraw::GlyphAtlas::
+end_frame(void)
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  assert(d->m_frame_counter > 0);
+  --d->m_frame_counter;
+}
+
+uint64_t
+fastuidraw::GlyphAtlas::
+frame(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  return d->m_frame;
+}
+
+bool
+fastuidraw::GlyphAtlas::
+frame_in_progress(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+
+  autolock_mutex m(d->m_mutex);
+  return d->m_frame_counter > 0;
+}
+
 void
 fastuidraw::GlyphAtlas::
 flush(void) const
@@ -450,6 +859,15 @@ flush(void) const
   d->m_geometry_store->flush();
 }
 
+enum fastuidraw::GlyphAtlas::texel_allocator_t
+fastuidraw::GlyphAtlas::
+texel_allocator(void) const
+{
+  GlyphAtlasPrivate *d;
+  d = static_cast<GlyphAtlasPrivate*>(m_d);
+  return d->m_texel_allocator;
+}
+
 fastuidraw::reference_counted_ptr<const fastuidraw::GlyphAtlasTexelBackingStoreBase>
 fastuidraw::GlyphAtlas::
 texel_store(void) const
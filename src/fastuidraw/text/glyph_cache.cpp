@@ -19,8 +19,10 @@
 
 #include <map>
 #include <vector>
+#include <algorithm>
 #include <fastuidraw/text/glyph_cache.hpp>
 #include <fastuidraw/text/glyph_render_data.hpp>
+#include <fastuidraw/util/tracing.hpp>
 #include "../private/util_private.hpp"
 
 
@@ -38,6 +40,11 @@ namespace
       m_geometry_offset(-1),
       m_geometry_length(0),
       m_uploaded_to_atlas(false),
+      m_evicted(false),
+      m_last_frame(0u),
+      m_last_use(0u),
+      m_pin_count(0u),
+      m_delete_pending(false),
       m_glyph_data(nullptr)
     {}
 
@@ -47,6 +54,30 @@ namespace
     enum fastuidraw::return_code
     upload_to_atlas(void);
 
+    void
+    mark_used(void);
+
+    enum fastuidraw::return_code
+    upload_implement(void);
+
+    /* remove the glyph from the atlas, keeping
+       the data to upload it again.
+     */
+    void
+    evict(void);
+
+    /* forget the locations of the glyph in the atlas,
+       without deallocating them, after the atlas is cleared.
+     */
+    void
+    forget_atlas_locations(void);
+
+    void
+    pin(void);
+
+    void
+    unpin(void);
+
     /* owner
      */
     GlyphCachePrivate *m_cache;
@@ -66,6 +97,22 @@ namespace
     int m_geometry_offset, m_geometry_length;
     bool m_uploaded_to_atlas;
 
+    /* residency tracking: if the glyph was removed from
+       the atlas while uploaded, the frame of the atlas
+       (GlyphAtlas::frame()) when the glyph was last used
+       and the value of m_cache->m_use_counter then.
+     */
+    bool m_evicted;
+    uint64_t m_last_frame, m_last_use;
+
+    /* number of pin() calls not yet undone by unpin() and
+       if delete_glyph() (or clear_cache()) was called while
+       the glyph was pinned, in which case the glyph is
+       cleared and its slot freed on the last unpin().
+     */
+    unsigned int m_pin_count;
+    bool m_delete_pending;
+
     /* Path of the glyph
      */
     fastuidraw::Path m_path;
@@ -102,6 +149,45 @@ namespace
     fastuidraw::GlyphRender m_render;
   };
 
+  /* A GlyphGenerateTask generates the rendering data
+     for a range of glyphs; each GlyphDataPrivate is
+     written only by the task that holds it.
+   */
+  class GlyphGenerateTask:public fastuidraw::TaskPool::Task
+  {
+  public:
+    class job
+    {
+    public:
+      GlyphDataPrivate *m_glyph;
+      uint32_t m_glyph_code;
+    };
+
+    GlyphGenerateTask(const fastuidraw::reference_counted_ptr<const fastuidraw::FontBase> &font,
+                      fastuidraw::const_c_array<job> jobs):
+      m_font(font),
+      m_jobs(jobs)
+    {}
+
+  protected:
+    virtual
+    void
+    run_task(void)
+    {
+      for(unsigned int i = 0; i < m_jobs.size(); ++i)
+        {
+          GlyphDataPrivate *q(m_jobs[i].m_glyph);
+          assert(!q->m_glyph_data);
+          q->m_glyph_data = m_font->compute_rendering_data(q->m_render, m_jobs[i].m_glyph_code,
+                                                           q->m_layout, q->m_path);
+        }
+    }
+
+  private:
+    fastuidraw::reference_counted_ptr<const fastuidraw::FontBase> m_font;
+    fastuidraw::const_c_array<job> m_jobs;
+  };
+
   class GlyphCachePrivate
   {
   public:
@@ -111,20 +197,40 @@ namespace
 
     ~GlyphCachePrivate();
 
-    /*  When the atlas is full, we will clear the atlas, but save
-        the values in m_glyphs but mark them as not having been
-        uploaded, this way returned values are safe and we do
-        not have to regenerate data either.
-     */
-
     GlyphDataPrivate*
     fetch_or_allocate_glyph(GlyphSource src);
 
+    /* clear a glyph and free its slot, or if the glyph
+       is pinned, do so when it is unpinned.
+     */
+    void
+    delete_glyph(GlyphDataPrivate *p);
+
+    /*  When the atlas is full, evict the least recently used
+        glyphs not used in the frame in progress, and retry.
+        The evicted glyphs keep their data (and stay in m_glyphs)
+        but are marked as not uploaded, this way returned values
+        are safe and we do not have to regenerate data either.
+     */
+    enum fastuidraw::return_code
+    evict_and_upload(GlyphDataPrivate *G);
+
+    bool
+    evictable(const GlyphDataPrivate *p, uint64_t frame, bool frame_in_progress) const
+    {
+      return p->m_render.valid()
+        && p->m_uploaded_to_atlas
+        && p->m_pin_count == 0
+        && (!frame_in_progress || p->m_last_frame != frame);
+    }
+
     fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas> m_atlas;
     std::map<GlyphSource, GlyphDataPrivate*> m_glyph_map;
     std::vector<GlyphDataPrivate*> m_glyphs;
     std::vector<unsigned int> m_free_slots;
     fastuidraw::GlyphCache *m_p;
+    uint64_t m_use_counter;
+    fastuidraw::vecN<unsigned int, fastuidraw::GlyphCache::num_stats> m_stats;
   };
 }
 
@@ -157,6 +263,8 @@ clear(void)
     }
 
   m_uploaded_to_atlas = false;
+  m_evicted = false;
+  m_delete_pending = false;
   if(m_glyph_data)
     {
       FASTUIDRAWdelete(m_glyph_data);
@@ -182,25 +290,134 @@ upload_to_atlas(void)
    */
   enum fastuidraw::return_code return_value;
 
+  mark_used();
   if(m_uploaded_to_atlas)
     {
       return fastuidraw::routine_success;
     }
 
-  assert(m_glyph_data);
-  return_value = m_glyph_data->upload_to_atlas(m_cache->m_atlas,
-                                               m_atlas_location[0],
-                                               m_atlas_location[1],
-                                               m_geometry_offset,
-                                               m_geometry_length);
+  return_value = upload_implement();
+  if(return_value != fastuidraw::routine_success)
+    {
+      return_value = m_cache->evict_and_upload(this);
+    }
+
   if(return_value == fastuidraw::routine_success)
     {
       m_uploaded_to_atlas = true;
+      if(m_geometry_offset != -1 && m_pin_count == 0)
+        {
+          /* let the atlas move the geometry data when it compacts */
+          m_cache->m_atlas->track_geometry_data(m_geometry_offset, &m_geometry_offset);
+        }
+      if(m_evicted)
+        {
+          ++m_cache->m_stats[fastuidraw::GlyphCache::num_glyphs_reuploaded];
+          m_evicted = false;
+        }
+    }
+  else
+    {
+      ++m_cache->m_stats[fastuidraw::GlyphCache::num_upload_failures];
     }
 
   return return_value;
 }
 
+void
+GlyphDataPrivate::
+mark_used(void)
+{
+  m_last_frame = m_cache->m_atlas->frame();
+  m_last_use = ++m_cache->m_use_counter;
+}
+
+enum fastuidraw::return_code
+GlyphDataPrivate::
+upload_implement(void)
+{
+  assert(m_glyph_data);
+  return m_glyph_data->upload_to_atlas(m_cache->m_atlas,
+                                       m_atlas_location[0],
+                                       m_atlas_location[1],
+                                       m_geometry_offset,
+                                       m_geometry_length);
+}
+
+void
+GlyphDataPrivate::
+evict(void)
+{
+  assert(m_uploaded_to_atlas);
+  for(unsigned int i = 0; i < 2; ++i)
+    {
+      if(m_atlas_location[i].valid())
+        {
+          m_cache->m_atlas->deallocate(m_atlas_location[i]);
+          m_atlas_location[i] = fastuidraw::GlyphLocation();
+        }
+    }
+
+  if(m_geometry_offset != -1)
+    {
+      m_cache->m_atlas->deallocate_geometry_data(m_geometry_offset, m_geometry_length);
+      m_geometry_offset = -1;
+      m_geometry_length = 0;
+    }
+
+  m_uploaded_to_atlas = false;
+  m_evicted = true;
+  ++m_cache->m_stats[fastuidraw::GlyphCache::num_glyphs_evicted];
+}
+
+void
+GlyphDataPrivate::
+forget_atlas_locations(void)
+{
+  if(m_uploaded_to_atlas)
+    {
+      m_evicted = true;
+    }
+  m_uploaded_to_atlas = false;
+  m_atlas_location[0] = fastuidraw::GlyphLocation();
+  m_atlas_location[1] = fastuidraw::GlyphLocation();
+  m_geometry_offset = -1;
+  m_geometry_length = 0;
+}
+
+void
+GlyphDataPrivate::
+pin(void)
+{
+  if(m_pin_count == 0 && m_uploaded_to_atlas && m_geometry_offset != -1)
+    {
+      /* data made from the glyph refers to the current
+         location of the geometry data, do not move it.
+       */
+      m_cache->m_atlas->track_geometry_data(m_geometry_offset, nullptr);
+    }
+  ++m_pin_count;
+}
+
+void
+GlyphDataPrivate::
+unpin(void)
+{
+  assert(m_pin_count > 0);
+  --m_pin_count;
+  if(m_pin_count == 0)
+    {
+      if(m_delete_pending)
+        {
+          m_cache->delete_glyph(this);
+        }
+      else if(m_uploaded_to_atlas && m_geometry_offset != -1)
+        {
+          m_cache->m_atlas->track_geometry_data(m_geometry_offset, &m_geometry_offset);
+        }
+    }
+}
+
 
 
 /////////////////////////////////////////////////
@@ -209,7 +426,9 @@ GlyphCachePrivate::
 GlyphCachePrivate(fastuidraw::reference_counted_ptr<fastuidraw::GlyphAtlas> patlas,
                   fastuidraw::GlyphCache *p):
   m_atlas(patlas),
-  m_p(p)
+  m_p(p),
+  m_use_counter(0u),
+  m_stats(0u)
 {}
 
 GlyphCachePrivate::
@@ -254,6 +473,65 @@ fetch_or_allocate_glyph(GlyphSource src)
   return G;
 }
 
+void
+GlyphCachePrivate::
+delete_glyph(GlyphDataPrivate *p)
+{
+  if(p->m_pin_count > 0)
+    {
+      p->m_delete_pending = true;
+    }
+  else
+    {
+      p->clear();
+      m_free_slots.push_back(p->m_cache_location);
+    }
+}
+
+enum fastuidraw::return_code
+GlyphCachePrivate::
+evict_and_upload(GlyphDataPrivate *G)
+{
+  FASTUIDRAWtrace_zone("GlyphCache::evict_and_upload");
+
+  std::vector<std::pair<uint64_t, GlyphDataPrivate*> > candidates;
+  uint64_t frame;
+  bool frame_in_progress;
+
+  frame = m_atlas->frame();
+  frame_in_progress = m_atlas->frame_in_progress();
+  for(unsigned int i = 0, endi = m_glyphs.size(); i < endi; ++i)
+    {
+      GlyphDataPrivate *p(m_glyphs[i]);
+      if(p != G && evictable(p, frame, frame_in_progress))
+        {
+          candidates.push_back(std::make_pair(p->m_last_use, p));
+        }
+    }
+  std::sort(candidates.begin(), candidates.end());
+
+  /* The room a glyph needs is not known before hand and the
+     atlas may be fragmented, so evict in batches that double
+     in size, trying to upload G after each batch. This keeps
+     the number of upload attempts logarithmic while evicting
+     at most twice as many glyphs as needed.
+   */
+  for(unsigned int k = 0, batch = 1; k < candidates.size(); batch *= 2)
+    {
+      for(unsigned int end = fastuidraw::t_min(k + batch, static_cast<unsigned int>(candidates.size())); k < end; ++k)
+        {
+          candidates[k].second->evict();
+        }
+
+      if(G->upload_implement() == fastuidraw::routine_success)
+        {
+          return fastuidraw::routine_success;
+        }
+    }
+
+  return fastuidraw::routine_fail;
+}
+
 ///////////////////////////////////////////////////////
 // fastuidraw::Glyph methods
 enum fastuidraw::glyph_type
@@ -336,6 +614,36 @@ upload_to_atlas(void) const
   return p->upload_to_atlas();
 }
 
+void
+fastuidraw::Glyph::
+mark_used(void) const
+{
+  GlyphDataPrivate *p;
+  p = static_cast<GlyphDataPrivate*>(m_opaque);
+  assert(p != nullptr && p->m_render.valid());
+  p->mark_used();
+}
+
+void
+fastuidraw::Glyph::
+pin(void) const
+{
+  GlyphDataPrivate *p;
+  p = static_cast<GlyphDataPrivate*>(m_opaque);
+  assert(p != nullptr && p->m_render.valid());
+  p->pin();
+}
+
+void
+fastuidraw::Glyph::
+unpin(void) const
+{
+  GlyphDataPrivate *p;
+  p = static_cast<GlyphDataPrivate*>(m_opaque);
+  assert(p != nullptr && p->m_render.valid());
+  p->unpin();
+}
+
 const fastuidraw::Path&
 fastuidraw::Glyph::
 path(void) const
@@ -395,6 +703,86 @@ fetch_glyph(GlyphRender render,
 }
 
 
+enum fastuidraw::return_code
+fastuidraw::GlyphCache::
+fetch_glyphs(GlyphRender render,
+             const reference_counted_ptr<const FontBase> &font,
+             const_c_array<uint32_t> glyph_codes,
+             c_array<Glyph> out_glyphs,
+             TaskPool &task_pool)
+{
+  assert(out_glyphs.size() >= glyph_codes.size());
+  if(!font || !font->can_create_rendering_data(render.m_type))
+    {
+      std::fill(out_glyphs.begin(), out_glyphs.end(), Glyph());
+      return routine_fail;
+    }
+
+  GlyphCachePrivate *d;
+  std::vector<GlyphGenerateTask::job> jobs;
+  std::vector<reference_counted_ptr<GlyphGenerateTask> > tasks;
+  enum return_code return_value(routine_success);
+  unsigned int num_tasks, per_task;
+
+  d = static_cast<GlyphCachePrivate*>(m_d);
+
+  /* the cache itself is only touched from the calling
+     thread: first find or allocate the glyphs, marking
+     new ones as valid so that a glyph code appearing
+     more than once is generated only once.
+   */
+  for(unsigned int i = 0; i < glyph_codes.size(); ++i)
+    {
+      GlyphDataPrivate *q;
+      GlyphSource src(font, glyph_codes[i], render);
+
+      q = d->fetch_or_allocate_glyph(src);
+      if(!q->m_render.valid())
+        {
+          GlyphGenerateTask::job J;
+
+          q->m_render = render;
+          J.m_glyph = q;
+          J.m_glyph_code = glyph_codes[i];
+          jobs.push_back(J);
+        }
+      out_glyphs[i] = Glyph(q);
+    }
+
+  /* generate the glyph data; several glyphs per task
+     so that the task overhead stays small.
+   */
+  num_tasks = t_min(static_cast<unsigned int>(jobs.size()), 4u * task_pool.number_threads());
+  per_task = (num_tasks > 0) ? (jobs.size() + num_tasks - 1) / num_tasks : 0;
+  for(unsigned int start = 0; start < jobs.size(); start += per_task)
+    {
+      const_c_array<GlyphGenerateTask::job> R;
+      reference_counted_ptr<GlyphGenerateTask> task;
+
+      R = make_c_array(jobs).sub_array(start, t_min(per_task, static_cast<unsigned int>(jobs.size()) - start));
+      task = FASTUIDRAWnew GlyphGenerateTask(font, R);
+      tasks.push_back(task);
+      task_pool.add_task(task);
+    }
+
+  /* help from the back while the workers start from the front */
+  for(unsigned int i = tasks.size(); i > 0; --i)
+    {
+      tasks[i - 1]->run();
+    }
+
+  /* upload to the atlas in order on the calling thread */
+  for(unsigned int i = 0; i < glyph_codes.size(); ++i)
+    {
+      if(out_glyphs[i].upload_to_atlas() != routine_success)
+        {
+          return_value = routine_fail;
+        }
+    }
+
+  return return_value;
+}
+
 void
 fastuidraw::GlyphCache::
 delete_glyph(Glyph G)
@@ -407,11 +795,11 @@ delete_glyph(Glyph G)
   assert(p != nullptr);
   assert(p->m_cache == d);
   assert(p->m_render.valid());
+  assert(!p->m_delete_pending);
 
   GlyphSource src(p->m_layout.m_font, p->m_layout.m_glyph_code, p->m_render);
   d->m_glyph_map.erase(src);
-  p->clear();
-  d->m_free_slots.push_back(p->m_cache_location);
+  d->delete_glyph(p);
 }
 
 void
@@ -424,11 +812,7 @@ clear_atlas(void)
   d->m_atlas->clear();
   for(unsigned int i = 0, endi = d->m_glyphs.size(); i < endi; ++i)
     {
-      d->m_glyphs[i]->m_uploaded_to_atlas = false;
-      d->m_glyphs[i]->m_atlas_location[0] = fastuidraw::GlyphLocation();
-      d->m_glyphs[i]->m_atlas_location[1] = fastuidraw::GlyphLocation();
-      d->m_glyphs[i]->m_geometry_offset = -1;
-      d->m_glyphs[i]->m_geometry_length = 0;
+      d->m_glyphs[i]->forget_atlas_locations();
     }
 }
 
@@ -447,10 +831,39 @@ clear_cache(void)
     {
       GlyphDataPrivate *p;
       p = d->m_glyphs[i];
-      if(p->m_render.valid())
+      if(p->m_pin_count > 0)
         {
+          /* the atlas is cleared, so the glyph is no longer
+             on it; keep the rest of the glyph until unpinned.
+           */
+          p->forget_atlas_locations();
+          p->m_delete_pending = true;
+        }
+      else if(p->m_render.valid())
+        {
+          p->forget_atlas_locations();
           p->clear();
           d->m_free_slots.push_back(p->m_cache_location);
         }
     }
 }
+
+unsigned int
+fastuidraw::GlyphCache::
+query_stat(enum stats_t st) const
+{
+  GlyphCachePrivate *d;
+  d = static_cast<GlyphCachePrivate*>(m_d);
+
+  assert(st < num_stats);
+  return d->m_stats[st];
+}
+
+void
+fastuidraw::GlyphCache::
+reset_stats(void)
+{
+  GlyphCachePrivate *d;
+  d = static_cast<GlyphCachePrivate*>(m_d);
+  d->m_stats = vecN<unsigned int, num_stats>(0u);
+}
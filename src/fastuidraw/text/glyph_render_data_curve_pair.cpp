@@ -20,6 +20,7 @@
 #include <fastuidraw/text/glyph_render_data_curve_pair.hpp>
 
 #include "../private/util_private.hpp"
+#include "../private/memory_accounting_private.hpp"
 
 namespace
 {
@@ -97,7 +98,8 @@ namespace
   {
   public:
     GlyphRenderDataCurvePairPrivate(void):
-      m_resolution(0, 0)
+      m_resolution(0, 0),
+      m_bytes(fastuidraw::memory_accounting::glyph_render_data)
     {}
 
     void
@@ -107,11 +109,20 @@ namespace
       assert(sz.y() >= 0);
       m_texels.resize(sz.x() * sz.y());
       m_resolution = sz;
+      update_bytes();
+    }
+
+    void
+    update_bytes(void)
+    {
+      m_bytes.bytes(m_texels.size() * sizeof(uint16_t)
+                    + m_geometry_data.size() * sizeof(fastuidraw::GlyphRenderDataCurvePair::entry));
     }
 
     fastuidraw::ivec2 m_resolution;
     std::vector<uint16_t> m_texels;
     std::vector<fastuidraw::GlyphRenderDataCurvePair::entry> m_geometry_data;
+    fastuidraw::detail::AccountedBytes m_bytes;
   };
 }
 
@@ -398,6 +409,7 @@ resize_geometry_data(int sz)
   d = static_cast<GlyphRenderDataCurvePairPrivate*>(m_d);
   assert(sz >= 0);
   d->m_geometry_data.resize(sz, fastuidraw::GlyphRenderDataCurvePair::entry(false));
+  d->update_bytes();
 }
 
 enum fastuidraw::return_code
@@ -20,6 +20,7 @@
 #include <vector>
 #include <fastuidraw/text/glyph_render_data_distance_field.hpp>
 #include "../private/util_private.hpp"
+#include "../private/memory_accounting_private.hpp"
 
 namespace
 {
@@ -27,7 +28,8 @@ namespace
   {
   public:
     GlyphDataPrivate(void):
-      m_resolution(0, 0)
+      m_resolution(0, 0),
+      m_bytes(fastuidraw::memory_accounting::glyph_render_data)
     {}
 
     void
@@ -37,10 +39,12 @@ namespace
       assert(sz.y() >= 0);
       m_texels.resize(sz.x() * sz.y());
       m_resolution = sz;
+      m_bytes.bytes(m_texels.size() * sizeof(uint8_t));
     }
 
     fastuidraw::ivec2 m_resolution;
     std::vector<uint8_t> m_texels;
+    fastuidraw::detail::AccountedBytes m_bytes;
   };
 }
 
@@ -4,7 +4,7 @@ dirstack_$(sp)	:= $(d)
 d		:= $(dir)
 # End standard header
 
-LIBRARY_PRIVATE_SOURCES += $(call filelist, rect_atlas.cpp freetype_util.cpp freetype_curvepair_util.cpp)
+LIBRARY_PRIVATE_SOURCES += $(call filelist, rect_atlas.cpp skyline_packer.cpp pinned_glyphs.cpp freetype_util.cpp freetype_curvepair_util.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
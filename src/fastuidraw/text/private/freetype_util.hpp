@@ -2314,6 +2314,28 @@ namespace detail
                             float max_dist,
                             bool compute_winding_number) const;
 
+    /*!\fn void compute_distance_values_sweep
+      Compute the L1 distance values, computing the distances
+      directly only for those texels near the outline and
+      propagating them to the remaining texels with a two
+      pass sweep. The running time does not depend on max_dist.
+      The values are never larger than those of
+      compute_distance_values() and equal to them for those
+      texels within max_dist/64 texels of the outline.
+      \param victim location to place the results, the
+                    dimensions of victim must be exactly
+                    the same as bitmap_size passed to the ctor.
+      \param max_dist The recorded distance is saturated to max_dist
+      \param compute_winding_number if true, compute the winding number
+                                    as well for each texel; the intersection
+                                    counts of distance_return_type::m_solution_count
+                                    are not computed, only the winding number.
+     */
+    void
+    compute_distance_values_sweep(array2d<distance_return_type> &victim,
+                                  float max_dist,
+                                  bool compute_winding_number) const;
+
     /*!\fn void compute_winding_numbers
       Compute the winding numbers, if you are calling already
       compute_distance_values(), extract the winding numbers
@@ -2536,6 +2558,14 @@ namespace detail
     compute_zero_derivative_values(array2d<distance_return_type> &victim,
                                    int radius) const;
 
+    void
+    compute_column_crossing_values(array2d<distance_return_type> &victim,
+                                   c_array<float> dist,
+                                   bool compute_winding_number) const;
+
+    void
+    compute_row_crossing_values(c_array<float> dist) const;
+
     void
     init_distance_values(array2d<distance_return_type> &victim,
                          float max_dist_value) const;
@@ -0,0 +1,77 @@
+/*!
+ * \file pinned_glyphs.cpp
+ * \brief file pinned_glyphs.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#include <algorithm>
+#include "pinned_glyphs.hpp"
+
+//////////////////////////////////////////
+// fastuidraw::detail::PinnedGlyphs methods
+void
+fastuidraw::detail::PinnedGlyphs::
+add(const_c_array<Glyph> glyphs)
+{
+  for(unsigned int i = 0; i < glyphs.size(); ++i)
+    {
+      if(glyphs[i].valid())
+        {
+          reference_counted_ptr<GlyphCache> cache(glyphs[i].cache());
+
+          /* almost always all glyphs are from one cache */
+          if(std::find(m_caches.begin(), m_caches.end(), cache) == m_caches.end())
+            {
+              m_caches.push_back(cache);
+            }
+          glyphs[i].pin();
+          m_glyphs.push_back(glyphs[i]);
+        }
+    }
+}
+
+void
+fastuidraw::detail::PinnedGlyphs::
+set(const_c_array<Glyph> glyphs)
+{
+  std::vector<Glyph> old_glyphs;
+  std::vector<reference_counted_ptr<GlyphCache> > old_caches;
+
+  /* pin the new glyphs before unpinning the old ones
+     so that a glyph in both is never unpinned.
+   */
+  old_glyphs.swap(m_glyphs);
+  old_caches.swap(m_caches);
+  add(glyphs);
+  for(unsigned int i = 0, endi = old_glyphs.size(); i < endi; ++i)
+    {
+      old_glyphs[i].unpin();
+    }
+}
+
+void
+fastuidraw::detail::PinnedGlyphs::
+clear(void)
+{
+  /* unpin before releasing the caches, the
+     last unpin() of a glyph may delete it.
+   */
+  for(unsigned int i = 0, endi = m_glyphs.size(); i < endi; ++i)
+    {
+      m_glyphs[i].unpin();
+    }
+  m_glyphs.clear();
+  m_caches.clear();
+}
@@ -0,0 +1,87 @@
+/*!
+ * \file pinned_glyphs.hpp
+ * \brief file pinned_glyphs.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/c_array.hpp>
+#include <fastuidraw/text/glyph.hpp>
+#include <fastuidraw/text/glyph_cache.hpp>
+
+#include "../../private/util_private.hpp"
+
+namespace fastuidraw {
+namespace detail {
+
+/*!\class PinnedGlyphs
+  Holds a pin (see Glyph::pin()) on each of a set of glyphs
+  and a reference to the GlyphCache of each, so that the
+  glyphs stay valid and in place in the GlyphAtlas for as
+  long as data made from them is alive.
+ */
+class PinnedGlyphs:fastuidraw::noncopyable
+{
+public:
+  PinnedGlyphs(void)
+  {}
+
+  ~PinnedGlyphs()
+  {
+    clear();
+  }
+
+  /*!\fn
+    Pin the valid glyphs of an array, keeping the
+    glyphs already pinned.
+   */
+  void
+  add(const_c_array<Glyph> glyphs);
+
+  /*!\fn
+    Pin the valid glyphs of an array and unpin the
+    glyphs pinned before; a glyph in both keeps
+    its pin throughout.
+   */
+  void
+  set(const_c_array<Glyph> glyphs);
+
+  /*!\fn
+    Unpin all glyphs.
+   */
+  void
+  clear(void);
+
+  /*!\fn
+    Returns the pinned glyphs.
+   */
+  const_c_array<Glyph>
+  glyphs(void) const
+  {
+    return make_c_array(m_glyphs);
+  }
+
+private:
+  std::vector<Glyph> m_glyphs;
+  std::vector<reference_counted_ptr<GlyphCache> > m_caches;
+};
+
+} //namespace detail
+} //namespace fastuidraw
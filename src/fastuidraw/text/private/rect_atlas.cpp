@@ -438,37 +438,64 @@ fast_check(ivec2 psize)
 ////////////////////////////////////
 // fastuidraw::detail::RectAtlas methods
 fastuidraw::detail::RectAtlas::
-RectAtlas(const ivec2 &dimensions):
+RectAtlas(const ivec2 &dimensions, enum allocator_t allocator):
+  m_dimensions(dimensions),
   m_root(nullptr),
-  m_empty_rect(this, ivec2(0, 0))
+  m_empty_rect(this, ivec2(0, 0)),
+  m_skyline(nullptr)
 {
-  m_root = FASTUIDRAWnew tree_node_without_children(nullptr, &m_tracker, ivec2(0,0), dimensions, nullptr);
+  if(allocator == skyline_allocator)
+    {
+      m_skyline = FASTUIDRAWnew SkylinePacker(dimensions);
+    }
+  else
+    {
+      m_root = FASTUIDRAWnew tree_node_without_children(nullptr, &m_tracker, ivec2(0,0), dimensions, nullptr);
+    }
 }
 
 fastuidraw::detail::RectAtlas::
 ~RectAtlas()
 {
-  assert(m_root != nullptr);
-  FASTUIDRAWdelete(m_root);
+  if(m_skyline)
+    {
+      clear();
+      FASTUIDRAWdelete(m_skyline);
+    }
+  else
+    {
+      assert(m_root != nullptr);
+      FASTUIDRAWdelete(m_root);
+    }
 }
 
 fastuidraw::ivec2
 fastuidraw::detail::RectAtlas::
 size(void) const
 {
-  assert(m_root != nullptr);
-  return m_root->size();
+  return m_dimensions;
 }
 
 void
 fastuidraw::detail::RectAtlas::
 clear(void)
 {
-  ivec2 dimensions(m_root->size());
-
   m_mutex.lock();
-  FASTUIDRAWdelete(m_root);
-  m_root = FASTUIDRAWnew tree_node_without_children(nullptr, &m_tracker, ivec2(0,0), dimensions, nullptr);
+  if(m_skyline)
+    {
+      for(std::set<rectangle*>::iterator iter = m_skyline_rectangles.begin(),
+            end = m_skyline_rectangles.end(); iter != end; ++iter)
+        {
+          FASTUIDRAWdelete(*iter);
+        }
+      m_skyline_rectangles.clear();
+      m_skyline->clear();
+    }
+  else
+    {
+      FASTUIDRAWdelete(m_root);
+      m_root = FASTUIDRAWnew tree_node_without_children(nullptr, &m_tracker, ivec2(0,0), m_dimensions, nullptr);
+    }
   m_mutex.unlock();
 }
 
@@ -481,7 +508,22 @@ add_rectangle(const ivec2 &dimensions,
   rectangle *return_value(nullptr);
 
   m_mutex.lock();
-  if(m_tracker.fast_check(dimensions))
+  if(m_skyline)
+    {
+      ivec2 location;
+
+      if(dimensions.x() <= 0 or dimensions.y() <= 0)
+        {
+          return_value = &m_empty_rect;
+        }
+      else if(m_skyline->allocate(dimensions, location) == routine_success)
+        {
+          return_value = FASTUIDRAWnew rectangle(this, dimensions);
+          set_minX_minY(return_value, location);
+          m_skyline_rectangles.insert(return_value);
+        }
+    }
+  else if(m_tracker.fast_check(dimensions))
     {
       add_remove_return_value R;
 
@@ -513,8 +555,11 @@ add_rectangle(const ivec2 &dimensions,
     }
   m_mutex.unlock();
 
-  return_value->finalize(left_padding, right_padding,
-                         top_padding, bottom_padding);
+  if(return_value != nullptr)
+    {
+      return_value->finalize(left_padding, right_padding,
+                             top_padding, bottom_padding);
+    }
   return return_value;
 }
 
@@ -532,6 +577,17 @@ remove_rectangle_implement(const rectangle *im)
       assert(im == &im->atlas()->m_empty_rect);
       return routine_success;
     }
+  else if(m_skyline)
+    {
+      rectangle *rect(const_cast<rectangle*>(im));
+
+      m_mutex.lock();
+      m_skyline->free(rect->minX_minY(), rect->size());
+      m_skyline_rectangles.erase(rect);
+      FASTUIDRAWdelete(rect);
+      m_mutex.unlock();
+      return routine_success;
+    }
   else
     {
       m_mutex.lock();
@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <list>
 #include <map>
+#include <set>
 
 #include <fastuidraw/util/reference_counted.hpp>
 #include <fastuidraw/util/util.hpp>
@@ -29,6 +30,7 @@
 #include <fastuidraw/util/c_array.hpp>
 
 #include "../../private/util_private.hpp"
+#include "skyline_packer.hpp"
 
 
 namespace fastuidraw {
@@ -44,6 +46,25 @@ private:
   class tree_base;
 
 public:
+  /*!\enum allocator_t
+    Enumeration of the ways a RectAtlas places
+    rectangles.
+   */
+  enum allocator_t
+    {
+      /*!
+        Binary tree of the regions of the atlas,
+        with the free sizes tracked by multimaps.
+       */
+      binary_tree_allocator,
+
+      /*!
+        Skyline bottom-left placement, see
+        SkylinePacker.
+       */
+      skyline_allocator,
+    };
+
   /*!\class rectangle
     An rectangle gives the location (i.e size and
     position) of a rectangle within a RectAtlas.
@@ -129,9 +150,11 @@ public:
   /*!\fn
     Ctor
     \param dimensions dimension of the atlas, this is then the return value to size().
+    \param allocator how the atlas places rectangles
    */
   explicit
-  RectAtlas(const ivec2 &dimensions);
+  RectAtlas(const ivec2 &dimensions,
+            enum allocator_t allocator = binary_tree_allocator);
 
   virtual
   ~RectAtlas();
@@ -388,10 +411,17 @@ private:
     rect->m_minX_minY = bl;
   }
 
+  ivec2 m_dimensions;
   freesize_tracker m_tracker;
   fastuidraw::mutex m_mutex;
   tree_base *m_root;
   rectangle m_empty_rect;
+
+  /* non-null only for skyline_allocator, in which case
+     m_root is null and the RectAtlas owns the rectangles.
+   */
+  SkylinePacker *m_skyline;
+  std::set<rectangle*> m_skyline_rectangles;
 };
 
 } //namespace detail_private
@@ -0,0 +1,381 @@
+/*!
+ * \file skyline_packer.cpp
+ * \brief file skyline_packer.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+#include <assert.h>
+#include "skyline_packer.hpp"
+
+//////////////////////////////////////////
+// fastuidraw::detail::SkylinePacker methods
+fastuidraw::detail::SkylinePacker::
+SkylinePacker(const ivec2 &dimensions):
+  m_dimensions(dimensions)
+{
+  clear();
+}
+
+fastuidraw::detail::SkylinePacker::
+~SkylinePacker()
+{}
+
+void
+fastuidraw::detail::SkylinePacker::
+clear(void)
+{
+  m_skyline.clear();
+  m_skyline.push_back(segment(0, 0, m_dimensions.x()));
+  m_min_skyline = 0;
+  m_free_rects.clear();
+  m_by_height.clear();
+  m_by_bottom.clear();
+  m_allocated_area = 0;
+}
+
+bool
+fastuidraw::detail::SkylinePacker::
+fast_check(const ivec2 &size) const
+{
+  if(size.x() > m_dimensions.x() || size.y() > m_dimensions.y())
+    {
+      return false;
+    }
+
+  return size.y() <= m_dimensions.y() - m_min_skyline
+    || (!m_by_height.empty() && m_by_height.rbegin()->first >= size.y());
+}
+
+enum fastuidraw::return_code
+fastuidraw::detail::SkylinePacker::
+allocate(const ivec2 &size, ivec2 &out_location)
+{
+  assert(size.x() > 0 && size.y() > 0);
+  if(!fast_check(size))
+    {
+      return routine_fail;
+    }
+
+  /* reuse free room first so that the skyline
+     rises only when there is no other choice.
+   */
+  if(allocate_from_free_rects(size, out_location)
+     || allocate_from_skyline(size, out_location))
+    {
+      m_allocated_area += size.x() * size.y();
+      return routine_success;
+    }
+  return routine_fail;
+}
+
+void
+fastuidraw::detail::SkylinePacker::
+free(const ivec2 &location, const ivec2 &size)
+{
+  std::vector<free_rect_list::iterator> absorbed;
+  std::vector<int> lowered_rows;
+
+  m_allocated_area -= size.x() * size.y();
+  assert(m_allocated_area >= 0);
+  if(m_allocated_area == 0)
+    {
+      clear();
+      return;
+    }
+
+  if(!lower_skyline(location.x(), size.x(), location.y(), location.y() + size.y()))
+    {
+      add_free_rect(location, size);
+      return;
+    }
+
+  /* the skyline went down to location.y(), free rectangles
+     whose bottom is there may now sit on the skyline too.
+   */
+  lowered_rows.push_back(location.y());
+  while(!lowered_rows.empty())
+    {
+      int row(lowered_rows.back());
+      std::pair<free_rect_map::iterator, free_rect_map::iterator> R;
+
+      lowered_rows.pop_back();
+      absorbed.clear();
+      R = m_by_bottom.equal_range(row);
+      for(free_rect_map::iterator iter = R.first; iter != R.second; ++iter)
+        {
+          absorbed.push_back(iter->second);
+        }
+
+      for(unsigned int i = 0; i < absorbed.size(); ++i)
+        {
+          ivec2 loc(absorbed[i]->m_location), sz(absorbed[i]->m_size);
+          if(lower_skyline(loc.x(), sz.x(), loc.y(), loc.y() + sz.y()))
+            {
+              remove_free_rect(absorbed[i]);
+              lowered_rows.push_back(loc.y());
+            }
+        }
+    }
+}
+
+bool
+fastuidraw::detail::SkylinePacker::
+allocate_from_free_rects(const ivec2 &size, ivec2 &out_location)
+{
+  /* number of fitting free rectangles after which
+     the search stops, bounding its cost.
+   */
+  const unsigned int max_candidates(16);
+
+  free_rect_list::iterator best(m_free_rects.end());
+  int best_waste(0);
+  unsigned int number_candidates(0);
+
+  /* best area fit among the free rectangles tall enough;
+     they are walked from the shortest, and the first that
+     fits exactly ends the search.
+   */
+  for(free_rect_map::iterator iter = m_by_height.lower_bound(size.y()),
+        end = m_by_height.end(); iter != end && number_candidates < max_candidates; ++iter)
+    {
+      const free_rect &F(*iter->second);
+      if(F.m_size.x() >= size.x())
+        {
+          int waste;
+
+          ++number_candidates;
+          waste = F.m_size.x() * F.m_size.y() - size.x() * size.y();
+          if(best == m_free_rects.end() || waste < best_waste)
+            {
+              best = iter->second;
+              best_waste = waste;
+              if(waste == 0)
+                {
+                  break;
+                }
+            }
+        }
+    }
+
+  if(best == m_free_rects.end())
+    {
+      return false;
+    }
+
+  ivec2 loc(best->m_location), sz(best->m_size);
+  int right_w, bottom_h;
+
+  remove_free_rect(best);
+  out_location = loc;
+
+  /* guillotine split of the remainder along the
+     shorter leftover axis.
+   */
+  right_w = sz.x() - size.x();
+  bottom_h = sz.y() - size.y();
+  if(right_w > bottom_h)
+    {
+      add_free_rect(ivec2(loc.x() + size.x(), loc.y()), ivec2(right_w, sz.y()));
+      add_free_rect(ivec2(loc.x(), loc.y() + size.y()), ivec2(size.x(), bottom_h));
+    }
+  else
+    {
+      add_free_rect(ivec2(loc.x() + size.x(), loc.y()), ivec2(right_w, size.y()));
+      add_free_rect(ivec2(loc.x(), loc.y() + size.y()), ivec2(sz.x(), bottom_h));
+    }
+  return true;
+}
+
+int
+fastuidraw::detail::SkylinePacker::
+fit(unsigned int i, int w) const
+{
+  int y(0);
+
+  if(m_skyline[i].m_x + w > m_dimensions.x())
+    {
+      return -1;
+    }
+
+  for(; w > 0; ++i)
+    {
+      assert(i < m_skyline.size());
+      y = t_max(y, m_skyline[i].m_y);
+      w -= m_skyline[i].m_width;
+    }
+  return y;
+}
+
+bool
+fastuidraw::detail::SkylinePacker::
+allocate_from_skyline(const ivec2 &size, ivec2 &out_location)
+{
+  int best_y(-1), best_width(0);
+  unsigned int best_i(0);
+
+  for(unsigned int i = 0, endi = m_skyline.size(); i < endi; ++i)
+    {
+      int y;
+
+      y = fit(i, size.x());
+      if(y >= 0 && y + size.y() <= m_dimensions.y()
+         && (best_y < 0 || y < best_y
+             || (y == best_y && m_skyline[i].m_width < best_width)))
+        {
+          best_y = y;
+          best_i = i;
+          best_width = m_skyline[i].m_width;
+        }
+    }
+
+  if(best_y < 0)
+    {
+      return false;
+    }
+
+  int x(m_skyline[best_i].m_x), end_x(x + size.x());
+  unsigned int first, last;
+
+  out_location = ivec2(x, best_y);
+
+  /* the room between the skyline and the bottom of
+     the placed rectangle becomes free rectangles.
+   */
+  first = split_skyline(x);
+  last = split_skyline(end_x);
+  for(unsigned int i = first; i < last; ++i)
+    {
+      if(m_skyline[i].m_y < best_y)
+        {
+          add_free_rect(ivec2(m_skyline[i].m_x, m_skyline[i].m_y),
+                        ivec2(m_skyline[i].m_width, best_y - m_skyline[i].m_y));
+        }
+    }
+
+  m_skyline.erase(m_skyline.begin() + first + 1, m_skyline.begin() + last);
+  m_skyline[first] = segment(x, best_y + size.y(), size.x());
+  merge_skyline();
+  update_min_skyline();
+  return true;
+}
+
+unsigned int
+fastuidraw::detail::SkylinePacker::
+split_skyline(int x)
+{
+  unsigned int i;
+
+  if(x >= m_dimensions.x())
+    {
+      return m_skyline.size();
+    }
+
+  for(i = 0; m_skyline[i].m_x + m_skyline[i].m_width <= x; ++i)
+    {}
+
+  if(m_skyline[i].m_x < x)
+    {
+      segment S(m_skyline[i]);
+
+      m_skyline[i].m_width = x - S.m_x;
+      m_skyline.insert(m_skyline.begin() + i + 1, segment(x, S.m_y, S.m_x + S.m_width - x));
+      ++i;
+    }
+  return i;
+}
+
+void
+fastuidraw::detail::SkylinePacker::
+merge_skyline(void)
+{
+  unsigned int j(0);
+  for(unsigned int i = 1, endi = m_skyline.size(); i < endi; ++i)
+    {
+      if(m_skyline[i].m_y == m_skyline[j].m_y)
+        {
+          m_skyline[j].m_width += m_skyline[i].m_width;
+        }
+      else
+        {
+          m_skyline[++j] = m_skyline[i];
+        }
+    }
+  m_skyline.erase(m_skyline.begin() + j + 1, m_skyline.end());
+}
+
+void
+fastuidraw::detail::SkylinePacker::
+update_min_skyline(void)
+{
+  m_min_skyline = m_dimensions.y();
+  for(unsigned int i = 0, endi = m_skyline.size(); i < endi; ++i)
+    {
+      m_min_skyline = t_min(m_min_skyline, m_skyline[i].m_y);
+    }
+}
+
+bool
+fastuidraw::detail::SkylinePacker::
+lower_skyline(int x, int w, int top, int bottom)
+{
+  unsigned int first, last;
+
+  /* check before splitting so that a failed
+     check leaves the skyline untouched.
+   */
+  for(unsigned int i = 0, endi = m_skyline.size(); i < endi; ++i)
+    {
+      const segment &S(m_skyline[i]);
+      if(S.m_x < x + w && x < S.m_x + S.m_width && S.m_y != bottom)
+        {
+          return false;
+        }
+    }
+
+  first = split_skyline(x);
+  last = split_skyline(x + w);
+  m_skyline.erase(m_skyline.begin() + first + 1, m_skyline.begin() + last);
+  m_skyline[first] = segment(x, top, w);
+  merge_skyline();
+  update_min_skyline();
+  return true;
+}
+
+void
+fastuidraw::detail::SkylinePacker::
+add_free_rect(const ivec2 &location, const ivec2 &size)
+{
+  free_rect_list::iterator iter;
+
+  if(size.x() <= 0 || size.y() <= 0)
+    {
+      return;
+    }
+
+  iter = m_free_rects.insert(m_free_rects.end(), free_rect());
+  iter->m_location = location;
+  iter->m_size = size;
+  iter->m_height_iter = m_by_height.insert(std::make_pair(size.y(), iter));
+  iter->m_bottom_iter = m_by_bottom.insert(std::make_pair(location.y() + size.y(), iter));
+}
+
+void
+fastuidraw::detail::SkylinePacker::
+remove_free_rect(free_rect_list::iterator iter)
+{
+  m_by_height.erase(iter->m_height_iter);
+  m_by_bottom.erase(iter->m_bottom_iter);
+  m_free_rects.erase(iter);
+}
@@ -0,0 +1,163 @@
+/*!
+ * \file skyline_packer.hpp
+ * \brief file skyline_packer.hpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/vecN.hpp>
+
+namespace fastuidraw {
+namespace detail {
+
+/*!\class SkylinePacker
+  Packs rectangles into a larger rectangle with the skyline
+  bottom-left heuristic: the skyline is the list of the lowest
+  free row of each column range and a rectangle is placed on
+  the skyline where its far edge is the lowest.
+
+  The room left under the skyline by a placement and the room
+  of rectangles freed that cannot be given back to the skyline
+  are kept as free rectangles, which are split guillotine style
+  to place later rectangles. A freed rectangle sitting on the
+  skyline, and then any free rectangle under it, is given back
+  to the skyline.
+
+  The largest free height is tracked so that fast_check() rejects
+  a rectangle that cannot fit in O(log n).
+ */
+class SkylinePacker:fastuidraw::noncopyable
+{
+public:
+  explicit
+  SkylinePacker(const ivec2 &dimensions);
+
+  ~SkylinePacker();
+
+  /*!\fn
+    Returns false if a rectangle of the size cannot
+    fit; may return true for a rectangle that does
+    not fit.
+   */
+  bool
+  fast_check(const ivec2 &size) const;
+
+  /*!\fn
+    Place a rectangle, returning routine_fail if
+    it does not fit.
+    \param size size of the rectangle
+    \param[out] out_location location of the rectangle
+   */
+  enum return_code
+  allocate(const ivec2 &size, ivec2 &out_location);
+
+  /*!\fn
+    Free a rectangle returned by allocate().
+   */
+  void
+  free(const ivec2 &location, const ivec2 &size);
+
+  /*!\fn
+    Free all rectangles.
+   */
+  void
+  clear(void);
+
+  const ivec2&
+  dimensions(void) const
+  {
+    return m_dimensions;
+  }
+
+private:
+  class segment
+  {
+  public:
+    segment(int x, int y, int w):
+      m_x(x), m_y(y), m_width(w)
+    {}
+
+    /* segment covers columns [m_x, m_x + m_width)
+       and rows [m_y, height) are free.
+     */
+    int m_x, m_y, m_width;
+  };
+
+  class free_rect;
+  typedef std::list<free_rect> free_rect_list;
+  typedef std::multimap<int, free_rect_list::iterator> free_rect_map;
+
+  class free_rect
+  {
+  public:
+    ivec2 m_location, m_size;
+
+    /* location in m_by_height and m_by_bottom */
+    free_rect_map::iterator m_height_iter, m_bottom_iter;
+  };
+
+  bool
+  allocate_from_free_rects(const ivec2 &size, ivec2 &out_location);
+
+  bool
+  allocate_from_skyline(const ivec2 &size, ivec2 &out_location);
+
+  /* returns the lowest free row to place a rectangle of width w
+     at the column of m_skyline[i], or -1 if it does not fit.
+   */
+  int
+  fit(unsigned int i, int w) const;
+
+  void
+  add_free_rect(const ivec2 &location, const ivec2 &size);
+
+  void
+  remove_free_rect(free_rect_list::iterator iter);
+
+  /* if the skyline over the columns [x, x + w) is exactly
+     at row bottom, lower it to row top and return true.
+   */
+  bool
+  lower_skyline(int x, int w, int top, int bottom);
+
+  /* split the segments of m_skyline so that one starts at x */
+  unsigned int
+  split_skyline(int x);
+
+  void
+  merge_skyline(void);
+
+  void
+  update_min_skyline(void);
+
+  ivec2 m_dimensions;
+  std::vector<segment> m_skyline;
+  int m_min_skyline;
+
+  free_rect_list m_free_rects;
+  free_rect_map m_by_height, m_by_bottom;
+
+  int64_t m_allocated_area;
+};
+
+} //namespace detail
+} //namespace fastuidraw
@@ -7,7 +7,8 @@ d		:= $(dir)
 LIBRARY_SOURCES += $(call filelist, static_resource.cpp \
 	fastuidraw_memory.cpp util.cpp blend_mode.cpp \
 	reference_count_mutex.cpp reference_count_atomic.cpp \
-	pixel_distance_math.cpp)
+	pixel_distance_math.cpp task_pool.cpp tracing.cpp \
+	memory_accounting.cpp bulk_copy.cpp)
 
 # Begin standard footer
 d		:= $(dirstack_$(sp))
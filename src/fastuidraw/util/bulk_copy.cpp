@@ -0,0 +1,585 @@
+/*!
+ * \file bulk_copy.cpp
+ * \brief file bulk_copy.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <assert.h>
+#include <cstring>
+#include <atomic>
+#include <fastuidraw/util/bulk_copy.hpp>
+
+/* The SIMD implementations are compiled with function target
+   attributes, so that they do not require the library to be
+   built for those instruction sets; which of them are used is
+   decided at runtime.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define FASTUIDRAW_BULK_COPY_X86
+  #include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #define FASTUIDRAW_BULK_COPY_NEON
+  #include <arm_neon.h>
+#endif
+
+namespace
+{
+  /* below these sizes the cost of aligning the destination
+     and of the fence outweighs the gain of the SIMD path.
+   */
+  enum
+    {
+      small_copy_bytes = 256,
+      small_copy_count = small_copy_bytes / sizeof(uint32_t)
+    };
+
+  class Implementation
+  {
+  public:
+    void (*m_copy)(void*, const void*, size_t);
+    void (*m_copy_add)(uint32_t*, const uint32_t*, size_t, uint32_t);
+    void (*m_copy_add_cached)(uint32_t*, const uint32_t*, size_t, uint32_t);
+    void (*m_fill)(uint32_t*, size_t, uint32_t);
+  };
+
+  ///////////////////////////////////
+  // scalar implementation
+  void
+  copy_scalar(void *dst, const void *src, size_t number_bytes)
+  {
+    std::memcpy(dst, src, number_bytes);
+  }
+
+  void
+  copy_add_scalar(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    for(size_t i = 0; i < count; ++i)
+      {
+        dst[i] = src[i] + value;
+      }
+  }
+
+  void
+  fill_scalar(uint32_t *dst, size_t count, uint32_t value)
+  {
+    for(size_t i = 0; i < count; ++i)
+      {
+        dst[i] = value;
+      }
+  }
+
+  /* returns the number of elements of type T to process
+     one at a time so that dst becomes aligned to A bytes.
+   */
+  template<size_t A, typename T>
+  size_t
+  count_to_alignment(const T *dst, size_t count)
+  {
+    size_t misalign, r;
+
+    misalign = reinterpret_cast<uintptr_t>(dst) & (A - 1);
+    if(misalign == 0 || misalign % sizeof(T) != 0)
+      {
+        /* already aligned or can never be */
+        return 0;
+      }
+    r = (A - misalign) / sizeof(T);
+    return (r < count) ? r : count;
+  }
+
+#ifdef FASTUIDRAW_BULK_COPY_X86
+  ///////////////////////////////////
+  // SSE2 implementation
+  __attribute__((target("sse2")))
+  void
+  copy_sse2(void *pdst, const void *psrc, size_t number_bytes)
+  {
+    uint8_t *dst(static_cast<uint8_t*>(pdst));
+    const uint8_t *src(static_cast<const uint8_t*>(psrc));
+    size_t head;
+
+    if(number_bytes < small_copy_bytes)
+      {
+        std::memcpy(dst, src, number_bytes);
+        return;
+      }
+
+    head = count_to_alignment<16>(dst, number_bytes);
+    std::memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    number_bytes -= head;
+
+    for(; number_bytes >= 64; number_bytes -= 64, dst += 64, src += 64)
+      {
+        __m128i a, b, c, d;
+
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+      }
+
+    for(; number_bytes >= 16; number_bytes -= 16, dst += 16, src += 16)
+      {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+      }
+
+    std::memcpy(dst, src, number_bytes);
+    _mm_sfence();
+  }
+
+  __attribute__((target("sse2")))
+  void
+  copy_add_sse2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    size_t head;
+    __m128i v;
+
+    if(count < small_copy_count)
+      {
+        copy_add_scalar(dst, src, count, value);
+        return;
+      }
+
+    head = count_to_alignment<16>(dst, count);
+    copy_add_scalar(dst, src, head, value);
+    dst += head;
+    src += head;
+    count -= head;
+
+    v = _mm_set1_epi32(static_cast<int>(value));
+    for(; count >= 16; count -= 16, dst += 16, src += 16)
+      {
+        __m128i a, b, c, d;
+
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4));
+        c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8));
+        d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi32(a, v));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_add_epi32(b, v));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_add_epi32(c, v));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 12), _mm_add_epi32(d, v));
+      }
+
+    for(; count >= 4; count -= 4, dst += 4, src += 4)
+      {
+        __m128i a;
+
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi32(a, v));
+      }
+
+    copy_add_scalar(dst, src, count, value);
+    _mm_sfence();
+  }
+
+  __attribute__((target("sse2")))
+  void
+  copy_add_cached_sse2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    __m128i v;
+
+    v = _mm_set1_epi32(static_cast<int>(value));
+    for(; count >= 4; count -= 4, dst += 4, src += 4)
+      {
+        __m128i a;
+
+        a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_add_epi32(a, v));
+      }
+    copy_add_scalar(dst, src, count, value);
+  }
+
+  __attribute__((target("sse2")))
+  void
+  fill_sse2(uint32_t *dst, size_t count, uint32_t value)
+  {
+    size_t head;
+    __m128i v;
+
+    if(count < small_copy_count)
+      {
+        fill_scalar(dst, count, value);
+        return;
+      }
+
+    head = count_to_alignment<16>(dst, count);
+    fill_scalar(dst, head, value);
+    dst += head;
+    count -= head;
+
+    v = _mm_set1_epi32(static_cast<int>(value));
+    for(; count >= 4; count -= 4, dst += 4)
+      {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), v);
+      }
+
+    fill_scalar(dst, count, value);
+    _mm_sfence();
+  }
+
+  ///////////////////////////////////
+  // AVX2 implementation
+  __attribute__((target("avx2")))
+  void
+  copy_avx2(void *pdst, const void *psrc, size_t number_bytes)
+  {
+    uint8_t *dst(static_cast<uint8_t*>(pdst));
+    const uint8_t *src(static_cast<const uint8_t*>(psrc));
+    size_t head;
+
+    if(number_bytes < small_copy_bytes)
+      {
+        std::memcpy(dst, src, number_bytes);
+        return;
+      }
+
+    head = count_to_alignment<32>(dst, number_bytes);
+    std::memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    number_bytes -= head;
+
+    for(; number_bytes >= 128; number_bytes -= 128, dst += 128, src += 128)
+      {
+        __m256i a, b, c, d;
+
+        a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+        c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+        d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+      }
+
+    for(; number_bytes >= 32; number_bytes -= 32, dst += 32, src += 32)
+      {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+      }
+
+    std::memcpy(dst, src, number_bytes);
+    _mm_sfence();
+  }
+
+  __attribute__((target("avx2")))
+  void
+  copy_add_avx2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    size_t head;
+    __m256i v;
+
+    if(count < small_copy_count)
+      {
+        copy_add_scalar(dst, src, count, value);
+        return;
+      }
+
+    head = count_to_alignment<32>(dst, count);
+    copy_add_scalar(dst, src, head, value);
+    dst += head;
+    src += head;
+    count -= head;
+
+    v = _mm256_set1_epi32(static_cast<int>(value));
+    for(; count >= 32; count -= 32, dst += 32, src += 32)
+      {
+        __m256i a, b, c, d;
+
+        a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 8));
+        c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 16));
+        d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 24));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi32(a, v));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 8), _mm256_add_epi32(b, v));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 16), _mm256_add_epi32(c, v));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 24), _mm256_add_epi32(d, v));
+      }
+
+    for(; count >= 8; count -= 8, dst += 8, src += 8)
+      {
+        __m256i a;
+
+        a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi32(a, v));
+      }
+
+    copy_add_scalar(dst, src, count, value);
+    _mm_sfence();
+  }
+
+  __attribute__((target("avx2")))
+  void
+  copy_add_cached_avx2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    __m256i v;
+
+    v = _mm256_set1_epi32(static_cast<int>(value));
+    for(; count >= 8; count -= 8, dst += 8, src += 8)
+      {
+        __m256i a;
+
+        a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi32(a, v));
+      }
+    copy_add_scalar(dst, src, count, value);
+  }
+
+  __attribute__((target("avx2")))
+  void
+  fill_avx2(uint32_t *dst, size_t count, uint32_t value)
+  {
+    size_t head;
+    __m256i v;
+
+    if(count < small_copy_count)
+      {
+        fill_scalar(dst, count, value);
+        return;
+      }
+
+    head = count_to_alignment<32>(dst, count);
+    fill_scalar(dst, head, value);
+    dst += head;
+    count -= head;
+
+    v = _mm256_set1_epi32(static_cast<int>(value));
+    for(; count >= 8; count -= 8, dst += 8)
+      {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), v);
+      }
+
+    fill_scalar(dst, count, value);
+    _mm_sfence();
+  }
+#endif
+
+#ifdef FASTUIDRAW_BULK_COPY_NEON
+  ///////////////////////////////////
+  // NEON implementation
+  void
+  copy_neon(void *pdst, const void *psrc, size_t number_bytes)
+  {
+    uint8_t *dst(static_cast<uint8_t*>(pdst));
+    const uint8_t *src(static_cast<const uint8_t*>(psrc));
+
+    if(number_bytes < small_copy_bytes)
+      {
+        std::memcpy(dst, src, number_bytes);
+        return;
+      }
+
+    for(; number_bytes >= 64; number_bytes -= 64, dst += 64, src += 64)
+      {
+        uint8x16_t a, b, c, d;
+
+        a = vld1q_u8(src);
+        b = vld1q_u8(src + 16);
+        c = vld1q_u8(src + 32);
+        d = vld1q_u8(src + 48);
+        vst1q_u8(dst, a);
+        vst1q_u8(dst + 16, b);
+        vst1q_u8(dst + 32, c);
+        vst1q_u8(dst + 48, d);
+      }
+    std::memcpy(dst, src, number_bytes);
+  }
+
+  void
+  copy_add_neon(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+  {
+    uint32x4_t v;
+
+    v = vdupq_n_u32(value);
+    for(; count >= 16; count -= 16, dst += 16, src += 16)
+      {
+        vst1q_u32(dst, vaddq_u32(vld1q_u32(src), v));
+        vst1q_u32(dst + 4, vaddq_u32(vld1q_u32(src + 4), v));
+        vst1q_u32(dst + 8, vaddq_u32(vld1q_u32(src + 8), v));
+        vst1q_u32(dst + 12, vaddq_u32(vld1q_u32(src + 12), v));
+      }
+    for(; count >= 4; count -= 4, dst += 4, src += 4)
+      {
+        vst1q_u32(dst, vaddq_u32(vld1q_u32(src), v));
+      }
+    copy_add_scalar(dst, src, count, value);
+  }
+
+  void
+  fill_neon(uint32_t *dst, size_t count, uint32_t value)
+  {
+    uint32x4_t v;
+
+    v = vdupq_n_u32(value);
+    for(; count >= 4; count -= 4, dst += 4)
+      {
+        vst1q_u32(dst, v);
+      }
+    fill_scalar(dst, count, value);
+  }
+#endif
+
+  class BulkCopyState
+  {
+  public:
+    BulkCopyState(void)
+    {
+      Implementation null_impl = { nullptr, nullptr, nullptr, nullptr };
+      Implementation scalar_impl = { copy_scalar, copy_add_scalar, copy_add_scalar, fill_scalar };
+
+      for(unsigned int i = 0; i < fastuidraw::bulk_copy::number_implementations; ++i)
+        {
+          m_implementations[i] = null_impl;
+        }
+      m_implementations[fastuidraw::bulk_copy::scalar_implementation] = scalar_impl;
+
+      #ifdef FASTUIDRAW_BULK_COPY_X86
+        {
+          Implementation sse2_impl = { copy_sse2, copy_add_sse2, copy_add_cached_sse2, fill_sse2 };
+          Implementation avx2_impl = { copy_avx2, copy_add_avx2, copy_add_cached_avx2, fill_avx2 };
+
+          __builtin_cpu_init();
+          if(__builtin_cpu_supports("sse2"))
+            {
+              m_implementations[fastuidraw::bulk_copy::sse2_implementation] = sse2_impl;
+            }
+          if(__builtin_cpu_supports("avx2"))
+            {
+              m_implementations[fastuidraw::bulk_copy::avx2_implementation] = avx2_impl;
+            }
+        }
+      #endif
+
+      #ifdef FASTUIDRAW_BULK_COPY_NEON
+        {
+          /* the NEON stores are regular stores already */
+          Implementation neon_impl = { copy_neon, copy_add_neon, copy_add_neon, fill_neon };
+          m_implementations[fastuidraw::bulk_copy::neon_implementation] = neon_impl;
+        }
+      #endif
+
+      m_current = fastuidraw::bulk_copy::scalar_implementation;
+      for(unsigned int i = 0; i < fastuidraw::bulk_copy::number_implementations; ++i)
+        {
+          if(m_implementations[i].m_copy)
+            {
+              m_current = i;
+            }
+        }
+    }
+
+    const Implementation&
+    current(void) const
+    {
+      return m_implementations[m_current.load(std::memory_order_relaxed)];
+    }
+
+    Implementation m_implementations[fastuidraw::bulk_copy::number_implementations];
+    std::atomic<unsigned int> m_current;
+  };
+
+  BulkCopyState&
+  bulk_copy_state(void)
+  {
+    static BulkCopyState R;
+    return R;
+  }
+}
+
+bool
+fastuidraw::bulk_copy::
+supported(enum implementation_t v)
+{
+  return v < number_implementations
+    && bulk_copy_state().m_implementations[v].m_copy != nullptr;
+}
+
+enum fastuidraw::bulk_copy::implementation_t
+fastuidraw::bulk_copy::
+implementation(void)
+{
+  return static_cast<enum implementation_t>(bulk_copy_state().m_current.load());
+}
+
+bool
+fastuidraw::bulk_copy::
+implementation(enum implementation_t v)
+{
+  if(!supported(v))
+    {
+      return false;
+    }
+  bulk_copy_state().m_current.store(v);
+  return true;
+}
+
+const char*
+fastuidraw::bulk_copy::
+label(enum implementation_t v)
+{
+  #define EASY(X) case X##_implementation: return #X
+
+  switch(v)
+    {
+      EASY(scalar);
+      EASY(sse2);
+      EASY(avx2);
+      EASY(neon);
+    default:
+      return "unknown";
+    }
+
+  #undef EASY
+}
+
+void
+fastuidraw::bulk_copy::
+copy(void *dst, const void *src, size_t number_bytes)
+{
+  bulk_copy_state().current().m_copy(dst, src, number_bytes);
+}
+
+void
+fastuidraw::bulk_copy::
+copy_add(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+{
+  bulk_copy_state().current().m_copy_add(dst, src, count, value);
+}
+
+void
+fastuidraw::bulk_copy::
+copy_add_cached(uint32_t *dst, const uint32_t *src, size_t count, uint32_t value)
+{
+  bulk_copy_state().current().m_copy_add_cached(dst, src, count, value);
+}
+
+void
+fastuidraw::bulk_copy::
+fill(uint32_t *dst, size_t count, uint32_t value)
+{
+  bulk_copy_state().current().m_fill(dst, count, value);
+}
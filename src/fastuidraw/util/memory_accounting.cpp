@@ -0,0 +1,267 @@
+/*!
+ * \file memory_accounting.cpp
+ * \brief file memory_accounting.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <assert.h>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <fastuidraw/util/memory_accounting.hpp>
+#include "../private/memory_accounting_private.hpp"
+
+namespace
+{
+  class AccountingState:fastuidraw::noncopyable
+  {
+  public:
+    AccountingState(void):
+      m_clock(1u)
+    {
+      for(unsigned int i = 0; i < fastuidraw::memory_accounting::number_categories; ++i)
+        {
+          m_live[i] = 0;
+          m_peak[i] = 0;
+          m_budget[i] = 0;
+        }
+    }
+
+    std::atomic<int64_t> m_live[fastuidraw::memory_accounting::number_categories];
+    std::atomic<int64_t> m_peak[fastuidraw::memory_accounting::number_categories];
+    std::atomic<uint64_t> m_budget[fastuidraw::memory_accounting::number_categories];
+
+    /* incremented by each enforce_budgets(), an EvictableCache
+       records the value at which it was last used.
+     */
+    std::atomic<uint64_t> m_clock;
+
+    /* the mutex is recursive because evicting a cache can
+       destroy other caches, which unregister themselves.
+     */
+    std::recursive_mutex m_mutex;
+    std::set<fastuidraw::detail::EvictableCache*> m_caches;
+  };
+
+  AccountingState&
+  accounting_state(void)
+  {
+    static AccountingState R;
+    return R;
+  }
+
+  bool
+  compare_last_used(const fastuidraw::detail::EvictableCache *lhs,
+                    const fastuidraw::detail::EvictableCache *rhs)
+  {
+    return lhs->last_used() < rhs->last_used();
+  }
+}
+
+////////////////////////////////////////
+// fastuidraw::detail methods
+void
+fastuidraw::detail::
+account_bytes(enum memory_accounting::category_t c, int64_t delta)
+{
+  AccountingState &S(accounting_state());
+  int64_t v, p;
+
+  assert(c < memory_accounting::number_categories);
+  if(delta == 0)
+    {
+      return;
+    }
+
+  v = S.m_live[c].fetch_add(delta, std::memory_order_relaxed) + delta;
+  assert(v >= 0);
+
+  p = S.m_peak[c].load(std::memory_order_relaxed);
+  while(v > p && !S.m_peak[c].compare_exchange_weak(p, v, std::memory_order_relaxed))
+    {}
+}
+
+/////////////////////////////////////////
+// fastuidraw::detail::EvictableCache methods
+fastuidraw::detail::EvictableCache::
+EvictableCache(uint32_t category_mask):
+  m_category_mask(category_mask),
+  m_last_used(0u),
+  m_registered(false)
+{
+  touch();
+}
+
+fastuidraw::detail::EvictableCache::
+~EvictableCache()
+{
+  /* the derived class must unregister before
+     its own data is destroyed.
+   */
+  assert(!m_registered);
+}
+
+void
+fastuidraw::detail::EvictableCache::
+touch(void)
+{
+  m_last_used.store(accounting_state().m_clock.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+}
+
+void
+fastuidraw::detail::EvictableCache::
+register_cache(void)
+{
+  AccountingState &S(accounting_state());
+  std::lock_guard<std::recursive_mutex> M(S.m_mutex);
+
+  assert(!m_registered);
+  S.m_caches.insert(this);
+  m_registered = true;
+}
+
+void
+fastuidraw::detail::EvictableCache::
+unregister_cache(void)
+{
+  AccountingState &S(accounting_state());
+  std::lock_guard<std::recursive_mutex> M(S.m_mutex);
+
+  if(m_registered)
+    {
+      S.m_caches.erase(this);
+      m_registered = false;
+    }
+}
+
+////////////////////////////////////////
+// fastuidraw::memory_accounting methods
+uint64_t
+fastuidraw::memory_accounting::
+live_bytes(enum category_t c)
+{
+  assert(c < number_categories);
+  return accounting_state().m_live[c].load(std::memory_order_relaxed);
+}
+
+uint64_t
+fastuidraw::memory_accounting::
+peak_bytes(enum category_t c)
+{
+  assert(c < number_categories);
+  return accounting_state().m_peak[c].load(std::memory_order_relaxed);
+}
+
+void
+fastuidraw::memory_accounting::
+reset_peak_bytes(void)
+{
+  AccountingState &S(accounting_state());
+  for(unsigned int i = 0; i < number_categories; ++i)
+    {
+      S.m_peak[i].store(S.m_live[i].load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+}
+
+const char*
+fastuidraw::memory_accounting::
+label(enum category_t c)
+{
+  #define EASY(X) case X: return #X
+
+  switch(c)
+    {
+      EASY(tessellation);
+      EASY(filled_path_data);
+      EASY(stroked_path_data);
+      EASY(glyph_render_data);
+      EASY(image_tiles);
+      EASY(colorstop_intervals);
+    default:
+      return "unknown";
+    }
+
+  #undef EASY
+}
+
+uint64_t
+fastuidraw::memory_accounting::
+soft_budget(enum category_t c)
+{
+  assert(c < number_categories);
+  return accounting_state().m_budget[c].load(std::memory_order_relaxed);
+}
+
+void
+fastuidraw::memory_accounting::
+soft_budget(enum category_t c, uint64_t v)
+{
+  assert(c < number_categories);
+  accounting_state().m_budget[c].store(v, std::memory_order_relaxed);
+}
+
+unsigned int
+fastuidraw::memory_accounting::
+enforce_budgets(void)
+{
+  AccountingState &S(accounting_state());
+  std::lock_guard<std::recursive_mutex> M(S.m_mutex);
+  std::vector<detail::EvictableCache*> candidates;
+  unsigned int return_value(0);
+  uint64_t clock;
+
+  clock = S.m_clock.load(std::memory_order_relaxed);
+  for(unsigned int i = 0; i < number_categories; ++i)
+    {
+      enum category_t c(static_cast<enum category_t>(i));
+      uint64_t budget(soft_budget(c));
+
+      if(budget == 0 || live_bytes(c) <= budget)
+        {
+          continue;
+        }
+
+      candidates.clear();
+      for(std::set<detail::EvictableCache*>::const_iterator iter = S.m_caches.begin(),
+            end = S.m_caches.end(); iter != end; ++iter)
+        {
+          if(((*iter)->category_mask() & (1u << c)) != 0u && (*iter)->last_used() < clock)
+            {
+              candidates.push_back(*iter);
+            }
+        }
+      std::stable_sort(candidates.begin(), candidates.end(), compare_last_used);
+
+      for(unsigned int k = 0; k < candidates.size() && live_bytes(c) > budget; ++k)
+        {
+          /* an eviction may have destroyed (and thus
+             unregistered) caches after it in candidates.
+           */
+          if(S.m_caches.find(candidates[k]) != S.m_caches.end()
+             && candidates[k]->evict(c))
+            {
+              ++return_value;
+            }
+        }
+    }
+
+  S.m_clock.store(clock + 1u, std::memory_order_relaxed);
+  return return_value;
+}
@@ -0,0 +1,331 @@
+/*!
+ * \file task_pool.cpp
+ * \brief file task_pool.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <assert.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <fastuidraw/util/fastuidraw_memory.hpp>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/util/task_pool.hpp>
+
+namespace
+{
+  class TaskPrivate:fastuidraw::noncopyable
+  {
+  public:
+    TaskPrivate(void):
+      m_started(false),
+      m_finished(false)
+    {}
+
+    /* returns true if the caller is to execute the task
+     */
+    bool
+    start(void)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(m_started)
+        {
+          return false;
+        }
+      m_started = true;
+      return true;
+    }
+
+    void
+    mark_finished(void)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished = true;
+      m_cond.notify_all();
+    }
+
+    void
+    wait(void)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while(!m_finished)
+        {
+          m_cond.wait(lock);
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_started;
+    bool m_finished;
+  };
+
+  class TaskPoolPrivate:fastuidraw::noncopyable
+  {
+  public:
+    typedef fastuidraw::reference_counted_ptr<fastuidraw::TaskPool::Task> task_ref;
+
+    explicit
+    TaskPoolPrivate(unsigned int number_threads);
+
+    ~TaskPoolPrivate();
+
+    void
+    add_task(const task_ref &task);
+
+    void
+    wait_all(void);
+
+    unsigned int
+    number_pending_tasks(void)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_number_pending;
+    }
+
+    unsigned int
+    number_threads(void) const
+    {
+      return m_threads.size();
+    }
+
+  private:
+    static
+    void
+    worker(TaskPoolPrivate *p);
+
+    std::mutex m_mutex;
+    std::condition_variable m_task_added;
+    std::condition_variable m_task_finished;
+    std::deque<task_ref> m_tasks;
+    unsigned int m_number_pending;
+    bool m_stopping;
+    std::vector<std::thread> m_threads;
+  };
+}
+
+////////////////////////////////////////
+// TaskPoolPrivate methods
+TaskPoolPrivate::
+TaskPoolPrivate(unsigned int number_threads):
+  m_number_pending(0),
+  m_stopping(false)
+{
+  if(number_threads == 0)
+    {
+      number_threads = fastuidraw::t_max(1u, std::thread::hardware_concurrency());
+    }
+
+  m_threads.reserve(number_threads);
+  for(unsigned int i = 0; i < number_threads; ++i)
+    {
+      m_threads.push_back(std::thread(worker, this));
+    }
+}
+
+TaskPoolPrivate::
+~TaskPoolPrivate()
+{
+  wait_all();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    m_task_added.notify_all();
+  }
+
+  for(std::vector<std::thread>::iterator iter = m_threads.begin(),
+        end = m_threads.end(); iter != end; ++iter)
+    {
+      iter->join();
+    }
+}
+
+void
+TaskPoolPrivate::
+add_task(const task_ref &task)
+{
+  assert(task);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_tasks.push_back(task);
+  ++m_number_pending;
+  m_task_added.notify_one();
+}
+
+void
+TaskPoolPrivate::
+wait_all(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(m_number_pending > 0)
+    {
+      m_task_finished.wait(lock);
+    }
+}
+
+void
+TaskPoolPrivate::
+worker(TaskPoolPrivate *p)
+{
+  for(;;)
+    {
+      task_ref task;
+
+      {
+        std::unique_lock<std::mutex> lock(p->m_mutex);
+        while(p->m_tasks.empty() && !p->m_stopping)
+          {
+            p->m_task_added.wait(lock);
+          }
+
+        if(p->m_tasks.empty())
+          {
+            assert(p->m_stopping);
+            return;
+          }
+
+        task = p->m_tasks.front();
+        p->m_tasks.pop_front();
+      }
+
+      task->run();
+
+      /* release our reference before signaling that the
+         task is done so that any resources the task holds
+         are freed before a waiter proceeds.
+       */
+      task = task_ref();
+
+      {
+        std::lock_guard<std::mutex> lock(p->m_mutex);
+        assert(p->m_number_pending > 0);
+        --p->m_number_pending;
+        p->m_task_finished.notify_all();
+      }
+    }
+}
+
+//////////////////////////////////////////
+// fastuidraw::TaskPool::Task methods
+fastuidraw::TaskPool::Task::
+Task(void)
+{
+  m_d = FASTUIDRAWnew TaskPrivate();
+}
+
+fastuidraw::TaskPool::Task::
+~Task()
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+bool
+fastuidraw::TaskPool::Task::
+finished(void) const
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  std::lock_guard<std::mutex> lock(d->m_mutex);
+  return d->m_finished;
+}
+
+void
+fastuidraw::TaskPool::Task::
+wait(void) const
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+  d->wait();
+}
+
+void
+fastuidraw::TaskPool::Task::
+run(void)
+{
+  TaskPrivate *d;
+  d = static_cast<TaskPrivate*>(m_d);
+
+  if(d->start())
+    {
+      run_task();
+      d->mark_finished();
+    }
+  else
+    {
+      d->wait();
+    }
+}
+
+//////////////////////////////////////////
+// fastuidraw::TaskPool methods
+fastuidraw::TaskPool::
+TaskPool(unsigned int number_threads)
+{
+  m_d = FASTUIDRAWnew TaskPoolPrivate(number_threads);
+}
+
+fastuidraw::TaskPool::
+~TaskPool()
+{
+  TaskPoolPrivate *d;
+  d = static_cast<TaskPoolPrivate*>(m_d);
+  FASTUIDRAWdelete(d);
+  m_d = nullptr;
+}
+
+unsigned int
+fastuidraw::TaskPool::
+number_threads(void) const
+{
+  TaskPoolPrivate *d;
+  d = static_cast<TaskPoolPrivate*>(m_d);
+  return d->number_threads();
+}
+
+void
+fastuidraw::TaskPool::
+add_task(const reference_counted_ptr<Task> &task)
+{
+  TaskPoolPrivate *d;
+  d = static_cast<TaskPoolPrivate*>(m_d);
+  d->add_task(task);
+}
+
+unsigned int
+fastuidraw::TaskPool::
+number_pending_tasks(void) const
+{
+  TaskPoolPrivate *d;
+  d = static_cast<TaskPoolPrivate*>(m_d);
+  return d->number_pending_tasks();
+}
+
+void
+fastuidraw::TaskPool::
+wait_all(void)
+{
+  TaskPoolPrivate *d;
+  d = static_cast<TaskPoolPrivate*>(m_d);
+  d->wait_all();
+}
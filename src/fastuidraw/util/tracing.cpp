@@ -0,0 +1,395 @@
+/*!
+ * \file tracing.cpp
+ * \brief file tracing.cpp
+ *
+ * Copyright 2016 by Intel.
+ *
+ * Contact: kevin.rogovin@intel.com
+ *
+ * This Source Code Form is subject to the
+ * terms of the Mozilla Public License, v. 2.0.
+ * If a copy of the MPL was not distributed with
+ * this file, You can obtain one at
+ * http://mozilla.org/MPL/2.0/.
+ *
+ * \author Kevin Rogovin <kevin.rogovin@intel.com>
+ *
+ */
+
+
+#include <assert.h>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fastuidraw/util/util.hpp>
+#include <fastuidraw/util/math.hpp>
+#include <fastuidraw/util/tracing.hpp>
+
+namespace
+{
+  class Zone
+  {
+  public:
+    const char *m_name;
+    uint64_t m_begin, m_end;
+  };
+
+  /* The zones of a single thread; only that thread writes
+     zones, m_mutex is (almost always uncontended) to allow
+     for exporting and resetting from another thread.
+   */
+  class ThreadBuffer:fastuidraw::noncopyable
+  {
+  public:
+    ThreadBuffer(unsigned int thread_id, unsigned int size):
+      m_thread_id(thread_id),
+      m_thread_exited(false),
+      m_capacity(fastuidraw::t_max(size, 1u)),
+      m_next(0),
+      m_count(0)
+    {}
+
+    void
+    add(const Zone &Z)
+    {
+      std::lock_guard<std::mutex> M(m_mutex);
+
+      /* grow up to m_capacity so that a thread that records
+         few zones does not pay for a full ring buffer.
+       */
+      if(m_zones.size() < m_capacity)
+        {
+          m_zones.push_back(Z);
+          m_next = m_zones.size() % m_capacity;
+        }
+      else
+        {
+          m_zones[m_next] = Z;
+          m_next = (m_next + 1u) % m_capacity;
+        }
+      m_count = fastuidraw::t_min(m_count + 1u, static_cast<unsigned int>(m_zones.size()));
+    }
+
+    void
+    clear(void)
+    {
+      std::lock_guard<std::mutex> M(m_mutex);
+      std::vector<Zone>().swap(m_zones);
+      m_next = 0;
+      m_count = 0;
+    }
+
+    unsigned int m_thread_id;
+
+    /* set when the thread exits, the buffer is
+       removed by the next tracing::reset().
+     */
+    bool m_thread_exited;
+
+    std::mutex m_mutex;
+    std::vector<Zone> m_zones;
+    unsigned int m_capacity;
+
+    /* index to which the next zone is written
+       and the number of valid zones, the oldest
+       zone is at m_next - m_count (modulo size).
+     */
+    unsigned int m_next, m_count;
+  };
+
+  class TracingState:fastuidraw::noncopyable
+  {
+  public:
+    TracingState(void):
+      m_enabled(false),
+      m_ring_buffer_size(65536),
+      m_start(std::chrono::steady_clock::now()),
+      m_next_thread_id(0)
+    {
+      for(unsigned int i = 0; i < fastuidraw::tracing::number_counters; ++i)
+        {
+          m_counters[i] = 0;
+        }
+    }
+
+    ThreadBuffer*
+    register_thread(void)
+    {
+      std::lock_guard<std::mutex> M(m_mutex);
+      m_buffers.emplace_back(m_next_thread_id++, m_ring_buffer_size.load());
+      return &m_buffers.back();
+    }
+
+    std::atomic<bool> m_enabled;
+    std::atomic<unsigned int> m_ring_buffer_size;
+    std::atomic<uint64_t> m_counters[fastuidraw::tracing::number_counters];
+    std::chrono::steady_clock::time_point m_start;
+
+    /* the ThreadBuffer of a thread that exited is kept until
+       the next reset() so that its zones can still be exported.
+     */
+    std::mutex m_mutex;
+    std::list<ThreadBuffer> m_buffers;
+    unsigned int m_next_thread_id;
+  };
+
+  TracingState&
+  tracing_state(void)
+  {
+    static TracingState R;
+    return R;
+  }
+
+  /* marks the ThreadBuffer of a thread as exited
+     when the thread's storage is destroyed.
+   */
+  class ThreadBufferHandle:fastuidraw::noncopyable
+  {
+  public:
+    ThreadBufferHandle(void):
+      m_buffer(nullptr)
+    {}
+
+    ~ThreadBufferHandle()
+    {
+      if(m_buffer)
+        {
+          std::lock_guard<std::mutex> M(tracing_state().m_mutex);
+          m_buffer->m_thread_exited = true;
+        }
+    }
+
+    ThreadBuffer *m_buffer;
+  };
+
+  ThreadBuffer*
+  thread_buffer(void)
+  {
+    static thread_local ThreadBufferHandle R;
+    if(!R.m_buffer)
+      {
+        R.m_buffer = tracing_state().register_thread();
+      }
+    return R.m_buffer;
+  }
+
+  void
+  write_time_us(std::ostream &str, uint64_t ns)
+  {
+    /* Chrome trace-event times are in microseconds */
+    str << ns / 1000u << "." << (ns % 1000u) / 100u << (ns % 100u) / 10u << ns % 10u;
+  }
+
+  void
+  write_json_string(std::ostream &str, const char *s)
+  {
+    str << "\"";
+    for(; *s; ++s)
+      {
+        if(*s == '"' || *s == '\\')
+          {
+            str << '\\';
+          }
+        str << *s;
+      }
+    str << "\"";
+  }
+}
+
+bool
+fastuidraw::tracing::
+enabled(void)
+{
+  return tracing_state().m_enabled.load(std::memory_order_relaxed);
+}
+
+void
+fastuidraw::tracing::
+enabled(bool v)
+{
+  tracing_state().m_enabled.store(v, std::memory_order_relaxed);
+}
+
+bool
+fastuidraw::tracing::
+compiled_in(void)
+{
+  #ifdef FASTUIDRAW_TRACING
+    {
+      return true;
+    }
+  #else
+    {
+      return false;
+    }
+  #endif
+}
+
+unsigned int
+fastuidraw::tracing::
+ring_buffer_size(void)
+{
+  return tracing_state().m_ring_buffer_size.load();
+}
+
+void
+fastuidraw::tracing::
+ring_buffer_size(unsigned int v)
+{
+  tracing_state().m_ring_buffer_size.store(v);
+}
+
+uint64_t
+fastuidraw::tracing::
+time_nanoseconds(void)
+{
+  std::chrono::steady_clock::duration d;
+  d = std::chrono::steady_clock::now() - tracing_state().m_start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void
+fastuidraw::tracing::
+add_zone(const char *name, uint64_t begin_ns, uint64_t end_ns)
+{
+  Zone Z;
+
+  Z.m_name = name;
+  Z.m_begin = begin_ns;
+  Z.m_end = end_ns;
+  thread_buffer()->add(Z);
+}
+
+void
+fastuidraw::tracing::
+add_counter(enum counter_t c, uint64_t v)
+{
+  TracingState &S(tracing_state());
+
+  assert(c < number_counters);
+  if(S.m_enabled.load(std::memory_order_relaxed))
+    {
+      S.m_counters[c].fetch_add(v, std::memory_order_relaxed);
+    }
+}
+
+uint64_t
+fastuidraw::tracing::
+counter(enum counter_t c)
+{
+  assert(c < number_counters);
+  return tracing_state().m_counters[c].load(std::memory_order_relaxed);
+}
+
+const char*
+fastuidraw::tracing::
+counter_label(enum counter_t c)
+{
+  #define EASY(X) case X: return #X
+
+  switch(c)
+    {
+      EASY(draw_breaks_blend_mode);
+      EASY(draw_breaks_item_shader_group);
+      EASY(draw_breaks_blend_shader_group);
+      EASY(draw_breaks_brush_shader);
+      EASY(draw_breaks_discard);
+      EASY(attribute_bytes);
+      EASY(header_attribute_bytes);
+      EASY(index_bytes);
+      EASY(data_store_bytes);
+      EASY(buffer_wait_nanoseconds);
+    default:
+      return "unknown";
+    }
+
+  #undef EASY
+}
+
+void
+fastuidraw::tracing::
+reset(void)
+{
+  TracingState &S(tracing_state());
+  std::lock_guard<std::mutex> M(S.m_mutex);
+
+  for(std::list<ThreadBuffer>::iterator iter = S.m_buffers.begin(); iter != S.m_buffers.end();)
+    {
+      if(iter->m_thread_exited)
+        {
+          iter = S.m_buffers.erase(iter);
+        }
+      else
+        {
+          iter->clear();
+          ++iter;
+        }
+    }
+
+  for(unsigned int i = 0; i < number_counters; ++i)
+    {
+      S.m_counters[i] = 0;
+    }
+}
+
+void
+fastuidraw::tracing::
+write_chrome_trace(std::ostream &str)
+{
+  TracingState &S(tracing_state());
+  std::lock_guard<std::mutex> M(S.m_mutex);
+  std::vector<Zone> zones;
+  const char *prefix("\n    ");
+
+  str << "{\n  \"traceEvents\": [";
+  for(std::list<ThreadBuffer>::iterator iter = S.m_buffers.begin(),
+        end = S.m_buffers.end(); iter != end; ++iter)
+    {
+      ThreadBuffer &B(*iter);
+      unsigned int sz;
+
+      /* copy the zones so that the thread
+         is not blocked while we write.
+       */
+      {
+        std::lock_guard<std::mutex> MB(B.m_mutex);
+        sz = B.m_zones.size();
+        zones.clear();
+        for(unsigned int i = 0; i < B.m_count; ++i)
+          {
+            zones.push_back(B.m_zones[(B.m_next + sz - B.m_count + i) % sz]);
+          }
+      }
+
+      str << prefix << "{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+          << B.m_thread_id << ", \"args\": { \"name\": \"thread " << B.m_thread_id << "\" } }";
+      prefix = ",\n    ";
+
+      for(unsigned int i = 0, endi = zones.size(); i < endi; ++i)
+        {
+          str << prefix << "{ \"name\": ";
+          write_json_string(str, zones[i].m_name);
+          str << ", \"cat\": \"fastuidraw\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+              << B.m_thread_id << ", \"ts\": ";
+          write_time_us(str, zones[i].m_begin);
+          str << ", \"dur\": ";
+          write_time_us(str, zones[i].m_end - zones[i].m_begin);
+          str << " }";
+        }
+    }
+
+  uint64_t now(time_nanoseconds());
+  for(unsigned int i = 0; i < number_counters; ++i)
+    {
+      enum counter_t c(static_cast<enum counter_t>(i));
+
+      str << prefix << "{ \"name\": \"" << counter_label(c)
+          << "\", \"cat\": \"fastuidraw\", \"ph\": \"C\", \"pid\": 1, \"ts\": ";
+      write_time_us(str, now);
+      str << ", \"args\": { \"value\": " << counter(c) << " } }";
+      prefix = ",\n    ";
+    }
+  str << "\n  ],\n  \"displayTimeUnit\": \"ns\"\n}\n";
+}